@@ -0,0 +1,144 @@
+// CANAL CONFIABLE DE COMANDOS
+// Emisor del canal binario de canal_cmd.h: numera cada comando, mantiene
+// varios en vuelo (ventana deslizante) y retransmite por timeout solo los
+// que el acuse selectivo del STM32 todavía no cubre
+
+const { encodeCommandFrame } = require("./telemetria");
+
+// Tramas adelantadas que el STM32 puede retener (CANAL_CMD_RETENIDOS en
+// canal_cmd.h); una ventana mayor convierte el reordenamiento en descartes
+const RETENIDOS_STM32 = 8;
+
+// Diferencia con signo entre dos seq de 16 bits
+function seqDiff(a, b) {
+    return ((a - b + 0x8000) & 0xFFFF) - 0x8000;
+}
+
+// write(buffer) envía bytes al puerto. Opciones:
+//   windowSize  distancia máxima entre el seq más antiguo sin confirmar y
+//               el próximo (máximo RETENIDOS_STM32)
+//   rtoMs       espera antes de retransmitir
+//   maxRetries  retransmisiones antes de rendirse con un comando
+function createCommandChannel(write, opciones = {}) {
+    const windowSize = Math.min(opciones.windowSize || RETENIDOS_STM32, RETENIDOS_STM32);
+    const rtoMs = opciones.rtoMs || 300;
+    const maxRetries = opciones.maxRetries !== undefined ? opciones.maxRetries : 10;
+    const now = opciones.now || Date.now;
+
+    // Sesión y seq inicial al azar: un puente reiniciado nunca reutiliza la
+    // numeración que el STM32 todavía recuerda
+    const sesion = opciones.sesion !== undefined ? opciones.sesion : (Math.random() * 256) | 0;
+    let nextSeq = opciones.seqInicial !== undefined ? opciones.seqInicial : (Math.random() * 0x10000) | 0;
+
+    const inFlight = new Map();     // seq -> { texto, enviado, intentos, resolve, reject }
+    const cola = [];                // comandos esperando lugar en la ventana
+    let timer = null;
+
+    const stats = {
+        sent: 0,
+        acked: 0,
+        retransmits: 0,
+        failed: 0,
+        acks: 0
+    };
+
+    // seq más antiguo sin confirmar (o el próximo si no hay ninguno)
+    function ventana() {
+        let min = null;
+        for (const seq of inFlight.keys()) {
+            if (min === null || seqDiff(seq, min) < 0) min = seq;
+        }
+        return min === null ? nextSeq : min;
+    }
+
+    function transmitir(seq, entrada) {
+        entrada.enviado = now();
+        write(encodeCommandFrame(seq, ventana(), sesion, entrada.texto));
+    }
+
+    // La ventana limita la distancia al más antiguo sin confirmar, no la
+    // cantidad en vuelo: el STM32 solo retiene RETENIDOS_STM32 seq por
+    // delante de base (el acuse cubre 32, pero más allá se descartan)
+    function llenarVentana() {
+        while (cola.length > 0 && seqDiff(nextSeq, ventana()) < windowSize) {
+            const entrada = cola.shift();
+            const seq = nextSeq;
+            nextSeq = (nextSeq + 1) & 0xFFFF;
+            entrada.intentos = 0;
+            inFlight.set(seq, entrada);
+            stats.sent++;
+            transmitir(seq, entrada);
+        }
+        programar();
+    }
+
+    function programar() {
+        if (timer || inFlight.size === 0) return;
+        timer = setTimeout(revisar, Math.max(10, rtoMs / 4));
+    }
+
+    // Retransmite lo vencido; se rinde tras maxRetries
+    function revisar() {
+        timer = null;
+        const t = now();
+
+        for (const [seq, entrada] of inFlight) {
+            if (t - entrada.enviado < rtoMs) continue;
+
+            if (entrada.intentos >= maxRetries) {
+                inFlight.delete(seq);
+                stats.failed++;
+                entrada.reject(new Error(`Comando sin acuse: ${entrada.texto}`));
+                continue;
+            }
+            entrada.intentos++;
+            stats.retransmits++;
+            transmitir(seq, entrada);
+        }
+        llenarVentana();
+    }
+
+    // Acuse del STM32: base = primer seq sin recibir, bit i = base + i recibido
+    function onAck(base, mask) {
+        stats.acks++;
+
+        for (const [seq, entrada] of inFlight) {
+            const d = seqDiff(seq, base);
+            if (d < 0 || (d < 32 && (mask >>> d) & 1)) {
+                inFlight.delete(seq);
+                stats.acked++;
+                entrada.resolve(seq);
+            }
+        }
+        llenarVentana();
+    }
+
+    // Encola un comando de texto; la promesa se cumple con su acuse
+    function send(texto) {
+        return new Promise((resolve, reject) => {
+            cola.push({ texto, resolve, reject });
+            llenarVentana();
+        });
+    }
+
+    // Descarta lo pendiente (puerto cerrado)
+    function close() {
+        if (timer) clearTimeout(timer);
+        timer = null;
+        const error = new Error("Canal cerrado");
+        for (const entrada of inFlight.values()) entrada.reject(error);
+        for (const entrada of cola) entrada.reject(error);
+        inFlight.clear();
+        cola.length = 0;
+    }
+
+    return {
+        send,
+        onAck,
+        close,
+        stats,
+        pending: () => inFlight.size + cola.length
+    };
+}
+
+module.exports = { createCommandChannel, seqDiff };
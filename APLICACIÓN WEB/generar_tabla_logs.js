@@ -0,0 +1,56 @@
+// GENERADOR DE TABLA DE LOGS
+// Lee log_mensajes.h del firmware y genera log_tabla.json para que el
+// bridge expanda los mensajes binarios de log (ID + argumentos)
+
+const fs = require("fs");
+const path = require("path");
+
+const origen = process.argv[2] ||
+    path.join(__dirname, "..", "FreeRTOS_Blink_Concurrente", "Core", "Inc", "log_mensajes.h");
+const destino = process.argv[3] || path.join(__dirname, "log_tabla.json");
+
+const NIVELES = { LOG_DEBUG: "DEBUG", LOG_INFO: "INFO", LOG_WARN: "WARN", LOG_ERROR: "ERROR" };
+
+// Conversión printf -> carácter de firma esperado
+const CONVERSION = { d: "d", i: "d", u: "u", s: "s", f: "f" };
+
+// Extrae la firma que implica el texto de formato
+function firmaDeFormato(formato) {
+    let firma = "";
+    const re = /%(%|[-+ 0#]*\d*(?:\.\d+)?([a-z]))/g;
+    let m;
+    while ((m = re.exec(formato)) !== null) {
+        if (m[1] === "%") continue;
+        firma += CONVERSION[m[2]] || "?";
+    }
+    return firma;
+}
+
+const texto = fs.readFileSync(origen, "utf8");
+const re = /X\(\s*(\w+)\s*,\s*(\w+)\s*,\s*"([^"]*)"\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)/g;
+
+const mensajes = [];
+let errores = 0;
+let m;
+
+while ((m = re.exec(texto)) !== null) {
+    const [, nombre, nivel, firma, formato] = m;
+
+    if (!NIVELES[nivel]) {
+        console.error(`${nombre}: nivel desconocido ${nivel}`);
+        errores++;
+    }
+    if (firmaDeFormato(formato) !== firma) {
+        console.error(`${nombre}: firma "${firma}" no coincide con el formato "${formato}"`);
+        errores++;
+    }
+
+    mensajes.push({ id: mensajes.length, nombre, nivel: NIVELES[nivel] || nivel, firma, formato });
+}
+
+if (errores > 0) {
+    process.exit(1);
+}
+
+fs.writeFileSync(destino, JSON.stringify({ version: 1, mensajes }, null, 2) + "\n");
+console.log(`${mensajes.length} mensajes -> ${destino}`);
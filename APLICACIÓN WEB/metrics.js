@@ -11,11 +11,19 @@ let driverTotalChart = null;
 let restaurantPrepChart = null;
 let houseDeliveryChart = null;
 
-// Datos agregados por entidad
-const driverPickupTimes = new Map();
-const driverTotalTimes = new Map();
-const restaurantPrepTimes = new Map();
-const houseDeliveryTimes = new Map();
+// Solo se guardan los últimos pedidos (gráfico y detalle); los promedios
+// y percentiles los calcula el STM32 (global_metrics / entity_metrics)
+const MAX_RECENT_ORDERS = 20;
+
+// Orden de las etapas en entity_metrics
+const STAGE = { queue: 0, prep: 1, wait: 2, drive: 3, total: 4 };
+
+// Resumen por entidad del STM32: id -> { n, stages: [{ avg, sd, min, max }] } (segundos)
+const restaurantStats = new Map();
+const driverStats = new Map();
+
+// Por casa el STM32 no resume: media incremental sin guardar muestras
+const houseStats = new Map();
 
 // Sistema de puntuación
 const driverScores = new Map();
@@ -58,7 +66,7 @@ window.handleMetricsData = function(metricsJson) {
         }
     }
     
-    // Guardar métricas
+    // Guardar métricas (solo los últimos pedidos)
     metricsData.set(receiptNumber, {
         t_queue_kitchen: parseFloat(metricsJson.t_queue_kitchen) || 0,
         t_prep: parseFloat(metricsJson.t_prep) || 0,
@@ -69,55 +77,76 @@ window.handleMetricsData = function(metricsJson) {
         restaurant_id: restaurantId,
         house_id: houseId
     });
+    while (metricsData.size > MAX_RECENT_ORDERS) {
+        metricsData.delete(metricsData.keys().next().value);
+    }
     
     console.log(`Métricas recibidas para ${receiptNumber}:`, metricsData.get(receiptNumber));
     
-    // Agregar datos del repartidor
+    // Sumar puntos al repartidor
     if (driverId !== undefined) {
-        if (!driverPickupTimes.has(driverId)) {
-            driverPickupTimes.set(driverId, []);
-        }
-        if (!driverTotalTimes.has(driverId)) {
-            driverTotalTimes.set(driverId, []);
-        }
-        driverPickupTimes.get(driverId).push(parseFloat(metricsJson.t_wait_driver) || 0);
-        driverTotalTimes.get(driverId).push(parseFloat(metricsJson.t_drive) || 0);
-        
-        // Sumar puntos
         if (!driverScores.has(driverId)) {
             driverScores.set(driverId, 0);
         }
         driverScores.set(driverId, driverScores.get(driverId) + 10);
     }
     
-    // Agregar datos del restaurante
-    if (restaurantId !== undefined) {
-        if (!restaurantPrepTimes.has(restaurantId)) {
-            restaurantPrepTimes.set(restaurantId, []);
-        }
-        restaurantPrepTimes.get(restaurantId).push(parseFloat(metricsJson.t_prep) || 0);
-        console.log(`📊 Tiempo de prep agregado a R${restaurantId}: ${metricsJson.t_prep}s`);
-    }
-    
-    // Agregar datos de la casa
+    // Acumular entrega de la casa
     if (houseId !== undefined) {
-        if (!houseDeliveryTimes.has(houseId)) {
-            houseDeliveryTimes.set(houseId, []);
+        if (!houseStats.has(houseId)) {
+            houseStats.set(houseId, { n: 0, mean: 0, m2: 0, min: Infinity, max: 0 });
         }
-        houseDeliveryTimes.get(houseId).push({
-            time: parseFloat(metricsJson.t_total) || 0,
-            receipt: receiptNumber
-        });
+        addSample(houseStats.get(houseId), parseFloat(metricsJson.t_total) || 0);
     }
     
     updateMetricsDisplay();
-    updateDriverPickupChart();
-    updateDriverTotalChart();
-    updateRestaurantPrepChart();
     updateHouseDeliveryChart();
     updateDriverScoreboard();
 };
 
+// Welford: actualiza media, varianza, mínimo y máximo con una muestra
+function addSample(acc, x) {
+    acc.n++;
+    const delta = x - acc.mean;
+    acc.mean += delta / acc.n;
+    acc.m2 += delta * (x - acc.mean);
+    acc.min = Math.min(acc.min, x);
+    acc.max = Math.max(acc.max, x);
+}
+
+// Resumen de un acumulador local en el formato de entity_metrics
+function summarize(acc) {
+    return {
+        avg: acc.mean,
+        sd: acc.n > 1 ? Math.sqrt(acc.m2 / (acc.n - 1)) : 0,
+        min: acc.n > 0 ? acc.min : 0,
+        max: acc.max
+    };
+}
+
+// Recibe el resumen de un restaurante o repartidor calculado por el STM32
+window.handleEntityMetrics = function(data) {
+    const target = data.kind === 'rest' ? restaurantStats :
+                   data.kind === 'driver' ? driverStats : null;
+    if (!target || !Array.isArray(data.s)) return;
+    
+    target.set(data.id, {
+        n: data.n,
+        stages: data.s.map(([avg, sd, min, max]) => ({
+            avg: avg / 1000,
+            sd: sd / 1000,
+            min: min / 1000,
+            max: max / 1000
+        }))
+    });
+    
+    if (data.kind === 'rest') {
+        updateRestaurantPrepChart();
+    } else {
+        updateDriverPickupChart();
+        updateDriverTotalChart();
+    }
+};
 // Recibe estadísticas globales calculadas por el STM32
 window.handleGlobalMetrics = function(data) {
     console.log('Métricas globales del STM32:', data);
@@ -129,17 +158,36 @@ window.handleGlobalMetrics = function(data) {
         avg_wait: parseFloat(data.avg_wait) || 0,
         avg_delivery: parseFloat(data.avg_delivery) || 0,
         p50_total: parseFloat(data.p50_total) || 0,
+        p90_total: parseFloat(data.p90_total) || 0,
         p95_total: parseFloat(data.p95_total) || 0,
+        p99_total: parseFloat(data.p99_total) || 0,
+        max_total: parseFloat(data.max_total) || 0,
         p50_prep: parseFloat(data.p50_prep) || 0,
         p95_prep: parseFloat(data.p95_prep) || 0,
         analyzed: parseInt(data.analyzed) || 0
     };
     
+    updateSummaryCards(data);
+    
+    // Ventanas móviles: [pedidos/min, entregas/min, p50, p95, p99 total]
+    const windows = [['1 min', data.win_1m], ['5 min', data.win_5m], ['15 min', data.win_15m]]
+        .filter(([, w]) => Array.isArray(w) && w.length >= 5);
+    const windowRows = windows.map(([label, [orders, deliveries, p50, p95, p99]]) => `
+                    <tr>
+                        <td>${label}</td>
+                        <td>${orders.toFixed(2)}</td>
+                        <td>${deliveries.toFixed(2)}</td>
+                        <td>${p50.toFixed(1)}s</td>
+                        <td>${p95.toFixed(1)}s</td>
+                        <td>${p99.toFixed(1)}s</td>
+                    </tr>`).join('');
+    
     // Log de métricas
     console.log(`[STM32] Promedio Total: ${stm32Metrics.avg_total.toFixed(2)}s`);
     console.log(`[STM32] Promedio Preparación: ${stm32Metrics.avg_prep.toFixed(2)}s`);
     console.log(`[STM32] P50 Total: ${stm32Metrics.p50_total.toFixed(2)}s`);
     console.log(`[STM32] P95 Total: ${stm32Metrics.p95_total.toFixed(2)}s`);
+    console.log(`[STM32] P99 Total: ${stm32Metrics.p99_total.toFixed(2)}s`);
     console.log(`[STM32] P50 Prep: ${stm32Metrics.p50_prep.toFixed(2)}s`);
     console.log(`[STM32] P95 Prep: ${stm32Metrics.p95_prep.toFixed(2)}s`);
     console.log(`[STM32] Pedidos analizados: ${stm32Metrics.analyzed}`);
@@ -171,11 +219,26 @@ window.handleGlobalMetrics = function(data) {
                         <span class="stm32-value">${stm32Metrics.p50_total.toFixed(2)}s</span>
                     </div>
                     
+                    <div class="stm32-metric">
+                        <span class="stm32-label">P90 Total</span>
+                        <span class="stm32-value">${stm32Metrics.p90_total.toFixed(2)}s</span>
+                    </div>
+                    
                     <div class="stm32-metric">
                         <span class="stm32-label">P95 Total</span>
                         <span class="stm32-value">${stm32Metrics.p95_total.toFixed(2)}s</span>
                     </div>
                     
+                    <div class="stm32-metric">
+                        <span class="stm32-label">P99 Total</span>
+                        <span class="stm32-value">${stm32Metrics.p99_total.toFixed(2)}s</span>
+                    </div>
+                    
+                    <div class="stm32-metric">
+                        <span class="stm32-label">Máximo Total</span>
+                        <span class="stm32-value">${stm32Metrics.max_total.toFixed(2)}s</span>
+                    </div>
+                    
                     <div class="stm32-metric">
                         <span class="stm32-label">P50 Preparación</span>
                         <span class="stm32-value">${stm32Metrics.p50_prep.toFixed(2)}s</span>
@@ -186,6 +249,22 @@ window.handleGlobalMetrics = function(data) {
                         <span class="stm32-value">${stm32Metrics.p95_prep.toFixed(2)}s</span>
                     </div>
                 </div>
+                
+                ${windows.length > 0 ? `
+                <table class="metrics-table" style="margin-top: 15px;">
+                    <thead>
+                        <tr>
+                            <th>Ventana</th>
+                            <th>Pedidos/min</th>
+                            <th>Entregas/min</th>
+                            <th>P50 Total</th>
+                            <th>P95 Total</th>
+                            <th>P99 Total</th>
+                        </tr>
+                    </thead>
+                    <tbody>${windowRows}
+                    </tbody>
+                </table>` : ''}
             </div>
         `;
     }
@@ -463,64 +542,35 @@ function initializeHouseDeliveryChart() {
     });
 }
 
-// Actualiza todas las secciones de métricas
+// Actualiza el gráfico y el detalle de los últimos pedidos
 function updateMetricsDisplay() {
-    const allMetrics = Array.from(metricsData.values());
-    
-    if (allMetrics.length === 0) {
+    if (metricsData.size === 0) {
         updateEmptyState();
         return;
     }
     
-    const stats = calculateAggregatedStats(allMetrics);
-    updateSummaryCards(stats);
     updateChart();
     updateDetailedTable();
 }
 
-// Calcula estadísticas agregadas
-function calculateAggregatedStats(metrics) {
-    const fields = ['t_queue_kitchen', 't_prep', 't_wait_driver', 't_drive', 't_total'];
-    const stats = {};
-    
-    fields.forEach(field => {
-        const values = metrics.map(m => m[field]).filter(v => v > 0).sort((a, b) => a - b);
-        
-        if (values.length === 0) {
-            stats[field] = { avg: 0, p50: 0, p90: 0 };
-            return;
-        }
-        
-        const avg = values.reduce((sum, v) => sum + v, 0) / values.length;
-        
-        const p50Index = Math.floor(values.length * 0.5);
-        const p50 = values[p50Index];
-        
-        const p90Index = Math.floor(values.length * 0.9);
-        const p90 = values[p90Index];
-        
-        stats[field] = { avg, p50, p90 };
-    });
-    
-    return stats;
-}
-
-// Actualiza las tarjetas de resumen
-function updateSummaryCards(stats) {
+// Actualiza las tarjetas de resumen con global_metrics del STM32
+function updateSummaryCards(data) {
     const fields = [
-        { key: 't_queue_kitchen', prefix: 'queue' },
-        { key: 't_prep', prefix: 'prep' },
-        { key: 't_wait_driver', prefix: 'wait' },
-        { key: 't_drive', prefix: 'drive' },
-        { key: 't_total', prefix: 'total' }
+        { key: 'queue', prefix: 'queue' },
+        { key: 'prep', prefix: 'prep' },
+        { key: 'wait', prefix: 'wait' },
+        { key: 'delivery', prefix: 'drive' },
+        { key: 'total', prefix: 'total' }
     ];
     
     fields.forEach(({ key, prefix }) => {
-        const stat = stats[key];
+        const avg = parseFloat(data[`avg_${key}`]) || 0;
+        const p50 = parseFloat(data[`p50_${key}`]) || 0;
+        const p90 = parseFloat(data[`p90_${key}`]) || 0;
         
-        document.getElementById(`metric-avg-${prefix}`).textContent = `${stat.avg.toFixed(1)}s`;
-        document.getElementById(`metric-p50-${prefix}`).textContent = `${stat.p50.toFixed(1)}s`;
-        document.getElementById(`metric-p90-${prefix}`).textContent = `${stat.p90.toFixed(1)}s`;
+        document.getElementById(`metric-avg-${prefix}`).textContent = `${avg.toFixed(1)}s`;
+        document.getElementById(`metric-p50-${prefix}`).textContent = `${p50.toFixed(1)}s`;
+        document.getElementById(`metric-p90-${prefix}`).textContent = `${p90.toFixed(1)}s`;
     });
 }
 
@@ -545,66 +595,33 @@ function updateChart() {
     metricsChart.update();
 }
 
+// Llena un gráfico de barras con el promedio de una etapa por entidad
+function fillEntityChart(chart, stats, label, stage) {
+    const sorted = Array.from(stats.entries()).sort((a, b) => a[0] - b[0]);
+    
+    chart.data.labels = sorted.map(([id]) => `${label}${id}`);
+    chart.data.datasets[0].data = sorted.map(([, s]) => s.stages[stage].avg);
+    chart.update();
+}
+
 // Actualiza gráfico de pickup de repartidores
 function updateDriverPickupChart() {
     if (!driverPickupChart) return;
-    
-    const labels = [];
-    const data = [];
-    
-    for (let [driverId, times] of driverPickupTimes) {
-        if (times.length === 0) continue;
-        const avg = times.reduce((sum, t) => sum + t, 0) / times.length;
-        labels.push(`M${driverId}`);
-        data.push(avg);
-    }
-    
-    driverPickupChart.data.labels = labels;
-    driverPickupChart.data.datasets[0].data = data;
-    driverPickupChart.update();
-    
+    fillEntityChart(driverPickupChart, driverStats, 'M', STAGE.wait);
     updateDriverPickupTable();
 }
 
 // Actualiza gráfico de tiempo total de repartidores
 function updateDriverTotalChart() {
     if (!driverTotalChart) return;
-    
-    const labels = [];
-    const data = [];
-    
-    for (let [driverId, times] of driverTotalTimes) {
-        if (times.length === 0) continue;
-        const avg = times.reduce((sum, t) => sum + t, 0) / times.length;
-        labels.push(`M${driverId}`);
-        data.push(avg);
-    }
-    
-    driverTotalChart.data.labels = labels;
-    driverTotalChart.data.datasets[0].data = data;
-    driverTotalChart.update();
-    
+    fillEntityChart(driverTotalChart, driverStats, 'M', STAGE.drive);
     updateDriverTotalTable();
 }
 
 // Actualiza gráfico de preparación de restaurantes
 function updateRestaurantPrepChart() {
     if (!restaurantPrepChart) return;
-    
-    const labels = [];
-    const data = [];
-    
-    for (let [restId, times] of restaurantPrepTimes) {
-        if (times.length === 0) continue;
-        const avg = times.reduce((sum, t) => sum + t, 0) / times.length;
-        labels.push(`R${restId}`);
-        data.push(avg);
-    }
-    
-    restaurantPrepChart.data.labels = labels;
-    restaurantPrepChart.data.datasets[0].data = data;
-    restaurantPrepChart.update();
-    
+    fillEntityChart(restaurantPrepChart, restaurantStats, 'R', STAGE.prep);
     updateRestaurantPrepTable();
 }
 
@@ -612,78 +629,60 @@ function updateRestaurantPrepChart() {
 function updateHouseDeliveryChart() {
     if (!houseDeliveryChart) return;
     
-    const labels = [];
-    const data = [];
-    
-    for (let [houseId, deliveries] of houseDeliveryTimes) {
-        if (deliveries.length === 0) continue;
-        const avg = deliveries.reduce((sum, d) => sum + d.time, 0) / deliveries.length;
-        labels.push(`H${houseId}`);
-        data.push(avg);
+    const houses = new Map();
+    for (const [houseId, acc] of houseStats) {
+        houses.set(houseId, { n: acc.n, stages: [null, null, null, null, summarize(acc)] });
     }
-    
-    houseDeliveryChart.data.labels = labels;
-    houseDeliveryChart.data.datasets[0].data = data;
-    houseDeliveryChart.update();
-    
+    fillEntityChart(houseDeliveryChart, houses, 'H', STAGE.total);
     updateHouseDeliveryTable();
 }
 
-// Actualiza tabla de entregas por casa
-function updateHouseDeliveryTable() {
-    const tbody = document.getElementById('houseDeliveryTableBody');
+// Tabla de una etapa por entidad: pedidos, promedio ± desviación y rango
+function renderEntityTable(tbodyId, rows, label, color) {
+    const tbody = document.getElementById(tbodyId);
     if (!tbody) return;
     
-    const houseOrders = new Map();
-    
-    // Agrupar por casa
-    for (let [houseId, deliveries] of houseDeliveryTimes) {
-        if (!houseOrders.has(houseId)) {
-            houseOrders.set(houseId, []);
-        }
-        deliveries.forEach(d => {
-            houseOrders.get(houseId).push({
-                receipt: d.receipt,
-                time: d.time
-            });
-        });
-    }
-    
-    if (houseOrders.size === 0) {
+    if (rows.length === 0) {
         tbody.innerHTML = '<tr class="table-empty"><td colspan="3" style="text-align: center;">Sin datos</td></tr>';
         return;
     }
     
-    // Ordenar casas por ID
-    const sortedHouses = Array.from(houseOrders.entries()).sort((a, b) => a[0] - b[0]);
-    let html = '';
-    
-    sortedHouses.forEach(([houseId, orders]) => {
-        orders.sort((a, b) => b.time - a.time);
-        
-        // Primera fila con rowspan
-        html += `
-            <tr style="border-top: 3px solid #27ae60;">
-                <td rowspan="${orders.length}" style="color: #27ae60; font-weight: 900; vertical-align: middle; background: rgba(39, 174, 96, 0.1); text-align: center;">
-                    H${houseId}
-                </td>
-                <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[0].receipt}</td>
-                <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[0].time.toFixed(2)}s</td>
-            </tr>
-        `;
-        
-        // Filas adicionales
-        for (let i = 1; i < orders.length; i++) {
-            html += `
-                <tr>
-                    <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[i].receipt}</td>
-                    <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[i].time.toFixed(2)}s</td>
-                </tr>
-            `;
-        }
-    });
-    
-    tbody.innerHTML = html;
+    tbody.innerHTML = rows.sort((a, b) => a.id - b.id).map(({ id, n, stat }) => `
+        <tr>
+            <td style="color: ${color}; font-weight: 900; text-align: center;">${label}${id}</td>
+            <td style="color: #ffaa00; font-weight: 800; text-align: center;">${n}</td>
+            <td style="color: #00ffff; font-weight: 900; text-align: center;">
+                ${stat.avg.toFixed(2)}s ± ${stat.sd.toFixed(2)}
+                <span style="color: #888; font-weight: 400;">(${stat.min.toFixed(2)}–${stat.max.toFixed(2)}s)</span>
+            </td>
+        </tr>
+    `).join('');
+}
+
+// Filas para renderEntityTable desde un resumen del STM32
+function entityRows(stats, stage) {
+    return Array.from(stats.entries()).map(([id, s]) => ({ id, n: s.n, stat: s.stages[stage] }));
+}
+
+// Actualiza tabla de entregas por casa
+function updateHouseDeliveryTable() {
+    const rows = Array.from(houseStats.entries()).map(([id, acc]) => ({ id, n: acc.n, stat: summarize(acc) }));
+    renderEntityTable('houseDeliveryTableBody', rows, 'H', '#27ae60');
+}
+
+// Actualiza tabla de pickup por motorista
+function updateDriverPickupTable() {
+    renderEntityTable('driverPickupTableBody', entityRows(driverStats, STAGE.wait), 'M', '#f1c40f');
+}
+
+// Actualiza tabla de entrega por motorista
+function updateDriverTotalTable() {
+    renderEntityTable('driverTotalTableBody', entityRows(driverStats, STAGE.drive), 'M', '#f1c40f');
+}
+
+// Actualiza tabla de preparación por restaurante
+function updateRestaurantPrepTable() {
+    renderEntityTable('restaurantPrepTableBody', entityRows(restaurantStats, STAGE.prep), 'R', '#e74c3c');
 }
 
 // Actualiza ranking de repartidores
@@ -765,10 +764,9 @@ function updateEmptyState() {
 // Limpia todas las métricas
 window.clearMetrics = function() {
     metricsData.clear();
-    driverPickupTimes.clear();
-    driverTotalTimes.clear();
-    restaurantPrepTimes.clear();
-    houseDeliveryTimes.clear();
+    restaurantStats.clear();
+    driverStats.clear();
+    houseStats.clear();
     driverScores.clear();
     updateEmptyState();
     updateDriverPickupChart();
@@ -1045,162 +1043,3 @@ window.clearDishesData = function() {
 };
 
 console.log('Sistema de métricas de platillos inicializado');
-
-// Actualiza tabla de pickup por motorista
-function updateDriverPickupTable() {
-    const tbody = document.getElementById('driverPickupTableBody');
-    if (!tbody) return;
-    
-    const driverOrders = new Map();
-    
-    for (let [receipt, metrics] of metricsData) {
-        if (metrics.driver_id !== undefined) {
-            if (!driverOrders.has(metrics.driver_id)) {
-                driverOrders.set(metrics.driver_id, []);
-            }
-            driverOrders.get(metrics.driver_id).push({
-                receipt: receipt,
-                time: metrics.t_wait_driver
-            });
-        }
-    }
-    
-    if (driverOrders.size === 0) {
-        tbody.innerHTML = '<tr class="table-empty"><td colspan="3" style="text-align: center;">Sin datos</td></tr>';
-        return;
-    }
-    
-    const sortedDrivers = Array.from(driverOrders.entries()).sort((a, b) => a[0] - b[0]);
-    let html = '';
-    
-    sortedDrivers.forEach(([driverId, orders]) => {
-        orders.sort((a, b) => b.time - a.time);
-        
-        html += `
-            <tr style="border-top: 3px solid #f1c40f;">
-                <td rowspan="${orders.length}" style="color: #f1c40f; font-weight: 900; vertical-align: middle; background: rgba(241, 196, 15, 0.1); text-align: center;">
-                    M${driverId}
-                </td>
-                <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[0].receipt}</td>
-                <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[0].time.toFixed(2)}s</td>
-            </tr>
-        `;
-        
-        for (let i = 1; i < orders.length; i++) {
-            html += `
-                <tr>
-                    <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[i].receipt}</td>
-                    <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[i].time.toFixed(2)}s</td>
-                </tr>
-            `;
-        }
-    });
-    
-    tbody.innerHTML = html;
-}
-
-// Actualiza tabla de entrega por motorista
-function updateDriverTotalTable() {
-    const tbody = document.getElementById('driverTotalTableBody');
-    if (!tbody) return;
-    
-    const driverOrders = new Map();
-    
-    for (let [receipt, metrics] of metricsData) {
-        if (metrics.driver_id !== undefined) {
-            if (!driverOrders.has(metrics.driver_id)) {
-                driverOrders.set(metrics.driver_id, []);
-            }
-            driverOrders.get(metrics.driver_id).push({
-                receipt: receipt,
-                time: metrics.t_drive
-            });
-        }
-    }
-    
-    if (driverOrders.size === 0) {
-        tbody.innerHTML = '<tr class="table-empty"><td colspan="3" style="text-align: center;">Sin datos</td></tr>';
-        return;
-    }
-    
-    const sortedDrivers = Array.from(driverOrders.entries()).sort((a, b) => a[0] - b[0]);
-    let html = '';
-    
-    sortedDrivers.forEach(([driverId, orders]) => {
-        orders.sort((a, b) => b.time - a.time);
-        
-        html += `
-            <tr style="border-top: 3px solid #f1c40f;">
-                <td rowspan="${orders.length}" style="color: #f1c40f; font-weight: 900; vertical-align: middle; background: rgba(241, 196, 15, 0.1); text-align: center;">
-                    M${driverId}
-                </td>
-                <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[0].receipt}</td>
-                <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[0].time.toFixed(2)}s</td>
-            </tr>
-        `;
-        
-        for (let i = 1; i < orders.length; i++) {
-            html += `
-                <tr>
-                    <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[i].receipt}</td>
-                    <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[i].time.toFixed(2)}s</td>
-                </tr>
-            `;
-        }
-    });
-    
-    tbody.innerHTML = html;
-}
-
-// Actualiza tabla de preparación por restaurante
-function updateRestaurantPrepTable() {
-    const tbody = document.getElementById('restaurantPrepTableBody');
-    if (!tbody) return;
-    
-    const restaurantOrders = new Map();
-    
-    for (let [receipt, metrics] of metricsData) {
-        if (metrics.restaurant_id !== undefined) {
-            if (!restaurantOrders.has(metrics.restaurant_id)) {
-                restaurantOrders.set(metrics.restaurant_id, []);
-            }
-            restaurantOrders.get(metrics.restaurant_id).push({
-                receipt: receipt,
-                time: metrics.t_prep
-            });
-        }
-    }
-    
-    if (restaurantOrders.size === 0) {
-        tbody.innerHTML = '<tr class="table-empty"><td colspan="3" style="text-align: center;">Sin datos</td></tr>';
-        return;
-    }
-    
-    const sortedRestaurants = Array.from(restaurantOrders.entries()).sort((a, b) => a[0] - b[0]);
-    let html = '';
-    
-    sortedRestaurants.forEach(([restaurantId, orders]) => {
-        orders.sort((a, b) => b.time - a.time);
-        
-        html += `
-            <tr style="border-top: 3px solid #e74c3c;">
-                <td rowspan="${orders.length}" style="color: #e74c3c; font-weight: 900; vertical-align: middle; background: rgba(231, 76, 60, 0.1); text-align: center;">
-                    R${restaurantId}
-                </td>
-                <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[0].receipt}</td>
-                <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[0].time.toFixed(2)}s</td>
-            </tr>
-        `;
-        
-        for (let i = 1; i < orders.length; i++) {
-            html += `
-                <tr>
-                    <td style="color: #ffaa00; font-weight: 800; text-align: center;">${orders[i].receipt}</td>
-                    <td style="color: #00ffff; font-weight: 900; text-align: center;">${orders[i].time.toFixed(2)}s</td>
-                </tr>
-            `;
-        }
-    });
-    
-    tbody.innerHTML = html;
-}
\ No newline at end of file
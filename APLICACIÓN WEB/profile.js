@@ -0,0 +1,213 @@
+// Perfil de tareas del STM32
+// Grafica task_stats: CPU y pila libre por tarea, heap y ocupación de colas;
+// tablas de sondas de duración (probes) y de cerrojos (locks)
+
+const MAX_HEAP_SAMPLES = 60;
+const LOCK_KINDS = { M: 'Mutex', S: 'Semáforo', Q: 'Cola' };
+
+let taskCpuChart = null;
+let taskStackChart = null;
+let heapChart = null;
+let queueDepthChart = null;
+
+// Último mensaje locks de cada grupo
+const lockGroups = new Map();
+
+// Opciones comunes de los gráficos del panel
+function profileChartOptions(unit) {
+    return {
+        responsive: true,
+        maintainAspectRatio: false,
+        animation: false,
+        scales: {
+            x: {
+                ticks: { color: '#00d9ff', font: { weight: 'bold' } },
+                grid: { color: 'rgba(0, 217, 255, 0.1)' }
+            },
+            y: {
+                beginAtZero: true,
+                ticks: {
+                    color: '#00ff00',
+                    font: { weight: 'bold' },
+                    callback: (value) => `${value}${unit}`
+                },
+                grid: { color: 'rgba(0, 255, 0, 0.1)' }
+            }
+        },
+        plugins: {
+            legend: {
+                labels: {
+                    color: '#00ffff',
+                    font: { weight: 'bold', size: 11 }
+                }
+            }
+        }
+    };
+}
+
+// Crea un gráfico de barras con un dataset
+function createProfileBarChart(id, label, color, unit) {
+    const ctx = document.getElementById(id);
+    if (!ctx) return null;
+    
+    return new Chart(ctx, {
+        type: 'bar',
+        data: {
+            labels: [],
+            datasets: [{
+                label: label,
+                data: [],
+                backgroundColor: color.replace('1)', '0.7)'),
+                borderColor: color,
+                borderWidth: 2
+            }]
+        },
+        options: profileChartOptions(unit)
+    });
+}
+
+// Inicializa los gráficos del panel
+function initializeProfileCharts() {
+    taskCpuChart = createProfileBarChart('taskCpuChart', 'CPU (%)', 'rgba(155, 89, 182, 1)', '%');
+    taskStackChart = createProfileBarChart('taskStackChart', 'Pila libre mínima (bytes)', 'rgba(52, 152, 219, 1)', ' B');
+    queueDepthChart = createProfileBarChart('queueDepthChart', 'Ocupación (%)', 'rgba(230, 126, 34, 1)', '%');
+    
+    const ctx = document.getElementById('heapChart');
+    if (!ctx) return;
+    
+    heapChart = new Chart(ctx, {
+        type: 'line',
+        data: {
+            labels: [],
+            datasets: [
+                {
+                    label: 'Heap libre (bytes)',
+                    data: [],
+                    borderColor: '#2ecc71',
+                    backgroundColor: 'rgba(46, 204, 113, 0.2)',
+                    borderWidth: 2,
+                    pointRadius: 0,
+                    fill: true
+                },
+                {
+                    label: 'Mínimo histórico (bytes)',
+                    data: [],
+                    borderColor: '#e74c3c',
+                    borderWidth: 2,
+                    pointRadius: 0,
+                    borderDash: [6, 4]
+                }
+            ]
+        },
+        options: profileChartOptions(' B')
+    });
+}
+
+// Recibe task_stats del STM32
+// tasks: [nombre, cpu %, pila libre mínima, prioridad, estado]
+// queues: [nombre, ocupados, capacidad]
+window.handleTaskStats = function(data) {
+    const tasks = Array.isArray(data.tasks) ? data.tasks : [];
+    const queues = Array.isArray(data.queues) ? data.queues : [];
+    
+    if (taskCpuChart) {
+        taskCpuChart.data.labels = tasks.map(t => t[0]);
+        taskCpuChart.data.datasets[0].data = tasks.map(t => t[1]);
+        taskCpuChart.update();
+    }
+    
+    if (taskStackChart) {
+        taskStackChart.data.labels = tasks.map(t => t[0]);
+        taskStackChart.data.datasets[0].data = tasks.map(t => t[2]);
+        taskStackChart.update();
+    }
+    
+    if (queueDepthChart) {
+        queueDepthChart.data.labels = queues.map(q => `${q[0]} (${q[1]}/${q[2]})`);
+        queueDepthChart.data.datasets[0].data = queues.map(q => q[2] > 0 ? (q[1] * 100) / q[2] : 0);
+        queueDepthChart.update();
+    }
+    
+    if (heapChart) {
+        const labels = heapChart.data.labels;
+        const [free, min] = heapChart.data.datasets;
+        
+        labels.push(new Date().toLocaleTimeString());
+        free.data.push(data.heap_free);
+        min.data.push(data.heap_min);
+        
+        if (labels.length > MAX_HEAP_SAMPLES) {
+            labels.shift();
+            free.data.shift();
+            min.data.shift();
+        }
+        heapChart.update();
+    }
+};
+
+// Recibe probes del STM32
+// probes: [etiqueta, llamadas, min, promedio, max, p99]
+window.handleProbes = function(data) {
+    const body = document.getElementById('probesTableBody');
+    const unit = document.getElementById('probesUnit');
+    if (!body) return;
+    
+    if (unit) unit.textContent = data.unit === 'ns' ? 'ns' : 'ciclos';
+    
+    const probes = Array.isArray(data.probes) ? data.probes : [];
+    if (probes.length === 0) {
+        body.innerHTML = '<tr><td colspan="6">Sin llamadas registradas</td></tr>';
+        return;
+    }
+    body.innerHTML = probes.map(p => `
+        <tr>
+            <td>${p[0]}</td>
+            <td>${p[1]}</td>
+            <td>${p[2]}</td>
+            <td>${p[3]}</td>
+            <td>${p[4]}</td>
+            <td>${p[5]}</td>
+        </tr>`).join('');
+};
+
+// Recibe locks del STM32 (un mensaje por grupo)
+// locks: [índice, tomas, contenciones, timeouts, espera p50, p99, máx,
+//         tenencia promedio, tenencia máx]
+window.handleLocks = function(data) {
+    const body = document.getElementById('locksTableBody');
+    if (!body || !data.group) return;
+    
+    lockGroups.set(data.group, data);
+    
+    const rows = [];
+    for (const group of lockGroups.values()) {
+        const kind = LOCK_KINDS[group.kind] || group.kind;
+        const mutex = group.kind === 'M';
+        
+        for (const l of (Array.isArray(group.locks) ? group.locks : [])) {
+            const name = l[0] >= 0 ? `${group.group} ${l[0]}` : group.group;
+            const attempts = l[1] + l[3];
+            const contention = attempts > 0 ? ((l[2] * 100) / attempts).toFixed(1) : '0.0';
+            const timeoutClass = l[3] > 0 ? ' class="lock-timeouts"' : '';
+            
+            rows.push(`
+        <tr>
+            <td>${name}</td>
+            <td>${kind}</td>
+            <td>${l[1]}</td>
+            <td>${contention}%</td>
+            <td${timeoutClass}>${l[3]}</td>
+            <td>${l[4]}</td>
+            <td>${l[5]}</td>
+            <td>${l[6]}</td>
+            <td>${mutex ? l[7] : '-'}</td>
+            <td>${mutex ? l[8] : '-'}</td>
+        </tr>`);
+        }
+    }
+    body.innerHTML = rows.join('');
+};
+
+document.addEventListener('DOMContentLoaded', initializeProfileCharts);
+
+console.log('Panel de perfil de tareas inicializado');
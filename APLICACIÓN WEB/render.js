@@ -651,6 +651,79 @@ map3.canvas.addEventListener('click', (event) => {
     }
 });
 
+// Estados del frame de flota (mismo orden que EstadoRepartidor en el STM32)
+const FLEET_STATES = [
+    'DESOCUPADO',
+    'EN_CAMINO_A_RESTAURANTE',
+    'RECOGIENDO',
+    'EN_CAMINO_A_DESTINO',
+    'ENTREGANDO',
+    'EN_RUTA_SIGUIENTE'
+];
+
+// Aplica posición y estado de un repartidor a los mapas
+function applyDriverMovement(rep, av, ca, estado) {
+    map2Data.repartidores[rep] = {av: av, ca: ca};
+    
+    if (estado) {
+        map2.setDriverState(rep, estado);
+        map3.setDriverState(rep, estado);
+    }
+    
+    // Simular ruta visual del repartidor
+    if (estado === 'EN_CAMINO_A_RESTAURANTE' || estado === 'EN_CAMINO_A_DESTINO') {
+        const currentPos = {
+            x: av - 1,
+            y: 14 - (ca - 1)
+        };
+        
+        let targetPos = null;
+        
+        // Buscar destino del pedido
+        for (let order of activeOrders) {
+            if (order.repartidorId == rep && !order.entregado) {
+                if (estado === 'EN_CAMINO_A_RESTAURANTE' && order.restaurant) {
+                    const rest = map1Data.restaurantes[order.restaurant.id];
+                    if (rest) {
+                        targetPos = {
+                            x: (rest.av - 1) * 2 + 1,
+                            y: (6 - (rest.ca - 1)) * 2 + 1
+                        };
+                    }
+                } else if (estado === 'EN_CAMINO_A_DESTINO' && order.destination) {
+                    const house = map1Data.casas[order.destination.id];
+                    if (house) {
+                        targetPos = {
+                            x: (house.av - 1) * 2 + 1,
+                            y: (6 - (house.ca - 1)) * 2 + 1
+                        };
+                    }
+                }
+                break;
+            }
+        }
+        
+        // Crear ruta visual interpolada
+        if (targetPos) {
+            const route = [];
+            const steps = 20;
+            
+            for (let i = 0; i <= steps; i++) {
+                const t = i / steps;
+                route.push({
+                    x: currentPos.x + (targetPos.x - currentPos.x) * t,
+                    y: currentPos.y + (targetPos.y - currentPos.y) * t
+                });
+            }
+            
+            driverRoutes.set(rep, route);
+        }
+    } else {
+        // Limpiar ruta si no está en movimiento
+        driverRoutes.delete(rep);
+    }
+}
+
 // Conexión WebSocket con servidor bridge
 let ws = new WebSocket('ws://localhost:8081');
 window.ws = ws;
@@ -705,6 +778,30 @@ ws.onmessage = (e) => {
                 return;
             }
             
+            // Capturar métricas por restaurante y repartidor del STM32
+            if (json.type === 'entity_metrics' && window.handleEntityMetrics) {
+                window.handleEntityMetrics(json);
+                return;
+            }
+            
+            // Capturar perfil de tareas del STM32
+            if (json.type === 'task_stats' && window.handleTaskStats) {
+                window.handleTaskStats(json);
+                return;
+            }
+            
+            // Capturar sondas de duración del STM32
+            if (json.type === 'probes' && window.handleProbes) {
+                window.handleProbes(json);
+                return;
+            }
+            
+            // Capturar contadores de cerrojos del STM32
+            if (json.type === 'locks' && window.handleLocks) {
+                window.handleLocks(json);
+                return;
+            }
+            
             // Regenerar mapa completo
             if (json.type === 'map') {
                 map1Data = { restaurantes: {}, casas: {} };
@@ -778,68 +875,17 @@ ws.onmessage = (e) => {
                 redrawAll();
             }
 
-            // Actualizar movimiento de repartidor
+            // Frame de flota: solo los repartidores que cambiaron en el tick
+            if (json.type === 'fleet') {
+                json.d.forEach(([rep, av, ca, estado]) => {
+                    applyDriverMovement(rep, av, ca, FLEET_STATES[estado] || 'DESCONOCIDO');
+                });
+                redrawAll();
+            }
+
+            // Movimiento individual (firmware anterior)
             if (json.type === 'mov') {
-                map2Data.repartidores[json.rep] = {av: json.av, ca: json.ca};
-                
-                if (json.estado) {
-                    map2.setDriverState(json.rep, json.estado);
-                    map3.setDriverState(json.rep, json.estado);
-                }
-                
-                // Simular ruta visual del repartidor
-                if (json.estado === 'EN_CAMINO_A_RESTAURANTE' || json.estado === 'EN_CAMINO_A_DESTINO') {
-                    const currentPos = {
-                        x: json.av - 1,
-                        y: 14 - (json.ca - 1)
-                    };
-                    
-                    let targetPos = null;
-                    
-                    // Buscar destino del pedido
-                    for (let order of activeOrders) {
-                        if (order.repartidorId == json.rep && !order.entregado) {
-                            if (json.estado === 'EN_CAMINO_A_RESTAURANTE' && order.restaurant) {
-                                const rest = map1Data.restaurantes[order.restaurant.id];
-                                if (rest) {
-                                    targetPos = {
-                                        x: (rest.av - 1) * 2 + 1,
-                                        y: (6 - (rest.ca - 1)) * 2 + 1
-                                    };
-                                }
-                            } else if (json.estado === 'EN_CAMINO_A_DESTINO' && order.destination) {
-                                const house = map1Data.casas[order.destination.id];
-                                if (house) {
-                                    targetPos = {
-                                        x: (house.av - 1) * 2 + 1,
-                                        y: (6 - (house.ca - 1)) * 2 + 1
-                                    };
-                                }
-                            }
-                            break;
-                        }
-                    }
-                    
-                    // Crear ruta visual interpolada
-                    if (targetPos) {
-                        const route = [];
-                        const steps = 20;
-                        
-                        for (let i = 0; i <= steps; i++) {
-                            const t = i / steps;
-                            route.push({
-                                x: currentPos.x + (targetPos.x - currentPos.x) * t,
-                                y: currentPos.y + (targetPos.y - currentPos.y) * t
-                            });
-                        }
-                        
-                        driverRoutes.set(json.rep, route);
-                    }
-                } else {
-                    // Limpiar ruta si no está en movimiento
-                    driverRoutes.delete(json.rep);
-                }
-                
+                applyDriverMovement(json.rep, json.av, json.ca, json.estado);
                 redrawAll();
             }
         }
@@ -6,6 +6,10 @@ const { SerialPort } = require("serialport");
 const { WebSocketServer } = require("ws");
 const cors = require("cors");
 const path = require("path");
+const fs = require("fs");
+const telemetria = require("./telemetria");
+const canal = require("./canal");
+const traza = require("./traza");
 
 const app = express();
 app.use(cors());
@@ -14,13 +18,47 @@ app.use(express.json());
 // Servir archivos estáticos
 app.use(express.static(__dirname));
 
-const portName = "COM5";
+// Puerto de la placa, o el pty del simulador de host (Host/sim)
+const portName = process.env.SERIAL_PORT || "COM5";
 const baudRate = 115200;
+// Formato pedido al STM32 al conectar: "json" o "bin"
+const telemetryFormat = (process.env.TELEMETRY || "json").toLowerCase();
+// Envío de comandos: "text" (líneas sueltas) o "reliable" (canal con acuses)
+const commandMode = (process.env.COMMANDS || "text").toLowerCase();
 
 let serial = null;
 let wss = null;
 let isConnected = false;
-let buffer = "";
+let decoder = null;
+let commandChannel = null;
+
+// Volcados de TRACE,DUMP: se guardan como Chrome trace para abrir en Perfetto
+const traceCollector = traza.createTraceCollector((chromeTrace) => {
+    const file = path.join(__dirname, `traza-${new Date().toISOString().replace(/[:.]/g, "-")}.json`);
+    fs.writeFileSync(file, JSON.stringify(chromeTrace));
+    const { events, lost } = chromeTrace.otherData;
+    console.log(`Traza guardada: ${file} (${events} eventos, ${lost} perdidos)`);
+    broadcastToClients({ type: "stm32_data", data: JSON.stringify({ type: "info", msg: `Traza guardada en ${path.basename(file)}` }) });
+});
+
+// Lotes de pedidos enviados con PEDIDOS_WEB esperando su batch_ack
+const BATCH_MAX_ORDERS = 22;
+const BATCH_MAX_LINE = 250;
+const BATCH_TIMEOUT_MS = 3000;
+const pendingBatches = new Map();
+let nextBatchId = 1;
+
+// Carga la tabla de mensajes de log (node generar_tabla_logs.js)
+function loadLogTable() {
+    const file = path.join(__dirname, "log_tabla.json");
+    try {
+        const tabla = JSON.parse(fs.readFileSync(file, "utf8"));
+        telemetria.setLogTable(tabla);
+        console.log(`Tabla de logs: ${tabla.mensajes.length} mensajes`);
+    } catch (e) {
+        console.log("Sin tabla de logs; los mensajes se mostrarán por ID");
+    }
+}
 
 // Abre el puerto serial y configura eventos
 function initSerial() {
@@ -30,6 +68,14 @@ function initSerial() {
         console.log(`Puerto ${portName} conectado`);
         isConnected = true;
         broadcastToClients({ type: "serial_connected", status: true });
+
+        if (commandMode === "reliable") {
+            commandChannel = canal.createCommandChannel((frame) => serial.write(frame));
+        }
+
+        if (telemetryFormat === "bin") {
+            sendToSTM32("FORMATO,BIN");
+        }
     });
 
     serial.on("error", (err) => {
@@ -40,30 +86,44 @@ function initSerial() {
     serial.on("close", () => {
         console.log("Puerto cerrado");
         isConnected = false;
+        if (commandChannel) {
+            commandChannel.close();
+            commandChannel = null;
+        }
     });
 
-    // Lee datos del STM32 línea por línea
-    serial.on("data", (data) => {
-        buffer += data.toString();
-        const lines = buffer.split(/\r?\n/);
-        buffer = lines.pop();
-        
-        lines.forEach(line => {
-            const text = line.trim();
-            if (text.length > 0) {
-                console.log("RX STM32:", text);
-                
-                // Filtra métricas del sistema
-                try {
-                    const json = JSON.parse(text);
-                    if (json.type === 'metric') return;
-                } catch (e) {}
-                
-                // Envía datos a clientes web
-                broadcastToClients({ type: "stm32_data", data: text });
-            }
-        });
-    });
+    // Lee datos del STM32: líneas de texto y tramas binarias
+    decoder = telemetria.createStreamDecoder(handleLine);
+    serial.on("data", (data) => decoder.push(data));
+}
+
+// Procesa una línea JSON (de texto o decodificada de binario)
+function handleLine(line) {
+    const text = line.trim();
+    if (text.length === 0) return;
+
+    let json = null;
+    try {
+        json = JSON.parse(text);
+    } catch (e) {}
+
+    // Acuses del canal de comandos: no son para la web
+    if (json && json.type === 'cmd_ack') {
+        if (commandChannel) commandChannel.onAck(json.base, json.mask);
+        return;
+    }
+
+    // Volcado de la traza: se arma en el bridge, no va a la web
+    if (traceCollector.push(json)) return;
+
+    console.log("RX STM32:", text);
+
+    // Filtra métricas del sistema
+    if (json && json.type === 'metric') return;
+    if (json && json.type === 'batch_ack') resolveBatch(json);
+
+    // Envía datos a clientes web
+    broadcastToClients({ type: "stm32_data", data: text });
 }
 
 // Crea servidor WebSocket en puerto 8081
@@ -97,6 +157,15 @@ function sendToSTM32(data) {
         return;
     }
 
+    // Canal confiable: el comando se retransmite hasta que el STM32 lo confirma
+    if (commandChannel) {
+        const texto = data.trim();
+        commandChannel.send(texto)
+            .then(() => console.log("TX:", texto))
+            .catch((err) => console.log("Error TX:", err.message));
+        return;
+    }
+
     const dataToSend = data.endsWith('\r\n') ? data : data + "\r\n";
 
     serial.write(dataToSend, (err) => {
@@ -127,16 +196,117 @@ app.post("/api/send", (req, res) => {
     res.json({ ok: true, sent: data });
 });
 
+// Parte los pedidos en líneas PEDIDOS_WEB que respetan los límites del firmware
+function buildBatchLines(orders) {
+    const lines = [];
+    let current = null;
+
+    for (let i = 0; i < orders.length; i++) {
+        const o = orders[i];
+        const item = `${o.restaurant}:${o.destination}:${(o.dishes || []).join("/")}`;
+
+        if (!current || current.indexes.length >= BATCH_MAX_ORDERS ||
+            current.text.length + 1 + item.length > BATCH_MAX_LINE) {
+            const id = nextBatchId++;
+            current = { id, text: `PEDIDOS_WEB,${id}`, indexes: [] };
+            lines.push(current);
+        }
+        current.text += `,${item}`;
+        current.indexes.push(i);
+    }
+    return lines;
+}
+
+// Completa el lote pendiente que corresponde a un batch_ack
+function resolveBatch(ack) {
+    const pending = pendingBatches.get(ack.batch);
+    if (!pending) return;
+    clearTimeout(pending.timer);
+    pendingBatches.delete(ack.batch);
+    pending.resolve(ack);
+}
+
+// Envía una línea de lote y espera su acuse
+function sendBatch(line) {
+    return new Promise((resolve) => {
+        const timer = setTimeout(() => {
+            pendingBatches.delete(line.id);
+            resolve(null);
+        }, BATCH_TIMEOUT_MS);
+        pendingBatches.set(line.id, { resolve, timer });
+        sendToSTM32(line.text);
+    });
+}
+
+// HTTP: ingesta de pedidos en lote
+// Body: { orders: [{ restaurant, destination, dishes: [..] }, ...] } (ids como PEDIDO_WEB)
+app.post("/api/orders/batch", async (req, res) => {
+    const orders = req.body && req.body.orders;
+    if (!Array.isArray(orders) || orders.length === 0) {
+        return res.status(400).json({ error: "Falta 'orders'" });
+    }
+    if (!isConnected) return res.status(503).json({ error: "Serial no conectado" });
+
+    const lines = buildBatchLines(orders);
+    const receipts = new Array(orders.length).fill(null);
+    const rejected = [];
+
+    // Se envían todas las líneas sin esperar: el firmware las encola por DMA
+    const acks = await Promise.all(lines.map(sendBatch));
+
+    acks.forEach((ack, k) => {
+        const indexes = lines[k].indexes;
+        if (!ack) {
+            indexes.forEach((i) => rejected.push({ index: i, reason: "timeout" }));
+            return;
+        }
+        indexes.forEach((i, pos) => {
+            if (ack.r[pos] > 0) receipts[i] = `PED-${ack.r[pos]}`;
+        });
+        ack.rej.forEach(([pos, reason]) => rejected.push({ index: indexes[pos], reason }));
+    });
+
+    rejected.sort((a, b) => a.index - b.index);
+    res.json({
+        ok: true,
+        frames: lines.length,
+        accepted: receipts.filter((r) => r !== null).length,
+        receipts,
+        rejected
+    });
+});
+
 // HTTP: estado del servidor
 app.get("/api/status", (req, res) => {
     res.json({ 
         connected: isConnected, 
         port: portName,
-        clients: wss ? wss.clients.size : 0
+        clients: wss ? wss.clients.size : 0,
+        telemetry: telemetryStatus(),
+        commands: commandChannel
+            ? { mode: commandMode, pending: commandChannel.pending(), ...commandChannel.stats }
+            : { mode: commandMode }
     });
 });
 
+// Resumen del ahorro de la telemetría binaria
+function telemetryStatus() {
+    if (!decoder) return { format: telemetryFormat };
+    const s = decoder.stats;
+    return {
+        format: telemetryFormat,
+        frames: s.frames,
+        binaryBytes: s.binaryBytes,
+        jsonEquivalentBytes: s.jsonEquivalentBytes,
+        reduction: s.binaryBytes > 0 ? +(s.jsonEquivalentBytes / s.binaryBytes).toFixed(2) : 0,
+        crcErrors: s.crcErrors,
+        versionErrors: s.versionErrors,
+        malformed: s.malformed
+    };
+}
+
 // Inicia servidor
+loadLogTable();
 initSerial();
 initWebSocket();
 
@@ -0,0 +1,391 @@
+// DECODIFICADOR DE TELEMETRÍA BINARIA
+// Separa las líneas JSON de las tramas binarias (COBS entre 0x00) que envía
+// el STM32 y convierte cada registro al mismo JSON que el modo texto
+
+const VERSION = 1;
+
+// Tipos de registro (ver telemetria.h)
+const TEL_MOV = 0x01;
+const TEL_EVENTO = 0x02;
+const TEL_METRICAS = 0x03;
+const TEL_STATS = 0x04;
+const TEL_ESTADO_REST = 0x05;
+const TEL_FLOTA = 0x06;
+const TEL_LOG = 0x07;
+const TEL_ACK = 0x08;
+const TEL_CMD = 0x10;
+
+const TEL_EV_CON_DRIVER = 0x01;
+const TEL_EV_CON_PREP = 0x02;
+const TEL_FLOTA_KEYFRAME = 0x01;
+const TEL_REST_SJF = 0x01;
+const TEL_REST_CARGADO = 0x02;
+
+// Mismo orden que CodigoEventoTel
+const EVENTOS = [
+    "ORDER_CREATED",
+    "ORDER_PREPARING",
+    "ORDER_READY",
+    "DRIVER_ASSIGNED",
+    "DRIVER_PICKED_UP",
+    "DELIVERED",
+    "CANCELLED",
+    "CANCEL_REJECTED",
+    "CANCEL_FAILED"
+];
+
+// Mismo orden que EstadoRepartidor + MOV_EN_RUTA_SIGUIENTE
+const ESTADOS_MOV = [
+    "DESOCUPADO",
+    "EN_CAMINO_A_RESTAURANTE",
+    "RECOGIENDO",
+    "EN_CAMINO_A_DESTINO",
+    "ENTREGANDO",
+    "EN_RUTA_SIGUIENTE"
+];
+
+// Tramas más largas que esto se consideran basura
+const MAX_TRAMA = 512;
+
+// Tabla de mensajes de log (generada por generar_tabla_logs.js)
+let tablaLogs = [];
+
+// CRC-16/CCITT-FALSE, igual que telemetriaCrc16
+function crc16(buf, len) {
+    let crc = 0xFFFF;
+    for (let i = 0; i < len; i++) {
+        crc ^= buf[i] << 8;
+        for (let b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            crc &= 0xFFFF;
+        }
+    }
+    return crc;
+}
+
+// Decodifica COBS; null si la trama está mal formada
+function cobsDecode(buf) {
+    const out = [];
+    let i = 0;
+    while (i < buf.length) {
+        const code = buf[i++];
+        if (code === 0) return null;
+        for (let j = 1; j < code; j++) {
+            if (i >= buf.length) return null;
+            out.push(buf[i++]);
+        }
+        if (code < 0xFF && i < buf.length) out.push(0);
+    }
+    return Buffer.from(out);
+}
+
+// Codifica COBS (sin delimitadores), igual que telemetriaCobsCodificar
+function cobsEncode(buf) {
+    const out = [0];
+    let idxCodigo = 0;
+    let codigo = 1;
+
+    for (const b of buf) {
+        if (b === 0) {
+            out[idxCodigo] = codigo;
+            codigo = 1;
+            idxCodigo = out.length;
+            out.push(0);
+        } else {
+            out.push(b);
+            codigo++;
+            if (codigo === 0xFF) {
+                out[idxCodigo] = codigo;
+                codigo = 1;
+                idxCodigo = out.length;
+                out.push(0);
+            }
+        }
+    }
+    out[idxCodigo] = codigo;
+    return Buffer.from(out);
+}
+
+// Trama del canal confiable de comandos (ver canal_cmd.h)
+function encodeCommandFrame(seq, ventana, sesion, texto) {
+    const cuerpo = Buffer.from(texto, "utf8");
+    const raw = Buffer.alloc(7 + cuerpo.length + 2);
+    raw[0] = VERSION;
+    raw[1] = TEL_CMD;
+    raw.writeUInt16LE(seq & 0xFFFF, 2);
+    raw.writeUInt16LE(ventana & 0xFFFF, 4);
+    raw[6] = sesion & 0xFF;
+    cuerpo.copy(raw, 7);
+    raw.writeUInt16LE(crc16(raw, raw.length - 2), raw.length - 2);
+    return Buffer.concat([Buffer.from([0]), cobsEncode(raw), Buffer.from([0])]);
+}
+
+// Lector secuencial de u8 y varints LEB128
+function lector(buf) {
+    let pos = 0;
+    return {
+        u8() {
+            if (pos >= buf.length) throw new Error("registro corto");
+            return buf[pos++];
+        },
+        restantes() {
+            return buf.length - pos;
+        },
+        bytes(n) {
+            if (pos + n > buf.length) throw new Error("registro corto");
+            const b = buf.subarray(pos, pos + n);
+            pos += n;
+            return b;
+        },
+        varint() {
+            let v = 0;
+            let shift = 0;
+            for (;;) {
+                const b = this.u8();
+                v += (b & 0x7F) * Math.pow(2, shift);
+                if ((b & 0x80) === 0) return v;
+                shift += 7;
+                if (shift > 28) throw new Error("varint invalido");
+            }
+        }
+    };
+}
+
+// Centésimas -> "s.cc", igual que floatToStr en el firmware
+function centis(c) {
+    return `${Math.floor(c / 100)}.${String(c % 100).padStart(2, "0")}`;
+}
+
+function nombreRepartidor(id) {
+    return `repartidor ${id + 1}`;
+}
+
+function recibo(n) {
+    return `PED-${n}`;
+}
+
+// Carga la tabla de mensajes de log generada desde log_mensajes.h
+function setLogTable(tabla) {
+    tablaLogs = (tabla && tabla.mensajes) || [];
+}
+
+// Expande %d %u %s %f %.Nf con los argumentos ya decodificados
+function formatear(formato, args) {
+    let i = 0;
+    return formato.replace(/%(%|[-+ 0#]*\d*(?:\.(\d+))?([a-z]))/g, (todo, conv, decimales, tipo) => {
+        if (conv === "%") return "%";
+        const v = args[i++];
+        if (tipo === "f") return Number(v).toFixed(decimales !== undefined ? Number(decimales) : 6);
+        return String(v);
+    });
+}
+
+// Decodifica un registro TEL_LOG a la línea de texto original
+function logATexto(r) {
+    const id = r.varint();
+    const msg = tablaLogs[id];
+
+    if (!msg) {
+        return `[log #${id}] ${r.bytes(r.restantes()).toString("hex")}`;
+    }
+
+    const args = [];
+    for (const tipo of msg.firma) {
+        if (tipo === "d") {
+            const z = r.varint();
+            args.push((z % 2) ? -(z + 1) / 2 : z / 2);
+        } else if (tipo === "u") {
+            args.push(r.varint());
+        } else if (tipo === "f") {
+            args.push(r.bytes(4).readFloatLE(0));
+        } else if (tipo === "s") {
+            args.push(r.bytes(r.u8()).toString("utf8"));
+        }
+    }
+
+    return formatear(msg.formato, args);
+}
+
+// Convierte un registro ya validado al objeto JSON del modo texto
+function registroAJson(tipo, payload) {
+    const r = lector(payload);
+
+    switch (tipo) {
+        case TEL_FLOTA: {
+            const seq = r.varint();
+            const key = (r.u8() & TEL_FLOTA_KEYFRAME) ? 1 : 0;
+            const n = r.u8();
+            const d = [];
+            for (let i = 0; i < n; i++) {
+                d.push([r.u8(), r.u8(), r.u8(), r.u8()]);
+            }
+            return { type: "fleet", seq, key, d };
+        }
+        // Acuse selectivo del canal de comandos
+        case TEL_ACK: {
+            const b = r.bytes(6);
+            return { type: "cmd_ack", base: b.readUInt16LE(0), mask: b.readUInt32LE(2) };
+        }
+        // Texto de diagnóstico: se devuelve la línea ya formateada
+        case TEL_LOG:
+            return logATexto(r);
+        // Firmware anterior a los frames de flota
+        case TEL_MOV: {
+            const rep = r.u8();
+            const av = r.u8();
+            const ca = r.u8();
+            const estado = r.u8();
+            return { type: "mov", rep, av, ca, estado: ESTADOS_MOV[estado] || "DESCONOCIDO" };
+        }
+        case TEL_EVENTO: {
+            const ev = r.u8();
+            const flags = r.u8();
+            const json = { type: "event", ev: EVENTOS[ev] || "DESCONOCIDO", order: recibo(r.varint()) };
+            if (flags & TEL_EV_CON_DRIVER) json.driver = nombreRepartidor(r.u8());
+            if (flags & TEL_EV_CON_PREP) {
+                json.prepTime = centis(r.varint());
+                json.restaurantId = r.u8();
+                json.destinationId = r.u8();
+            }
+            return json;
+        }
+        case TEL_METRICAS:
+            return {
+                type: "metrics",
+                order: recibo(r.varint()),
+                t_queue_kitchen: centis(r.varint()),
+                t_prep: centis(r.varint()),
+                t_wait_driver: centis(r.varint()),
+                t_drive: centis(r.varint()),
+                t_total: centis(r.varint())
+            };
+        case TEL_STATS:
+            return {
+                type: "stats",
+                driver: nombreRepartidor(r.u8()),
+                accepted: r.varint(),
+                rejected: r.varint(),
+                delivered: r.varint(),
+                rate: r.u8()
+            };
+        case TEL_ESTADO_REST: {
+            const id = r.u8();
+            const flags = r.u8();
+            return {
+                type: "restaurant_status",
+                id,
+                algorithm: (flags & TEL_REST_SJF) ? "SJF" : "FCFS",
+                status: (flags & TEL_REST_CARGADO) ? "CARGADO" : "NORMAL",
+                queue: r.varint(),
+                threshold: r.varint()
+            };
+        }
+        default:
+            return null;
+    }
+}
+
+// Valida y decodifica una trama COBS (sin los 0x00); null si no es válida
+function decodeFrame(frame, stats) {
+    const raw = cobsDecode(frame);
+    if (!raw || raw.length < 4) return null;
+
+    const n = raw.length - 2;
+    const crc = raw[n] | (raw[n + 1] << 8);
+    if (crc16(raw, n) !== crc) {
+        stats.crcErrors++;
+        return null;
+    }
+    if (raw[0] !== VERSION) {
+        stats.versionErrors++;
+        return null;
+    }
+
+    try {
+        return registroAJson(raw[1], raw.subarray(2, n));
+    } catch (e) {
+        stats.malformed++;
+        return null;
+    }
+}
+
+// Crea un separador de flujo: onLine(texto) recibe cada línea JSON, tanto
+// las de texto como las reconstruidas a partir de registros binarios
+function createStreamDecoder(onLine) {
+    let text = [];
+    let frame = [];
+    let inFrame = false;
+
+    const stats = {
+        frames: 0,
+        binaryBytes: 0,
+        jsonEquivalentBytes: 0,
+        crcErrors: 0,
+        versionErrors: 0,
+        malformed: 0
+    };
+
+    function flushText() {
+        const line = Buffer.from(text).toString("utf8");
+        text = [];
+        onLine(line);
+    }
+
+    function endFrame() {
+        const bytes = Buffer.from(frame);
+        frame = [];
+
+        const json = decodeFrame(bytes, stats);
+        if (json) {
+            const line = typeof json === "string" ? json : JSON.stringify(json);
+            stats.frames++;
+            stats.binaryBytes += bytes.length + 2;
+            stats.jsonEquivalentBytes += line.length + 2;
+            inFrame = false;
+            onLine(line);
+            return;
+        }
+
+        // Desincronizado: lo leído era texto y este 0x00 abre una trama
+        for (const b of bytes) {
+            if (b === 0x0A) flushText();
+            else text.push(b);
+        }
+    }
+
+    function push(data) {
+        for (const b of data) {
+            if (inFrame) {
+                if (b !== 0x00) {
+                    frame.push(b);
+                    if (frame.length > MAX_TRAMA) {
+                        frame = [];
+                        inFrame = false;
+                    }
+                } else if (frame.length > 0) {
+                    endFrame();
+                }
+                // 0x00 con trama vacía: delimitador de inicio repetido
+            } else if (b === 0x00) {
+                inFrame = true;
+            } else if (b === 0x0A) {
+                flushText();
+            } else {
+                text.push(b);
+            }
+        }
+    }
+
+    return { push, stats };
+}
+
+module.exports = {
+    VERSION,
+    crc16,
+    cobsDecode,
+    cobsEncode,
+    encodeCommandFrame,
+    decodeFrame,
+    setLogTable,
+    createStreamDecoder
+};
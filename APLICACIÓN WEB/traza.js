@@ -0,0 +1,228 @@
+// TRAZA DEL SCHEDULER -> CHROME TRACE
+// Convierte el volcado de TRACE,DUMP (trace_info + trace + trace_end, ver
+// traza.c) a Chrome trace JSON, que se abre en Perfetto o chrome://tracing.
+//
+// Uso: node traza.js captura.log [salida.json]
+//   captura.log puede ser la salida del bridge: de cada línea se toma el
+//   JSON desde la primera llave
+
+const fs = require("fs");
+
+// Debe coincidir con TipoEventoTraza (traza.h)
+const TRAZA = {
+    TAREA_ENTRA: 1,
+    TAREA_SALE: 2,
+    COLA_ENVIO: 3,
+    COLA_ENVIO_FALLO: 4,
+    COLA_RECEPCION: 5,
+    COLA_BLOQUEO_ENVIO: 6,
+    COLA_BLOQUEO_RECEPCION: 7,
+    PEDIDO: 8
+};
+
+// EstadoPedido (freertos.c)
+const ESTADOS_PEDIDO = [
+    "CREADO", "PREPARANDO", "LISTO", "BUSCANDO_MOTORISTA", "ACEPTADO",
+    "EN_CAMINO_RESTAURANTE", "RECOGIDO", "EN_CAMINO_DESTINO", "ENTREGADO", "CANCELADO"
+];
+const ESTADOS_FINALES = new Set(["ENTREGADO", "CANCELADO"]);
+
+const PID_CPU = 1;
+const PID_PEDIDOS = 2;
+const TID_CPU = 0;
+
+// Verbo de cada evento de cola según ucQueueType (0 = cola, resto semáforos/mutex)
+function verbo(tipo, tipoCola) {
+    const cola = tipoCola === 0;
+    switch (tipo) {
+        case TRAZA.COLA_ENVIO: return cola ? "send" : "give";
+        case TRAZA.COLA_ENVIO_FALLO: return cola ? "send_full" : "give_failed";
+        case TRAZA.COLA_RECEPCION: return cola ? "receive" : "take";
+        case TRAZA.COLA_BLOQUEO_ENVIO: return cola ? "block_send" : "block_give";
+        case TRAZA.COLA_BLOQUEO_RECEPCION: return cola ? "block_receive" : "block_take";
+        default: return `evento_${tipo}`;
+    }
+}
+
+// Decodifica los eventos de 8 bytes: t u32, tipo u8, a u8, b u16 (LE)
+function decodeEvents(buffer) {
+    const eventos = [];
+    for (let off = 0; off + 8 <= buffer.length; off += 8) {
+        eventos.push({
+            t: buffer.readUInt32LE(off),
+            tipo: buffer[off + 4],
+            a: buffer[off + 5],
+            b: buffer.readUInt16LE(off + 6)
+        });
+    }
+    return eventos;
+}
+
+// Marcas de 32 bits -> microsegundos desde el primer evento. Los eventos
+// consecutivos están a menos de media vuelta del contador
+function unwrapTimestamps(eventos, hz) {
+    let anterior = null;
+    let acumulado = 0;
+
+    for (const e of eventos) {
+        if (anterior !== null) acumulado += (e.t - anterior) | 0;
+        anterior = e.t;
+        e.ts = (acumulado * 1e6) / hz;
+    }
+    // Dos eventos de interrupción pueden quedar invertidos por pocos ciclos
+    return eventos.sort((x, y) => x.ts - y.ts);
+}
+
+// info = mensaje trace_info; buffer = eventos concatenados
+function toChromeTrace(info, buffer) {
+    const hz = info.hz || 1e6;
+    const tareas = new Map((info.tasks || []).map(([num, nombre]) => [num, nombre]));
+    const objetos = new Map((info.objs || []).map(([num, grupo, indice]) =>
+        [num, indice >= 0 ? `${grupo}[${indice}]` : grupo]));
+
+    const nombreTarea = (num) => tareas.get(num) || `tarea_${num}`;
+    const nombreObjeto = (num) => objetos.get(num) || `obj_${num}`;
+
+    const eventos = unwrapTimestamps(decodeEvents(buffer), hz);
+    const salida = [];
+
+    salida.push({ ph: "M", name: "process_name", pid: PID_CPU, args: { name: "STM32" } });
+    salida.push({ ph: "M", name: "thread_name", pid: PID_CPU, tid: TID_CPU, args: { name: "CPU" } });
+    salida.push({ ph: "M", name: "thread_sort_index", pid: PID_CPU, tid: TID_CPU, args: { sort_index: -1 } });
+    for (const [num, nombre] of tareas) {
+        salida.push({ ph: "M", name: "thread_name", pid: PID_CPU, tid: num, args: { name: nombre } });
+    }
+    salida.push({ ph: "M", name: "process_name", pid: PID_PEDIDOS, args: { name: "Pedidos" } });
+
+    const inicioTarea = new Map();      // tid -> ts de TAREA_ENTRA
+    const estadoPedido = new Map();     // índice -> { nombre, ts }
+    let actual = null;                  // tarea en ejecución
+    let ultimo = 0;
+
+    function cerrarTarea(num, ts) {
+        if (!inicioTarea.has(num)) return;
+        const inicio = inicioTarea.get(num);
+        inicioTarea.delete(num);
+        const dur = Math.max(ts - inicio, 0);
+        const nombre = nombreTarea(num);
+        salida.push({ ph: "X", name: nombre, pid: PID_CPU, tid: num, ts: inicio, dur });
+        salida.push({ ph: "X", name: nombre, pid: PID_CPU, tid: TID_CPU, ts: inicio, dur });
+    }
+
+    for (const e of eventos) {
+        ultimo = e.ts;
+
+        switch (e.tipo) {
+            case TRAZA.TAREA_ENTRA:
+                inicioTarea.set(e.a, e.ts);
+                actual = e.a;
+                break;
+
+            case TRAZA.TAREA_SALE:
+                cerrarTarea(e.a, e.ts);
+                if (actual === e.a) actual = null;
+                break;
+
+            case TRAZA.PEDIDO: {
+                const nombre = ESTADOS_PEDIDO[e.a] || `estado_${e.a}`;
+                const id = `pedido_${e.b}`;
+                const previo = estadoPedido.get(e.b);
+
+                if (previo) {
+                    salida.push({ ph: "e", cat: "pedido", name: previo, id, pid: PID_PEDIDOS, ts: e.ts });
+                }
+                if (ESTADOS_FINALES.has(nombre)) {
+                    estadoPedido.delete(e.b);
+                    salida.push({ ph: "i", s: "p", cat: "pedido", name: `${id} ${nombre}`, pid: PID_PEDIDOS, tid: 0, ts: e.ts });
+                } else {
+                    estadoPedido.set(e.b, nombre);
+                    salida.push({ ph: "b", cat: "pedido", name: nombre, id, pid: PID_PEDIDOS, ts: e.ts, args: { pedido: e.b } });
+                }
+                break;
+            }
+
+            default:
+                salida.push({
+                    ph: "i", s: "t", cat: "cola",
+                    name: `${verbo(e.tipo, e.b)} ${nombreObjeto(e.a)}`,
+                    pid: PID_CPU, tid: actual === null ? TID_CPU : actual, ts: e.ts
+                });
+        }
+    }
+
+    // Lo que seguía abierto al detener la traza
+    for (const num of [...inicioTarea.keys()]) cerrarTarea(num, ultimo);
+    for (const [indice, nombre] of estadoPedido) {
+        salida.push({ ph: "e", cat: "pedido", name: nombre, id: `pedido_${indice}`, pid: PID_PEDIDOS, ts: ultimo });
+    }
+
+    return {
+        traceEvents: salida,
+        displayTimeUnit: "ms",
+        otherData: { hz, events: eventos.length, lost: info.lost || 0 }
+    };
+}
+
+// Junta los mensajes de un volcado; onTrace(chromeTrace) al llegar trace_end
+function createTraceCollector(onTrace) {
+    let info = null;
+    let partes = [];
+
+    // Devuelve true si el mensaje era parte de la traza
+    function push(json) {
+        if (!json || typeof json.type !== "string") return false;
+
+        if (json.type === "trace_info") {
+            info = json;
+            partes = [];
+            return true;
+        }
+        if (json.type === "trace") {
+            if (info) partes.push({ i: json.i, datos: Buffer.from(json.d || "", "hex") });
+            return true;
+        }
+        if (json.type === "trace_end") {
+            if (info) {
+                partes.sort((x, y) => x.i - y.i);
+                onTrace(toChromeTrace(info, Buffer.concat(partes.map(p => p.datos))));
+            }
+            info = null;
+            partes = [];
+            return true;
+        }
+        return false;
+    }
+
+    return { push };
+}
+
+module.exports = { toChromeTrace, createTraceCollector, decodeEvents, TRAZA };
+
+// Línea de comandos
+if (require.main === module) {
+    const [entrada, salidaArchivo] = process.argv.slice(2);
+    if (!entrada) {
+        console.error("Uso: node traza.js captura.log [salida.json]");
+        process.exit(1);
+    }
+
+    let resultado = null;
+    const colector = createTraceCollector((traza) => { resultado = traza; });
+
+    for (const linea of fs.readFileSync(entrada, "utf8").split(/\r?\n/)) {
+        const inicio = linea.indexOf("{");
+        if (inicio < 0) continue;
+        try {
+            colector.push(JSON.parse(linea.slice(inicio)));
+        } catch (e) {}
+    }
+
+    if (!resultado) {
+        console.error("No se encontró un volcado completo (trace_info ... trace_end)");
+        process.exit(1);
+    }
+
+    const destino = salidaArchivo || entrada.replace(/\.[^.]*$/, "") + ".trace.json";
+    fs.writeFileSync(destino, JSON.stringify(resultado));
+    console.log(`${resultado.otherData.events} eventos (${resultado.otherData.lost} perdidos) -> ${destino}`);
+}
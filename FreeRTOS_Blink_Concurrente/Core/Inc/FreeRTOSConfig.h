@@ -166,6 +166,32 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* Tiempo de CPU por tarea medido con el contador de ciclos DWT (perfil.c) */
+#define configGENERATE_RUN_TIME_STATS            1
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  void perfilIniciarContador(void);
+  uint32_t perfilContador(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() perfilIniciarContador()
+#define portGET_RUN_TIME_COUNTER_VALUE()         perfilContador()
+
+/* Traza del scheduler en un anillo de RAM (traza.c); solo los objetos con
+   número de cola (registrados en cerrojo.c) generan eventos */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  #include "traza.h"
+#endif
+#if TRAZA_HABILITADA
+#define traceTASK_SWITCHED_IN()                  trazaRegistrar(TRAZA_TAREA_ENTRA, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SWITCHED_OUT()                 trazaRegistrar(TRAZA_TAREA_SALE, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceQUEUE_SEND(q)                       trazaCola(TRAZA_COLA_ENVIO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_SEND_FROM_ISR(q)              trazaCola(TRAZA_COLA_ENVIO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_SEND_FAILED(q)                trazaCola(TRAZA_COLA_ENVIO_FALLO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_RECEIVE(q)                    trazaCola(TRAZA_COLA_RECEPCION, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_RECEIVE_FROM_ISR(q)           trazaCola(TRAZA_COLA_RECEPCION, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceBLOCKING_ON_QUEUE_SEND(q)           trazaCola(TRAZA_COLA_BLOQUEO_ENVIO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(q)        trazaCola(TRAZA_COLA_BLOQUEO_RECEPCION, (q)->uxQueueNumber, (q)->ucQueueType)
+#endif
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,63 @@
+/**
+  ******************************************************************************
+  * @file    aleatorio.h
+  * @brief   Flujos pseudoaleatorios independientes por subsistema.
+  *
+  *          Cada subsistema saca sus números de su propio flujo xoshiro128**,
+  *          derivado de una única semilla de corrida (comando SEED). Así el
+  *          paseo de un repartidor libre no corre la secuencia de las
+  *          confirmaciones: con la misma semilla y el mismo escenario las
+  *          decisiones de despacho se repiten.
+  *
+  *          Cada flujo lo usa una sola tarea; quien resiembra con el sistema
+  *          corriendo debe serializarlo con ella. No depende de FreeRTOS.
+  ******************************************************************************
+  */
+#ifndef __ALEATORIO_H__
+#define __ALEATORIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define ALEATORIO_SEMILLA_DEFECTO   12345u
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    ALEATORIO_MAPA = 0,         // regenerarMapa / inicializarSistema
+    ALEATORIO_CONFIRMACION,     // verificarConfirmacion
+    ALEATORIO_PEDIDOS,          // crearPedidoAleatorio
+    ALEATORIO_PASEO,            // repartidores libres
+    ALEATORIO_CARGA,            // generador de carga (carga.c)
+    ALEATORIO_NUM_FLUJOS
+} FlujoAleatorio;
+
+/* Function prototypes -------------------------------------------------------*/
+// Fija la semilla de corrida y reinicia todos los flujos
+void aleatorioSembrar(uint32_t semilla);
+uint32_t aleatorioSemilla(void);
+
+// Vuelve al inicio de la secuencia que la semilla de corrida da al flujo
+void aleatorioReiniciarFlujo(FlujoAleatorio flujo);
+// Reinicia el flujo con una semilla propia (0 = la de corrida)
+void aleatorioSembrarFlujo(FlujoAleatorio flujo, uint32_t semilla);
+
+uint32_t aleatorioSiguiente(FlujoAleatorio flujo);
+// Entero uniforme en [0, n) sin sesgo de módulo; 0 si n <= 1
+uint32_t aleatorioRango(FlujoAleatorio flujo, uint32_t n);
+// Uniforme en [0, 1) con 24 bits
+float aleatorioUniforme(FlujoAleatorio flujo);
+
+// Números sacados del flujo desde su último reinicio
+uint32_t aleatorioUsos(FlujoAleatorio flujo);
+const char *aleatorioNombreFlujo(FlujoAleatorio flujo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ALEATORIO_H__ */
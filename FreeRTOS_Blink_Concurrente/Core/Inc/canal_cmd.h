@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    canal_cmd.h
+  * @brief   Canal confiable de comandos host -> STM32.
+  *
+  *          Trama: 0x00 + COBS([version][TEL_CMD][seq u16 LE][ventana u16 LE]
+  *                             [sesion u8][comando de texto...][crc16 LE]) + 0x00
+  *
+  *          seq numera cada comando; ventana es el seq más antiguo que el
+  *          host aún no tiene confirmado; sesion cambia cada vez que el host
+  *          reinicia su numeración (el STM32 se resincroniza).
+  *
+  *          El STM32 ejecuta cada seq una sola vez y en orden de seq: lo
+  *          que llega antes de su turno se retiene (hasta
+  *          CANAL_CMD_RETENIDOS comandos) y sale detrás del que faltaba.
+  *          Responde a cada trama con un TEL_ACK selectivo: base = primer
+  *          seq sin recibir y una máscara de 32 bits con los recibidos
+  *          después de base. El host retransmite por timeout solo lo que la
+  *          máscara no cubre; un seq que el host abandona (ventana pasa por
+  *          encima) se salta.
+  *
+  *          El comando viaja como el mismo texto del protocolo anterior y
+  *          se despacha igual; las líneas de texto sueltas siguen valiendo.
+  ******************************************************************************
+  */
+#ifndef __CANAL_CMD_H__
+#define __CANAL_CMD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+// Secuencias aceptadas por delante de base (ancho de la máscara de acuse)
+#define CANAL_CMD_VENTANA   32
+// Comandos fuera de orden que se guardan hasta su turno; sin lugar, la
+// trama no se confirma y el host la repite
+#define CANAL_CMD_RETENIDOS 8
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t tramas;
+    uint32_t ejecutadas;
+    uint32_t duplicadas;
+    uint32_t fueraDeVentana;
+    uint32_t erroresCrc;
+    uint32_t malformadas;
+    uint32_t resincronizaciones;
+    uint32_t retenidas;         // llegaron antes de su turno
+    uint32_t sinLugar;          // fuera de orden sin lugar para retenerlas
+    uint32_t abandonadas;       // seq que el host dejó de reintentar
+} EstadisticasCanalCmd;
+
+/* Function prototypes -------------------------------------------------------*/
+char *canalCmdProcesarTrama(uint8_t *trama, int len);
+char *canalCmdSiguiente(void);
+void canalCmdObtenerEstadisticas(EstadisticasCanalCmd *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CANAL_CMD_H__ */
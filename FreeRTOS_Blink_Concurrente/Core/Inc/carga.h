@@ -0,0 +1,102 @@
+/**
+  ******************************************************************************
+  * @file    carga.h
+  * @brief   Generador de carga: llegadas de pedidos y su contenido.
+  *
+  *          Procesos de llegada:
+  *            WEB       un pedido cada 20-30 s, pedido a la web (el de antes)
+  *            POISSON   tasa constante, intervalos exponenciales
+  *            HORA_PICO Poisson no homogéneo: la tasa base se multiplica por
+  *                      una curva por tramos (interpolada) que se repite
+  *                      cada "periodo"; se muestrea por adelgazamiento
+  *            RAFAGAS   Poisson base más ráfagas de "tamRafaga" pedidos
+  *                      separados CARGA_ESPACIADO_RAFAGA_MS, que llegan a su
+  *                      vez como Poisson
+  *
+  *          El restaurante sigue una Zipf (el índice 0 es el más popular),
+  *          la casa es uniforme, la cantidad de platillos sale de los pesos
+  *          de "mezcla" y cada platillo de otra Zipf sobre el menú. Con
+  *          exponente 0 la Zipf es uniforme.
+  *
+  *          Todo sale del flujo ALEATORIO_CARGA (aleatorio.h): la misma
+  *          configuración aplicada en el mismo instante produce los mismos
+  *          pedidos. El módulo no depende de FreeRTOS; quien lo llame debe
+  *          serializar cargaConfigurar con el resto.
+  *
+  *          La tabla de pedidos no recicla huecos: con MAX_PEDIDOS creados
+  *          las llegadas siguientes se cuentan en "alTope". No es una medida
+  *          de saturación del despacho, solo el tope de la tabla.
+  ******************************************************************************
+  */
+#ifndef __CARGA_H__
+#define __CARGA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define CARGA_TRAMOS                24
+#define CARGA_MAX_MEZCLA            6
+#define CARGA_ESPACIADO_RAFAGA_MS   200
+#define CARGA_SIN_LLEGADA           0xFFFFFFFFu
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    CARGA_APAGADA = 0,
+    CARGA_WEB,
+    CARGA_POISSON,
+    CARGA_HORA_PICO,
+    CARGA_RAFAGAS
+} ModoCarga;
+
+typedef struct {
+    ModoCarga modo;
+    uint32_t porHora;                   // tasa base (pedidos/hora)
+    uint32_t periodoS;                  // duración de la curva de hora pico
+    uint32_t rafagasPorHora;
+    uint32_t tamRafaga;
+    uint16_t curva[CARGA_TRAMOS];       // multiplicador (%) de cada punto
+    uint8_t tramos;                     // puntos usados de la curva
+    uint8_t mezclaCount;
+    uint8_t mezcla[CARGA_MAX_MEZCLA];   // peso de pedir 1, 2, ... platillos
+    uint16_t zipfRestaurante;           // exponente x100
+    uint16_t zipfPlatillo;              // exponente x100
+    uint32_t semilla;                   // 0 = la semilla de corrida
+} ConfigCarga;
+
+typedef struct {
+    uint32_t generados;
+    uint32_t alTope;                    // descartados con la tabla llena
+} ContadoresCarga;
+
+/* Function prototypes -------------------------------------------------------*/
+void cargaIniciar(uint32_t ahora);
+void cargaConfigurar(const ConfigCarga *config, uint32_t ahora);
+void cargaObtenerConfig(ConfigCarga *out);
+// Vuelve a empezar la secuencia desde la semilla (p. ej. al arrancar)
+void cargaReiniciar(uint32_t ahora);
+
+// 1 si ya venció una llegada (la consume); llamar hasta que devuelva 0
+int cargaPedidoDebido(uint32_t ahora);
+// Milisegundos hasta la próxima llegada o CARGA_SIN_LLEGADA
+uint32_t cargaMsHastaProximo(uint32_t ahora);
+
+void cargaElegirDestino(int numRestaurantes, int numCasas, int *restaurante, int *casa);
+// Llena "platillos" con índices del menú; devuelve la cantidad
+int cargaElegirPlatillos(int numPlatillos, int *platillos, int max);
+
+// aceptado = 0 solo cuando la tabla de pedidos está llena
+void cargaContar(int aceptado);
+void cargaObtenerContadores(ContadoresCarga *out);
+
+const char *cargaNombreModo(ModoCarga modo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CARGA_H__ */
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file    cerrojo.h
+  * @brief   Mutex, semáforos y colas instrumentados.
+  *
+  *          cerrojoTomar / cerrojoLiberar / colaEnviar / colaRecibir hacen lo
+  *          mismo que las llamadas de FreeRTOS que reemplazan, y además
+  *          cuentan por cada objeto registrado:
+  *            - tomas: operaciones que salieron bien
+  *            - contenciones: las que no pudieron hacerse en el acto
+  *            - timeouts: las que se rindieron (el llamador salta el trabajo)
+  *            - histograma log2 de la espera de las contenciones, en us
+  *            - tenencia promedio y máxima (solo mutex)
+  *
+  *          Recibir de una cola vacía sin espera es un sondeo y no cuenta
+  *          como timeout; enviar a una cola llena sin espera sí (se pierde
+  *          el elemento).
+  *
+  *          El objeto se encuentra por su número de cola de FreeRTOS
+  *          (vQueueSetQueueNumber), así que buscarlo es O(1). Los que no se
+  *          registraron pasan directo, sin contar nada.
+  ******************************************************************************
+  */
+#ifndef __CERROJO_H__
+#define __CERROJO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define CERROJOS_MAX        28
+
+// Cubeta k: espera en [2^k, 2^(k+1)) us; la última junta todo desde ~32 ms
+#define CERROJO_CUBETAS     16
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    CERROJO_MUTEX = 0,
+    CERROJO_SEMAFORO,
+    CERROJO_COLA
+} TipoCerrojo;
+
+typedef struct {
+    const char *grupo;
+    int indice;
+    TipoCerrojo tipo;
+    uint32_t tomas;
+    uint32_t contenciones;
+    uint32_t timeouts;
+    uint32_t esperaP50;     // us, límite superior de la cubeta
+    uint32_t esperaP99;
+    uint32_t esperaMax;
+    uint32_t tenenciaPromedio;
+    uint32_t tenenciaMax;
+} ResumenCerrojo;
+
+/* Function prototypes -------------------------------------------------------*/
+int cerrojoRegistrar(QueueHandle_t h, const char *grupo, int indice, TipoCerrojo tipo);
+
+BaseType_t cerrojoTomar(SemaphoreHandle_t h, TickType_t espera);
+BaseType_t cerrojoLiberar(SemaphoreHandle_t h);
+BaseType_t colaEnviar(QueueHandle_t q, const void *elemento, TickType_t espera);
+BaseType_t colaRecibir(QueueHandle_t q, void *elemento, TickType_t espera);
+
+int cerrojosCantidad(void);
+int cerrojoResumir(int i, ResumenCerrojo *r);
+void cerrojosReiniciar(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CERROJO_H__ */
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file    comandos.h
+  * @brief   Registro y despacho de comandos de texto recibidos por UART.
+  *
+  *          Cada línea se parte en tokens en una sola pasada y en el lugar
+  *          (los separadores se reemplazan por '\0'): el primer token es el
+  *          nombre del comando y se busca por coincidencia exacta en un
+  *          índice hash, así el costo no crece al agregar comandos.
+  *
+  *          Separadores: ',' y espacios/tabs; los blancos alrededor de una
+  *          coma se ignoran y ",," deja un argumento vacío.
+  *
+  *          No depende del HAL ni de FreeRTOS (se prueba y mide en host).
+  ******************************************************************************
+  */
+#ifndef __COMANDOS_H__
+#define __COMANDOS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+// Tokens por línea, incluido el nombre del comando
+#define CMD_MAX_TOKENS      24
+// Capacidad del índice hash (potencia de 2, mayor que los comandos)
+#define CMD_TAM_INDICE      64
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    int argc;                       // Incluye el nombre (argv[0])
+    char *argv[CMD_MAX_TOKENS];
+} ArgsCmd;
+
+typedef void (*ManejadorCmd)(const ArgsCmd *args);
+
+typedef struct {
+    const char *nombre;
+    ManejadorCmd manejador;
+    uint8_t minArgs;                // Sin contar el nombre
+    uint8_t maxArgs;
+    const char *uso;                // Sintaxis de los argumentos (HELP)
+} Comando;
+
+typedef enum {
+    CMD_OK = 0,
+    CMD_VACIO,                      // Línea en blanco
+    CMD_DESCONOCIDO,
+    CMD_FALTAN_ARGS,
+    CMD_SOBRAN_ARGS
+} ResultadoCmd;
+
+/* Function prototypes -------------------------------------------------------*/
+int comandosRegistrar(const Comando *tabla, int n);
+ResultadoCmd comandosDespachar(char *linea, ArgsCmd *args, const Comando **cmd);
+int comandosTokenizar(char *linea, ArgsCmd *args);
+const Comando *comandosBuscar(const char *nombre);
+// -1 si la lista no entra en "cap"
+int comandosListar(char *buf, int cap);
+
+// Parsers tipados: 1 si el token es válido
+int cmdArgEntero(const char *tok, int32_t min, int32_t max, int32_t *out);
+int cmdArgOpcion(const char *tok, const char *const *opciones, int n, int *out);
+int cmdArgTexto(const char *tok, int maxLen, const char **out);
+int cmdPartir(char *tok, char sep, char **partes, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __COMANDOS_H__ */
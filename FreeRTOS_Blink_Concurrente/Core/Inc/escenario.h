@@ -0,0 +1,127 @@
+/**
+  ******************************************************************************
+  * @file    escenario.h
+  * @brief   Escenarios fijos: ciudad, menús y traza de pedidos.
+  *
+  *          Un escenario es una secuencia de registros de texto, los mismos
+  *          en un archivo del host (--escenario) y por UART (comando
+  *          SCENARIO), uno por línea:
+  *            SCENARIO,BEGIN,n               grilla de n x n avenidas/calles
+  *            SCENARIO,R,av,ca,dir,umbral,prep1[,prep2...]
+  *                                           restaurante en la manzana
+  *                                           (av, ca), entrada U|D|L|R,
+  *                                           umbral FCFS->SJF y tiempo de
+  *                                           cada platillo en centésimas
+  *            SCENARIO,H,av,ca,dir           casa, entrada u|d|l|r
+  *            SCENARIO,D,av,ca,velocidad     repartidor en la esquina
+  *                                           (av, ca), velocidad x100
+  *            SCENARIO,O,ms,rest,casa,p1[,p2...]
+  *                                           pedido a los "ms" del arranque;
+  *                                           rest y casa en base 1 y
+  *                                           platillos en base 0, como
+  *                                           PEDIDO_WEB; ms no decreciente
+  *            SCENARIO,END
+  *          Restaurantes, casas y repartidores se numeran en el orden en que
+  *          aparecen. En un archivo se ignoran las líneas vacías y las que
+  *          empiezan con '#'.
+  *
+  *          El módulo solo valida y guarda el escenario y recorre la traza;
+  *          freertos.c construye el mapa con él. No depende de FreeRTOS.
+  ******************************************************************************
+  */
+#ifndef __ESCENARIO_H__
+#define __ESCENARIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+// Los mismos topes que el sistema (freertos.c)
+#define ESCENARIO_MAX_TAMANIO       20
+#define ESCENARIO_MAX_RESTAURANTES  10
+#define ESCENARIO_MAX_CASAS         20
+#define ESCENARIO_MAX_REPARTIDORES  10
+#define ESCENARIO_MAX_MENU          6
+#define ESCENARIO_MAX_PEDIDOS       50
+#define ESCENARIO_MAX_PLATILLOS     10
+
+#define ESCENARIO_SIN_PEDIDO        0xFFFFFFFFu
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    ESCENARIO_VACIO = 0,        // mapa aleatorio
+    ESCENARIO_CARGANDO,         // entre BEGIN y END
+    ESCENARIO_LISTO
+} EstadoEscenario;
+
+typedef struct {
+    uint8_t av;
+    uint8_t ca;
+    char direccion;
+    uint8_t umbral;                             // cantidadDeCambio
+    uint8_t numPlatillos;
+    uint16_t prep[ESCENARIO_MAX_MENU];          // centésimas de segundo
+} EscenarioRestaurante;
+
+typedef struct {
+    uint8_t av;
+    uint8_t ca;
+    char direccion;
+} EscenarioCasa;
+
+typedef struct {
+    uint8_t av;
+    uint8_t ca;
+    uint16_t velocidad;                         // x100
+} EscenarioRepartidor;
+
+typedef struct {
+    uint32_t ms;                                // desde el arranque
+    uint8_t restaurante;                        // base 0
+    uint8_t casa;                               // base 0
+    uint8_t numPlatillos;
+    uint8_t platillos[ESCENARIO_MAX_PLATILLOS];
+} EscenarioPedido;
+
+typedef struct {
+    uint8_t tamanio;
+    uint8_t numRestaurantes;
+    uint8_t numCasas;
+    uint8_t numRepartidores;
+    uint8_t numPedidos;
+    EscenarioRestaurante restaurantes[ESCENARIO_MAX_RESTAURANTES];
+    EscenarioCasa casas[ESCENARIO_MAX_CASAS];
+    EscenarioRepartidor repartidores[ESCENARIO_MAX_REPARTIDORES];
+    EscenarioPedido pedidos[ESCENARIO_MAX_PEDIDOS];
+} Escenario;
+
+/* Function prototypes -------------------------------------------------------*/
+// Descarta el escenario: el próximo mapa vuelve a ser aleatorio
+void escenarioIniciar(void);
+
+// Procesa un registro ("campos" empieza en BEGIN, R, ...); devuelve NULL o
+// el nombre del campo inválido, cuyo índice deja en "campoMalo"
+const char *escenarioProcesar(char *const *campos, int n, int *campoMalo);
+
+EstadoEscenario escenarioEstado(void);
+const char *escenarioNombreEstado(EstadoEscenario estado);
+const Escenario *escenarioObtener(void);
+
+// Traza: vuelve al primer pedido tomando "ahora" como arranque
+void escenarioReiniciarTraza(uint32_t ahora);
+// Próximo pedido vencido (lo consume) o NULL
+const EscenarioPedido *escenarioPedidoDebido(uint32_t ahora);
+// Milisegundos hasta el próximo pedido o ESCENARIO_SIN_PEDIDO
+uint32_t escenarioMsHastaProximo(uint32_t ahora);
+// Pedidos de la traza ya entregados al sistema
+int escenarioPedidosReproducidos(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ESCENARIO_H__ */
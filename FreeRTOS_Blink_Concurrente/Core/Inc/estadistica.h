@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file    estadistica.h
+  * @brief   Media, varianza, mínimo y máximo incrementales (Welford).
+  *
+  *          Cada muestra actualiza el acumulador en O(1) sin guardarla; la
+  *          varianza se obtiene en cualquier momento sin la pérdida de
+  *          precisión de sumar cuadrados. Las muestras son milisegundos.
+  *          media y m2 van en double: con float la media deja de absorber
+  *          muestras chicas tras miles de pedidos y m2 deriva.
+  ******************************************************************************
+  */
+#ifndef __ESTADISTICA_H__
+#define __ESTADISTICA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t n;
+    double media;
+    double m2;          // suma de cuadrados de las desviaciones
+    uint32_t min;
+    uint32_t max;
+} Welford;
+
+/* Function prototypes -------------------------------------------------------*/
+void welfordReiniciar(Welford *w);
+void welfordAgregar(Welford *w, uint32_t ms);
+float welfordVarianza(const Welford *w);
+float welfordDesviacion(const Welford *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ESTADISTICA_H__ */
@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    flota.h
+  * @brief   Frames de posición de la flota agrupados por tick.
+  *
+  *          Los movimientos solo se registran en una tabla; una vez por tick
+  *          se envía un único frame con los repartidores que cambiaron desde
+  *          el último frame (delta) y, cada FLOTA_PERIODO_KEYFRAME frames, un
+  *          keyframe con la flota completa para los clientes que se conectan
+  *          tarde.
+  ******************************************************************************
+  */
+#ifndef __FLOTA_H__
+#define __FLOTA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define FLOTA_MAX_REPARTIDORES   10
+// Frames entre keyframes (a 100 ms por periodo, uno cada 5 s)
+#define FLOTA_PERIODO_KEYFRAME   50
+
+/* Function prototypes -------------------------------------------------------*/
+void flotaReiniciar(void);
+void flotaForzarKeyframe(void);
+void flotaActualizar(int rep, int av, int ca, int estado);
+int flotaEmitirFrame(int numRepartidores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLOTA_H__ */
@@ -0,0 +1,70 @@
+/**
+  ******************************************************************************
+  * @file    histograma.h
+  * @brief   Histograma de latencias log-lineal de memoria fija.
+  *
+  *          Al estilo de HdrHistogram: cada potencia de 2 se divide en
+  *          HIST_SUBCUBETAS cubetas iguales, así que el error relativo de
+  *          cualquier percentil queda acotado (1/16 = 6.25%) sin importar
+  *          cuántas muestras haya. Los valores son milisegundos enteros;
+  *          por debajo de HIST_SUBCUBETAS ms cada cubeta es exacta.
+  *
+  *          Registrar es O(1) y no ordena nada; los percentiles se leen en
+  *          una pasada sobre las cubetas en cualquier momento.
+  ******************************************************************************
+  */
+#ifndef __HISTOGRAMA_H__
+#define __HISTOGRAMA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define HIST_BITS_SUB       4
+#define HIST_SUBCUBETAS     (1u << HIST_BITS_SUB)
+
+// Mayor valor distinguible: 2^22 ms (~70 min); lo de arriba se acumula
+// en la última cubeta y solo max conserva el valor real
+#define HIST_BITS_MAX       22
+#define HIST_NUM_CUBETAS    (HIST_SUBCUBETAS * (HIST_BITS_MAX - HIST_BITS_SUB + 1))
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t cubetas[HIST_NUM_CUBETAS];
+    uint32_t total;
+    uint64_t suma;
+    uint32_t min;
+    uint32_t max;
+} Histograma;
+
+typedef struct {
+    uint32_t pedidos;
+    uint32_t promedio;
+    uint32_t min;
+    uint32_t max;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p95;
+    uint32_t p99;
+} ResumenHistograma;
+
+/* Function prototypes -------------------------------------------------------*/
+void histogramaReiniciar(Histograma *h);
+void histogramaRegistrar(Histograma *h, uint32_t ms);
+uint32_t histogramaPercentil(const Histograma *h, uint32_t milesimas);
+void histogramaResumir(const Histograma *h, ResumenHistograma *r);
+
+// Cubetas sueltas, para histogramas con otra resolución (p. ej. ventanas)
+uint32_t histogramaIndice(uint32_t ms, uint32_t bitsSub, uint32_t bitsMax);
+uint32_t histogramaValorCubeta(uint32_t indice, uint32_t bitsSub);
+int histogramaCubetaPercentil(const uint32_t *cubetas, uint32_t num, uint32_t total, uint32_t milesimas);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HISTOGRAMA_H__ */
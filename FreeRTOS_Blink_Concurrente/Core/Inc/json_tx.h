@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    json_tx.h
+  * @brief   Escritor JSON en flujo, sin memoria dinámica ni printf.
+  *
+  *          Escribe claves y valores directamente en un espacio reservado
+  *          del buffer de TX (jsonIniciar) o en un buffer propio
+  *          (jsonIniciarBuffer). Los decimales se pasan como enteros de
+  *          punto fijo: jsonFijo(j, "t", 1250, 2) escribe 12.50.
+  *          Si el espacio no alcanza el mensaje completo se descarta.
+  ******************************************************************************
+  */
+#ifndef __JSON_TX_H__
+#define __JSON_TX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "uart_tx.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define JSON_MAX_PROFUNDIDAD 8
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    char *buf;
+    int cap;
+    int pos;
+    uint8_t desbordado;
+    uint8_t profundidad;
+    uint8_t enBufferTx;
+    uint8_t hayElemento[JSON_MAX_PROFUNDIDAD];
+    ReservaUartTx reserva;
+} JsonTx;
+
+/* Function prototypes -------------------------------------------------------*/
+int jsonIniciar(JsonTx *j, int capacidad);
+void jsonIniciarBuffer(JsonTx *j, char *buf, int cap);
+int jsonTerminar(JsonTx *j);
+
+// clave NULL = elemento de un arreglo
+void jsonCadena(JsonTx *j, const char *clave, const char *valor);
+void jsonCaracter(JsonTx *j, const char *clave, char valor);
+void jsonEntero(JsonTx *j, const char *clave, int32_t valor);
+void jsonSinSigno(JsonTx *j, const char *clave, uint32_t valor);
+void jsonFijo(JsonTx *j, const char *clave, int32_t valor, int decimales);
+void jsonFijoTexto(JsonTx *j, const char *clave, int32_t valor, int decimales);
+void jsonHex(JsonTx *j, const char *clave, const void *datos, int len);
+void jsonAbrirArreglo(JsonTx *j, const char *clave);
+void jsonCerrarArreglo(JsonTx *j);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JSON_TX_H__ */
@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file    log.h
+  * @brief   Logging binario con formato diferido.
+  *
+  *          Cada mensaje de log_mensajes.h tiene un ID fijo en compilación.
+  *          El firmware solo envía el ID y los argumentos crudos como
+  *          registro de telemetría (TEL_LOG); el texto de formato vive en la
+  *          tabla del host, que arma la línea legible.
+  *
+  *          Los mensajes con nivel menor a LOG_NIVEL_MINIMO se eliminan en
+  *          compilación (definir LOG_NIVEL_MINIMO en las opciones del build).
+  ******************************************************************************
+  */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "log_mensajes.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define LOG_DEBUG   0
+#define LOG_INFO    1
+#define LOG_WARN    2
+#define LOG_ERROR   3
+#define LOG_NADA    4
+
+#ifndef LOG_NIVEL_MINIMO
+#define LOG_NIVEL_MINIMO LOG_DEBUG
+#endif
+
+// Longitud máxima de un argumento de cadena
+#define LOG_MAX_CADENA 32
+
+/* Types ---------------------------------------------------------------------*/
+#define LOG_X_ID(nombre, nivel, firma, formato)     LOG_ID_##nombre,
+#define LOG_X_NIVEL(nombre, nivel, firma, formato)  LOG_NIVEL_##nombre = (nivel),
+
+typedef enum {
+    LOG_TABLA(LOG_X_ID)
+    LOG_NUM_MENSAJES
+} IdLog;
+
+enum {
+    LOG_TABLA(LOG_X_NIVEL)
+};
+
+/* Macros --------------------------------------------------------------------*/
+// LOG(NOMBRE, args...): el if es constante y el compilador lo descarta
+#define LOG(nombre, ...) \
+    do { \
+        if (LOG_NIVEL_##nombre >= LOG_NIVEL_MINIMO) { \
+            logEmitir(LOG_ID_##nombre, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+/* Function prototypes -------------------------------------------------------*/
+void logEmitir(IdLog id, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LOG_H__ */
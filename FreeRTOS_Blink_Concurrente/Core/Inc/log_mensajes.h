@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    log_mensajes.h
+  * @brief   Tabla de mensajes de diagnóstico (ver log.h).
+  *
+  *          X(nombre, nivel, firma, formato)
+  *            firma:   un carácter por argumento
+  *                     d = int, u = unsigned, s = cadena, f = float
+  *            formato: solo lo usa el host; no se compila en el firmware.
+  *
+  *          El ID de cada mensaje es su posición en la tabla: agregar
+  *          mensajes solo al final y regenerar la tabla del host con
+  *          "node generar_tabla_logs.js" en APLICACIÓN WEB.
+  ******************************************************************************
+  */
+#ifndef __LOG_MENSAJES_H__
+#define __LOG_MENSAJES_H__
+
+#define LOG_TABLA(X) \
+    /* Asignador */ \
+    X(ASIG_PROCESANDO,        LOG_DEBUG, "s",    "[Asignador Hibrido] ===== Procesando %s =====") \
+    X(ASIG_LIMITE_INTENTOS,   LOG_WARN,  "sd",   "[Asignador Hibrido] Pedido %s supero limite de intentos (%d)") \
+    X(ASIG_ESPERA_LIBERAR,    LOG_WARN,  "",     "Esperando 10s para liberar motoristas y reiniciando contador") \
+    X(ASIG_SIN_CAPACIDAD,     LOG_INFO,  "",     "[Asignador Hibrido] Ningun motorista con capacidad disponible") \
+    X(ASIG_REINTENTO,         LOG_INFO,  "d",    "Reintentando en 3s (intento %d/5)") \
+    X(ASIG_LISTA_CANDIDATOS,  LOG_DEBUG, "",     "[Asignador Hibrido] Lista candidatos (mejor->peor):") \
+    X(ASIG_CANDIDATO,         LOG_DEBUG, "sfdd", "   %s | score=%.2f | desvio=%d | pedidos=%d") \
+    X(ASIG_PREGUNTA,          LOG_DEBUG, "ss",   "[Asignador Hibrido] Preguntando a %s -> %s") \
+    X(ASIG_FORZADA,           LOG_INFO,  "s",    "[Asignador Hibrido] Ningun motorista confirmo. Asignacion forzada a %s") \
+    X(ASIG_SCORE,             LOG_INFO,  "fd",   "(score=%.2f, desvio=%d)") \
+    X(ASIG_SIN_DISPONIBLE,    LOG_INFO,  "",     "[Asignador Hibrido] Ningun motorista disponible") \
+    X(ASIG_ABANDONADO,        LOG_WARN,  "s",    "[Asignador Hibrido] Pedido %s no pudo asignarse tras varios intentos") \
+    X(ASIG_BUSCANDO,          LOG_WARN,  "",     "Marcado como BUSCANDO_MOTORISTA") \
+    X(ASIG_ASIGNADO,          LOG_INFO,  "s",    "[Asignador Hibrido] ✓ Pedido asignado a %s") \
+    X(ASIG_TAREA_INICIADA,    LOG_INFO,  "",     "[Asignador Hibrido] Tarea iniciada") \
+    /* Estadísticas y métricas */ \
+    X(STATS_INICIO,           LOG_INFO,  "",     "========== ESTADISTICAS ROUND-ROBIN ==========") \
+    X(STATS_FIN,              LOG_INFO,  "",     "==============================================") \
+    X(MET_CALCULADAS,         LOG_DEBUG, "d",    "[Metricas] Calculadas: %d pedidos analizados") \
+    X(MET_INICIO,             LOG_INFO,  "",     "========== METRICAS GLOBALES ==========") \
+    X(MET_PROM_TOTAL,         LOG_INFO,  "f",    "Promedio Total:      %.2f seg") \
+    X(MET_PROM_PREP,          LOG_INFO,  "f",    "Promedio Prep:       %.2f seg") \
+    X(MET_PROM_ESPERA,        LOG_INFO,  "f",    "Promedio Espera:     %.2f seg") \
+    X(MET_PROM_ENTREGA,       LOG_INFO,  "f",    "Promedio Entrega:    %.2f seg") \
+    X(MET_P50_TOTAL,          LOG_INFO,  "f",    "Percentil 50 Total:  %.2f seg") \
+    X(MET_P95_TOTAL,          LOG_INFO,  "f",    "Percentil 95 Total:  %.2f seg") \
+    X(MET_P50_PREP,           LOG_INFO,  "f",    "Percentil 50 Prep:   %.2f seg") \
+    X(MET_P95_PREP,           LOG_INFO,  "f",    "Percentil 95 Prep:   %.2f seg") \
+    X(MET_ANALIZADOS,         LOG_INFO,  "d",    "Pedidos Analizados:  %d") \
+    X(MET_FIN,                LOG_INFO,  "",     "=======================================") \
+    /* Cancelador */ \
+    X(CANC_INICIO,            LOG_INFO,  "s",    "[Cancelador] ===== Cancelando pedido %s =====") \
+    X(CANC_NO_ENCONTRADO,     LOG_WARN,  "s",    "[Cancelador] Pedido %s NO ENCONTRADO") \
+    X(CANC_ESTADO,            LOG_DEBUG, "d",    "[Cancelador] Pedido encontrado - Estado: %d") \
+    X(CANC_REPARTIDOR,        LOG_DEBUG, "d",    "[Cancelador] Asignado a repartidor: %d") \
+    X(CANC_BANDERAS,          LOG_DEBUG, "dddd", "[Cancelador] Estados - Asignado: %d | EnPreparacion: %d | Listo: %d | EnReparto: %d") \
+    X(CANC_REMOVIDO_COLA,     LOG_DEBUG, "d",    "[Cancelador] Pedido removido de cola del restaurante (posición %d)") \
+    X(CANC_NUEVA_COLA,        LOG_DEBUG, "d",    "[Cancelador] Nueva cola: %d pedidos") \
+    X(CANC_ENTREGANDO,        LOG_WARN,  "",     "[Cancelador] NO SE PUEDE CANCELAR - Repartidor está entregando en la casa") \
+    X(CANC_SERA_ENTREGADO,    LOG_WARN,  "",     "[Cancelador] El pedido será entregado en unos segundos") \
+    X(CANC_EN_REPARTIDOR,     LOG_DEBUG, "dd",   "[Cancelador] Pedido encontrado en repartidor (índice %d de %d)") \
+    X(CANC_ERA_ACTUAL,        LOG_DEBUG, "",     "[Cancelador] Era el pedido ACTUAL del repartidor") \
+    X(CANC_ESTADO_REP,        LOG_DEBUG, "dd",   "[Cancelador] Estado del repartidor: %d | Bloqueado: %d") \
+    X(CANC_DESBLOQUEO,        LOG_DEBUG, "",     "[Cancelador] Desbloqueando repartidor (estaba esperando)") \
+    X(CANC_REMOVIDO_REP,      LOG_DEBUG, "d",    "[Cancelador] Pedido removido. Repartidor ahora tiene %d pedidos") \
+    X(CANC_SIGUIENTE,         LOG_DEBUG, "s",    "[Cancelador] Cambiando a siguiente pedido %s") \
+    X(CANC_DESOCUPADO,        LOG_DEBUG, "",     "[Cancelador] Repartidor ahora DESOCUPADO (sin más pedidos)") \
+    X(CANC_EN_COLA_REP,       LOG_DEBUG, "",     "[Cancelador] Era pedido en cola (no actual), removiendo") \
+    X(CANC_NO_EN_REP,         LOG_WARN,  "",     "[Cancelador] Pedido NO encontrado en repartidor (pero estaba asignado)") \
+    X(CANC_MARCADO,           LOG_INFO,  "",     "[Cancelador] Pedido marcado como CANCELADO") \
+    X(CANC_FIN,               LOG_INFO,  "",     "[Cancelador] ===== Cancelación completada =====") \
+    X(MET_P99_TOTAL,          LOG_INFO,  "f",    "Percentil 99 Total:  %.2f seg")
+
+#endif /* __LOG_MENSAJES_H__ */
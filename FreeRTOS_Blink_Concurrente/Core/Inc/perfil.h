@@ -0,0 +1,47 @@
+/**
+  ******************************************************************************
+  * @file    perfil.h
+  * @brief   Perfil de tareas: CPU, pilas, heap y colas.
+  *
+  *          El contador de ejecución de FreeRTOS (configGENERATE_RUN_TIME_STATS)
+  *          sale del contador de ciclos DWT extendido a 64 bits y dividido
+  *          por 2^PERFIL_CORRIMIENTO: a 180 MHz cuenta de a 1.4 us y el
+  *          valor de 32 bits que ve el kernel tarda ~1.7 h en dar la vuelta.
+  *          En host (HOST_SIM) cuenta microsegundos del reloj monótono.
+  *
+  *          task_stats informa el uso de CPU de cada tarea desde el reporte
+  *          anterior, el mínimo de pila libre que tuvo, el heap libre y el
+  *          mínimo histórico, y la ocupación de las colas registradas.
+  ******************************************************************************
+  */
+#ifndef __PERFIL_H__
+#define __PERFIL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* Defines -------------------------------------------------------------------*/
+#define PERFIL_CORRIMIENTO  8
+#define PERFIL_MAX_TAREAS   12
+#define PERFIL_MAX_COLAS    6
+
+/* Function prototypes -------------------------------------------------------*/
+// Contador de configGENERATE_RUN_TIME_STATS (ver FreeRTOSConfig.h)
+void perfilIniciarContador(void);
+uint32_t perfilContador(void);
+
+void perfilIniciar(void);
+int perfilRegistrarCola(const char *nombre, QueueHandle_t cola);
+void perfilEnviarEstadisticas(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PERFIL_H__ */
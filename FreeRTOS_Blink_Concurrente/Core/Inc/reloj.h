@@ -0,0 +1,56 @@
+/**
+  ******************************************************************************
+  * @file    reloj.h
+  * @brief   Reloj de la simulación: las marcas de tiempo y las esperas de
+  *          freertos.c pasan por aquí.
+  *
+  *          En la placa es HAL_GetTick y vTaskDelay, sin costo extra. En el
+  *          simulador de host (HOST_SIM) el reloj puede ser virtual: cuando
+  *          todas las tareas están bloqueadas, la tarea idle adelanta el
+  *          tick de FreeRTOS hasta el próximo desbloqueo (tickless idle, ver
+  *          relojSuprimirTicks). Los tiempos de preparación, entrega y
+  *          movimiento se cumplen igual, pero sin esperarlos en tiempo real.
+  ******************************************************************************
+  */
+#ifndef __RELOJ_H__
+#define __RELOJ_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    RELOJ_REAL = 0,     // el tick avanza con el tiempo de pared
+    RELOJ_VIRTUAL       // el tick salta al próximo evento (solo host)
+} ModoReloj;
+
+typedef struct {
+    uint32_t saltos;            // veces que se adelantó el tick
+    uint32_t ticksSaltados;     // ms simulados sin esperar
+} EstadisticasReloj;
+
+/* Function prototypes -------------------------------------------------------*/
+// Milisegundos simulados desde el arranque
+uint32_t relojAhora(void);
+// Espera en tiempo simulado; solo desde una tarea
+void relojEsperar(uint32_t ms);
+// Ticks de FreeRTOS que dura una espera de ms
+uint32_t relojMsATicks(uint32_t ms);
+ModoReloj relojModo(void);
+// Devuelve 0 si el modo no existe en este build (virtual en la placa)
+int relojFijarModo(ModoReloj modo);
+void relojObtenerEstadisticas(EstadisticasReloj *out);
+void relojReiniciarEstadisticas(void);
+#ifdef HOST_SIM
+void relojSuprimirTicks(uint32_t esperados);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RELOJ_H__ */
@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file    sonda.h
+  * @brief   Sondas de duración para los caminos calientes del firmware.
+  *
+  *          SONDA_AMBITO(NOMBRE) al principio de un bloque mide desde ese
+  *          punto hasta que el bloque termina (por cualquier return), y
+  *          SONDA_INICIO / SONDA_FIN marcan un tramo a mano. Cada sonda
+  *          acumula conteo, mínimo, máximo, suma y un histograma log2.
+  *
+  *          En el STM32 se cuentan ciclos del DWT (CYCCNT); en host
+  *          (HOST_SIM) nanosegundos del reloj monótono. Con
+  *          SONDAS_HABILITADAS en 0 las macros no generan código.
+  *
+  *          X(nombre, etiqueta): agregar sondas en cualquier posición; la
+  *          etiqueta es la que muestra el comando PROBES.
+  ******************************************************************************
+  */
+#ifndef __SONDA_H__
+#define __SONDA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#ifndef SONDAS_HABILITADAS
+#define SONDAS_HABILITADAS  1
+#endif
+
+#define SONDA_CUBETAS       32
+
+#define SONDAS_TABLA(X) \
+    X(ASTAR,             "astar") \
+    X(ASIGNAR,           "asignar_pedido") \
+    X(PROCESAR_REST,     "procesar_restaurante") \
+    X(CALC_METRICAS,     "calcular_metricas") \
+    X(ENVIAR_MAPA,       "enviar_mapa") \
+    X(ENVIAR_EVENTO,     "enviar_evento") \
+    X(ENVIAR_MET_PEDIDO, "enviar_metricas_pedido") \
+    X(ENVIAR_MET_GLOBAL, "enviar_metricas_globales") \
+    X(ENVIAR_ENTIDADES,  "enviar_metricas_entidades") \
+    X(ENVIAR_ESTAD,      "enviar_estadisticas")
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+#define SONDA_ENUM(nombre, etiqueta) SONDA_##nombre,
+    SONDAS_TABLA(SONDA_ENUM)
+#undef SONDA_ENUM
+    NUM_SONDAS
+} IdSonda;
+
+typedef struct {
+    uint32_t llamadas;
+    uint32_t min;
+    uint32_t max;
+    uint32_t p99;       // límite superior de la cubeta log2 del p99
+    uint64_t suma;
+} ResumenSonda;
+
+/* Function prototypes -------------------------------------------------------*/
+#if SONDAS_HABILITADAS
+
+typedef struct {
+    uint8_t id;
+    uint32_t inicio;
+} AmbitoSonda;
+
+void sondasIniciar(void);
+uint32_t sondaLeer(void);
+void sondaRegistrar(IdSonda id, uint32_t duracion);
+void sondasReiniciar(void);
+int sondaResumir(IdSonda id, ResumenSonda *r);
+const char *sondaEtiqueta(IdSonda id);
+const char *sondaUnidad(void);
+
+static inline void sondaCerrarAmbito(AmbitoSonda *a) {
+    sondaRegistrar((IdSonda)a->id, sondaLeer() - a->inicio);
+}
+
+#define SONDA_AMBITO(nombre) \
+    AmbitoSonda _sonda_##nombre __attribute__((cleanup(sondaCerrarAmbito))) = { SONDA_##nombre, sondaLeer() }
+#define SONDA_INICIO(nombre)    uint32_t _sondaInicio_##nombre = sondaLeer()
+#define SONDA_FIN(nombre)       sondaRegistrar(SONDA_##nombre, sondaLeer() - _sondaInicio_##nombre)
+
+#else
+
+#define SONDA_AMBITO(nombre)    do { } while (0)
+#define SONDA_INICIO(nombre)    do { } while (0)
+#define SONDA_FIN(nombre)       do { } while (0)
+
+#endif /* SONDAS_HABILITADAS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SONDA_H__ */
@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    telemetria.h
+  * @brief   Protocolo binario compacto de telemetría (versión 1).
+  *
+  *          Registro: [version][tipo][payload...][crc16 LE]
+  *          El CRC es CRC-16/CCITT-FALSE sobre version+tipo+payload.
+  *          En la línea cada registro viaja codificado con COBS entre dos
+  *          delimitadores 0x00, así convive con las líneas JSON de texto
+  *          (que nunca contienen 0x00). Los enteros sin tamaño fijo van
+  *          como varint LEB128 sin signo.
+  ******************************************************************************
+  */
+#ifndef __TELEMETRIA_H__
+#define __TELEMETRIA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define TEL_VERSION           1
+#define TEL_MAX_PAYLOAD       96
+
+// Tipos de registro
+#define TEL_MOV               0x01  // Reservado: reemplazado por TEL_FLOTA
+#define TEL_EVENTO            0x02
+#define TEL_METRICAS          0x03
+#define TEL_STATS             0x04
+#define TEL_ESTADO_REST       0x05
+#define TEL_FLOTA             0x06
+#define TEL_LOG               0x07
+#define TEL_ACK               0x08  // Acuse selectivo del canal de comandos
+
+// Tipos de registro que envía el host (ver canal_cmd.h)
+#define TEL_CMD               0x10
+
+// Banderas del registro de evento
+#define TEL_EV_CON_DRIVER     0x01
+#define TEL_EV_CON_PREP       0x02
+
+// Banderas del registro de flota
+#define TEL_FLOTA_KEYFRAME    0x01
+
+// Banderas del registro de estado de restaurante
+#define TEL_REST_SJF          0x01
+#define TEL_REST_CARGADO      0x02
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    TELEMETRIA_JSON,
+    TELEMETRIA_BINARIA
+} FormatoTelemetria;
+
+// Códigos de evento (el orden es parte del protocolo)
+typedef enum {
+    TEL_EV_ORDER_CREATED,
+    TEL_EV_ORDER_PREPARING,
+    TEL_EV_ORDER_READY,
+    TEL_EV_DRIVER_ASSIGNED,
+    TEL_EV_DRIVER_PICKED_UP,
+    TEL_EV_DELIVERED,
+    TEL_EV_CANCELLED,
+    TEL_EV_CANCEL_REJECTED,
+    TEL_EV_CANCEL_FAILED,
+    TEL_EV_DESCONOCIDO
+} CodigoEventoTel;
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t len;
+    uint8_t datos[TEL_MAX_PAYLOAD];
+} RegistroTel;
+
+/* Function prototypes -------------------------------------------------------*/
+void telemetriaSetFormato(FormatoTelemetria formato);
+FormatoTelemetria telemetriaGetFormato(void);
+int telemetriaBinaria(void);
+
+CodigoEventoTel telemetriaCodigoEvento(const char *evento);
+int telemetriaNumeroRecibo(const char *numeroRecibo);
+
+void telRegistroIniciar(RegistroTel *r, uint8_t tipo);
+void telPonerU8(RegistroTel *r, uint8_t v);
+void telPonerVarint(RegistroTel *r, uint32_t v);
+int telemetriaEnviarRegistro(const RegistroTel *r);
+
+uint16_t telemetriaCrc16(const uint8_t *datos, int len);
+int telemetriaCobsCodificar(const uint8_t *entrada, int len, uint8_t *salida);
+int telemetriaCobsDecodificar(uint8_t *datos, int len);
+int telemetriaEmpaquetar(const RegistroTel *r, uint8_t *salida, int maxLen);
+
+void telemetriaFlota(uint32_t seq, int keyframe, const uint8_t *entradas, int n);
+void telemetriaEvento(CodigoEventoTel ev, int pedido, int driver, uint32_t prepCentis, int restaurantId, int destinationId);
+void telemetriaMetricas(int pedido, uint32_t queueCs, uint32_t prepCs, uint32_t waitCs, uint32_t driveCs, uint32_t totalCs);
+void telemetriaStats(int driver, int aceptados, int rechazados, int entregados, int tasa);
+void telemetriaEstadoRestaurante(int id, int sjf, int cargado, int cola, int umbral);
+void telemetriaAck(uint16_t base, uint32_t mascara);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEMETRIA_H__ */
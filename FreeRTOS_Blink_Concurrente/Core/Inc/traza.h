@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    traza.h
+  * @brief   Traza del scheduler en un anillo de RAM.
+  *
+  *          Los macros trace* de FreeRTOS (FreeRTOSConfig.h) registran cada
+  *          cambio de contexto y las operaciones sobre los objetos que
+  *          registró cerrojo.c (número de cola != 0); freertos.c agrega los
+  *          cambios de estado de los pedidos. Cada evento son 8 bytes con la
+  *          marca del contador de ciclos DWT (en host, microsegundos).
+  *
+  *          El anillo guarda los últimos TRAZA_EVENTOS eventos. Registrar es
+  *          un incremento atómico y cuatro escrituras, sin secciones
+  *          críticas: se puede llamar desde el kernel y desde interrupciones.
+  *
+  *          Este header lo incluye FreeRTOSConfig.h, así que no puede
+  *          depender de FreeRTOS.h ni de los headers del HAL.
+  ******************************************************************************
+  */
+#ifndef __TRAZA_H__
+#define __TRAZA_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#ifndef TRAZA_HABILITADA
+#define TRAZA_HABILITADA    1
+#endif
+
+// Potencia de 2
+#define TRAZA_EVENTOS       512
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    TRAZA_TAREA_ENTRA = 1,          // a = número de TCB
+    TRAZA_TAREA_SALE,               // a = número de TCB
+    TRAZA_COLA_ENVIO,               // a = número de cola, b = tipo de cola
+    TRAZA_COLA_ENVIO_FALLO,
+    TRAZA_COLA_RECEPCION,
+    TRAZA_COLA_BLOQUEO_ENVIO,
+    TRAZA_COLA_BLOQUEO_RECEPCION,
+    TRAZA_PEDIDO                    // a = nuevo estado, b = índice del pedido
+} TipoEventoTraza;
+
+typedef struct {
+    uint32_t t;
+    uint8_t tipo;
+    uint8_t a;
+    uint16_t b;
+} EventoTraza;
+
+/* Function prototypes -------------------------------------------------------*/
+#if TRAZA_HABILITADA
+
+extern EventoTraza trazaEventos[TRAZA_EVENTOS];
+extern uint32_t trazaEscritos;
+extern volatile uint8_t trazaActiva;
+
+#ifdef HOST_SIM
+uint32_t trazaReloj(void);
+#else
+// DWT->CYCCNT (lo habilita perfilIniciarContador)
+static inline uint32_t trazaReloj(void) {
+    return *(volatile uint32_t *)0xE0001004u;
+}
+#endif
+
+static inline void trazaRegistrar(uint8_t tipo, uint8_t a, uint16_t b) {
+    if (!trazaActiva) return;
+
+    uint32_t i = __atomic_fetch_add(&trazaEscritos, 1u, __ATOMIC_RELAXED);
+    EventoTraza *e = &trazaEventos[i & (TRAZA_EVENTOS - 1)];
+
+    e->t = trazaReloj();
+    e->tipo = tipo;
+    e->a = a;
+    e->b = b;
+}
+
+// Solo los objetos registrados en cerrojo.c tienen número
+static inline void trazaCola(uint8_t tipo, uint32_t numero, uint8_t tipoCola) {
+    if (numero != 0) trazaRegistrar(tipo, (uint8_t)numero, tipoCola);
+}
+
+void trazaArrancar(void);
+void trazaDetener(void);
+void trazaVolcar(void);
+void trazaEnviarEstado(void);
+
+#else
+
+static inline void trazaRegistrar(uint8_t tipo, uint8_t a, uint16_t b) {
+    (void)tipo; (void)a; (void)b;
+}
+
+#endif /* TRAZA_HABILITADA */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TRAZA_H__ */
@@ -0,0 +1,84 @@
+/**
+  ******************************************************************************
+  * @file    uart_rx.h
+  * @brief   Recepción UART por DMA circular con detección de línea inactiva.
+  *
+  *          El DMA escribe sin pausa en un anillo; la interrupción (mitad,
+  *          completo o línea inactiva) solo publica cuántos bytes van
+  *          recibidos y despierta a la tarea lectora. El separador de
+  *          líneas (FramerRx) corre en la tarea y entrega cada comando como
+  *          un tramo dentro del propio anillo, sin copiarlo.
+  *
+  *          Además de líneas de texto entrega tramas binarias del canal de
+  *          comandos (0x00 + COBS + 0x00, ver canal_cmd.h): un 0x00 fuera
+  *          de trama abre una y el siguiente 0x00 la cierra.
+  *
+  *          FramerRx no depende del HAL ni de FreeRTOS: se puede probar en
+  *          host alimentándolo con un flujo de bytes simulado.
+  ******************************************************************************
+  */
+#ifndef __UART_RX_H__
+#define __UART_RX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+// Tamaño del anillo de DMA (~89 ms de tráfico continuo a 115200 baud)
+#define UART_RX_BUFFER_SIZE   1024
+// Longitud máxima de una línea; las más largas se descartan completas
+#define UART_RX_MAX_LINEA     255
+
+/* Types ---------------------------------------------------------------------*/
+// Línea completa terminada en '\0' (el terminador reemplaza al '\r'/'\n'),
+// o trama binaria sin sus delimitadores si binaria = 1
+typedef struct {
+    char *datos;
+    uint16_t len;
+    uint8_t binaria;
+} LineaRx;
+
+typedef struct {
+    uint32_t bytesRecibidos;
+    uint32_t lineas;
+    uint32_t lineasLargas;      // Descartadas por superar UART_RX_MAX_LINEA
+    uint32_t lineasPartidas;    // Cruzaron el final del anillo (se copiaron)
+    uint32_t tramas;            // Tramas binarias entregadas
+    uint32_t bytesPerdidos;     // El DMA alcanzó a la tarea lectora
+    uint32_t erroresUart;
+} EstadisticasUartRx;
+
+// Separador de líneas sobre un anillo escrito por un productor externo.
+// Las posiciones son monótonas (se reducen módulo tam al acceder).
+typedef struct {
+    uint8_t *anillo;
+    uint32_t tam;
+    uint32_t leido;         // Siguiente byte a examinar
+    uint32_t inicioLinea;   // Primer byte de la línea en curso
+    uint8_t descartando;    // Línea en curso inválida hasta el próximo fin
+    uint8_t enTrama;        // Dentro de una trama binaria
+    char partida[UART_RX_MAX_LINEA + 1];
+    EstadisticasUartRx est;
+} FramerRx;
+
+/* Function prototypes -------------------------------------------------------*/
+void framerRxIniciar(FramerRx *f, uint8_t *anillo, uint32_t tam);
+int framerRxSiguiente(FramerRx *f, uint32_t escrito, LineaRx *linea);
+
+void uartRxInit(void);
+int uartRxSiguienteLinea(LineaRx *linea, uint32_t esperaMs);
+void uartRxObtenerEstadisticas(EstadisticasUartRx *out);
+void uartRxErrorUart(void);
+#ifdef HOST_SIM
+void uartRxAlimentar(const uint8_t *datos, int len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_RX_H__ */
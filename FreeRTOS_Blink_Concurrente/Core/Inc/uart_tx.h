@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file    uart_tx.h
+  * @brief   Transmisión UART no bloqueante: buffer circular MPSC sin locks
+  *          drenado en segundo plano por DMA (USART2 TX) o por un transporte
+  *          stub en host.
+  ******************************************************************************
+  */
+#ifndef __UART_TX_H__
+#define __UART_TX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+// Tamaño del buffer circular (potencia de 2)
+#define UART_TX_BUFFER_SIZE        4096
+// Longitud máxima de un registro; los más largos se descartan enteros
+#define UART_TX_MAX_REGISTRO       1024
+// Espera máxima en modo bloqueante antes de descartar
+#define UART_TX_TIMEOUT_BLOQUEO_MS 100
+// Intentos de arrancar el DMA con un registro antes de descartarlo
+#define UART_TX_MAX_REINTENTOS     8
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    UART_TX_DESCARTAR,  // Si el buffer está lleno se descarta la línea
+    UART_TX_BLOQUEAR    // Si el buffer está lleno la tarea espera espacio
+} ModoUartTx;
+
+typedef struct {
+    uint32_t bytesEnviados;
+    uint32_t registrosEnviados;
+    uint32_t registrosDescartados;
+    uint32_t bytesDescartados;
+    uint32_t desbordes;
+    uint32_t ocupacionMaxima;
+    uint32_t fallosDma;         // HAL_UART_Transmit_DMA distinto de HAL_OK
+    uint32_t registrosLargos;   // descartados por pasar UART_TX_MAX_REGISTRO
+} EstadisticasUartTx;
+
+// Espacio reservado en el buffer para escribir un registro en el lugar
+typedef struct {
+    uint32_t inicio;
+    uint32_t total;
+} ReservaUartTx;
+
+/* Function prototypes -------------------------------------------------------*/
+void uartTxInit(void);
+int uartTxEnviar(const char *datos, int len);
+uint8_t *uartTxReservar(int capacidad, ReservaUartTx *reserva);
+void uartTxConfirmar(ReservaUartTx *reserva, int len);
+void uartTxSetModo(ModoUartTx modo);
+ModoUartTx uartTxGetModo(void);
+void uartTxObtenerEstadisticas(EstadisticasUartTx *out);
+void uartTxModoPanico(void);
+void uartTxTransmisionCompleta(void);
+// Reintento sin depender de otro productor (ver uart_tx.c)
+void uartTxReintentar(void);
+#ifdef HOST_SIM
+void uartTxHostEscribir(const uint8_t *datos, int len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UART_TX_H__ */
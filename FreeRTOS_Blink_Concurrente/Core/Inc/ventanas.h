@@ -0,0 +1,61 @@
+/**
+  ******************************************************************************
+  * @file    ventanas.h
+  * @brief   Métricas en ventanas móviles (1, 5 y 15 minutos).
+  *
+  *          Un anillo de cubetas de VENTANA_SEG_CUBETA segundos guarda los
+  *          pedidos creados, las entregas y un histograma compacto del
+  *          tiempo total de cada entrega. Una cubeta se reutiliza cuando
+  *          el anillo da la vuelta, así que la memoria y el costo de cada
+  *          evento no dependen del tiempo encendido.
+  *
+  *          Una ventana de N minutos suma las cubetas completas de esos N
+  *          minutos más la cubeta en curso; las tasas se dividen por el
+  *          tiempo realmente cubierto.
+  ******************************************************************************
+  */
+#ifndef __VENTANAS_H__
+#define __VENTANAS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define VENTANA_SEG_CUBETA      10
+#define VENTANA_MAX_MIN         15
+#define VENTANA_NUM_CUBETAS     (VENTANA_MAX_MIN * 60 / VENTANA_SEG_CUBETA + 1)
+
+// Histograma por cubeta: 4 cubetas por potencia de 2 (error <= 12.5%)
+// hasta 2^20 ms (~17 min)
+#define VENTANA_HIST_BITS_SUB   2
+#define VENTANA_HIST_BITS_MAX   20
+#define VENTANA_HIST_CUBETAS    ((1u << VENTANA_HIST_BITS_SUB) * (VENTANA_HIST_BITS_MAX - VENTANA_HIST_BITS_SUB + 1))
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t minutos;
+    uint32_t segundosCubiertos;
+    uint32_t pedidos;
+    uint32_t entregas;
+    uint32_t pedidosPorMin;     // centésimas
+    uint32_t entregasPorMin;    // centésimas
+    uint32_t p50;               // tiempo total, ms
+    uint32_t p95;
+    uint32_t p99;
+} ResumenVentana;
+
+/* Function prototypes -------------------------------------------------------*/
+void ventanasReiniciar(uint32_t ahora);
+void ventanasRegistrarPedido(uint32_t ahora);
+void ventanasRegistrarEntrega(uint32_t ahora, uint32_t totalMs);
+void ventanasResumir(uint32_t ahora, uint32_t minutos, ResumenVentana *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VENTANAS_H__ */
@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    aleatorio.c
+  * @brief   Flujos pseudoaleatorios xoshiro128** (ver aleatorio.h).
+  *
+  *          xoshiro128** usa solo operaciones de 32 bits (barato en el M4) y
+  *          tiene periodo 2^128 - 1. El estado de cada flujo se llena con
+  *          splitmix32 a partir de la semilla mezclada con el número de
+  *          flujo, así dos flujos de la misma semilla no se parecen.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "aleatorio.h"
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t s[4];
+    uint32_t usos;
+} Flujo;
+
+/* Variables -----------------------------------------------------------------*/
+static Flujo flujos[ALEATORIO_NUM_FLUJOS];
+static uint32_t semillaCorrida = ALEATORIO_SEMILLA_DEFECTO;
+
+static const char *const nombresFlujo[] = {
+    [ALEATORIO_MAPA]         = "map",
+    [ALEATORIO_CONFIRMACION] = "confirm",
+    [ALEATORIO_PEDIDOS]      = "orders",
+    [ALEATORIO_PASEO]        = "roam",
+    [ALEATORIO_CARGA]        = "load",
+};
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline uint32_t rotar(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static uint32_t splitmix32(uint32_t *x) {
+    uint32_t z = (*x += 0x9E3779B9u);
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    return z ^ (z >> 16);
+}
+
+static void sembrar(Flujo *f, uint32_t semilla, uint32_t indice) {
+    uint32_t x = semilla ^ ((indice + 1u) * 0x632BE5ABu);
+
+    for (int i = 0; i < 4; i++) {
+        f->s[i] = splitmix32(&x);
+    }
+    // El estado todo en cero es el único prohibido
+    if ((f->s[0] | f->s[1] | f->s[2] | f->s[3]) == 0) f->s[0] = 1;
+    f->usos = 0;
+}
+
+static uint32_t siguiente(Flujo *f) {
+    uint32_t *s = f->s;
+    uint32_t resultado = rotar(s[1] * 5u, 7) * 9u;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotar(s[3], 11);
+
+    f->usos++;
+    return resultado;
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+void aleatorioSembrar(uint32_t semilla) {
+    semillaCorrida = semilla;
+    for (int i = 0; i < ALEATORIO_NUM_FLUJOS; i++) {
+        sembrar(&flujos[i], semilla, (uint32_t)i);
+    }
+}
+
+uint32_t aleatorioSemilla(void) {
+    return semillaCorrida;
+}
+
+void aleatorioReiniciarFlujo(FlujoAleatorio flujo) {
+    sembrar(&flujos[flujo], semillaCorrida, (uint32_t)flujo);
+}
+
+void aleatorioSembrarFlujo(FlujoAleatorio flujo, uint32_t semilla) {
+    sembrar(&flujos[flujo], semilla != 0 ? semilla : semillaCorrida, (uint32_t)flujo);
+}
+
+uint32_t aleatorioSiguiente(FlujoAleatorio flujo) {
+    return siguiente(&flujos[flujo]);
+}
+
+// Multiplicación de 64 bits y rechazo de la franja sesgada (Lemire)
+uint32_t aleatorioRango(FlujoAleatorio flujo, uint32_t n) {
+    if (n <= 1) return 0;
+
+    Flujo *f = &flujos[flujo];
+    uint64_t m = (uint64_t)siguiente(f) * n;
+    uint32_t bajo = (uint32_t)m;
+
+    if (bajo < n) {
+        uint32_t umbral = (0u - n) % n;
+        while (bajo < umbral) {
+            m = (uint64_t)siguiente(f) * n;
+            bajo = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+float aleatorioUniforme(FlujoAleatorio flujo) {
+    return (float)(siguiente(&flujos[flujo]) >> 8) * (1.0f / 16777216.0f);
+}
+
+uint32_t aleatorioUsos(FlujoAleatorio flujo) {
+    return flujos[flujo].usos;
+}
+
+const char *aleatorioNombreFlujo(FlujoAleatorio flujo) {
+    if ((unsigned)flujo >= sizeof(nombresFlujo) / sizeof(nombresFlujo[0])) return "?";
+    return nombresFlujo[flujo];
+}
@@ -0,0 +1,182 @@
+/**
+  ******************************************************************************
+  * @file    canal_cmd.c
+  * @brief   Canal confiable de comandos host -> STM32 (ver canal_cmd.h).
+  *
+  *          Solo lo usa StartTaskRx, así que el estado no necesita locks.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "canal_cmd.h"
+#include "telemetria.h"
+#include "uart_rx.h"
+#include <string.h>
+
+/* Defines -------------------------------------------------------------------*/
+// version + tipo + seq + ventana + sesion + crc
+#define CANAL_CABECERA      7
+#define CANAL_MIN_CRUDO     (CANAL_CABECERA + 2)
+
+/* Variables -----------------------------------------------------------------*/
+static int sincronizado = 0;
+static uint8_t sesionActual = 0;
+
+// base = próximo seq a ejecutar; bit i = base + i recibido y retenido
+static uint16_t base = 0;
+static uint32_t mascara = 0;
+// Los seq anteriores a salto que falten los abandonó el host
+static uint16_t salto = 0;
+
+// Comandos llegados antes de su turno
+static char retenidos[CANAL_CMD_RETENIDOS][UART_RX_MAX_LINEA + 1];
+static uint16_t seqRetenido[CANAL_CMD_RETENIDOS];
+static uint8_t slotOcupado[CANAL_CMD_RETENIDOS];
+
+static EstadisticasCanalCmd estadisticas;
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline int antesDe(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b) < 0;
+}
+
+static int buscarRetenido(uint16_t seq) {
+    for (int i = 0; i < CANAL_CMD_RETENIDOS; i++) {
+        if (slotOcupado[i] && seqRetenido[i] == seq) return i;
+    }
+    return -1;
+}
+
+static int slotLibre(void) {
+    for (int i = 0; i < CANAL_CMD_RETENIDOS; i++) {
+        if (!slotOcupado[i]) return i;
+    }
+    return -1;
+}
+
+// Ajusta la ventana al seq más antiguo que el host espera confirmar
+static void alinearVentana(uint16_t ventana, uint8_t sesion) {
+    if (!sincronizado || sesion != sesionActual) {
+        // Primer contacto, STM32 reiniciado o host con numeración nueva
+        if (sincronizado) estadisticas.resincronizaciones++;
+        sincronizado = 1;
+        sesionActual = sesion;
+        base = ventana;
+        salto = ventana;
+        mascara = 0;
+        memset(slotOcupado, 0, sizeof(slotOcupado));
+    } else if (antesDe(salto, ventana)) {
+        // El host dejó de esperar los anteriores a ventana; los retenidos
+        // entre base y ventana igual se ejecutan, en orden
+        salto = ventana;
+    }
+    // ventana atrasada: trama vieja o acuse perdido, base no retrocede
+}
+
+// Primer seq sin recibir y máscara tal como quedarán tras ejecutar todo lo
+// que ya se puede: es lo que se confirma
+static void calcularAcuse(uint16_t *b, uint32_t *m) {
+    *b = base;
+    *m = mascara;
+    while ((*m & 1u) || antesDe(*b, salto)) {
+        *m >>= 1;
+        (*b)++;
+    }
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+// Valida una trama (sin delimitadores), la confirma y devuelve el comando a
+// ejecutar terminado en '\0', o NULL si no hay ninguno listo. Los que llegan
+// antes de su turno se retienen; tras ejecutar el devuelto hay que pedir los
+// siguientes con canalCmdSiguiente. El texto apunta dentro de trama o a un
+// retenido y vale hasta la próxima trama.
+char *canalCmdProcesarTrama(uint8_t *trama, int len) {
+    int n = telemetriaCobsDecodificar(trama, len);
+
+    if (n < CANAL_MIN_CRUDO) {
+        estadisticas.malformadas++;
+        return NULL;
+    }
+
+    uint16_t crc = (uint16_t)(trama[n - 2] | (trama[n - 1] << 8));
+    if (telemetriaCrc16(trama, n - 2) != crc) {
+        estadisticas.erroresCrc++;
+        return NULL;
+    }
+    if (trama[0] != TEL_VERSION || trama[1] != TEL_CMD) {
+        estadisticas.malformadas++;
+        return NULL;
+    }
+
+    uint16_t seq = (uint16_t)(trama[2] | (trama[3] << 8));
+    uint16_t ventana = (uint16_t)(trama[4] | (trama[5] << 8));
+
+    estadisticas.tramas++;
+    alinearVentana(ventana, trama[6]);
+
+    uint16_t d = (uint16_t)(seq - base);
+    char *texto = NULL;
+
+    trama[n - 2] = '\0';
+
+    if ((int16_t)d < 0 || (d < 32 && (mascara & (1u << d))) || antesDe(seq, salto)) {
+        // Retransmisión de algo ya recibido, o de un seq abandonado
+        estadisticas.duplicadas++;
+    } else if (d >= CANAL_CMD_VENTANA) {
+        estadisticas.fueraDeVentana++;
+    } else if (d == 0) {
+        // En su turno: se ejecuta sin copiarlo
+        base++;
+        mascara >>= 1;
+        estadisticas.ejecutadas++;
+        texto = (char *)&trama[CANAL_CABECERA];
+    } else {
+        int slot = slotLibre();
+        if (slot < 0) {
+            // Sin lugar no se confirma: el host lo retransmitirá
+            estadisticas.sinLugar++;
+        } else {
+            strncpy(retenidos[slot], (char *)&trama[CANAL_CABECERA], UART_RX_MAX_LINEA);
+            retenidos[slot][UART_RX_MAX_LINEA] = '\0';
+            seqRetenido[slot] = seq;
+            slotOcupado[slot] = 1;
+            mascara |= 1u << d;
+            estadisticas.retenidas++;
+        }
+    }
+
+    // Se confirma antes de ejecutar: un comando lento no retrasa el acuse
+    uint16_t b;
+    uint32_t m;
+    calcularAcuse(&b, &m);
+    telemetriaAck(b, m);
+
+    return (texto != NULL) ? texto : canalCmdSiguiente();
+}
+
+// Siguiente comando retenido que ya le toca, o NULL. Los seq abandonados
+// por el host se saltan
+char *canalCmdSiguiente(void) {
+    while ((mascara & 1u) || antesDe(base, salto)) {
+        int slot = (mascara & 1u) ? buscarRetenido(base) : -1;
+
+        base++;
+        mascara >>= 1;
+
+        if (slot >= 0) {
+            slotOcupado[slot] = 0;
+            estadisticas.ejecutadas++;
+            return retenidos[slot];
+        }
+        estadisticas.abandonadas++;
+    }
+    return NULL;
+}
+
+// Copia de los contadores del canal
+void canalCmdObtenerEstadisticas(EstadisticasCanalCmd *out) {
+    if (out == NULL) return;
+    *out = estadisticas;
+}
@@ -0,0 +1,268 @@
+/**
+  ******************************************************************************
+  * @file    carga.c
+  * @brief   Generador de carga: procesos de llegada y muestreo de pedidos.
+  *
+  *          Las llegadas se guardan como instantes absolutos en ms; cada
+  *          intervalo se redondea al ms, así varias llegadas pueden caer en
+  *          el mismo tick. Las comparaciones usan la diferencia con signo,
+  *          igual que el resto del código, para sobrevivir al desborde.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "carga.h"
+#include "aleatorio.h"
+#include <math.h>
+#include <string.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define MS_POR_HORA         3600000.0f
+// Tope de candidatos rechazados por llegada (curva casi en cero)
+#define MAX_ADELGAZAMIENTO  1000
+
+/* Variables -----------------------------------------------------------------*/
+static ConfigCarga config;
+
+static uint32_t origen;             // inicio de la curva de hora pico
+static uint32_t proximaBase;
+static uint32_t proximaRafaga;
+static uint32_t proximoEnRafaga;
+static uint32_t pendientesRafaga;
+
+static ContadoresCarga contadores;
+
+// Curva por defecto de un día: madrugada casi vacía, almuerzo y cena
+static const uint16_t curvaDia[CARGA_TRAMOS] = {
+    20, 10, 10, 10, 10, 20, 40, 60, 80, 90, 100, 200,
+    300, 250, 120, 90, 90, 120, 250, 350, 300, 180, 80, 40
+};
+
+static const char *const nombresModo[] = {
+    [CARGA_APAGADA]   = "off",
+    [CARGA_WEB]       = "web",
+    [CARGA_POISSON]   = "poisson",
+    [CARGA_HORA_PICO] = "rush",
+    [CARGA_RAFAGAS]   = "burst",
+};
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline float uniforme(void) {
+    return aleatorioUniforme(ALEATORIO_CARGA);
+}
+
+static inline int vencido(uint32_t ahora, uint32_t instante) {
+    return (int32_t)(ahora - instante) >= 0;
+}
+
+// Intervalo exponencial en ms para una tasa en pedidos/hora
+static uint32_t intervaloExponencial(float porHora) {
+    float media = MS_POR_HORA / porHora;
+    return (uint32_t)(-logf(1.0f - uniforme()) * media + 0.5f);
+}
+
+// Multiplicador (%) de la curva en "t" ms desde el origen, interpolado
+static float multiplicadorCurva(uint32_t t) {
+    uint32_t periodo = config.periodoS * 1000u;
+    if (periodo == 0 || config.tramos == 0) return 100.0f;
+
+    float pos = (float)(t % periodo) * config.tramos / (float)periodo;
+    int i = (int)pos;
+    if (i >= config.tramos) i = config.tramos - 1;
+    int siguiente = (i + 1) % config.tramos;
+    float frac = pos - (float)i;
+
+    return config.curva[i] + (config.curva[siguiente] - config.curva[i]) * frac;
+}
+
+static uint16_t maximoCurva(void) {
+    uint16_t max = 0;
+    for (int i = 0; i < config.tramos; i++) {
+        if (config.curva[i] > max) max = config.curva[i];
+    }
+    return max;
+}
+
+// Próxima llegada del proceso base a partir de "desde"
+static uint32_t siguienteBase(uint32_t desde) {
+    switch (config.modo) {
+        case CARGA_WEB:
+            return desde + 20000u + (uint32_t)(uniforme() * 10000.0f);
+
+        case CARGA_POISSON:
+        case CARGA_RAFAGAS:
+            return desde + intervaloExponencial((float)config.porHora);
+
+        case CARGA_HORA_PICO: {
+            // Adelgazamiento: candidatos a la tasa máxima, aceptados con
+            // probabilidad tasa(t) / tasa máxima
+            float max = (float)maximoCurva();
+            uint32_t t = desde;
+            if (max <= 0.0f) return desde + MS_POR_HORA;
+
+            for (int i = 0; i < MAX_ADELGAZAMIENTO; i++) {
+                t += intervaloExponencial((float)config.porHora * max / 100.0f);
+                if (uniforme() * max < multiplicadorCurva(t - origen)) break;
+            }
+            return t;
+        }
+
+        default:
+            return desde;
+    }
+}
+
+// Índice en [0, n) con probabilidad proporcional a 1 / (k + 1)^s
+static int elegirZipf(int n, uint16_t exponente) {
+    if (n <= 1) return 0;
+    if (exponente == 0) return (int)aleatorioRango(ALEATORIO_CARGA, (uint32_t)n);
+
+    float s = exponente / 100.0f;
+    float total = 0.0f;
+    for (int k = 1; k <= n; k++) {
+        total += powf((float)k, -s);
+    }
+
+    float objetivo = uniforme() * total;
+    for (int k = 1; k <= n; k++) {
+        objetivo -= powf((float)k, -s);
+        if (objetivo < 0.0f) return k - 1;
+    }
+    return n - 1;
+}
+
+static int baseActiva(void) {
+    return config.modo == CARGA_WEB || config.porHora > 0;
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+void cargaIniciar(uint32_t ahora) {
+    memset(&config, 0, sizeof(config));
+    config.modo = CARGA_WEB;
+    config.porHora = 60;
+    config.periodoS = 24u * 3600u;
+    config.rafagasPorHora = 2;
+    config.tamRafaga = 10;
+    memcpy(config.curva, curvaDia, sizeof(curvaDia));
+    config.tramos = CARGA_TRAMOS;
+    config.mezclaCount = 3;
+    config.mezcla[0] = 1;
+    config.mezcla[1] = 1;
+    config.mezcla[2] = 1;
+
+    cargaReiniciar(ahora);
+}
+
+void cargaConfigurar(const ConfigCarga *nueva, uint32_t ahora) {
+    config = *nueva;
+    if (config.tramos > CARGA_TRAMOS) config.tramos = CARGA_TRAMOS;
+    if (config.mezclaCount > CARGA_MAX_MEZCLA) config.mezclaCount = CARGA_MAX_MEZCLA;
+    cargaReiniciar(ahora);
+}
+
+void cargaObtenerConfig(ConfigCarga *out) {
+    *out = config;
+}
+
+void cargaReiniciar(uint32_t ahora) {
+    aleatorioSembrarFlujo(ALEATORIO_CARGA, config.semilla);
+    origen = ahora;
+    pendientesRafaga = 0;
+    memset(&contadores, 0, sizeof(contadores));
+
+    proximaBase = siguienteBase(ahora);
+    if (config.modo == CARGA_RAFAGAS && config.rafagasPorHora > 0) {
+        proximaRafaga = ahora + intervaloExponencial((float)config.rafagasPorHora);
+    }
+}
+
+int cargaPedidoDebido(uint32_t ahora) {
+    if (config.modo == CARGA_APAGADA) return 0;
+
+    if (config.modo == CARGA_RAFAGAS && config.rafagasPorHora > 0 &&
+        pendientesRafaga == 0 && vencido(ahora, proximaRafaga)) {
+        pendientesRafaga = config.tamRafaga;
+        proximoEnRafaga = proximaRafaga;
+        proximaRafaga += intervaloExponencial((float)config.rafagasPorHora);
+    }
+
+    if (pendientesRafaga > 0 && vencido(ahora, proximoEnRafaga)) {
+        pendientesRafaga--;
+        proximoEnRafaga += CARGA_ESPACIADO_RAFAGA_MS;
+        return 1;
+    }
+
+    if (baseActiva() && vencido(ahora, proximaBase)) {
+        proximaBase = siguienteBase(proximaBase);
+        return 1;
+    }
+
+    return 0;
+}
+
+uint32_t cargaMsHastaProximo(uint32_t ahora) {
+    uint32_t espera = CARGA_SIN_LLEGADA;
+
+    if (config.modo == CARGA_APAGADA) return espera;
+
+    if (baseActiva()) {
+        espera = vencido(ahora, proximaBase) ? 0 : proximaBase - ahora;
+    }
+    if (pendientesRafaga > 0) {
+        uint32_t e = vencido(ahora, proximoEnRafaga) ? 0 : proximoEnRafaga - ahora;
+        if (e < espera) espera = e;
+    } else if (config.modo == CARGA_RAFAGAS && config.rafagasPorHora > 0) {
+        uint32_t e = vencido(ahora, proximaRafaga) ? 0 : proximaRafaga - ahora;
+        if (e < espera) espera = e;
+    }
+    return espera;
+}
+
+void cargaElegirDestino(int numRestaurantes, int numCasas, int *restaurante, int *casa) {
+    *restaurante = elegirZipf(numRestaurantes, config.zipfRestaurante);
+    *casa = (int)aleatorioRango(ALEATORIO_CARGA, (uint32_t)numCasas);
+}
+
+int cargaElegirPlatillos(int numPlatillos, int *platillos, int max) {
+    uint32_t total = 0;
+    int cantidad = 1;
+
+    for (int i = 0; i < config.mezclaCount; i++) {
+        total += config.mezcla[i];
+    }
+    if (total > 0) {
+        uint32_t objetivo = aleatorioRango(ALEATORIO_CARGA, total);
+        for (int i = 0; i < config.mezclaCount; i++) {
+            if (objetivo < config.mezcla[i]) {
+                cantidad = i + 1;
+                break;
+            }
+            objetivo -= config.mezcla[i];
+        }
+    }
+    if (cantidad > max) cantidad = max;
+
+    for (int i = 0; i < cantidad; i++) {
+        platillos[i] = elegirZipf(numPlatillos, config.zipfPlatillo);
+    }
+    return cantidad;
+}
+
+void cargaContar(int aceptado) {
+    if (aceptado) {
+        contadores.generados++;
+    } else {
+        contadores.alTope++;
+    }
+}
+
+void cargaObtenerContadores(ContadoresCarga *out) {
+    *out = contadores;
+}
+
+const char *cargaNombreModo(ModoCarga modo) {
+    if ((unsigned)modo >= sizeof(nombresModo) / sizeof(nombresModo[0])) return "?";
+    return nombresModo[modo];
+}
@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @file    cerrojo.c
+  * @brief   Mutex, semáforos y colas instrumentados (ver cerrojo.h).
+  *
+  *          Los contadores de un mutex los tocan también las tareas que no
+  *          lo tienen (contenciones, timeouts), así que cada actualización
+  *          va en una sección crítica corta.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "cerrojo.h"
+#include "histograma.h"
+#include "task.h"
+#include <string.h>
+
+#ifdef HOST_SIM
+#include <time.h>
+#else
+#include "main.h"
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    QueueHandle_t h;
+    const char *grupo;
+    int8_t indice;
+    uint8_t tipo;
+    uint32_t tomas;
+    uint32_t contenciones;
+    uint32_t timeouts;
+    uint32_t esperaMax;
+    uint32_t tenenciaMax;
+    uint64_t tenenciaSuma;
+    uint32_t inicioTenencia;
+    uint32_t esperas[CERROJO_CUBETAS];
+} Cerrojo;
+
+/* Variables -----------------------------------------------------------------*/
+static Cerrojo cerrojos[CERROJOS_MAX];
+static int numCerrojos = 0;
+
+/* Reloj ---------------------------------------------------------------------*/
+
+// El DWT lo habilita perfilIniciarContador al arrancar el scheduler
+#ifdef HOST_SIM
+static uint32_t leerReloj(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+static inline uint32_t microsegundos(uint32_t cuentas) {
+    return cuentas;
+}
+#else
+static inline uint32_t leerReloj(void) {
+    return DWT->CYCCNT;
+}
+
+static inline uint32_t microsegundos(uint32_t cuentas) {
+    return cuentas / (SystemCoreClock / 1000000u);
+}
+#endif
+
+/* Helper Functions ----------------------------------------------------------*/
+
+// Cerrojo registrado de un handle (número de cola = índice + 1)
+static inline Cerrojo *buscar(QueueHandle_t h) {
+    UBaseType_t n = uxQueueGetQueueNumber(h);
+    return (n > 0 && n <= (UBaseType_t)numCerrojos) ? &cerrojos[n - 1] : NULL;
+}
+
+static inline uint32_t cubetaEspera(uint32_t us) {
+    uint32_t k = us ? 31u - (uint32_t)__builtin_clz(us) : 0;
+    return (k < CERROJO_CUBETAS) ? k : CERROJO_CUBETAS - 1;
+}
+
+// Una operación que salió bien en el acto
+static void contarInmediata(Cerrojo *c) {
+    taskENTER_CRITICAL();
+    c->tomas++;
+    if (c->tipo == CERROJO_MUTEX) c->inicioTenencia = leerReloj();
+    taskEXIT_CRITICAL();
+}
+
+// Una operación que tuvo que esperar (o rendirse sin esperar)
+static void contarContencion(Cerrojo *c, BaseType_t ok, uint32_t esperaUs) {
+    taskENTER_CRITICAL();
+    c->contenciones++;
+    if (ok == pdTRUE) {
+        c->tomas++;
+        if (c->tipo == CERROJO_MUTEX) c->inicioTenencia = leerReloj();
+    } else {
+        c->timeouts++;
+    }
+    c->esperas[cubetaEspera(esperaUs)]++;
+    if (esperaUs > c->esperaMax) c->esperaMax = esperaUs;
+    taskEXIT_CRITICAL();
+}
+
+// Límite superior de la cubeta del percentil, acotado por el máximo
+static uint32_t percentilEspera(const Cerrojo *c, uint32_t milesimas) {
+    int k = histogramaCubetaPercentil(c->esperas, CERROJO_CUBETAS, c->contenciones, milesimas);
+    if (k < 0) return 0;
+
+    uint32_t v = (2u << k) - 1;
+    return (v < c->esperaMax) ? v : c->esperaMax;
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+// Registra un objeto ya creado; indice < 0 si es único en su grupo.
+// Los del mismo grupo van seguidos. 0 si no queda lugar.
+int cerrojoRegistrar(QueueHandle_t h, const char *grupo, int indice, TipoCerrojo tipo) {
+    if (h == NULL || numCerrojos >= CERROJOS_MAX) return 0;
+
+    Cerrojo *c = &cerrojos[numCerrojos];
+    memset(c, 0, sizeof(*c));
+    c->h = h;
+    c->grupo = grupo;
+    c->indice = (int8_t)indice;
+    c->tipo = (uint8_t)tipo;
+
+    numCerrojos++;
+    vQueueSetQueueNumber(h, (UBaseType_t)numCerrojos);
+    return 1;
+}
+
+// xSemaphoreTake contando contención, espera y timeout
+BaseType_t cerrojoTomar(SemaphoreHandle_t h, TickType_t espera) {
+    Cerrojo *c = buscar(h);
+
+    if (xSemaphoreTake(h, 0) == pdTRUE) {
+        if (c) contarInmediata(c);
+        return pdTRUE;
+    }
+    if (c == NULL) return (espera > 0) ? xSemaphoreTake(h, espera) : pdFALSE;
+
+    uint32_t t0 = leerReloj();
+    BaseType_t ok = (espera > 0) ? xSemaphoreTake(h, espera) : pdFALSE;
+
+    contarContencion(c, ok, microsegundos(leerReloj() - t0));
+    return ok;
+}
+
+// xSemaphoreGive; en un mutex cierra la tenencia
+BaseType_t cerrojoLiberar(SemaphoreHandle_t h) {
+    Cerrojo *c = buscar(h);
+
+    if (c && c->tipo == CERROJO_MUTEX) {
+        uint32_t tenencia = microsegundos(leerReloj() - c->inicioTenencia);
+
+        taskENTER_CRITICAL();
+        c->tenenciaSuma += tenencia;
+        if (tenencia > c->tenenciaMax) c->tenenciaMax = tenencia;
+        taskEXIT_CRITICAL();
+    }
+    return xSemaphoreGive(h);
+}
+
+// xQueueSend contando colas llenas; sin espera, llena = elemento perdido
+BaseType_t colaEnviar(QueueHandle_t q, const void *elemento, TickType_t espera) {
+    Cerrojo *c = buscar(q);
+
+    if (xQueueSend(q, elemento, 0) == pdPASS) {
+        if (c) contarInmediata(c);
+        return pdPASS;
+    }
+    if (c == NULL) return (espera > 0) ? xQueueSend(q, elemento, espera) : errQUEUE_FULL;
+
+    uint32_t t0 = leerReloj();
+    BaseType_t ok = (espera > 0) ? xQueueSend(q, elemento, espera) : errQUEUE_FULL;
+
+    contarContencion(c, ok, microsegundos(leerReloj() - t0));
+    return ok;
+}
+
+// xQueueReceive; sin espera, una cola vacía no cuenta (es un sondeo)
+BaseType_t colaRecibir(QueueHandle_t q, void *elemento, TickType_t espera) {
+    Cerrojo *c = buscar(q);
+
+    if (xQueueReceive(q, elemento, 0) == pdPASS) {
+        if (c) contarInmediata(c);
+        return pdPASS;
+    }
+    if (espera == 0) return errQUEUE_EMPTY;
+    if (c == NULL) return xQueueReceive(q, elemento, espera);
+
+    uint32_t t0 = leerReloj();
+    BaseType_t ok = xQueueReceive(q, elemento, espera);
+
+    contarContencion(c, ok, microsegundos(leerReloj() - t0));
+    return ok;
+}
+
+int cerrojosCantidad(void) {
+    return numCerrojos;
+}
+
+// Copia consistente de los contadores de un cerrojo; 0 si no existe
+int cerrojoResumir(int i, ResumenCerrojo *r) {
+    Cerrojo copia;
+
+    if (i < 0 || i >= numCerrojos) return 0;
+
+    taskENTER_CRITICAL();
+    copia = cerrojos[i];
+    taskEXIT_CRITICAL();
+
+    memset(r, 0, sizeof(*r));
+    r->grupo = copia.grupo;
+    r->indice = copia.indice;
+    r->tipo = (TipoCerrojo)copia.tipo;
+    r->tomas = copia.tomas;
+    r->contenciones = copia.contenciones;
+    r->timeouts = copia.timeouts;
+    r->esperaP50 = percentilEspera(&copia, 500);
+    r->esperaP99 = percentilEspera(&copia, 990);
+    r->esperaMax = copia.esperaMax;
+    r->tenenciaMax = copia.tenenciaMax;
+    if (copia.tomas > 0) r->tenenciaPromedio = (uint32_t)(copia.tenenciaSuma / copia.tomas);
+    return 1;
+}
+
+// Pone a cero los contadores sin olvidar los registros
+void cerrojosReiniciar(void) {
+    for (int i = 0; i < numCerrojos; i++) {
+        Cerrojo *c = &cerrojos[i];
+
+        taskENTER_CRITICAL();
+        c->tomas = 0;
+        c->contenciones = 0;
+        c->timeouts = 0;
+        c->esperaMax = 0;
+        c->tenenciaMax = 0;
+        c->tenenciaSuma = 0;
+        memset(c->esperas, 0, sizeof(c->esperas));
+        taskEXIT_CRITICAL();
+    }
+}
@@ -0,0 +1,210 @@
+/**
+  ******************************************************************************
+  * @file    comandos.c
+  * @brief   Registro y despacho de comandos de texto (ver comandos.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "comandos.h"
+#include <string.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define MASCARA_INDICE  (CMD_TAM_INDICE - 1)
+
+#if (CMD_TAM_INDICE & MASCARA_INDICE) != 0
+#error "CMD_TAM_INDICE debe ser potencia de 2"
+#endif
+
+/* Variables -----------------------------------------------------------------*/
+static const Comando *tablaComandos = NULL;
+static int numComandos = 0;
+
+// Direccionamiento abierto: posición = hash del nombre, NULL = libre
+static const Comando *indice[CMD_TAM_INDICE];
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline int esBlanco(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// FNV-1a de 32 bits
+static uint32_t hashNombre(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Registro ------------------------------------------------------------------*/
+
+// Indexa la tabla; 0 si hay nombres repetidos o no caben en el índice
+int comandosRegistrar(const Comando *tabla, int n) {
+    if (n >= CMD_TAM_INDICE) return 0;
+
+    memset(indice, 0, sizeof(indice));
+
+    for (int i = 0; i < n; i++) {
+        uint32_t pos = hashNombre(tabla[i].nombre) & MASCARA_INDICE;
+
+        while (indice[pos] != NULL) {
+            if (strcmp(indice[pos]->nombre, tabla[i].nombre) == 0) return 0;
+            pos = (pos + 1) & MASCARA_INDICE;
+        }
+        indice[pos] = &tabla[i];
+    }
+
+    tablaComandos = tabla;
+    numComandos = n;
+    return 1;
+}
+
+const Comando *comandosBuscar(const char *nombre) {
+    uint32_t pos = hashNombre(nombre) & MASCARA_INDICE;
+
+    while (indice[pos] != NULL) {
+        if (strcmp(indice[pos]->nombre, nombre) == 0) return indice[pos];
+        pos = (pos + 1) & MASCARA_INDICE;
+    }
+    return NULL;
+}
+
+// Lista "NOMBRE NOMBRE ..." para HELP; devuelve la longitud escrita o -1
+// si algún nombre no entró (lo escrito queda terminado igual)
+int comandosListar(char *buf, int cap) {
+    int len = 0;
+
+    if (cap <= 0) return -1;
+
+    for (int i = 0; i < numComandos; i++) {
+        int n = (int)strlen(tablaComandos[i].nombre);
+        if (len + n + 2 > cap) {
+            buf[len] = '\0';
+            return -1;
+        }
+        if (len > 0) buf[len++] = ' ';
+        memcpy(&buf[len], tablaComandos[i].nombre, n);
+        len += n;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+/* Tokenizador ---------------------------------------------------------------*/
+
+// Parte la línea en el lugar; devuelve argc o -1 si sobran tokens
+int comandosTokenizar(char *linea, ArgsCmd *args) {
+    char *p = linea;
+
+    args->argc = 0;
+
+    while (esBlanco(*p)) p++;
+
+    while (*p) {
+        if (args->argc == CMD_MAX_TOKENS) return -1;
+
+        args->argv[args->argc++] = p;
+
+        while (*p && *p != ',' && !esBlanco(*p)) p++;
+
+        // El separador es: blancos, a lo sumo una coma, blancos
+        char *fin = p;
+        while (esBlanco(*p)) p++;
+        if (*p == ',') {
+            p++;
+            while (esBlanco(*p)) p++;
+        }
+        *fin = '\0';
+    }
+
+    return args->argc;
+}
+
+// Tokeniza, busca y ejecuta; en error deja en *cmd el comando (si existe)
+ResultadoCmd comandosDespachar(char *linea, ArgsCmd *args, const Comando **cmd) {
+    const Comando *c = NULL;
+    int argc = comandosTokenizar(linea, args);
+
+    if (cmd) *cmd = NULL;
+
+    if (args->argc == 0) return CMD_VACIO;
+
+    c = comandosBuscar(args->argv[0]);
+    if (cmd) *cmd = c;
+
+    if (c == NULL) return CMD_DESCONOCIDO;
+    if (argc < 0 || argc - 1 > c->maxArgs) return CMD_SOBRAN_ARGS;
+    if (argc - 1 < c->minArgs) return CMD_FALTAN_ARGS;
+
+    c->manejador(args);
+    return CMD_OK;
+}
+
+/* Argumentos ----------------------------------------------------------------*/
+
+// Entero decimal con signo opcional, sin basura al final y dentro de [min, max]
+int cmdArgEntero(const char *tok, int32_t min, int32_t max, int32_t *out) {
+    const char *p = tok;
+    int negativo = 0;
+    int64_t v = 0;
+
+    if (*p == '-' || *p == '+') {
+        negativo = (*p == '-');
+        p++;
+    }
+    if (*p == '\0') return 0;
+
+    while (*p) {
+        if (*p < '0' || *p > '9') return 0;
+        v = v * 10 + (*p - '0');
+        if (v > 0x7FFFFFFFLL + 1) return 0;
+        p++;
+    }
+
+    if (negativo) v = -v;
+    if (v < min || v > max) return 0;
+
+    *out = (int32_t)v;
+    return 1;
+}
+
+// Una de las opciones dadas (coincidencia exacta)
+int cmdArgOpcion(const char *tok, const char *const *opciones, int n, int *out) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(tok, opciones[i]) == 0) {
+            *out = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Texto no vacío de hasta maxLen caracteres
+int cmdArgTexto(const char *tok, int maxLen, const char **out) {
+    int len = (int)strlen(tok);
+
+    if (len == 0 || len > maxLen) return 0;
+
+    *out = tok;
+    return 1;
+}
+
+// Parte un token en el lugar por sep; devuelve las partes o -1 si sobran
+int cmdPartir(char *tok, char sep, char **partes, int max) {
+    int n = 0;
+
+    if (max <= 0) return -1;
+
+    partes[n++] = tok;
+    for (char *p = tok; *p; p++) {
+        if (*p == sep) {
+            if (n == max) return -1;
+            *p = '\0';
+            partes[n++] = p + 1;
+        }
+    }
+    return n;
+}
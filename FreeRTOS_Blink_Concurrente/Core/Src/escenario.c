@@ -0,0 +1,273 @@
+/**
+  ******************************************************************************
+  * @file    escenario.c
+  * @brief   Escenarios fijos: validación de registros y recorrido de la
+  *          traza de pedidos (ver escenario.h).
+  *
+  *          Los registros se acumulan en un escenario en construcción; BEGIN
+  *          lo vacía y END lo da por listo. Un registro inválido no cambia
+  *          nada, así que el emisor puede corregir y reenviar esa línea.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "escenario.h"
+#include "comandos.h"
+#include <string.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define PREP_MAX_CENTIS     60000       // 10 minutos por platillo
+#define UMBRAL_MAX          50
+#define VELOCIDAD_MAX       1000        // x100
+
+/* Variables -----------------------------------------------------------------*/
+static Escenario escenario;
+static EstadoEscenario estado = ESCENARIO_VACIO;
+
+static uint32_t origenTraza;
+static int proximoPedido;
+
+static const char *const nombresEstado[] = {
+    [ESCENARIO_VACIO]    = "empty",
+    [ESCENARIO_CARGANDO] = "loading",
+    [ESCENARIO_LISTO]    = "ready",
+};
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline int vencido(uint32_t ahora, uint32_t instante) {
+    return (int32_t)(ahora - instante) >= 0;
+}
+
+// Dirección de la entrada: una de "validas", en mayúscula o minúscula
+static int parsearDireccion(const char *tok, const char *validas, char *out) {
+    if (tok[0] == '\0' || tok[1] != '\0') return 0;
+
+    for (const char *v = validas; *v; v++) {
+        if ((tok[0] | 0x20) == (*v | 0x20)) {
+            *out = *v;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 1 si la manzana (av, ca) ya tiene restaurante o casa
+static int manzanaOcupada(int av, int ca) {
+    for (int r = 0; r < escenario.numRestaurantes; r++) {
+        if (escenario.restaurantes[r].av == av && escenario.restaurantes[r].ca == ca) return 1;
+    }
+    for (int c = 0; c < escenario.numCasas; c++) {
+        if (escenario.casas[c].av == av && escenario.casas[c].ca == ca) return 1;
+    }
+    return 0;
+}
+
+static int esquinaOcupada(int av, int ca) {
+    for (int d = 0; d < escenario.numRepartidores; d++) {
+        if (escenario.repartidores[d].av == av && escenario.repartidores[d].ca == ca) return 1;
+    }
+    return 0;
+}
+
+/* Registros -----------------------------------------------------------------*/
+
+static const char *procesarInicio(char *const *campos, int n, int *campoMalo) {
+    int32_t tamanio;
+
+    *campoMalo = 1;
+    if (n != 2 || !cmdArgEntero(campos[1], 2, ESCENARIO_MAX_TAMANIO, &tamanio)) return "tamanio";
+
+    memset(&escenario, 0, sizeof(escenario));
+    escenario.tamanio = (uint8_t)tamanio;
+    estado = ESCENARIO_CARGANDO;
+    return NULL;
+}
+
+static const char *procesarRestaurante(char *const *campos, int n, int *campoMalo) {
+    EscenarioRestaurante r;
+    int32_t v;
+
+    memset(&r, 0, sizeof(r));
+    *campoMalo = 0;
+    if (n < 6 || n > 5 + ESCENARIO_MAX_MENU) return "platillos";
+    if (escenario.numRestaurantes >= ESCENARIO_MAX_RESTAURANTES) return "restaurantes";
+
+    *campoMalo = 1;
+    if (!cmdArgEntero(campos[1], 0, escenario.tamanio - 2, &v)) return "avenida";
+    r.av = (uint8_t)v;
+    *campoMalo = 2;
+    if (!cmdArgEntero(campos[2], 0, escenario.tamanio - 2, &v)) return "calle";
+    r.ca = (uint8_t)v;
+    if (manzanaOcupada(r.av, r.ca)) return "posicion";
+    *campoMalo = 3;
+    if (!parsearDireccion(campos[3], "UDLR", &r.direccion)) return "direccion";
+    *campoMalo = 4;
+    if (!cmdArgEntero(campos[4], 1, UMBRAL_MAX, &v)) return "umbral";
+    r.umbral = (uint8_t)v;
+
+    for (int i = 5; i < n; i++) {
+        *campoMalo = i;
+        if (!cmdArgEntero(campos[i], 1, PREP_MAX_CENTIS, &v)) return "prep";
+        r.prep[r.numPlatillos++] = (uint16_t)v;
+    }
+
+    escenario.restaurantes[escenario.numRestaurantes++] = r;
+    return NULL;
+}
+
+static const char *procesarCasa(char *const *campos, int n, int *campoMalo) {
+    EscenarioCasa c;
+    int32_t v;
+
+    *campoMalo = 0;
+    if (n != 4) return "argumentos";
+    if (escenario.numCasas >= ESCENARIO_MAX_CASAS) return "casas";
+
+    *campoMalo = 1;
+    if (!cmdArgEntero(campos[1], 0, escenario.tamanio - 2, &v)) return "avenida";
+    c.av = (uint8_t)v;
+    *campoMalo = 2;
+    if (!cmdArgEntero(campos[2], 0, escenario.tamanio - 2, &v)) return "calle";
+    c.ca = (uint8_t)v;
+    if (manzanaOcupada(c.av, c.ca)) return "posicion";
+    *campoMalo = 3;
+    if (!parsearDireccion(campos[3], "udlr", &c.direccion)) return "direccion";
+
+    escenario.casas[escenario.numCasas++] = c;
+    return NULL;
+}
+
+static const char *procesarRepartidor(char *const *campos, int n, int *campoMalo) {
+    EscenarioRepartidor d;
+    int32_t v;
+
+    *campoMalo = 0;
+    if (n != 4) return "argumentos";
+    if (escenario.numRepartidores >= ESCENARIO_MAX_REPARTIDORES) return "repartidores";
+
+    *campoMalo = 1;
+    if (!cmdArgEntero(campos[1], 0, escenario.tamanio - 1, &v)) return "avenida";
+    d.av = (uint8_t)v;
+    *campoMalo = 2;
+    if (!cmdArgEntero(campos[2], 0, escenario.tamanio - 1, &v)) return "calle";
+    d.ca = (uint8_t)v;
+    if (esquinaOcupada(d.av, d.ca)) return "posicion";
+    *campoMalo = 3;
+    if (!cmdArgEntero(campos[3], 1, VELOCIDAD_MAX, &v)) return "velocidad";
+    d.velocidad = (uint16_t)v;
+
+    escenario.repartidores[escenario.numRepartidores++] = d;
+    return NULL;
+}
+
+static const char *procesarPedido(char *const *campos, int n, int *campoMalo) {
+    EscenarioPedido p;
+    int32_t v;
+
+    memset(&p, 0, sizeof(p));
+    *campoMalo = 0;
+    if (n < 5 || n > 4 + ESCENARIO_MAX_PLATILLOS) return "platillos";
+    if (escenario.numPedidos >= ESCENARIO_MAX_PEDIDOS) return "pedidos";
+
+    *campoMalo = 1;
+    if (!cmdArgEntero(campos[1], 0, 0x7FFFFFFF, &v)) return "ms";
+    p.ms = (uint32_t)v;
+    if (escenario.numPedidos > 0 && p.ms < escenario.pedidos[escenario.numPedidos - 1].ms) return "ms";
+
+    *campoMalo = 2;
+    if (!cmdArgEntero(campos[2], 1, escenario.numRestaurantes, &v)) return "restaurante";
+    p.restaurante = (uint8_t)(v - 1);
+    *campoMalo = 3;
+    if (!cmdArgEntero(campos[3], 1, escenario.numCasas, &v)) return "casa";
+    p.casa = (uint8_t)(v - 1);
+
+    for (int i = 4; i < n; i++) {
+        *campoMalo = i;
+        if (!cmdArgEntero(campos[i], 0, escenario.restaurantes[p.restaurante].numPlatillos - 1, &v)) {
+            return "platillo";
+        }
+        p.platillos[p.numPlatillos++] = (uint8_t)v;
+    }
+
+    escenario.pedidos[escenario.numPedidos++] = p;
+    return NULL;
+}
+
+static const char *procesarFin(int n, int *campoMalo) {
+    *campoMalo = 0;
+    if (n != 1) return "argumentos";
+    if (escenario.numRestaurantes == 0) return "restaurantes";
+    if (escenario.numCasas == 0) return "casas";
+    if (escenario.numRepartidores == 0) return "repartidores";
+
+    estado = ESCENARIO_LISTO;
+    escenarioReiniciarTraza(0);
+    return NULL;
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+void escenarioIniciar(void) {
+    memset(&escenario, 0, sizeof(escenario));
+    estado = ESCENARIO_VACIO;
+    proximoPedido = 0;
+}
+
+const char *escenarioProcesar(char *const *campos, int n, int *campoMalo) {
+    static const char *const registros[] = { "BEGIN", "R", "H", "D", "O", "END" };
+    int registro;
+
+    *campoMalo = 0;
+    if (n < 1 || !cmdArgOpcion(campos[0], registros, 6, &registro)) return "registro";
+
+    if (registro == 0) return procesarInicio(campos, n, campoMalo);
+    if (estado != ESCENARIO_CARGANDO) return "registro";
+
+    switch (registro) {
+        case 1: return procesarRestaurante(campos, n, campoMalo);
+        case 2: return procesarCasa(campos, n, campoMalo);
+        case 3: return procesarRepartidor(campos, n, campoMalo);
+        case 4: return procesarPedido(campos, n, campoMalo);
+        default: return procesarFin(n, campoMalo);
+    }
+}
+
+EstadoEscenario escenarioEstado(void) {
+    return estado;
+}
+
+const char *escenarioNombreEstado(EstadoEscenario e) {
+    if ((unsigned)e >= sizeof(nombresEstado) / sizeof(nombresEstado[0])) return "?";
+    return nombresEstado[e];
+}
+
+const Escenario *escenarioObtener(void) {
+    return &escenario;
+}
+
+void escenarioReiniciarTraza(uint32_t ahora) {
+    origenTraza = ahora;
+    proximoPedido = 0;
+}
+
+const EscenarioPedido *escenarioPedidoDebido(uint32_t ahora) {
+    if (estado != ESCENARIO_LISTO || proximoPedido >= escenario.numPedidos) return NULL;
+
+    const EscenarioPedido *p = &escenario.pedidos[proximoPedido];
+    if (!vencido(ahora, origenTraza + p->ms)) return NULL;
+
+    proximoPedido++;
+    return p;
+}
+
+uint32_t escenarioMsHastaProximo(uint32_t ahora) {
+    if (estado != ESCENARIO_LISTO || proximoPedido >= escenario.numPedidos) return ESCENARIO_SIN_PEDIDO;
+
+    uint32_t instante = origenTraza + escenario.pedidos[proximoPedido].ms;
+    return vencido(ahora, instante) ? 0 : instante - ahora;
+}
+
+int escenarioPedidosReproducidos(void) {
+    return proximoPedido;
+}
@@ -0,0 +1,40 @@
+/**
+  ******************************************************************************
+  * @file    estadistica.c
+  * @brief   Acumulador de Welford (ver estadistica.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "estadistica.h"
+#include <math.h>
+#include <string.h>
+
+/* Functions -----------------------------------------------------------------*/
+
+void welfordReiniciar(Welford *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+// Agrega una muestra: media y m2 se corrigen con la desviación nueva
+void welfordAgregar(Welford *w, uint32_t ms) {
+    double x = (double)ms;
+
+    w->n++;
+    double delta = x - w->media;
+    w->media += delta / (double)w->n;
+    w->m2 += delta * (x - w->media);
+
+    if (w->n == 1 || ms < w->min) w->min = ms;
+    if (ms > w->max) w->max = ms;
+}
+
+// Varianza muestral; 0 con menos de dos muestras
+float welfordVarianza(const Welford *w) {
+    if (w->n < 2) return 0.0f;
+    return (float)(w->m2 / (double)(w->n - 1));
+}
+
+float welfordDesviacion(const Welford *w) {
+    return sqrtf(welfordVarianza(w));
+}
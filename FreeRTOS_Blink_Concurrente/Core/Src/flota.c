@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    flota.c
+  * @brief   Agrupación de movimientos de la flota en un frame por tick
+  *          (ver flota.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "flota.h"
+#include "telemetria.h"
+#include "json_tx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint8_t valido;
+    uint8_t av;
+    uint8_t ca;
+    uint8_t estado;
+} EstadoFlota;
+
+/* Variables -----------------------------------------------------------------*/
+// Último estado registrado y último estado enviado de cada repartidor
+static EstadoFlota actual[FLOTA_MAX_REPARTIDORES];
+static EstadoFlota enviado[FLOTA_MAX_REPARTIDORES];
+
+static uint32_t secuencia = 0;
+static int framesDesdeKeyframe = 0;
+static volatile int keyframePendiente = 1;
+
+/* Functions -----------------------------------------------------------------*/
+
+// Olvida la flota anterior (mapa nuevo) y fuerza un keyframe
+void flotaReiniciar(void) {
+    taskENTER_CRITICAL();
+    memset(actual, 0, sizeof(actual));
+    memset(enviado, 0, sizeof(enviado));
+    keyframePendiente = 1;
+    taskEXIT_CRITICAL();
+}
+
+void flotaForzarKeyframe(void) {
+    keyframePendiente = 1;
+}
+
+// Registra posición y estado; no toca la UART
+void flotaActualizar(int rep, int av, int ca, int estado) {
+    if (rep < 0 || rep >= FLOTA_MAX_REPARTIDORES) return;
+
+    taskENTER_CRITICAL();
+    actual[rep].valido = 1;
+    actual[rep].av = (uint8_t)av;
+    actual[rep].ca = (uint8_t)ca;
+    actual[rep].estado = (uint8_t)estado;
+    taskEXIT_CRITICAL();
+}
+
+// Envía el frame del tick; devuelve cuántos repartidores incluyó
+int flotaEmitirFrame(int numRepartidores) {
+    uint8_t entradas[FLOTA_MAX_REPARTIDORES * 4];
+    int n = 0;
+
+    if (numRepartidores > FLOTA_MAX_REPARTIDORES) numRepartidores = FLOTA_MAX_REPARTIDORES;
+
+    int keyframe = keyframePendiente || ++framesDesdeKeyframe >= FLOTA_PERIODO_KEYFRAME;
+
+    // Copia de los cambios contra el último frame
+    taskENTER_CRITICAL();
+    for (int i = 0; i < numRepartidores; i++) {
+        if (!actual[i].valido) continue;
+
+        if (keyframe || memcmp(&actual[i], &enviado[i], sizeof(EstadoFlota)) != 0) {
+            entradas[n * 4 + 0] = (uint8_t)i;
+            entradas[n * 4 + 1] = actual[i].av;
+            entradas[n * 4 + 2] = actual[i].ca;
+            entradas[n * 4 + 3] = actual[i].estado;
+            enviado[i] = actual[i];
+            n++;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (keyframe) {
+        keyframePendiente = 0;
+        framesDesdeKeyframe = 0;
+    }
+
+    if (n == 0 && !keyframe) return 0;
+
+    secuencia++;
+
+    if (telemetriaBinaria()) {
+        telemetriaFlota(secuencia, keyframe, entradas, n);
+        return n;
+    }
+
+    JsonTx j;
+    jsonIniciar(&j, 64 + FLOTA_MAX_REPARTIDORES * 20);
+    jsonCadena(&j, "type", "fleet");
+    jsonSinSigno(&j, "seq", secuencia);
+    jsonEntero(&j, "key", keyframe);
+    jsonAbrirArreglo(&j, "d");
+    for (int i = 0; i < n; i++) {
+        jsonAbrirArreglo(&j, NULL);
+        for (int k = 0; k < 4; k++) {
+            jsonEntero(&j, NULL, entradas[i * 4 + k]);
+        }
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+    jsonTerminar(&j);
+
+    return n;
+}
@@ -3,6 +3,25 @@
 #include "cmsis_os.h"
 #include "usart.h"
 #include "gpio.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "comandos.h"
+#include "canal_cmd.h"
+#include "telemetria.h"
+#include "flota.h"
+#include "log.h"
+#include "json_tx.h"
+#include "histograma.h"
+#include "estadistica.h"
+#include "ventanas.h"
+#include "perfil.h"
+#include "sonda.h"
+#include "cerrojo.h"
+#include "traza.h"
+#include "reloj.h"
+#include "carga.h"
+#include "escenario.h"
+#include "aleatorio.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
@@ -29,6 +48,33 @@ extern UART_HandleTypeDef huart2;
 #define MAX_PEDIDOS_POR_REPARTIDOR 3
 #define MAX_COLA_RESTAURANTE 10
 
+// Estado extra de "mov" cuando el repartidor pasa al siguiente pedido
+#define MOV_EN_RUTA_SIGUIENTE 5
+
+// Pedidos del generador de carga creados por vuelta de StartTaskTx
+#define CARGA_MAX_POR_CICLO 16
+
+// Buffer de la lista de HELP; comandosListar avisa si la tabla no entra
+#define TAM_LISTA_HELP 256
+
+// Movimiento: a velocidad 1.0 una celda cada MS_POR_CELDA. El avance se
+// acumula cada PERIODO_MOVIMIENTO_MS en punto fijo (16 bits de fracción)
+#define MS_POR_CELDA 500
+#define PERIODO_MOVIMIENTO_MS 100
+#define CELDA_Q16 (1u << 16)
+// Tope de celdas por periodo (velocidad 10.0 da 2)
+#define MAX_PASOS_POR_PERIODO 4
+// Conjunto activo de StartTaskRepartidores: un bit por repartidor
+#define TODOS_LOS_REPARTIDORES ((1u << MAX_REPARTIDORES) - 1u)
+
+#if MAX_REPARTIDORES > 32
+#error "MAX_REPARTIDORES no cabe en el conjunto activo de 32 bits"
+#endif
+
+// Entidades de enviarMetricasEntidades
+#define ENTIDAD_RESTAURANTE (1 << 0)
+#define ENTIDAD_REPARTIDOR  (1 << 1)
+
 /* Event Group Bits ----------------------------------------------------------*/
 #define EVENT_PEDIDO_LISTO (1 << 0)
 
@@ -59,6 +105,13 @@ typedef enum {
     ENTREGANDO
 } EstadoRepartidor;
 
+// Lo que un repartidor le pide a la tarea de movimiento
+typedef enum {
+    ACTIVIDAD_NINGUNA,      // quieto: sale del conjunto activo
+    ACTIVIDAD_MOVIMIENTO,   // en ruta o paseando: un paso por periodo
+    ACTIVIDAD_PLAZO         // recogiendo o entregando hasta tiempoEspera
+} ActividadRepartidor;
+
 /* Structures ----------------------------------------------------------------*/
 typedef struct {
     int posx;
@@ -147,6 +200,11 @@ typedef struct {
     int pedidosAceptadosPorRR;
     int pedidosRechazadosPorDesvio;
     int pedidosEntregados;
+    uint32_t celdasRecorridas;          // pasos en ruta y de paseo
+
+    // Movimiento en punto fijo: celdas por periodo y fracción acumulada
+    uint32_t avanceQ16;
+    uint32_t progresoQ16;
 
     EstadoRepartidor estado;
     int fase;
@@ -156,23 +214,31 @@ typedef struct {
 
 } Repartidor;
 
-typedef struct {
-    float promedioTotal;
-    float promedioPreparacion;
-    float promedioEspera;
-    float promedioEntrega;
-
-    float percentil50Total;
-    float percentil95Total;
-
-    float percentil50Prep;
-    float percentil95Prep;
+// Etapas de un pedido con histograma de latencia propio
+typedef enum {
+    ETAPA_COLA = 0,         // creado -> inicio de preparación
+    ETAPA_PREPARACION,      // preparación en cocina
+    ETAPA_ESPERA,           // listo -> recogido por el repartidor
+    ETAPA_ENTREGA,          // recogido -> entregado
+    ETAPA_TOTAL,            // creado -> entregado
+    NUM_ETAPAS
+} EtapaPedido;
 
+typedef struct {
+    ResumenHistograma etapas[NUM_ETAPAS];
     int pedidosAnalizados;
 } MetricasGlobales;
 
 MetricasGlobales metricas;
 
+// Un pedido entra una sola vez, al entregarse (solo escribe TaskRepartidores)
+static Histograma histogramasEtapa[NUM_ETAPAS];
+
+// Media y varianza por etapa: global, por restaurante y por repartidor
+static Welford welfordEtapa[NUM_ETAPAS];
+static Welford welfordRestaurante[MAX_RESTAURANTES][NUM_ETAPAS];
+static Welford welfordRepartidor[MAX_REPARTIDORES][NUM_ETAPAS];
+
 typedef struct {
     int calles;
     int avenidas;
@@ -199,11 +265,9 @@ typedef struct {
 } NodoA;
 
 /* Variables -----------------------------------------------------------------*/
-QueueHandle_t queueRx;
 QueueHandle_t queuePedidos;
 QueueHandle_t queueButton;
 QueueHandle_t queuePedidosListos;
-uint8_t rxByte;
 
 SistemaRepartidores sistema;
 int sistemaInicializado = 0;
@@ -217,6 +281,24 @@ SemaphoreHandle_t mutexRestaurantes[MAX_RESTAURANTES];
 
 int indiceMotoristaRR = 0;
 
+// Mapa construido desde el escenario cargado (su traza se reproduce) e
+// instante del último arranque, base de los "ms" de la traza y del export
+static int mundoEscenario = 0;
+static uint32_t inicioCorrida = 0;
+
+// Periodo de task_stats en ms (0 = solo con PROFILE)
+static volatile uint32_t periodoPerfil = 10000;
+
+// Tarea de movimiento, para avisarle de trabajo nuevo, y paseo al azar de
+// los repartidores libres (comando ROAM)
+static TaskHandle_t tareaRepartidores = NULL;
+static volatile int paseoLibre = 1;
+
+#ifdef HOST_SIM
+// Herramientas del host (regresion_host.c) que siguen los eventos de pedido
+void (*observadorEventoPedido)(const char *evento, const char *numeroRecibo, const char *driver) = NULL;
+#endif
+
 /* Task handles --------------------------------------------------------------*/
 osThreadId_t TaskTxHandle;
 osThreadId_t TaskRxHandle;
@@ -231,15 +313,27 @@ void StartTaskRestaurantes(void *argument);
 void StartTaskRepartidores(void *argument);
 void StartTaskAsignador(void *argument);
 void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep);
+void inicializarDesdeEscenario(const Escenario *e);
 void calcularMetricasGlobales(void);
+void reiniciarMetricas(void);
+void enviarMetricasEntidades(int tipos);
+void enviarSondas(void);
+void enviarCerrojos(void);
+void enviarReloj(void);
+void enviarCarga(void);
+void enviarEscenario(void);
+void exportarEscenario(void);
+void enviarSemilla(void);
 void enviarMetricasGlobales(void);
 void crearMapaUnificado(void);
 void actualizarPosicionesAlMapaUnificado(void);
 void enviarMapaCompleto(void);
 void enviarMapaCombinado(void);
-void enviarEventoPedido(const char *evento, const char *numeroRecibo, const char *driver, const char *prepTime, int restaurantId, int destinationId);
-void moverRepartidor(int idRep);
+void enviarEventoPedido(const char *evento, const char *numeroRecibo, const char *driver, int prepCentis, int restaurantId, int destinationId);
+int moverRepartidor(int idRep);
 int calcularDistancia(Posicion a, Posicion b);
+uint32_t calcularEtaMs(int idRep, int celdas);
+void despertarRepartidores(uint32_t mascara);
 void asignarPedidoARepartidor(int pedidoId);
 void crearRuta(int repId, Posicion origen, Posicion destino);
 void regenerarMapa(void);
@@ -256,6 +350,12 @@ int calcularDesvioRuta(int idRep, Pedido* nuevoPedido);
 float calcularScoreCompleto(int idRep, Pedido* pedido, int desvio);
 int verificarConfirmacion(float score, int desvio, int idRep);
 void enviarEstadisticas(void);
+void enviarEstadisticasTx(void);
+void enviarEstadisticasRx(void);
+void notificarEstadoRestaurante(int idRest);
+int indiceRepartidorPorNombre(const char *nombre);
+int registrarPedidoWeb(int restId, int casaId, const int *platillos, int platillosCount);
+void registrarComandosRx(void);
 
 /* Helper Functions ----------------------------------------------------------*/
 
@@ -281,6 +381,11 @@ void floatToStr(float val, char *str, int maxLen) {
     snprintf(str, maxLen, "%d.%02d", intPart, fracPart);
 }
 
+// Marca en la traza el estado actual de un pedido
+static inline void trazarPedido(const Pedido *p) {
+    trazaRegistrar(TRAZA_PEDIDO, (uint8_t)p->estado, (uint16_t)(p - sistema.listaPedidos));
+}
+
 // Distancia Manhattan entre dos posiciones
 int calcularDistancia(Posicion a, Posicion b) {
     return abs(a.posx - b.posx) + abs(a.posy - b.posy);
@@ -288,8 +393,7 @@ int calcularDistancia(Posicion a, Posicion b) {
 
 // Envía datos por UART
 void enviarPorUART(const char *data) {
-    uint16_t len = strlen(data);
-    HAL_UART_Transmit(&huart2, (uint8_t*)data, len, 200);
+    uartTxEnviar(data, strlen(data));
 }
 
 // Busca pedido por número de recibo
@@ -302,6 +406,19 @@ Pedido* buscarPedido(const char* numeroRecibo) {
     return NULL;
 }
 
+// Índice del repartidor a partir de su nombre; -1 si no existe
+int indiceRepartidorPorNombre(const char *nombre) {
+    if (nombre == NULL) return -1;
+
+    for (int i = 0; i < sistema.numRepartidores; i++) {
+        if (nombre == sistema.listaRepartidores[i].nombre ||
+            strcmp(sistema.listaRepartidores[i].nombre, nombre) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 // Obtiene punto de acceso del restaurante
 Posicion getPuntoAccesoRestaurante(int idRest) {
     Posicion punto = sistema.listaRestaurantes[idRest].posxyUnificado;
@@ -378,13 +495,24 @@ int calcularDesvioRuta(int idRep, Pedido* nuevoPedido) {
     return distanciaConDesvio - distanciaOriginal;
 }
 
+// Milisegundos que tarda el repartidor en recorrer "celdas" a su velocidad
+uint32_t calcularEtaMs(int idRep, int celdas) {
+    float velocidad = sistema.listaRepartidores[idRep].velocidad;
+
+    if (celdas <= 0) return 0;
+    if (velocidad <= 0.0f) velocidad = 1.0f;
+    return (uint32_t)((float)celdas * MS_POR_CELDA / velocidad + 0.5f);
+}
+
 // Calcula score de prioridad para asignación
 float calcularScoreCompleto(int idRep, Pedido* pedido, int desvio) {
     Repartidor* rep = &sistema.listaRepartidores[idRep];
 
+    // Un punto por cada MS_POR_CELDA de viaje hasta el restaurante: a
+    // igual distancia gana el más rápido
     Posicion puntoRecogida = getPuntoAccesoRestaurante(pedido->idRestaurante);
     int dist = calcularDistancia(rep->posxyUnificado, puntoRecogida);
-    float score = 100.0f - (float)dist;
+    float score = 100.0f - (float)calcularEtaMs(idRep, dist) / MS_POR_CELDA;
 
     score -= (float)rep->numPedidosAceptados * 10.0f;
 
@@ -415,7 +543,7 @@ float calcularScoreCompleto(int idRep, Pedido* pedido, int desvio) {
 int verificarConfirmacion(float score, int desvio, int idRep) {
     Repartidor* rep = &sistema.listaRepartidores[idRep];
 
-    int random = rand() % 100;
+    int random = aleatorioRango(ALEATORIO_CONFIRMACION, 100);
 
     if (desvio > rep->desvioMaximoPermitido) {
         return (random < 5);
@@ -445,6 +573,8 @@ int heuristica(Posicion a, Posicion b) {
 
 // Calcula siguiente paso con A*
 Posicion calcularSiguientePasoAStar(Posicion inicio, Posicion destino) {
+    SONDA_AMBITO(ASTAR);
+
     if (inicio.posx == destino.posx && inicio.posy == destino.posy) {
         return inicio;
     }
@@ -600,7 +730,7 @@ void limpiarSistemaCompleto(void) {
     printf("{\"type\":\"info\",\"msg\":\"LIMPIANDO SISTEMA COMPLETO...\"}\r\n");
 
     sistema.sistemaCorriendo = 0;
-    vTaskDelay(pdMS_TO_TICKS(200));
+    relojEsperar(200);
 
     for (int i = 0; i < sistema.numPedidos; i++) {
         memset(&sistema.listaPedidos[i], 0, sizeof(Pedido));
@@ -609,17 +739,17 @@ void limpiarSistemaCompleto(void) {
     contadorPedidos = 1;
 
     for (int r = 0; r < sistema.numRestaurantes; r++) {
-        if (xSemaphoreTake(mutexRestaurantes[r], pdMS_TO_TICKS(200)) == pdTRUE) {
+        if (cerrojoTomar(mutexRestaurantes[r], pdMS_TO_TICKS(200)) == pdTRUE) {
             sistema.listaRestaurantes[r].colaPedidosCount = 0;
             for (int j = 0; j < MAX_COLA_RESTAURANTE; j++) {
                 sistema.listaRestaurantes[r].colaPedidos[j] = 0;
             }
-            xSemaphoreGive(mutexRestaurantes[r]);
+            cerrojoLiberar(mutexRestaurantes[r]);
         }
     }
 
     for (int i = 0; i < sistema.numRepartidores; i++) {
-        if (xSemaphoreTake(mutexRepartidores[i], pdMS_TO_TICKS(200)) == pdTRUE) {
+        if (cerrojoTomar(mutexRepartidores[i], pdMS_TO_TICKS(200)) == pdTRUE) {
             Repartidor* rep = &sistema.listaRepartidores[i];
 
             rep->numPedidosAceptados = 0;
@@ -641,25 +771,37 @@ void limpiarSistemaCompleto(void) {
             rep->pedidosRechazadosPorDesvio = 0;
             rep->pedidosEntregados = 0;
 
-            xSemaphoreGive(mutexRepartidores[i]);
+            cerrojoLiberar(mutexRepartidores[i]);
         }
     }
 
     xQueueReset(queuePedidos);
     xQueueReset(queuePedidosListos);
 
+    // Reinicio del cupo: no pasa por los contadores de cerrojo
     while (xSemaphoreTake(semCapacidadCola, 0) == pdTRUE) {}
     for (int i = 0; i < MAX_COLA_RESTAURANTE; i++) {
         xSemaphoreGive(semCapacidadCola);
     }
 
     xEventGroupClearBits(eventGroupPedidos, 0xFFFFFF);
-    memset(&metricas, 0, sizeof(MetricasGlobales));
+    reiniciarMetricas();
     indiceMotoristaRR = 0;
 
     printf("{\"type\":\"info\",\"msg\":\"Sistema completamente limpio\"}\r\n");
 }
 
+// Al arrancar, los flujos de la corrida vuelven al inicio de su secuencia:
+// con la misma semilla y el mismo mapa se repiten las decisiones. El mapa
+// sigue su flujo, así cada REGEN da otra ciudad
+static void reiniciarFlujosCorrida(void) {
+    taskENTER_CRITICAL();
+    aleatorioReiniciarFlujo(ALEATORIO_CONFIRMACION);
+    aleatorioReiniciarFlujo(ALEATORIO_PEDIDOS);
+    aleatorioReiniciarFlujo(ALEATORIO_PASEO);
+    taskEXIT_CRITICAL();
+}
+
 // Regenera el mapa con nuevos restaurantes, casas y repartidores
 void regenerarMapa(void) {
     printf("{\"type\":\"info\",\"msg\":\"GENERANDO MAPA...\"}\r\n");
@@ -667,7 +809,7 @@ void regenerarMapa(void) {
     limpiarSistemaCompleto();
 
     printf("{\"type\":\"event\",\"ev\":\"SYSTEM_RESET\",\"order\":\"RESET\"}\r\n");
-    vTaskDelay(pdMS_TO_TICKS(300));
+    relojEsperar(300);
 
     // Limpiar grillas
     for (int i = 0; i < MAX_GRID_SIZE; i++) {
@@ -686,49 +828,58 @@ void regenerarMapa(void) {
     sistema.numCasas = 0;
     sistema.numRepartidores = 0;
 
-    // Generar cantidades aleatorias
-    int numMotoristas = 3 + (rand() % 4);
-    int numCasas = 10 + (rand() % 11);
-    int numRestaurantes = 5 + (rand() % 4);
+    // Con un escenario cargado el mapa es fijo; si no, aleatorio
+    mundoEscenario = (escenarioEstado() == ESCENARIO_LISTO);
+    if (mundoEscenario) {
+        inicializarDesdeEscenario(escenarioObtener());
+    } else {
+        int numMotoristas = 3 + aleatorioRango(ALEATORIO_MAPA, 4);
+        int numCasas = 10 + aleatorioRango(ALEATORIO_MAPA, 11);
+        int numRestaurantes = 5 + aleatorioRango(ALEATORIO_MAPA, 4);
 
-    printf("{\"type\":\"info\",\"msg\":\"Generando: %d motoristas, %d casas, %d restaurantes\"}\r\n",
-           numMotoristas, numCasas, numRestaurantes);
+        printf("{\"type\":\"info\",\"msg\":\"Generando: %d motoristas, %d casas, %d restaurantes\"}\r\n",
+               numMotoristas, numCasas, numRestaurantes);
 
-    inicializarSistema(8, 8, numRestaurantes, numCasas, numMotoristas);
+        inicializarSistema(8, 8, numRestaurantes, numCasas, numMotoristas);
+    }
 
     printf("{\"type\":\"regenerate\",\"msg\":\"Recargando interfaz web...\"}\r\n");
 
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    relojEsperar(1000);
 
     printf("{\"type\":\"system_reset\",\"msg\":\"Limpiando interfaz web\"}\r\n");
-    vTaskDelay(pdMS_TO_TICKS(300));
+    relojEsperar(300);
 
     enviarMapaCompleto();
     enviarMapaCombinado();
 
-    vTaskDelay(pdMS_TO_TICKS(500));
+    relojEsperar(500);
+    reiniciarFlujosCorrida();
     sistema.sistemaCorriendo = 1;
+    despertarRepartidores(TODOS_LOS_REPARTIDORES);
 
     printf("{\"type\":\"info\",\"msg\":\"Mapa generado. Sistema iniciado\"}\r\n");
 
     // LED de confirmación
     for (int i = 0; i < 3; i++) {
         HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET);
-        HAL_Delay(100);
+        relojEsperar(100);
         HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-        HAL_Delay(100);
+        relojEsperar(100);
     }
     HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET);
 }
 
-// Inicializa el sistema completo
-void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep) {
+// Vacía el sistema y las grillas para un mapa nuevo
+static void prepararMapaVacio(int calles, int avenidas, int rep) {
     sistema.calles = calles;
     sistema.avenidas = avenidas;
     sistema.numRestaurantes = 0;
     sistema.numCasas = 0;
     sistema.numRepartidores = rep;
     sistema.sistemaCorriendo = 0;
+
+    flotaReiniciar();
     sistema.numPedidos = 0;
 
     for (int i = 0; i < (avenidas - 1); i++) {
@@ -742,16 +893,49 @@ void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep)
             sistema.grillaMapa[i][j] = 'o';
         }
     }
+}
+
+// Deja un repartidor desocupado y sin historial (la posición va aparte)
+static void prepararRepartidor(int n, float velocidad) {
+    Repartidor *rep = &sistema.listaRepartidores[n];
+
+    snprintf(rep->nombre, 32, "repartidor %d", n + 1);
+
+    rep->velocidad = velocidad;
+    rep->avanceQ16 = (uint32_t)(velocidad * (float)CELDA_Q16 * PERIODO_MOVIMIENTO_MS / MS_POR_CELDA + 0.5f);
+    rep->progresoQ16 = 0;
+    rep->activo = 1;
+    rep->enRuta = 0;
+    rep->estado = DESOCUPADO;
+    rep->fase = 0;
+
+    rep->numPedidosAceptados = 0;
+    rep->capacidadMaxima = MAX_PEDIDOS_POR_REPARTIDOR;
+    rep->indicePedidoActual = 0;
+    rep->desvioMaximoPermitido = 5;
+    rep->factorDesvio = 1.5f;
+    rep->pedidosAceptadosPorRR = 0;
+    rep->pedidosRechazadosPorDesvio = 0;
+    rep->pedidosEntregados = 0;
+    rep->celdasRecorridas = 0;
+    rep->bloqueado = 0;
+    rep->tiempoEspera = 0;
+    strcpy(rep->tipoDestino, "");
+}
+
+// Inicializa el sistema completo
+void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep) {
+    prepararMapaVacio(calles, avenidas, rep);
 
     // Colocar restaurantes
     int restantesRest = rest;
     int numRestaurante = 0;
     while (restantesRest > 0 && sistema.numRestaurantes < MAX_RESTAURANTES) {
-        int i = rand() % (avenidas - 1);
-        int j = rand() % (calles - 1);
+        int i = aleatorioRango(ALEATORIO_MAPA, avenidas - 1);
+        int j = aleatorioRango(ALEATORIO_MAPA, calles - 1);
 
         if (sistema.grilla[i][j] == '0') {
-            int dir = rand() % 4;
+            int dir = aleatorioRango(ALEATORIO_MAPA, 4);
             char direccion;
             switch (dir) {
                 case 0: direccion = 'U'; break;
@@ -772,17 +956,17 @@ void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep)
                     "Restaurante no. %d", numRestaurante);
 
             // Generar menú
-            int cantidadPlatillos = 3 + (rand() % 4);
+            int cantidadPlatillos = 3 + aleatorioRango(ALEATORIO_MAPA, 4);
             sistema.listaRestaurantes[sistema.numRestaurantes].numPlatillos = cantidadPlatillos;
 
             for (int p = 0; p < cantidadPlatillos && p < MAX_MENU; p++) {
                 snprintf(sistema.listaRestaurantes[sistema.numRestaurantes].menu[p].nombre, 32,
                         "Platillo %d", p + 1);
                 sistema.listaRestaurantes[sistema.numRestaurantes].menu[p].tiempoPreparacion =
-                    20.0f + ((float)(rand() % 1000)) / 100.0f;
+                    20.0f + (float)aleatorioRango(ALEATORIO_MAPA, 1000) / 100.0f;
             }
 
-            sistema.listaRestaurantes[sistema.numRestaurantes].cantidadDeCambio = 5 + (rand() % 5);
+            sistema.listaRestaurantes[sistema.numRestaurantes].cantidadDeCambio = 5 + aleatorioRango(ALEATORIO_MAPA, 5);
             sistema.listaRestaurantes[sistema.numRestaurantes].algoritmo = FCFS;
             sistema.listaRestaurantes[sistema.numRestaurantes].colaPedidosCount = 0;
 
@@ -796,11 +980,11 @@ void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep)
     int restantesCasas = casas;
     int numCasa = 0;
     while (restantesCasas > 0 && sistema.numCasas < MAX_CASAS) {
-        int i = rand() % (avenidas - 1);
-        int j = rand() % (calles - 1);
+        int i = aleatorioRango(ALEATORIO_MAPA, avenidas - 1);
+        int j = aleatorioRango(ALEATORIO_MAPA, calles - 1);
 
         if (sistema.grilla[i][j] == '0') {
-            int dir = rand() % 4;
+            int dir = aleatorioRango(ALEATORIO_MAPA, 4);
             char direccion;
             switch (dir) {
                 case 0: direccion = 'u'; break;
@@ -828,32 +1012,14 @@ void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep)
 
     // Colocar motoristas
     for (int n = 0; n < rep && n < MAX_REPARTIDORES; n++) {
-        snprintf(sistema.listaRepartidores[n].nombre, 32, "repartidor %d", n + 1);
-
-        sistema.listaRepartidores[n].velocidad = 1.0f + ((float)(rand() % 400)) / 100.0f;
-        sistema.listaRepartidores[n].activo = 1;
-        sistema.listaRepartidores[n].enRuta = 0;
-        sistema.listaRepartidores[n].estado = DESOCUPADO;
-        sistema.listaRepartidores[n].fase = 0;
-
-        sistema.listaRepartidores[n].numPedidosAceptados = 0;
-        sistema.listaRepartidores[n].capacidadMaxima = MAX_PEDIDOS_POR_REPARTIDOR;
-        sistema.listaRepartidores[n].indicePedidoActual = 0;
-        sistema.listaRepartidores[n].desvioMaximoPermitido = 5;
-        sistema.listaRepartidores[n].factorDesvio = 1.5f;
-        sistema.listaRepartidores[n].pedidosAceptadosPorRR = 0;
-        sistema.listaRepartidores[n].pedidosRechazadosPorDesvio = 0;
-        sistema.listaRepartidores[n].pedidosEntregados = 0;
-        sistema.listaRepartidores[n].bloqueado = 0;
-        sistema.listaRepartidores[n].tiempoEspera = 0;
-        strcpy(sistema.listaRepartidores[n].tipoDestino, "");
+        prepararRepartidor(n, 1.0f + (float)aleatorioRango(ALEATORIO_MAPA, 400) / 100.0f);
 
         // Buscar posición válida
         int i, j;
         int intentos = 0;
         do {
-            i = rand() % avenidas;
-            j = rand() % calles;
+            i = aleatorioRango(ALEATORIO_MAPA, avenidas);
+            j = aleatorioRango(ALEATORIO_MAPA, calles);
             intentos++;
 
             if (intentos > 100) {
@@ -881,10 +1047,76 @@ void inicializarSistema(int calles, int avenidas, int rest, int casas, int rep)
            sistema.numRestaurantes, sistema.numCasas, sistema.numRepartidores);
 }
 
+// Construye el mapa del escenario cargado; mismos nombres que el aleatorio
+void inicializarDesdeEscenario(const Escenario *e) {
+    prepararMapaVacio(e->tamanio, e->tamanio, e->numRepartidores);
+
+    for (int r = 0; r < e->numRestaurantes; r++) {
+        const EscenarioRestaurante *er = &e->restaurantes[r];
+        Restaurante *rest = &sistema.listaRestaurantes[r];
+
+        sistema.grilla[er->av][er->ca] = er->direccion;
+
+        rest->id = r;
+        rest->posxy.posx = er->av;
+        rest->posxy.posy = er->ca;
+        rest->direccion = er->direccion;
+        snprintf(rest->nombre, 32, "Restaurante no. %d", r);
+
+        rest->numPlatillos = er->numPlatillos;
+        for (int p = 0; p < er->numPlatillos; p++) {
+            snprintf(rest->menu[p].nombre, 32, "Platillo %d", p + 1);
+            rest->menu[p].tiempoPreparacion = (float)er->prep[p] / 100.0f;
+        }
+
+        rest->cantidadDeCambio = er->umbral;
+        rest->algoritmo = FCFS;
+        rest->colaPedidosCount = 0;
+        sistema.numRestaurantes++;
+    }
+
+    for (int c = 0; c < e->numCasas; c++) {
+        const EscenarioCasa *ec = &e->casas[c];
+        Casa *casa = &sistema.listaCasas[c];
+
+        sistema.grilla[ec->av][ec->ca] = ec->direccion;
+
+        casa->id = c;
+        casa->posxy.posx = ec->av;
+        casa->posxy.posy = ec->ca;
+        casa->direccion = ec->direccion;
+        snprintf(casa->nombre, 32, "Casa no. %d", c);
+        sistema.numCasas++;
+    }
+
+    for (int n = 0; n < e->numRepartidores; n++) {
+        const EscenarioRepartidor *ed = &e->repartidores[n];
+
+        prepararRepartidor(n, (float)ed->velocidad / 100.0f);
+        sistema.listaRepartidores[n].posxy.posx = ed->av;
+        sistema.listaRepartidores[n].posxy.posy = ed->ca;
+        sistema.grillaMapa[ed->av][ed->ca] = 'p';
+    }
+
+    crearMapaUnificado();
+    actualizarPosicionesAlMapaUnificado();
+
+    sistemaInicializado = 1;
+
+    printf("{\"type\":\"info\",\"msg\":\"Escenario: %d rest, %d casas, %d motoristas, %d pedidos en la traza\"}\r\n",
+           sistema.numRestaurantes, sistema.numCasas, sistema.numRepartidores, e->numPedidos);
+}
+
 // Envía el mapa completo por UART
 void enviarMapaCompleto(void) {
-    printf("{\"type\":\"map\",\"calles\":%d,\"avenidas\":%d}\r\n",
-           sistema.calles, sistema.avenidas);
+    SONDA_AMBITO(ENVIAR_MAPA);
+
+    JsonTx json;
+    jsonIniciar(&json, 64);
+    jsonCadena(&json, "type", "map");
+    jsonEntero(&json, "calles", sistema.calles);
+    jsonEntero(&json, "avenidas", sistema.avenidas);
+    jsonTerminar(&json);
 
     // Restaurantes
     for (int n = 0; n < sistema.numRestaurantes; n++) {
@@ -894,18 +1126,25 @@ void enviarMapaCompleto(void) {
         int av = j + 1;
         int ca = (sistema.avenidas - 1) - i;
 
-        printf("{\"type\":\"restaurante\",\"id\":%d,\"av\":%d,\"ca\":%d,\"dir\":\"%c\"}\r\n",
-               n + 1, av, ca, sistema.listaRestaurantes[n].direccion);
+        jsonIniciar(&json, 80);
+        jsonCadena(&json, "type", "restaurante");
+        jsonEntero(&json, "id", n + 1);
+        jsonEntero(&json, "av", av);
+        jsonEntero(&json, "ca", ca);
+        jsonCaracter(&json, "dir", sistema.listaRestaurantes[n].direccion);
+        jsonTerminar(&json);
     }
 
     // Menús
     for (int r = 0; r < sistema.numRestaurantes; r++) {
         for (int p = 0; p < sistema.listaRestaurantes[r].numPlatillos; p++) {
-            char tiempoStr[16];
-            floatToStr(sistema.listaRestaurantes[r].menu[p].tiempoPreparacion, tiempoStr, 16);
-
-            printf("{\"type\":\"menu\",\"restaurantId\":%d,\"dishId\":%d,\"nombre\":\"%s\",\"tiempo\":\"%s\"}\r\n",
-                   r + 1, p, sistema.listaRestaurantes[r].menu[p].nombre, tiempoStr);
+            jsonIniciar(&json, 128);
+            jsonCadena(&json, "type", "menu");
+            jsonEntero(&json, "restaurantId", r + 1);
+            jsonEntero(&json, "dishId", p);
+            jsonCadena(&json, "nombre", sistema.listaRestaurantes[r].menu[p].nombre);
+            jsonFijoTexto(&json, "tiempo", (int32_t)(sistema.listaRestaurantes[r].menu[p].tiempoPreparacion * 100.0f), 2);
+            jsonTerminar(&json);
         }
     }
 
@@ -917,8 +1156,13 @@ void enviarMapaCompleto(void) {
         int av = j + 1;
         int ca = (sistema.avenidas - 1) - i;
 
-        printf("{\"type\":\"casa\",\"id\":%d,\"av\":%d,\"ca\":%d,\"dir\":\"%c\"}\r\n",
-               n + 1, av, ca, sistema.listaCasas[n].direccion);
+        jsonIniciar(&json, 80);
+        jsonCadena(&json, "type", "casa");
+        jsonEntero(&json, "id", n + 1);
+        jsonEntero(&json, "av", av);
+        jsonEntero(&json, "ca", ca);
+        jsonCaracter(&json, "dir", sistema.listaCasas[n].direccion);
+        jsonTerminar(&json);
     }
 
     // Repartidores
@@ -928,9 +1172,18 @@ void enviarMapaCompleto(void) {
         int av, ca;
         convertirUnificadoAAvCa(sistema.listaRepartidores[i].posxyUnificado, &av, &ca);
 
-        printf("{\"type\":\"repartidor\",\"id\":%d,\"nombre\":\"%s\",\"av\":%d,\"ca\":%d,\"vel\":%d}\r\n",
-               i, sistema.listaRepartidores[i].nombre, av, ca, velInt);
+        jsonIniciar(&json, 112);
+        jsonCadena(&json, "type", "repartidor");
+        jsonEntero(&json, "id", i);
+        jsonCadena(&json, "nombre", sistema.listaRepartidores[i].nombre);
+        jsonEntero(&json, "av", av);
+        jsonEntero(&json, "ca", ca);
+        jsonEntero(&json, "vel", velInt);
+        jsonTerminar(&json);
+
+        flotaActualizar(i, av, ca, sistema.listaRepartidores[i].estado);
     }
+    flotaForzarKeyframe();
 
     printf("{\"type\":\"info\",\"msg\":\"Mapa: %d rest, %d casas, %d reps\"}\r\n",
            sistema.numRestaurantes, sistema.numCasas, sistema.numRepartidores);
@@ -956,98 +1209,135 @@ void enviarMapaCombinado(void) {
 }
 
 // Envía evento de pedido por UART
-void enviarEventoPedido(const char *evento, const char *numeroRecibo, const char *driver, const char *prepTime, int restaurantId, int destinationId) {
-    char buffer[256];
-    int len = 0;
-
-    if (driver && prepTime && restaurantId > 0 && destinationId > 0) {
-        len = snprintf(buffer, sizeof(buffer),
-            "{\"type\":\"event\",\"ev\":\"%s\",\"order\":\"%s\",\"driver\":\"%s\",\"prepTime\":\"%s\",\"restaurantId\":%d,\"destinationId\":%d}\r\n",
-            evento, numeroRecibo, driver, prepTime, restaurantId, destinationId);
-    } else if (driver) {
-        len = snprintf(buffer, sizeof(buffer),
-            "{\"type\":\"event\",\"ev\":\"%s\",\"order\":\"%s\",\"driver\":\"%s\"}\r\n",
-            evento, numeroRecibo, driver);
-    } else if (prepTime && restaurantId > 0 && destinationId > 0) {
-        len = snprintf(buffer, sizeof(buffer),
-            "{\"type\":\"event\",\"ev\":\"%s\",\"order\":\"%s\",\"prepTime\":\"%s\",\"restaurantId\":%d,\"destinationId\":%d}\r\n",
-            evento, numeroRecibo, prepTime, restaurantId, destinationId);
-    } else {
-        len = snprintf(buffer, sizeof(buffer),
-            "{\"type\":\"event\",\"ev\":\"%s\",\"order\":\"%s\"}\r\n",
-            evento, numeroRecibo);
+void enviarEventoPedido(const char *evento, const char *numeroRecibo, const char *driver, int prepCentis, int restaurantId, int destinationId) {
+    SONDA_AMBITO(ENVIAR_EVENTO);
+
+#ifdef HOST_SIM
+    if (observadorEventoPedido != NULL) observadorEventoPedido(evento, numeroRecibo, driver);
+#endif
+
+    int conPrep = (prepCentis >= 0 && restaurantId > 0 && destinationId > 0);
+
+    if (telemetriaBinaria()) {
+        CodigoEventoTel ev = telemetriaCodigoEvento(evento);
+        int pedido = telemetriaNumeroRecibo(numeroRecibo);
+        int idDriver = indiceRepartidorPorNombre(driver);
+
+        if (ev != TEL_EV_DESCONOCIDO && pedido >= 0 && (driver == NULL || idDriver >= 0)) {
+            if (conPrep) {
+                telemetriaEvento(ev, pedido, idDriver, (uint32_t)prepCentis, restaurantId, destinationId);
+            } else {
+                telemetriaEvento(ev, pedido, idDriver, 0, 0, 0);
+            }
+            return;
+        }
     }
 
-    if (len > 0) {
-        HAL_UART_Transmit(&huart2, (uint8_t*)buffer, len, 200);
+    JsonTx j;
+    jsonIniciar(&j, 192);
+    jsonCadena(&j, "type", "event");
+    jsonCadena(&j, "ev", evento);
+    jsonCadena(&j, "order", numeroRecibo);
+    if (driver) {
+        jsonCadena(&j, "driver", driver);
     }
+    if (conPrep) {
+        jsonFijoTexto(&j, "prepTime", prepCentis, 2);
+        jsonEntero(&j, "restaurantId", restaurantId);
+        jsonEntero(&j, "destinationId", destinationId);
+    }
+    jsonTerminar(&j);
 }
 
-// Calcula y envía métricas de un pedido
-void enviarMetricasPedido(Pedido *p) {
-    if (p == NULL || p->metricsSent) return;
+// Milisegundos entre dos marcas; -1 si falta alguna o es imposible
+static int32_t msEntre(uint32_t desde, uint32_t hasta) {
+    if (desde == 0 || hasta == 0 || hasta <= desde) return -1;
 
-    p->metricsSent = 1;
+    uint32_t ms = hasta - desde;
+    if (ms > 4000000u) return -1;
+
+    return (int32_t)ms;
+}
+
+// Centésimas de segundo entre dos marcas; 0 si falta alguna o es imposible
+static int32_t centesimasEntre(uint32_t desde, uint32_t hasta) {
+    int32_t ms = msEntre(desde, hasta);
+    return ms < 0 ? 0 : ms / 10;
+}
+
+// Registra cada etapa medible del pedido en su histograma
+static void registrarLatencias(const Pedido *p) {
+    const int32_t ms[NUM_ETAPAS] = {
+        [ETAPA_COLA]        = msEntre(p->t_creado, p->t_inicioPrep),
+        [ETAPA_PREPARACION] = msEntre(p->t_inicioPrep, p->t_finPrep),
+        [ETAPA_ESPERA]      = msEntre(p->t_finPrep, p->t_recogido),
+        [ETAPA_ENTREGA]     = msEntre(p->t_recogido, p->t_entregado),
+        [ETAPA_TOTAL]       = msEntre(p->t_creado, p->t_entregado),
+    };
 
-    float t_queue_kitchen = 0.0f;
-    float t_prep = 0.0f;
-    float t_wait_driver = 0.0f;
-    float t_drive = 0.0f;
-    float t_total = 0.0f;
+    int r = p->idRestaurante;
+    int m = p->repartidorId;
 
-    if (p->t_inicioPrep > 0 && p->t_creado > 0 && p->t_inicioPrep > p->t_creado)
-        t_queue_kitchen = (float)(p->t_inicioPrep - p->t_creado) / 1000.0f;
+    if (ms[ETAPA_TOTAL] >= 0) {
+        ventanasRegistrarEntrega(p->t_entregado, (uint32_t)ms[ETAPA_TOTAL]);
+    }
 
-    if (p->t_finPrep > 0 && p->t_inicioPrep > 0 && p->t_finPrep > p->t_inicioPrep)
-        t_prep = (float)(p->t_finPrep - p->t_inicioPrep) / 1000.0f;
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        if (ms[e] < 0) continue;
 
-    if (p->t_recogido > 0 && p->t_finPrep > 0 && p->t_recogido > p->t_finPrep)
-        t_wait_driver = (float)(p->t_recogido - p->t_finPrep) / 1000.0f;
+        histogramaRegistrar(&histogramasEtapa[e], (uint32_t)ms[e]);
+        welfordAgregar(&welfordEtapa[e], (uint32_t)ms[e]);
 
-    if (p->t_entregado > 0 && p->t_recogido > 0 && p->t_entregado > p->t_recogido)
-        t_drive = (float)(p->t_entregado - p->t_recogido) / 1000.0f;
+        if (r >= 0 && r < MAX_RESTAURANTES) {
+            welfordAgregar(&welfordRestaurante[r][e], (uint32_t)ms[e]);
+        }
+        if (m >= 0 && m < MAX_REPARTIDORES) {
+            welfordAgregar(&welfordRepartidor[m][e], (uint32_t)ms[e]);
+        }
+    }
+}
 
-    if (p->t_entregado > 0 && p->t_creado > 0 && p->t_entregado > p->t_creado)
-        t_total = (float)(p->t_entregado - p->t_creado) / 1000.0f;
+// Calcula y envía métricas de un pedido
+void enviarMetricasPedido(Pedido *p) {
+    SONDA_AMBITO(ENVIAR_MET_PEDIDO);
 
-    // Filtrar valores imposibles
-    if (t_queue_kitchen < 0.0f || t_queue_kitchen > 4000.0f) t_queue_kitchen = 0.0f;
-    if (t_prep < 0.0f || t_prep > 4000.0f) t_prep = 0.0f;
-    if (t_wait_driver < 0.0f || t_wait_driver > 4000.0f) t_wait_driver = 0.0f;
-    if (t_drive < 0.0f || t_drive > 4000.0f) t_drive = 0.0f;
-    if (t_total < 0.0f || t_total > 4000.0f) t_total = 0.0f;
+    if (p == NULL || p->metricsSent) return;
 
-    char qStr[16], pStr[16], wStr[16], dStr[16], totStr[16];
-    floatToStr(t_queue_kitchen, qStr, sizeof(qStr));
-    floatToStr(t_prep,         pStr, sizeof(pStr));
-    floatToStr(t_wait_driver,  wStr, sizeof(wStr));
-    floatToStr(t_drive,        dStr, sizeof(dStr));
-    floatToStr(t_total,        totStr, sizeof(totStr));
+    p->metricsSent = 1;
+    registrarLatencias(p);
 
-    char buffer[256];
-    int len = snprintf(buffer, sizeof(buffer),
-        "{\"type\":\"metrics\",\"order\":\"%s\","
-        "\"t_queue_kitchen\":\"%s\","
-        "\"t_prep\":\"%s\","
-        "\"t_wait_driver\":\"%s\","
-        "\"t_drive\":\"%s\","
-        "\"t_total\":\"%s\"}\r\n",
-        p->numeroRecibo, qStr, pStr, wStr, dStr, totStr);
+    int32_t t_queue_kitchen = centesimasEntre(p->t_creado, p->t_inicioPrep);
+    int32_t t_prep = centesimasEntre(p->t_inicioPrep, p->t_finPrep);
+    int32_t t_wait_driver = centesimasEntre(p->t_finPrep, p->t_recogido);
+    int32_t t_drive = centesimasEntre(p->t_recogido, p->t_entregado);
+    int32_t t_total = centesimasEntre(p->t_creado, p->t_entregado);
 
-    if (len > 0 && len < (int)sizeof(buffer)) {
-        HAL_UART_Transmit(&huart2, (uint8_t*)buffer, len, 200);
+    int numPedido = telemetriaNumeroRecibo(p->numeroRecibo);
+    if (telemetriaBinaria() && numPedido >= 0) {
+        telemetriaMetricas(numPedido, t_queue_kitchen, t_prep, t_wait_driver, t_drive, t_total);
+        return;
     }
+
+    JsonTx j;
+    jsonIniciar(&j, 192);
+    jsonCadena(&j, "type", "metrics");
+    jsonCadena(&j, "order", p->numeroRecibo);
+    jsonFijoTexto(&j, "t_queue_kitchen", t_queue_kitchen, 2);
+    jsonFijoTexto(&j, "t_prep", t_prep, 2);
+    jsonFijoTexto(&j, "t_wait_driver", t_wait_driver, 2);
+    jsonFijoTexto(&j, "t_drive", t_drive, 2);
+    jsonFijoTexto(&j, "t_total", t_total, 2);
+    jsonTerminar(&j);
 }
 
 // Envía estadísticas de repartidores
 void enviarEstadisticas(void) {
-    char buffer[512];
-    int len;
+    SONDA_AMBITO(ENVIAR_ESTAD);
 
-    printf("\n========== ESTADISTICAS ROUND-ROBIN ==========\r\n");
+    LOG(STATS_INICIO);
 
     for (int i = 0; i < sistema.numRepartidores; i++) {
-        if (xSemaphoreTake(mutexRepartidores[i], pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (cerrojoTomar(mutexRepartidores[i], pdMS_TO_TICKS(100)) == pdTRUE) {
             Repartidor* rep = &sistema.listaRepartidores[i];
 
             int total = rep->pedidosAceptadosPorRR + rep->pedidosRechazadosPorDesvio;
@@ -1056,116 +1346,106 @@ void enviarEstadisticas(void) {
                 tasaAceptacion = (rep->pedidosAceptadosPorRR * 100) / total;
             }
 
-            len = snprintf(buffer, sizeof(buffer),
-                "{\"type\":\"stats\",\"driver\":\"%s\",\"accepted\":%d,\"rejected\":%d,\"delivered\":%d,\"rate\":%d}\r\n",
-                rep->nombre,
-                rep->pedidosAceptadosPorRR,
-                rep->pedidosRechazadosPorDesvio,
-                rep->pedidosEntregados,
-                tasaAceptacion);
-
-            HAL_UART_Transmit(&huart2, (uint8_t*)buffer, len, 200);
+            if (telemetriaBinaria()) {
+                telemetriaStats(i,
+                                rep->pedidosAceptadosPorRR,
+                                rep->pedidosRechazadosPorDesvio,
+                                rep->pedidosEntregados,
+                                tasaAceptacion);
+                cerrojoLiberar(mutexRepartidores[i]);
+                continue;
+            }
 
-            xSemaphoreGive(mutexRepartidores[i]);
+            JsonTx j;
+            jsonIniciar(&j, 160);
+            jsonCadena(&j, "type", "stats");
+            jsonCadena(&j, "driver", rep->nombre);
+            jsonEntero(&j, "accepted", rep->pedidosAceptadosPorRR);
+            jsonEntero(&j, "rejected", rep->pedidosRechazadosPorDesvio);
+            jsonEntero(&j, "delivered", rep->pedidosEntregados);
+            jsonEntero(&j, "rate", tasaAceptacion);
+            jsonSinSigno(&j, "cells", rep->celdasRecorridas);
+            jsonTerminar(&j);
+
+            cerrojoLiberar(mutexRepartidores[i]);
         }
     }
 
-    printf("==============================================\r\n");
+    LOG(STATS_FIN);
 }
 
-// Quicksort para ordenar arrays
-void quickSort(float arr[], int low, int high) {
-    if (low < high) {
-        float pivot = arr[high];
-        int i = low - 1;
-
-        for (int j = low; j < high; j++) {
-            if (arr[j] < pivot) {
-                i++;
-                float temp = arr[i];
-                arr[i] = arr[j];
-                arr[j] = temp;
-            }
-        }
-
-        float temp = arr[i + 1];
-        arr[i + 1] = arr[high];
-        arr[high] = temp;
-
-        int pi = i + 1;
-        quickSort(arr, low, pi - 1);
-        quickSort(arr, pi + 1, high);
-    }
+// Envía contadores de la transmisión UART
+void enviarEstadisticasTx(void) {
+    EstadisticasUartTx tx;
+    uartTxObtenerEstadisticas(&tx);
+
+    JsonTx j;
+    jsonIniciar(&j, 240);
+    jsonCadena(&j, "type", "tx_stats");
+    jsonSinSigno(&j, "bytes", tx.bytesEnviados);
+    jsonSinSigno(&j, "lines", tx.registrosEnviados);
+    jsonSinSigno(&j, "dropped", tx.registrosDescartados);
+    jsonSinSigno(&j, "dropped_bytes", tx.bytesDescartados);
+    jsonSinSigno(&j, "overflows", tx.desbordes);
+    jsonSinSigno(&j, "max_used", tx.ocupacionMaxima);
+    jsonSinSigno(&j, "dma_retries", tx.fallosDma);
+    jsonSinSigno(&j, "oversized", tx.registrosLargos);
+    jsonCadena(&j, "mode", uartTxGetModo() == UART_TX_BLOQUEAR ? "BLOQUEAR" : "DESCARTAR");
+    jsonTerminar(&j);
 }
 
-// Calcula percentil de array ordenado
-float calcularPercentil(float datos[], int n, int percentil) {
-    if (n == 0) return 0.0f;
-
-    static float temp[MAX_PEDIDOS];
-    for (int i = 0; i < n; i++) {
-        temp[i] = datos[i];
-    }
-
-    quickSort(temp, 0, n - 1);
-
-    int index = (percentil * n) / 100;
-    if (index >= n) index = n - 1;
-
-    return temp[index];
+// Envía contadores de la recepción UART
+void enviarEstadisticasRx(void) {
+    EstadisticasUartRx rx;
+    EstadisticasCanalCmd canal;
+    uartRxObtenerEstadisticas(&rx);
+    canalCmdObtenerEstadisticas(&canal);
+
+    JsonTx j;
+    jsonIniciar(&j, 448);
+    jsonCadena(&j, "type", "rx_stats");
+    jsonSinSigno(&j, "bytes", rx.bytesRecibidos);
+    jsonSinSigno(&j, "lines", rx.lineas);
+    jsonSinSigno(&j, "too_long", rx.lineasLargas);
+    jsonSinSigno(&j, "wrapped", rx.lineasPartidas);
+    jsonSinSigno(&j, "lost_bytes", rx.bytesPerdidos);
+    jsonSinSigno(&j, "uart_errors", rx.erroresUart);
+    jsonSinSigno(&j, "frames", rx.tramas);
+    jsonSinSigno(&j, "cmd_executed", canal.ejecutadas);
+    jsonSinSigno(&j, "cmd_duplicates", canal.duplicadas);
+    jsonSinSigno(&j, "cmd_out_of_window", canal.fueraDeVentana);
+    jsonSinSigno(&j, "cmd_crc_errors", canal.erroresCrc);
+    jsonSinSigno(&j, "cmd_malformed", canal.malformadas);
+    jsonSinSigno(&j, "cmd_resyncs", canal.resincronizaciones);
+    jsonSinSigno(&j, "cmd_held", canal.retenidas);
+    jsonSinSigno(&j, "cmd_no_room", canal.sinLugar);
+    jsonSinSigno(&j, "cmd_abandoned", canal.abandonadas);
+    jsonTerminar(&j);
 }
 
-// Calcula métricas globales del sistema
+// Resume los histogramas de cada etapa (percentiles en O(cubetas))
 void calcularMetricasGlobales(void) {
-    float tiemposTotal[MAX_PEDIDOS];
-    float tiemposPrep[MAX_PEDIDOS];
-
-    int countTotal = 0;
-    int countPrep = 0;
-
-    float sumaTotal = 0.0f;
-    float sumaPrep = 0.0f;
-
-    for (int i = 0; i < sistema.numPedidos; i++) {
-        Pedido *p = &sistema.listaPedidos[i];
-
-        if (p->entregado && p->t_entregado > 0 && p->t_creado > 0) {
-            if (p->t_entregado > p->t_creado) {
-                float t_total = (float)(p->t_entregado - p->t_creado) / 1000.0f;
-
-                if (t_total > 0.0f && t_total < 4000.0f) {
-                    tiemposTotal[countTotal] = t_total;
-                    sumaTotal += t_total;
-                    countTotal++;
-                }
-            }
-
-            if (p->t_finPrep > 0 && p->t_inicioPrep > 0 && p->t_finPrep > p->t_inicioPrep) {
-                float t_prep = (float)(p->t_finPrep - p->t_inicioPrep) / 1000.0f;
+    SONDA_AMBITO(CALC_METRICAS);
 
-                if (t_prep > 0.0f && t_prep < 4000.0f) {
-                    tiemposPrep[countPrep] = t_prep;
-                    sumaPrep += t_prep;
-                    countPrep++;
-                }
-            }
-        }
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        histogramaResumir(&histogramasEtapa[e], &metricas.etapas[e]);
     }
 
-    metricas.promedioTotal = countTotal > 0 ? sumaTotal / countTotal : 0.0f;
-    metricas.promedioPreparacion = countPrep > 0 ? sumaPrep / countPrep : 0.0f;
-    metricas.promedioEspera = 0.0f;
-    metricas.promedioEntrega = 0.0f;
-
-    metricas.percentil50Total = calcularPercentil(tiemposTotal, countTotal, 50);
-    metricas.percentil95Total = calcularPercentil(tiemposTotal, countTotal, 95);
+    metricas.pedidosAnalizados = (int)metricas.etapas[ETAPA_TOTAL].pedidos;
 
-    metricas.percentil50Prep = calcularPercentil(tiemposPrep, countPrep, 50);
-    metricas.percentil95Prep = calcularPercentil(tiemposPrep, countPrep, 95);
-
-    metricas.pedidosAnalizados = countTotal;
+    LOG(MET_CALCULADAS, metricas.pedidosAnalizados);
+}
 
-    printf("[Metricas] Calculadas: %d pedidos analizados\r\n", countTotal);
+// Vacía histogramas y resúmenes (arranque y limpieza del sistema)
+void reiniciarMetricas(void) {
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        histogramaReiniciar(&histogramasEtapa[e]);
+        welfordReiniciar(&welfordEtapa[e]);
+    }
+    memset(welfordRestaurante, 0, sizeof(welfordRestaurante));
+    memset(welfordRepartidor, 0, sizeof(welfordRepartidor));
+    memset(&metricas, 0, sizeof(MetricasGlobales));
+    ventanasReiniciar(relojAhora());
 }
 
 // Calcula información de ruta entre dos puntos
@@ -1180,19 +1460,21 @@ void crearRuta(int repId, Posicion origen, Posicion destino) {
            repId, distX, distY, distTotal);
 }
 
-// Gestiona movimiento y estados de un repartidor
-void moverRepartidor(int idRep) {
-    if (idRep >= sistema.numRepartidores) return;
+// Gestiona movimiento y estados de un repartidor; devuelve 1 si tras el
+// paso sigue en ruta sin esperar (visto con el cerrojo tomado), 0 si llegó,
+// está esperando, no tiene ruta o no se pudo tomar el cerrojo
+int moverRepartidor(int idRep) {
+    if (idRep >= sistema.numRepartidores) return 0;
 
-    if (xSemaphoreTake(mutexRepartidores[idRep], pdMS_TO_TICKS(10)) != pdTRUE) {
-        return;
+    if (cerrojoTomar(mutexRepartidores[idRep], pdMS_TO_TICKS(10)) != pdTRUE) {
+        return 0;
     }
 
     Repartidor *rep = &sistema.listaRepartidores[idRep];
 
     // Verificar si está esperando
     if (rep->bloqueado) {
-        if (HAL_GetTick() >= rep->tiempoEspera) {
+        if (relojAhora() >= rep->tiempoEspera) {
             rep->bloqueado = 0;
 
             if (rep->numPedidosAceptados > 0) {
@@ -1209,9 +1491,10 @@ void moverRepartidor(int idRep) {
                         pedido->listo = 0;
                         pedido->enReparto = 1;
                         pedido->estado = RECOGIDO;
-                        pedido->t_recogido = HAL_GetTick();
+                        trazarPedido(pedido);
+                        pedido->t_recogido = relojAhora();
 
-                        enviarEventoPedido("DRIVER_PICKED_UP", pedido->numeroRecibo, rep->nombre, NULL, 0, 0);
+                        enviarEventoPedido("DRIVER_PICKED_UP", pedido->numeroRecibo, rep->nombre, -1, 0, 0);
 
                         rep->estado = EN_CAMINO_A_DESTINO;
                         rep->destino = getPuntoAccesoCasa(pedido->idCasa);
@@ -1225,11 +1508,12 @@ void moverRepartidor(int idRep) {
                         pedido->enReparto = 0;
                         pedido->entregado = 1;
                         pedido->estado = ENTREGADO;
-                        pedido->t_entregado = HAL_GetTick();
+                        trazarPedido(pedido);
+                        pedido->t_entregado = relojAhora();
 
                         enviarMetricasPedido(pedido);
 
-                        enviarEventoPedido("DELIVERED", pedido->numeroRecibo, rep->nombre, NULL, 0, 0);
+                        enviarEventoPedido("DELIVERED", pedido->numeroRecibo, rep->nombre, -1, 0, 0);
                         rep->pedidosEntregados++;
                         printf("{\"type\":\"info\",\"msg\":\"[%s] Pedido %s ENTREGADO (%d entregados total)\"}\r\n",
                                rep->nombre, pedido->numeroRecibo, rep->pedidosEntregados);
@@ -1272,41 +1556,33 @@ void moverRepartidor(int idRep) {
                             rep->fase = 0;
                         }
                     }
+
+                    flotaActualizar(idRep, av, ca, rep->estado);
                 }
             }
         }
-        xSemaphoreGive(mutexRepartidores[idRep]);
-        return;
+        int sigue = rep->enRuta && !rep->bloqueado;
+        cerrojoLiberar(mutexRepartidores[idRep]);
+        return sigue;
     }
 
     if (!rep->enRuta) {
-        xSemaphoreGive(mutexRepartidores[idRep]);
-        return;
+        cerrojoLiberar(mutexRepartidores[idRep]);
+        return 0;
     }
 
     // Mover una posición con A*
     sistema.mapaUnificado[rep->posxyUnificado.posx][rep->posxyUnificado.posy] = 'o';
     Posicion siguientePaso = calcularSiguientePasoAStar(rep->posxyUnificado, rep->destino);
+    if (siguientePaso.posx != rep->posxyUnificado.posx || siguientePaso.posy != rep->posxyUnificado.posy) {
+        rep->celdasRecorridas++;
+    }
     rep->posxyUnificado = siguientePaso;
     sistema.mapaUnificado[rep->posxyUnificado.posx][rep->posxyUnificado.posy] = 'p';
 
-    // Enviar posición actualizada
     int av, ca;
     convertirUnificadoAAvCa(rep->posxyUnificado, &av, &ca);
 
-    const char* estadoStr;
-    switch(rep->estado) {
-        case DESOCUPADO: estadoStr = "DESOCUPADO"; break;
-        case EN_CAMINO_A_RESTAURANTE: estadoStr = "EN_CAMINO_A_RESTAURANTE"; break;
-        case RECOGIENDO: estadoStr = "RECOGIENDO"; break;
-        case EN_CAMINO_A_DESTINO: estadoStr = "EN_CAMINO_A_DESTINO"; break;
-        case ENTREGANDO: estadoStr = "ENTREGANDO"; break;
-        default: estadoStr = "DESCONOCIDO";
-    }
-
-    printf("{\"type\":\"mov\",\"rep\":%d,\"av\":%d,\"ca\":%d,\"estado\":\"%s\"}\r\n",
-           idRep, av, ca, estadoStr);
-
     // Verificar llegada al destino
     if (rep->posxyUnificado.posx == rep->destino.posx &&
         rep->posxyUnificado.posy == rep->destino.posy) {
@@ -1321,35 +1597,158 @@ void moverRepartidor(int idRep) {
                     printf("{\"type\":\"info\",\"msg\":\"[%s] Llego al restaurante. Recogiendo...\"}\r\n", rep->nombre);
                     rep->estado = RECOGIENDO;
                     rep->bloqueado = 1;
-                    rep->tiempoEspera = HAL_GetTick() + 3000;
-                    printf("{\"type\":\"mov\",\"rep\":%d,\"av\":%d,\"ca\":%d,\"estado\":\"RECOGIENDO\"}\r\n",
-                           idRep, av, ca);
+                    rep->tiempoEspera = relojAhora() + 3000;
                 }
                 // Llegó a la casa
                 else if (rep->fase == 1) {
                     printf("{\"type\":\"info\",\"msg\":\"[%s] Llego a la casa. Entregando...\"}\r\n", rep->nombre);
                     rep->estado = ENTREGANDO;
                     rep->bloqueado = 1;
-                    rep->tiempoEspera = HAL_GetTick() + 2000;
-                    printf("{\"type\":\"mov\",\"rep\":%d,\"av\":%d,\"ca\":%d,\"estado\":\"ENTREGANDO\"}\r\n",
-                           idRep, av, ca);
+                    rep->tiempoEspera = relojAhora() + 2000;
                 }
+
+                // El avance que sobra no se guarda para después de la espera
+                rep->progresoQ16 = 0;
             }
         }
     }
 
-    xSemaphoreGive(mutexRepartidores[idRep]);
+    // Posición y estado final del paso para el frame de flota
+    flotaActualizar(idRep, av, ca, rep->estado);
+
+    int sigue = rep->enRuta && !rep->bloqueado;
+    cerrojoLiberar(mutexRepartidores[idRep]);
+    return sigue;
+}
+
+// Un paso al azar de un repartidor libre; el cerrojo lo toma quien llama
+static void pasearRepartidor(int i) {
+    Repartidor *rep = &sistema.listaRepartidores[i];
+    int x = rep->posxyUnificado.posx;
+    int y = rep->posxyUnificado.posy;
+
+    Posicion movimientos[4];
+    int numMovimientos = 0;
+
+    // Verificar 4 direcciones
+    if (x - 1 >= 0 && sistema.mapaUnificado[x - 1][y] == 'o') {
+        movimientos[numMovimientos].posx = x - 1;
+        movimientos[numMovimientos].posy = y;
+        numMovimientos++;
+    }
+    if (x + 1 < sistema.tamanioUnificado && sistema.mapaUnificado[x + 1][y] == 'o') {
+        movimientos[numMovimientos].posx = x + 1;
+        movimientos[numMovimientos].posy = y;
+        numMovimientos++;
+    }
+    if (y - 1 >= 0 && sistema.mapaUnificado[x][y - 1] == 'o') {
+        movimientos[numMovimientos].posx = x;
+        movimientos[numMovimientos].posy = y - 1;
+        numMovimientos++;
+    }
+    if (y + 1 < sistema.tamanioUnificado && sistema.mapaUnificado[x][y + 1] == 'o') {
+        movimientos[numMovimientos].posx = x;
+        movimientos[numMovimientos].posy = y + 1;
+        numMovimientos++;
+    }
+
+    if (numMovimientos == 0) return;
+
+    int indiceAleatorio = aleatorioRango(ALEATORIO_PASEO, numMovimientos);
+
+    sistema.mapaUnificado[rep->posxyUnificado.posx][rep->posxyUnificado.posy] = 'o';
+
+    rep->posxyUnificado.posx = movimientos[indiceAleatorio].posx;
+    rep->posxyUnificado.posy = movimientos[indiceAleatorio].posy;
+    rep->celdasRecorridas++;
+
+    sistema.mapaUnificado[rep->posxyUnificado.posx][rep->posxyUnificado.posy] = 'p';
+
+    int av, ca;
+    convertirUnificadoAAvCa(rep->posxyUnificado, &av, &ca);
+
+    flotaActualizar(i, av, ca, DESOCUPADO);
+}
+
+// Mueve al repartidor las celdas que le tocan en este periodo según su
+// velocidad; la fracción que sobra queda para el siguiente
+static void avanzarRepartidor(int i) {
+    Repartidor *rep = &sistema.listaRepartidores[i];
+
+    if (cerrojoTomar(mutexRepartidores[i], pdMS_TO_TICKS(10)) != pdTRUE) return;
+
+    // Recogiendo o entregando: solo se revisa el plazo, sin acumular
+    if (rep->enRuta && rep->bloqueado) {
+        rep->progresoQ16 = 0;
+        cerrojoLiberar(mutexRepartidores[i]);
+        moverRepartidor(i);
+        return;
+    }
+
+    int libre = paseoLibre && !rep->enRuta && rep->numPedidosAceptados == 0 && rep->estado == DESOCUPADO;
+    if (!rep->enRuta && !libre) {
+        rep->progresoQ16 = 0;
+        cerrojoLiberar(mutexRepartidores[i]);
+        return;
+    }
+
+    rep->progresoQ16 += rep->avanceQ16;
+    int pasos = (int)(rep->progresoQ16 / CELDA_Q16);
+    if (pasos > MAX_PASOS_POR_PERIODO) pasos = MAX_PASOS_POR_PERIODO;
+    rep->progresoQ16 %= CELDA_Q16;
+
+    if (libre) {
+        for (int k = 0; k < pasos; k++) {
+            pasearRepartidor(i);
+        }
+        cerrojoLiberar(mutexRepartidores[i]);
+        return;
+    }
+    cerrojoLiberar(mutexRepartidores[i]);
+
+    // Se corta con lo que moverRepartidor vio bajo el cerrojo: al soltarlo
+    // otra tarea puede cambiar el repartidor
+    for (int k = 0; k < pasos; k++) {
+        if (!moverRepartidor(i)) break;
+    }
+}
+
+// Qué necesita el repartidor en la próxima vuelta; si está esperando, el
+// plazo va en *plazo. Se lee sin cerrojo: quien le da trabajo después avisa
+// con despertarRepartidores y la tarea lo vuelve a mirar
+static ActividadRepartidor actividadRepartidor(int i, uint32_t *plazo) {
+    Repartidor *rep = &sistema.listaRepartidores[i];
+
+    if (rep->enRuta && rep->bloqueado) {
+        *plazo = rep->tiempoEspera;
+        return ACTIVIDAD_PLAZO;
+    }
+    if (rep->enRuta) return ACTIVIDAD_MOVIMIENTO;
+    if (paseoLibre && rep->numPedidosAceptados == 0 && rep->estado == DESOCUPADO) {
+        return ACTIVIDAD_MOVIMIENTO;
+    }
+    return ACTIVIDAD_NINGUNA;
+}
+
+// Suma repartidores al conjunto activo de la tarea de movimiento y la
+// despierta si estaba dormida
+void despertarRepartidores(uint32_t mascara) {
+    if (tareaRepartidores != NULL) {
+        xTaskNotify(tareaRepartidores, mascara, eSetBits);
+    }
 }
 
 // Asigna pedido a repartidor con scoring y confirmaciones
 void asignarPedidoARepartidor(int pedidoId) {
+    SONDA_AMBITO(ASIGNAR);
+
     if (pedidoId >= sistema.numPedidos) return;
 
     Pedido *pedido = &sistema.listaPedidos[pedidoId];
 
     if (pedido->asignado || !pedido->listo) return;
 
-    printf("\n[Asignador Hibrido] ===== Procesando %s =====\r\n", pedido->numeroRecibo);
+    LOG(ASIG_PROCESANDO, pedido->numeroRecibo);
 
     typedef struct {
         int idx;
@@ -1362,11 +1761,11 @@ void asignarPedidoARepartidor(int pedidoId) {
 
     // Calcular scores
     for (int i = 0; i < sistema.numRepartidores; i++) {
-        if (xSemaphoreTake(mutexRepartidores[i], pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (cerrojoTomar(mutexRepartidores[i], pdMS_TO_TICKS(10)) == pdTRUE) {
             Repartidor* rep = &sistema.listaRepartidores[i];
 
             if (rep->numPedidosAceptados >= rep->capacidadMaxima) {
-                xSemaphoreGive(mutexRepartidores[i]);
+                cerrojoLiberar(mutexRepartidores[i]);
                 continue;
             }
 
@@ -1378,7 +1777,7 @@ void asignarPedidoARepartidor(int pedidoId) {
             candidatos[numCandidatos].desvio = desvio;
             numCandidatos++;
 
-            xSemaphoreGive(mutexRepartidores[i]);
+            cerrojoLiberar(mutexRepartidores[i]);
         }
     }
 
@@ -1389,23 +1788,22 @@ void asignarPedidoARepartidor(int pedidoId) {
         int espera = 3000;
 
         if (pedido->reintentosAsignacion > 5) {
-            printf("[Asignador Hibrido] Pedido %s supero limite de intentos (%d)\r\n",
-                   pedido->numeroRecibo, pedido->reintentosAsignacion);
-            printf("Esperando 10s para liberar motoristas y reiniciando contador\r\n");
+            LOG(ASIG_LIMITE_INTENTOS, pedido->numeroRecibo, pedido->reintentosAsignacion);
+            LOG(ASIG_ESPERA_LIBERAR);
 
             pedido->reintentosAsignacion = 0;
             espera = 10000;
         }
         else {
-            printf("[Asignador Hibrido] Ningun motorista con capacidad disponible\r\n");
-            printf("Reintentando en 3s (intento %d/5)\r\n", pedido->reintentosAsignacion);
+            LOG(ASIG_SIN_CAPACIDAD);
+            LOG(ASIG_REINTENTO, pedido->reintentosAsignacion);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(espera));
+        relojEsperar(espera);
 
-        if (xSemaphoreTake(mutexSistema, pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (cerrojoTomar(mutexSistema, pdMS_TO_TICKS(100)) == pdTRUE) {
             xEventGroupSetBits(eventGroupPedidos, EVENT_PEDIDO_LISTO);
-            xSemaphoreGive(mutexSistema);
+            cerrojoLiberar(mutexSistema);
         }
 
         return;
@@ -1424,18 +1822,15 @@ void asignarPedidoARepartidor(int pedidoId) {
     }
 
     // Mostrar candidatos
-    printf("[Asignador Hibrido] Lista candidatos (mejor->peor):\r\n");
+    LOG(ASIG_LISTA_CANDIDATOS);
     for (int i = 0; i < numCandidatos; i++) {
-        char scoreStr[16];
-        floatToStr(candidatos[i].score, scoreStr, 16);
-
-        if (xSemaphoreTake(mutexRepartidores[candidatos[i].idx], pdMS_TO_TICKS(5)) == pdTRUE) {
-            printf("   %s | score=%s | desvio=%d | pedidos=%d\r\n",
-                   sistema.listaRepartidores[candidatos[i].idx].nombre,
-                   scoreStr,
-                   candidatos[i].desvio,
-                   sistema.listaRepartidores[candidatos[i].idx].numPedidosAceptados);
-            xSemaphoreGive(mutexRepartidores[candidatos[i].idx]);
+        if (cerrojoTomar(mutexRepartidores[candidatos[i].idx], pdMS_TO_TICKS(5)) == pdTRUE) {
+            LOG(ASIG_CANDIDATO,
+                sistema.listaRepartidores[candidatos[i].idx].nombre,
+                candidatos[i].score,
+                candidatos[i].desvio,
+                sistema.listaRepartidores[candidatos[i].idx].numPedidosAceptados);
+            cerrojoLiberar(mutexRepartidores[candidatos[i].idx]);
         }
     }
 
@@ -1447,19 +1842,17 @@ void asignarPedidoARepartidor(int pedidoId) {
     for (int i = 0; i < numCandidatos; i++) {
         int idx = candidatos[i].idx;
 
-        if (xSemaphoreTake(mutexRepartidores[idx], pdMS_TO_TICKS(10)) == pdTRUE) {
+        if (cerrojoTomar(mutexRepartidores[idx], pdMS_TO_TICKS(10)) == pdTRUE) {
             Repartidor* rep = &sistema.listaRepartidores[idx];
 
             if (rep->numPedidosAceptados >= rep->capacidadMaxima) {
-                xSemaphoreGive(mutexRepartidores[idx]);
+                cerrojoLiberar(mutexRepartidores[idx]);
                 continue;
             }
 
             int confirma = verificarConfirmacion(candidatos[i].score, candidatos[i].desvio, idx);
 
-            printf("[Asignador Hibrido] Preguntando a %s -> %s\r\n",
-                   rep->nombre,
-                   confirma ? "CONFIRMA" : "RECHAZA");
+            LOG(ASIG_PREGUNTA, rep->nombre, confirma ? "CONFIRMA" : "RECHAZA");
 
             if (confirma) {
                 strcpy(rep->pedidosAceptados[rep->numPedidosAceptados], pedido->numeroRecibo);
@@ -1478,23 +1871,25 @@ void asignarPedidoARepartidor(int pedidoId) {
                 pedido->asignado = 1;
                 pedido->repartidorId = idx;
                 pedido->estado = ACEPTADO;
+                trazarPedido(pedido);
                 pedido->reintentosAsignacion = 0;
-                pedido->t_asignado = HAL_GetTick();
+                pedido->t_asignado = relojAhora();
 
                 seleccionado = idx;
                 scoreSeleccion = candidatos[i].score;
                 desvioSeleccion = candidatos[i].desvio;
 
-                enviarEventoPedido("DRIVER_ASSIGNED", pedido->numeroRecibo, rep->nombre, NULL, 0, 0);
+                enviarEventoPedido("DRIVER_ASSIGNED", pedido->numeroRecibo, rep->nombre, -1, 0, 0);
 
-                xSemaphoreGive(mutexRepartidores[idx]);
+                cerrojoLiberar(mutexRepartidores[idx]);
+                despertarRepartidores(1u << idx);
                 break;
             }
             else {
                 rep->pedidosRechazadosPorDesvio++;
             }
 
-            xSemaphoreGive(mutexRepartidores[idx]);
+            cerrojoLiberar(mutexRepartidores[idx]);
         }
     }
 
@@ -1507,23 +1902,23 @@ void asignarPedidoARepartidor(int pedidoId) {
         for (int i = 0; i < numCandidatos; i++) {
             int idx = candidatos[i].idx;
 
-            if (xSemaphoreTake(mutexRepartidores[idx], pdMS_TO_TICKS(10)) == pdTRUE) {
+            if (cerrojoTomar(mutexRepartidores[idx], pdMS_TO_TICKS(10)) == pdTRUE) {
                 Repartidor* rep = &sistema.listaRepartidores[idx];
 
                 if (rep->numPedidosAceptados < rep->capacidadMaxima) {
                     mejorIdx = idx;
                     mejorScore = candidatos[i].score;
                     mejorDesvio = candidatos[i].desvio;
-                    xSemaphoreGive(mutexRepartidores[idx]);
+                    cerrojoLiberar(mutexRepartidores[idx]);
                     break;
                 }
 
-                xSemaphoreGive(mutexRepartidores[idx]);
+                cerrojoLiberar(mutexRepartidores[idx]);
             }
         }
 
         if (mejorIdx != -1) {
-            if (xSemaphoreTake(mutexRepartidores[mejorIdx], pdMS_TO_TICKS(10)) == pdTRUE) {
+            if (cerrojoTomar(mutexRepartidores[mejorIdx], pdMS_TO_TICKS(10)) == pdTRUE) {
                 Repartidor* rep = &sistema.listaRepartidores[mejorIdx];
 
                 strcpy(rep->pedidosAceptados[rep->numPedidosAceptados], pedido->numeroRecibo);
@@ -1542,41 +1937,40 @@ void asignarPedidoARepartidor(int pedidoId) {
                 pedido->asignado = 1;
                 pedido->repartidorId = mejorIdx;
                 pedido->estado = ACEPTADO;
+                trazarPedido(pedido);
                 pedido->reintentosAsignacion = 0;
-                pedido->t_asignado = HAL_GetTick();
+                pedido->t_asignado = relojAhora();
 
                 seleccionado = mejorIdx;
 
-                enviarEventoPedido("DRIVER_ASSIGNED", pedido->numeroRecibo, rep->nombre, NULL, 0, 0);
+                enviarEventoPedido("DRIVER_ASSIGNED", pedido->numeroRecibo, rep->nombre, -1, 0, 0);
 
-                char scoreStr[16];
-                floatToStr(mejorScore, scoreStr, 16);
-                printf("[Asignador Hibrido] Ningun motorista confirmo. Asignacion forzada a %s\r\n",
-                       rep->nombre);
-                printf("(score=%s, desvio=%d)\r\n\n", scoreStr, mejorDesvio);
+                LOG(ASIG_FORZADA, rep->nombre);
+                LOG(ASIG_SCORE, mejorScore, mejorDesvio);
 
-                xSemaphoreGive(mutexRepartidores[mejorIdx]);
+                cerrojoLiberar(mutexRepartidores[mejorIdx]);
+                despertarRepartidores(1u << mejorIdx);
             }
         }
         else {
             pedido->reintentosAsignacion++;
 
             if (pedido->reintentosAsignacion <= 5) {
-                printf("[Asignador Hibrido] Ningun motorista disponible\r\n");
-                printf("Reintentando en 3s (intento %d/5)\r\n", pedido->reintentosAsignacion);
+                LOG(ASIG_SIN_DISPONIBLE);
+                LOG(ASIG_REINTENTO, pedido->reintentosAsignacion);
 
-                vTaskDelay(pdMS_TO_TICKS(3000));
+                relojEsperar(3000);
 
-                if (xSemaphoreTake(mutexSistema, pdMS_TO_TICKS(100)) == pdTRUE) {
+                if (cerrojoTomar(mutexSistema, pdMS_TO_TICKS(100)) == pdTRUE) {
                     xEventGroupSetBits(eventGroupPedidos, EVENT_PEDIDO_LISTO);
-                    xSemaphoreGive(mutexSistema);
+                    cerrojoLiberar(mutexSistema);
                 }
             }
             else {
-                printf("[Asignador Hibrido] Pedido %s no pudo asignarse tras varios intentos\r\n",
-                       pedido->numeroRecibo);
-                printf("Marcado como BUSCANDO_MOTORISTA\r\n");
+                LOG(ASIG_ABANDONADO, pedido->numeroRecibo);
+                LOG(ASIG_BUSCANDO);
                 pedido->estado = BUSCANDO_MOTORISTA;
+                trazarPedido(pedido);
             }
 
             return;
@@ -1587,17 +1981,15 @@ void asignarPedidoARepartidor(int pedidoId) {
     if (seleccionado >= 0) {
         indiceMotoristaRR = (seleccionado + 1) % sistema.numRepartidores;
 
-        char scoreStr[16];
-        floatToStr(scoreSeleccion, scoreStr, 16);
-
-        printf("[Asignador Hibrido] ✓ Pedido asignado a %s\r\n",
-               sistema.listaRepartidores[seleccionado].nombre);
-        printf("(score=%s, desvio=%d)\r\n\n", scoreStr, desvioSeleccion);
+        LOG(ASIG_ASIGNADO, sistema.listaRepartidores[seleccionado].nombre);
+        LOG(ASIG_SCORE, scoreSeleccion, desvioSeleccion);
     }
 }
 
 // Procesa cola de pedidos con FCFS o SJF
 void procesarPedidosRestaurante(int idRest) {
+    SONDA_AMBITO(PROCESAR_REST);
+
     if (idRest >= sistema.numRestaurantes) return;
 
     Restaurante *rest = &sistema.listaRestaurantes[idRest];
@@ -1641,11 +2033,12 @@ void procesarPedidosRestaurante(int idRest) {
         Pedido *p = &sistema.listaPedidos[pedidoId];
 
         p->estado = PREPARANDO;
+        trazarPedido(p);
         p->enPreparacion = 1;
         p->listo = 0;
         p->idRestaurante = idRest;
 
-        uint32_t tickNow = HAL_GetTick();
+        uint32_t tickNow = relojAhora();
 
         if (p->t_creado == 0) {
             p->t_creado = tickNow;
@@ -1664,7 +2057,7 @@ void procesarPedidosRestaurante(int idRest) {
         printf("{\"type\":\"info\",\"msg\":\"[%s] Preparando %s (%s seg)\"}\r\n",
                rest->nombre, p->numeroRecibo, tiempoStr);
 
-        enviarEventoPedido("ORDER_PREPARING", p->numeroRecibo, NULL, NULL, 0, 0);
+        enviarEventoPedido("ORDER_PREPARING", p->numeroRecibo, NULL, -1, 0, 0);
     }
 }
 
@@ -1681,8 +2074,8 @@ void crearPedidoAleatorio(void) {
         return;
     }
 
-    int idxRest = rand() % sistema.numRestaurantes;
-    int idxCasa = rand() % sistema.numCasas;
+    int idxRest = aleatorioRango(ALEATORIO_PEDIDOS, sistema.numRestaurantes);
+    int idxCasa = aleatorioRango(ALEATORIO_PEDIDOS, sistema.numCasas);
 
     Pedido nuevoPedido;
     nuevoPedido.id = sistema.numPedidos;
@@ -1700,7 +2093,8 @@ void crearPedidoAleatorio(void) {
     nuevoPedido.entregado = 0;
     nuevoPedido.repartidorId = -1;
     nuevoPedido.estado = CREADO;
-    nuevoPedido.t_creado     = HAL_GetTick();
+    nuevoPedido.t_creado     = relojAhora();
+    ventanasRegistrarPedido(nuevoPedido.t_creado);
     nuevoPedido.t_inicioPrep = 0;
     nuevoPedido.t_finPrep    = 0;
     nuevoPedido.t_asignado   = 0;
@@ -1708,10 +2102,10 @@ void crearPedidoAleatorio(void) {
     nuevoPedido.t_entregado  = 0;
     nuevoPedido.metricsSent  = 0;
 
-    nuevoPedido.platillosCount = 1 + (rand() % 3);
+    nuevoPedido.platillosCount = 1 + aleatorioRango(ALEATORIO_PEDIDOS, 3);
     float tiempoTotal = 0.0f;
     for (int i = 0; i < nuevoPedido.platillosCount; i++) {
-        int idxPlatillo = rand() % sistema.listaRestaurantes[idxRest].numPlatillos;
+        int idxPlatillo = aleatorioRango(ALEATORIO_PEDIDOS, sistema.listaRestaurantes[idxRest].numPlatillos);
         nuevoPedido.platillos[i] = idxPlatillo;
         tiempoTotal += sistema.listaRestaurantes[idxRest].menu[idxPlatillo].tiempoPreparacion;
     }
@@ -1720,13 +2114,12 @@ void crearPedidoAleatorio(void) {
     nuevoPedido.reintentosAsignacion = 0;
 
     sistema.listaPedidos[sistema.numPedidos] = nuevoPedido;
+    trazarPedido(&sistema.listaPedidos[sistema.numPedidos]);
 
-    char tiempoStr[16];
-    floatToStr(tiempoTotal, tiempoStr, 16);
-    enviarEventoPedido("ORDER_CREATED", nuevoPedido.numeroRecibo, NULL, tiempoStr, idxRest + 1, idxCasa + 1);
+    enviarEventoPedido("ORDER_CREATED", nuevoPedido.numeroRecibo, NULL, (int)(tiempoTotal * 100.0f), idxRest + 1, idxCasa + 1);
 
     // Agregar a cola del restaurante
-    if (xSemaphoreTake(mutexRestaurantes[idxRest], pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (cerrojoTomar(mutexRestaurantes[idxRest], pdMS_TO_TICKS(100)) == pdTRUE) {
         Restaurante *rest = &sistema.listaRestaurantes[idxRest];
 
         if (rest->colaPedidosCount < MAX_PEDIDOS) {
@@ -1734,10 +2127,10 @@ void crearPedidoAleatorio(void) {
             rest->colaPedidosCount++;
         }
 
-        xSemaphoreGive(mutexRestaurantes[idxRest]);
+        cerrojoLiberar(mutexRestaurantes[idxRest]);
     }
 
-    xQueueSend(queuePedidos, &sistema.numPedidos, 0);
+    colaEnviar(queuePedidos, &sistema.numPedidos, 0);
     sistema.numPedidos++;
 
     printf("{\"type\":\"info\",\"msg\":\"Pedido %s creado (en cola del restaurante)\"}\r\n",
@@ -1750,21 +2143,21 @@ void solicitarPedidoAutomaticoAWeb(void) {
         return;
     }
 
-    int idxRest = rand() % sistema.numRestaurantes;
-    int idxCasa = rand() % sistema.numCasas;
+    int idxRest, idxCasa;
+    int platillos[MAX_PLATILLOS];
 
-    int cantidadPlatillos = 1 + (rand() % 3);
+    cargaElegirDestino(sistema.numRestaurantes, sistema.numCasas, &idxRest, &idxCasa);
+    int cantidadPlatillos = cargaElegirPlatillos(sistema.listaRestaurantes[idxRest].numPlatillos,
+                                                 platillos, MAX_PLATILLOS);
 
     char platillosStr[64] = "";
     int offset = 0;
 
     for (int i = 0; i < cantidadPlatillos; i++) {
-        int idxPlatillo = rand() % sistema.listaRestaurantes[idxRest].numPlatillos;
-
         if (i > 0) {
             offset += snprintf(platillosStr + offset, sizeof(platillosStr) - offset, ",");
         }
-        offset += snprintf(platillosStr + offset, sizeof(platillosStr) - offset, "%d", idxPlatillo);
+        offset += snprintf(platillosStr + offset, sizeof(platillosStr) - offset, "%d", platillos[i]);
     }
 
     // Solo enviar - la web procesa todo
@@ -1772,13 +2165,74 @@ void solicitarPedidoAutomaticoAWeb(void) {
            idxRest + 1, idxCasa + 1, platillosStr);
 }
 
+// Crea los pedidos del generador de carga que ya vencieron; en modo WEB
+// solo los pide a la web, como antes. Con la tabla llena las llegadas se
+// descartan (avisa una vez): los huecos no se reciclan
+static void generarCarga(uint32_t ahora) {
+    static int topeAvisado = 0;
+
+    if (sistema.numRestaurantes == 0 || sistema.numCasas == 0) {
+        return;
+    }
+    if (sistema.numPedidos < MAX_PEDIDOS) topeAvisado = 0;
+
+    for (int n = 0; n < CARGA_MAX_POR_CICLO && cargaPedidoDebido(ahora); n++) {
+        ConfigCarga config;
+        cargaObtenerConfig(&config);
+
+        if (config.modo == CARGA_WEB) {
+            solicitarPedidoAutomaticoAWeb();
+            continue;
+        }
+
+        int idxRest, idxCasa;
+        int platillos[MAX_PLATILLOS];
+
+        cargaElegirDestino(sistema.numRestaurantes, sistema.numCasas, &idxRest, &idxCasa);
+        int cantidad = cargaElegirPlatillos(sistema.listaRestaurantes[idxRest].numPlatillos,
+                                            platillos, MAX_PLATILLOS);
+
+        int aceptado = registrarPedidoWeb(idxRest, idxCasa, platillos, cantidad) != 0;
+        cargaContar(aceptado);
+
+        if (!aceptado && !topeAvisado) {
+            topeAvisado = 1;
+            printf("{\"type\":\"warning\",\"msg\":\"Carga: tope de %d pedidos, las llegadas se descartan\"}\r\n",
+                   MAX_PEDIDOS);
+        }
+    }
+}
+
+// Crea los pedidos vencidos de la traza del escenario
+static void reproducirTraza(uint32_t ahora) {
+    if (!mundoEscenario) return;
+
+    for (int n = 0; n < CARGA_MAX_POR_CICLO; n++) {
+        const EscenarioPedido *debido = escenarioPedidoDebido(ahora);
+        if (debido == NULL) break;
+
+        // Copia: SCENARIO puede reescribir el escenario mientras se espera
+        EscenarioPedido p = *debido;
+        int platillos[MAX_PLATILLOS];
+
+        for (int i = 0; i < p.numPlatillos; i++) {
+            platillos[i] = p.platillos[i];
+        }
+        if (p.restaurante >= sistema.numRestaurantes || p.casa >= sistema.numCasas) continue;
+
+        registrarPedidoWeb(p.restaurante, p.casa, platillos, p.numPlatillos);
+    }
+}
+
 // Inicializa FreeRTOS con tareas, colas y semáforos
 void MX_FREERTOS_Init(void)
 {
-    srand(HAL_GetTick());
+    uartTxInit();
+    aleatorioSembrar(ALEATORIO_SEMILLA_DEFECTO);
+    cargaIniciar(relojAhora());
+    reiniciarMetricas();
 
     // Colas
-    queueRx = xQueueCreate(64, sizeof(uint8_t));
     queuePedidos = xQueueCreate(32, sizeof(int));
     queueButton = xQueueCreate(8, sizeof(uint32_t));
     queuePedidosListos = xQueueCreate(32, sizeof(int));
@@ -1796,6 +2250,29 @@ void MX_FREERTOS_Init(void)
         mutexRestaurantes[i] = xSemaphoreCreateMutex();
     }
 
+    // Perfil: colas que informa task_stats
+    perfilIniciar();
+    perfilRegistrarCola("pedidos", queuePedidos);
+    perfilRegistrarCola("listos", queuePedidosListos);
+    perfilRegistrarCola("boton", queueButton);
+    perfilRegistrarCola("cupo_cocina", semCapacidadCola);
+
+    // Cerrojos instrumentados: cada grupo sale en su propio mensaje locks
+    cerrojoRegistrar(mutexSistema, "sistema", -1, CERROJO_MUTEX);
+    for (int i = 0; i < MAX_REPARTIDORES; i++) {
+        cerrojoRegistrar(mutexRepartidores[i], "repartidor", i, CERROJO_MUTEX);
+    }
+    for (int i = 0; i < MAX_RESTAURANTES; i++) {
+        cerrojoRegistrar(mutexRestaurantes[i], "restaurante", i, CERROJO_MUTEX);
+    }
+    cerrojoRegistrar(semCapacidadCola, "cupo_cocina", -1, CERROJO_SEMAFORO);
+    cerrojoRegistrar(queuePedidos, "cola_pedidos", -1, CERROJO_COLA);
+    cerrojoRegistrar(queueButton, "cola_boton", -1, CERROJO_COLA);
+
+#if SONDAS_HABILITADAS
+    sondasIniciar();
+#endif
+
     // Tarea transmisión
     const osThreadAttr_t taskTx_attributes = {
         .name = "TaskTx",
@@ -1842,7 +2319,8 @@ void MX_FREERTOS_Init(void)
         printf("{\"type\":\"info\",\"msg\":\"UART2 OK, iniciando recepcion...\"}\r\n");
     }
 
-    HAL_UART_Receive_IT(&huart2, &rxByte, 1);
+    registrarComandosRx();
+    uartRxInit();
 
     printf("{\"type\":\"info\",\"msg\":\"STM32 FreeRTOS Iniciado\"}\r\n");
     printf("{\"type\":\"info\",\"msg\":\"Presiona el boton para generar el mapa\"}\r\n");
@@ -1855,7 +2333,7 @@ void MX_FREERTOS_Init(void)
 // Tarea de asignación con event groups
 void StartTaskAsignador(void *argument)
 {
-    printf("[Asignador Hibrido] Tarea iniciada\r\n");
+    LOG(ASIG_TAREA_INICIADA);
 
     for(;;)
     {
@@ -1873,13 +2351,13 @@ void StartTaskAsignador(void *argument)
 
                     if (pedido->listo && !pedido->asignado) {
                         asignarPedidoARepartidor(p);
-                        vTaskDelay(pdMS_TO_TICKS(100));
+                        relojEsperar(100);
                     }
                 }
             }
         }
         else {
-            vTaskDelay(pdMS_TO_TICKS(500));
+            relojEsperar(500);
         }
     }
 }
@@ -1893,24 +2371,25 @@ void StartTaskRestaurantes(void *argument)
     {
         if (sistema.sistemaCorriendo && sistemaInicializado) {
 
-            if ((HAL_GetTick() - lastCheck) > 1000) {
-                lastCheck = HAL_GetTick();
+            if ((relojAhora() - lastCheck) > 1000) {
+                lastCheck = relojAhora();
 
                 // Revisar pedidos en preparación
                 for (int p = 0; p < sistema.numPedidos; p++) {
                     if (sistema.listaPedidos[p].enPreparacion && !sistema.listaPedidos[p].listo) {
-                        uint32_t tiempoTranscurridoMs = HAL_GetTick() - sistema.listaPedidos[p].tiempoInicioPreparacion;
+                        uint32_t tiempoTranscurridoMs = relojAhora() - sistema.listaPedidos[p].tiempoInicioPreparacion;
                         float tiempoTranscurridoSeg = (float)tiempoTranscurridoMs / 1000.0f;
 
                         if (tiempoTranscurridoSeg >= sistema.listaPedidos[p].tiempoPreparacion) {
                             sistema.listaPedidos[p].listo = 1;
                             sistema.listaPedidos[p].enPreparacion = 0;
                             sistema.listaPedidos[p].estado = LISTO;
-                            sistema.listaPedidos[p].t_finPrep = HAL_GetTick();
+                            trazarPedido(&sistema.listaPedidos[p]);
+                            sistema.listaPedidos[p].t_finPrep = relojAhora();
 
-                            enviarEventoPedido("ORDER_READY", sistema.listaPedidos[p].numeroRecibo, NULL, NULL, 0, 0);
+                            enviarEventoPedido("ORDER_READY", sistema.listaPedidos[p].numeroRecibo, NULL, -1, 0, 0);
 
-                            xSemaphoreGive(semCapacidadCola);
+                            cerrojoLiberar(semCapacidadCola);
                             xEventGroupSetBits(eventGroupPedidos, EVENT_PEDIDO_LISTO);
                         }
                     }
@@ -1919,19 +2398,14 @@ void StartTaskRestaurantes(void *argument)
                 // Procesar colas de restaurantes
                 for (int idRest = 0; idRest < sistema.numRestaurantes; idRest++) {
 
-                    if (xSemaphoreTake(mutexRestaurantes[idRest], pdMS_TO_TICKS(50)) == pdTRUE) {
+                    if (cerrojoTomar(mutexRestaurantes[idRest], pdMS_TO_TICKS(50)) == pdTRUE) {
                         Restaurante *rest = &sistema.listaRestaurantes[idRest];
 
                         // Notificar cambios
                         static int last_queue[MAX_RESTAURANTES] = {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1};
 
                         if (last_queue[idRest] != rest->colaPedidosCount) {
-                            const char* algoritmo = (rest->colaPedidosCount > rest->cantidadDeCambio) ? "SJF" : "FCFS";
-                            const char* estado = (rest->colaPedidosCount > rest->cantidadDeCambio) ? "CARGADO" : "NORMAL";
-
-                            printf("{\"type\":\"restaurant_status\",\"id\":%d,\"algorithm\":\"%s\",\"status\":\"%s\",\"queue\":%d,\"threshold\":%d}\r\n",
-                                   idRest + 1, algoritmo, estado, rest->colaPedidosCount, rest->cantidadDeCambio);
-
+                            notificarEstadoRestaurante(idRest);
                             last_queue[idRest] = rest->colaPedidosCount;
                         }
 
@@ -1948,34 +2422,44 @@ void StartTaskRestaurantes(void *argument)
                             }
 
                             if (!yaPreparando) {
-                                if (xSemaphoreTake(semCapacidadCola, 0) == pdTRUE) {
+                                if (cerrojoTomar(semCapacidadCola, 0) == pdTRUE) {
                                     procesarPedidosRestaurante(idRest);
                                 }
                             }
                         }
 
-                        xSemaphoreGive(mutexRestaurantes[idRest]);
+                        cerrojoLiberar(mutexRestaurantes[idRest]);
                     }
                 }
             }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(100));
+        relojEsperar(100);
     }
 }
 
 // Notifica estado del restaurante
 void notificarEstadoRestaurante(int idRest) {
     Restaurante *rest = &sistema.listaRestaurantes[idRest];
+    int cargado = rest->colaPedidosCount > rest->cantidadDeCambio;
 
-    const char* algoritmo = (rest->colaPedidosCount > rest->cantidadDeCambio) ? "SJF" : "FCFS";
-    const char* estado = (rest->colaPedidosCount > rest->cantidadDeCambio) ? "CARGADO" : "NORMAL";
+    if (telemetriaBinaria()) {
+        telemetriaEstadoRestaurante(idRest + 1, cargado, cargado, rest->colaPedidosCount, rest->cantidadDeCambio);
+        return;
+    }
 
-    printf("{\"type\":\"restaurant_status\",\"id\":%d,\"algorithm\":\"%s\",\"status\":\"%s\",\"queue\":%d,\"threshold\":%d}\r\n",
-           idRest + 1, algoritmo, estado, rest->colaPedidosCount, rest->cantidadDeCambio);
+    JsonTx j;
+    jsonIniciar(&j, 128);
+    jsonCadena(&j, "type", "restaurant_status");
+    jsonEntero(&j, "id", idRest + 1);
+    jsonCadena(&j, "algorithm", cargado ? "SJF" : "FCFS");
+    jsonCadena(&j, "status", cargado ? "CARGADO" : "NORMAL");
+    jsonEntero(&j, "queue", rest->colaPedidosCount);
+    jsonEntero(&j, "threshold", rest->cantidadDeCambio);
+    jsonTerminar(&j);
 }
 
-// Maneja overflow de HAL_GetTick
+// Maneja overflow del reloj
 static inline uint32_t diff_ms(uint32_t later, uint32_t earlier) {
     return later - earlier;
 }
@@ -1987,33 +2471,43 @@ void StartTaskTx(void *argument)
     uint32_t buttonMsg;
     uint32_t lastStats = 0;
     uint32_t lastGlobalMetrics = 0;
-    uint32_t lastAutoOrderRequest = 0;
+    uint32_t lastEntityMetrics = 0;
+    uint32_t lastProfile = 0;
+    int cargaCorriendo = 0;
 
     for(;;)
     {
-        uint32_t tick = HAL_GetTick();
+        uint32_t tick = relojAhora();
+
+        // Registro que el DMA rechazó: sin transferencia en vuelo ningún
+        // callback lo reintenta
+        uartTxReintentar();
 
         // Botón
-        if(xQueueReceive(queueButton, &buttonMsg, 0) == pdPASS)
+        if(colaRecibir(queueButton, &buttonMsg, 0) == pdPASS)
         {
             printf("{\"type\":\"info\",\"msg\":\"Boton B1 presionado\"}\r\n");
             regenerarMapa();
         }
 
         // Pedidos
-        if (sistema.sistemaCorriendo && xQueueReceive(queuePedidos, &pedidoId, 0) == pdPASS)
+        if (sistema.sistemaCorriendo && colaRecibir(queuePedidos, &pedidoId, 0) == pdPASS)
         {
-            vTaskDelay(pdMS_TO_TICKS(10));
+            relojEsperar(10);
         }
 
-        // Solicitar pedido automático cada 20-30 seg
-        if (sistema.sistemaCorriendo && sistemaInicializado) {
-            uint32_t intervalo = 20000 + (rand() % 10000);
-
-            if ((tick - lastAutoOrderRequest) > intervalo) {
-                lastAutoOrderRequest = tick;
-                solicitarPedidoAutomaticoAWeb();
-            }
+        // Generador de carga (LOAD); la secuencia empieza de nuevo en cada
+        // arranque del sistema para que sea reproducible
+        int corriendo = sistema.sistemaCorriendo && sistemaInicializado;
+        if (corriendo && !cargaCorriendo) {
+            inicioCorrida = tick;
+            cargaReiniciar(tick);
+            escenarioReiniciarTraza(tick);
+        }
+        cargaCorriendo = corriendo;
+        if (corriendo) {
+            generarCarga(tick);
+            reproducirTraza(tick);
         }
 
         // Estadísticas cada 10 seg
@@ -2028,84 +2522,399 @@ void StartTaskTx(void *argument)
             enviarMetricasGlobales();
         }
 
-        vTaskDelay(pdMS_TO_TICKS(500));
+        // Métricas por restaurante y repartidor cada 30 seg
+        if ((tick - lastEntityMetrics) > 30000) {
+            lastEntityMetrics = tick;
+            enviarMetricasEntidades(ENTIDAD_RESTAURANTE | ENTIDAD_REPARTIDOR);
+        }
+
+        // Perfil de tareas y cerrojos (PROFILE cambia el periodo)
+        if (periodoPerfil > 0 && (tick - lastProfile) > periodoPerfil) {
+            lastProfile = tick;
+            perfilEnviarEstadisticas();
+            enviarCerrojos();
+        }
+
+        // Se despierta antes si el generador tiene una llegada más próxima
+        uint32_t espera = 500;
+        if (cargaCorriendo) {
+            uint32_t proximo = cargaMsHastaProximo(relojAhora());
+            if (mundoEscenario) {
+                uint32_t traza = escenarioMsHastaProximo(relojAhora());
+                if (traza < proximo) proximo = traza;
+            }
+            if (proximo < espera) espera = proximo > 0 ? proximo : 1;
+        }
+        relojEsperar(espera);
     }
 }
 
+// Claves JSON por etapa: promedio, p50, p90, p95, p99, máximo y desviación
+static const char *const clavesEtapa[NUM_ETAPAS][7] = {
+    [ETAPA_COLA]        = {"avg_queue", "p50_queue", "p90_queue", "p95_queue", "p99_queue", "max_queue", "sd_queue"},
+    [ETAPA_PREPARACION] = {"avg_prep", "p50_prep", "p90_prep", "p95_prep", "p99_prep", "max_prep", "sd_prep"},
+    [ETAPA_ESPERA]      = {"avg_wait", "p50_wait", "p90_wait", "p95_wait", "p99_wait", "max_wait", "sd_wait"},
+    [ETAPA_ENTREGA]     = {"avg_delivery", "p50_delivery", "p90_delivery", "p95_delivery", "p99_delivery", "max_delivery", "sd_delivery"},
+    [ETAPA_TOTAL]       = {"avg_total", "p50_total", "p90_total", "p95_total", "p99_total", "max_total", "sd_total"},
+};
+
+// Ventanas móviles de global_metrics
+static const struct {
+    const char *clave;
+    uint32_t minutos;
+} ventanasMetricas[] = {
+    { "win_1m", 1 },
+    { "win_5m", 5 },
+    { "win_15m", 15 },
+};
+
+// Segundos con dos decimales a partir de milisegundos
+static inline float segundos(uint32_t ms) {
+    return (float)ms / 1000.0f;
+}
+
 // Calcula y envía métricas globales
 void enviarMetricasGlobales(void) {
-    char buffer[512];
-    int len;
+    SONDA_AMBITO(ENVIAR_MET_GLOBAL);
 
     calcularMetricasGlobales();
 
-    char avgTotalStr[16], avgPrepStr[16], avgEsperaStr[16], avgEntregaStr[16];
-    char p50TotalStr[16], p95TotalStr[16], p50PrepStr[16], p95PrepStr[16];
-
-    floatToStr(metricas.promedioTotal, avgTotalStr, 16);
-    floatToStr(metricas.promedioPreparacion, avgPrepStr, 16);
-    floatToStr(metricas.promedioEspera, avgEsperaStr, 16);
-    floatToStr(metricas.promedioEntrega, avgEntregaStr, 16);
-
-    floatToStr(metricas.percentil50Total, p50TotalStr, 16);
-    floatToStr(metricas.percentil95Total, p95TotalStr, 16);
-    floatToStr(metricas.percentil50Prep, p50PrepStr, 16);
-    floatToStr(metricas.percentil95Prep, p95PrepStr, 16);
-
-    len = snprintf(buffer, sizeof(buffer),
-        "{\"type\":\"global_metrics\","
-        "\"avg_total\":\"%s\","
-        "\"avg_prep\":\"%s\","
-        "\"avg_wait\":\"%s\","
-        "\"avg_delivery\":\"%s\","
-        "\"p50_total\":\"%s\","
-        "\"p95_total\":\"%s\","
-        "\"p50_prep\":\"%s\","
-        "\"p95_prep\":\"%s\","
-        "\"analyzed\":%d}\r\n",
-        avgTotalStr, avgPrepStr, avgEsperaStr, avgEntregaStr,
-        p50TotalStr, p95TotalStr, p50PrepStr, p95PrepStr,
-        metricas.pedidosAnalizados);
-
-    if (len > 0) {
-        HAL_UART_Transmit(&huart2, (uint8_t*)buffer, len, 500);
-    }
-
-    printf("========== METRICAS GLOBALES ==========\r\n");
-    printf("Promedio Total:      %s seg\r\n", avgTotalStr);
-    printf("Promedio Prep:       %s seg\r\n", avgPrepStr);
-    printf("Promedio Espera:     %s seg\r\n", avgEsperaStr);
-    printf("Promedio Entrega:    %s seg\r\n", avgEntregaStr);
-    printf("Percentil 50 Total:  %s seg\r\n", p50TotalStr);
-    printf("Percentil 95 Total:  %s seg\r\n", p95TotalStr);
-    printf("Percentil 50 Prep:   %s seg\r\n", p50PrepStr);
-    printf("Percentil 95 Prep:   %s seg\r\n", p95PrepStr);
-    printf("Pedidos Analizados:  %d\r\n", metricas.pedidosAnalizados);
-    printf("=======================================\r\n");
-}
-
-// Cancela pedido y actualiza estados
-void cancelarPedido(const char* numeroRecibo) {
-    printf("\n[Cancelador] ===== Cancelando pedido %s =====\r\n", numeroRecibo);
+    JsonTx j;
+    jsonIniciar(&j, UART_TX_MAX_REGISTRO);
+    jsonCadena(&j, "type", "global_metrics");
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        const ResumenHistograma *r = &metricas.etapas[e];
+        const uint32_t valores[7] = { r->promedio, r->p50, r->p90, r->p95, r->p99, r->max,
+                                      (uint32_t)welfordDesviacion(&welfordEtapa[e]) };
 
-    Pedido* pedido = buscarPedido(numeroRecibo);
-    if (pedido == NULL) {
-        printf("[Cancelador] Pedido %s NO ENCONTRADO\r\n", numeroRecibo);
-        enviarEventoPedido("CANCEL_FAILED", numeroRecibo, NULL, NULL, 0, 0);
-        return;
+        for (int k = 0; k < 7; k++) {
+            jsonFijoTexto(&j, clavesEtapa[e][k], (int32_t)(valores[k] / 10), 2);
+        }
     }
+    jsonEntero(&j, "analyzed", metricas.pedidosAnalizados);
+
+    // [pedidos/min, entregas/min, p50, p95, p99 del tiempo total en seg]
+    uint32_t ahora = relojAhora();
+    for (int w = 0; w < 3; w++) {
+        ResumenVentana v;
+        ventanasResumir(ahora, ventanasMetricas[w].minutos, &v);
+
+        jsonAbrirArreglo(&j, ventanasMetricas[w].clave);
+        jsonFijo(&j, NULL, (int32_t)v.pedidosPorMin, 2);
+        jsonFijo(&j, NULL, (int32_t)v.entregasPorMin, 2);
+        jsonFijo(&j, NULL, (int32_t)(v.p50 / 10), 2);
+        jsonFijo(&j, NULL, (int32_t)(v.p95 / 10), 2);
+        jsonFijo(&j, NULL, (int32_t)(v.p99 / 10), 2);
+        jsonCerrarArreglo(&j);
+    }
+    jsonTerminar(&j);
+
+    const ResumenHistograma *total = &metricas.etapas[ETAPA_TOTAL];
+    const ResumenHistograma *prep = &metricas.etapas[ETAPA_PREPARACION];
+
+    LOG(MET_INICIO);
+    LOG(MET_PROM_TOTAL, segundos(total->promedio));
+    LOG(MET_PROM_PREP, segundos(prep->promedio));
+    LOG(MET_PROM_ESPERA, segundos(metricas.etapas[ETAPA_ESPERA].promedio));
+    LOG(MET_PROM_ENTREGA, segundos(metricas.etapas[ETAPA_ENTREGA].promedio));
+    LOG(MET_P50_TOTAL, segundos(total->p50));
+    LOG(MET_P95_TOTAL, segundos(total->p95));
+    LOG(MET_P99_TOTAL, segundos(total->p99));
+    LOG(MET_P50_PREP, segundos(prep->p50));
+    LOG(MET_P95_PREP, segundos(prep->p95));
+    LOG(MET_ANALIZADOS, metricas.pedidosAnalizados);
+    LOG(MET_FIN);
+}
 
-    int idRestaurante = pedido->idRestaurante;
-    int idRepartidor = pedido->repartidorId;
+// Un mensaje por entidad con pedidos: "s" trae por etapa (cola, prep,
+// espera, entrega, total) [media, desviación, mínimo, máximo] en ms
+static void enviarMetricasEntidad(const char *tipo, int id, const Welford *etapas) {
+    if (etapas[ETAPA_TOTAL].n == 0) return;
+
+    JsonTx j;
+    jsonIniciar(&j, 256);
+    jsonCadena(&j, "type", "entity_metrics");
+    jsonCadena(&j, "kind", tipo);
+    jsonEntero(&j, "id", id);
+    jsonSinSigno(&j, "n", etapas[ETAPA_TOTAL].n);
+    jsonAbrirArreglo(&j, "s");
+    for (int e = 0; e < NUM_ETAPAS; e++) {
+        const Welford *w = &etapas[e];
+
+        jsonAbrirArreglo(&j, NULL);
+        jsonSinSigno(&j, NULL, (uint32_t)w->media);
+        jsonSinSigno(&j, NULL, (uint32_t)welfordDesviacion(w));
+        jsonSinSigno(&j, NULL, w->min);
+        jsonSinSigno(&j, NULL, w->max);
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+    jsonTerminar(&j);
+}
 
-    printf("[Cancelador] Pedido encontrado - Estado: %d\r\n", pedido->estado);
-    printf("[Cancelador] Asignado a repartidor: %d\r\n", idRepartidor);
-    printf("[Cancelador] Estados - Asignado: %d | EnPreparacion: %d | Listo: %d | EnReparto: %d\r\n",
-           pedido->asignado, pedido->enPreparacion, pedido->listo, pedido->enReparto);
+// Envía las métricas de restaurantes y/o repartidores (ENTIDAD_*)
+void enviarMetricasEntidades(int tipos) {
+    SONDA_AMBITO(ENVIAR_ENTIDADES);
 
-    // Remover de cola si aún no se preparó
+    if (tipos & ENTIDAD_RESTAURANTE) {
+        for (int i = 0; i < sistema.numRestaurantes; i++) {
+            enviarMetricasEntidad("rest", i + 1, welfordRestaurante[i]);
+        }
+    }
+    if (tipos & ENTIDAD_REPARTIDOR) {
+        for (int i = 0; i < sistema.numRepartidores; i++) {
+            enviarMetricasEntidad("driver", i, welfordRepartidor[i]);
+        }
+    }
+}
+
+// Envía el modo del reloj y cuánto tiempo simulado se saltó sin esperar
+void enviarReloj(void) {
+    EstadisticasReloj e;
+    JsonTx j;
+
+    relojObtenerEstadisticas(&e);
+    if (!jsonIniciar(&j, 128)) return;
+
+    jsonCadena(&j, "type", "clock");
+    jsonCadena(&j, "mode", relojModo() == RELOJ_VIRTUAL ? "virtual" : "real");
+    jsonSinSigno(&j, "now", relojAhora());
+    jsonSinSigno(&j, "jumps", e.saltos);
+    jsonSinSigno(&j, "skipped", e.ticksSaltados);
+    jsonTerminar(&j);
+}
+
+// Envía la configuración del generador de carga y lo que lleva generado
+void enviarCarga(void) {
+    ConfigCarga c;
+    ContadoresCarga k;
+    JsonTx j;
+
+    cargaObtenerConfig(&c);
+    cargaObtenerContadores(&k);
+    if (!jsonIniciar(&j, 512)) return;
+
+    jsonCadena(&j, "type", "load");
+    jsonCadena(&j, "mode", cargaNombreModo(c.modo));
+    jsonSinSigno(&j, "per_hour", c.porHora);
+    jsonSinSigno(&j, "period_s", c.periodoS);
+    jsonSinSigno(&j, "bursts_per_hour", c.rafagasPorHora);
+    jsonSinSigno(&j, "burst_size", c.tamRafaga);
+    jsonFijo(&j, "zipf_rest", c.zipfRestaurante, 2);
+    jsonFijo(&j, "zipf_dish", c.zipfPlatillo, 2);
+    jsonAbrirArreglo(&j, "mix");
+    for (int i = 0; i < c.mezclaCount; i++) {
+        jsonSinSigno(&j, NULL, c.mezcla[i]);
+    }
+    jsonCerrarArreglo(&j);
+    jsonAbrirArreglo(&j, "curve");
+    for (int i = 0; i < c.tramos; i++) {
+        jsonSinSigno(&j, NULL, c.curva[i]);
+    }
+    jsonCerrarArreglo(&j);
+    jsonSinSigno(&j, "seed", c.semilla);
+    jsonSinSigno(&j, "generated", k.generados);
+    jsonSinSigno(&j, "capped", k.alTope);
+    jsonEntero(&j, "orders", sistema.numPedidos);
+    jsonEntero(&j, "cap", MAX_PEDIDOS);
+
+    uint32_t proximo = cargaMsHastaProximo(relojAhora());
+    if (proximo != CARGA_SIN_LLEGADA) {
+        jsonSinSigno(&j, "next_ms", proximo);
+    }
+    jsonTerminar(&j);
+}
+
+// Envía la semilla de corrida y cuántos números sacó cada flujo
+void enviarSemilla(void) {
+    JsonTx j;
+    char clave[16];
+
+    if (!jsonIniciar(&j, 192)) return;
+
+    jsonCadena(&j, "type", "seed");
+    jsonSinSigno(&j, "seed", aleatorioSemilla());
+    for (int f = 0; f < ALEATORIO_NUM_FLUJOS; f++) {
+        snprintf(clave, sizeof(clave), "draws_%s", aleatorioNombreFlujo((FlujoAleatorio)f));
+        jsonSinSigno(&j, clave, aleatorioUsos((FlujoAleatorio)f));
+    }
+    jsonTerminar(&j);
+}
+
+// Estado del escenario cargado y de su traza
+void enviarEscenario(void) {
+    const Escenario *e = escenarioObtener();
+    JsonTx j;
+
+    if (!jsonIniciar(&j, 192)) return;
+
+    jsonCadena(&j, "type", "scenario_status");
+    jsonCadena(&j, "state", escenarioNombreEstado(escenarioEstado()));
+    jsonEntero(&j, "size", e->tamanio);
+    jsonEntero(&j, "restaurants", e->numRestaurantes);
+    jsonEntero(&j, "houses", e->numCasas);
+    jsonEntero(&j, "drivers", e->numRepartidores);
+    jsonEntero(&j, "orders", e->numPedidos);
+    jsonEntero(&j, "active", mundoEscenario);
+    jsonEntero(&j, "replayed", escenarioPedidosReproducidos());
+    jsonTerminar(&j);
+}
+
+// Un registro del escenario exportado, listo para volver a cargarse
+static void enviarLineaEscenario(const char *linea) {
+    JsonTx j;
+
+    if (!jsonIniciar(&j, 48 + (int)strlen(linea))) return;
+    jsonCadena(&j, "type", "scenario");
+    jsonCadena(&j, "line", linea);
+    jsonTerminar(&j);
+}
+
+// Exporta el mapa actual y sus pedidos como registros SCENARIO: la ciudad
+// con sus posiciones iniciales y la traza relativa al último arranque
+void exportarEscenario(void) {
+    char linea[128];
+    int n;
+
+    snprintf(linea, sizeof(linea), "SCENARIO,BEGIN,%d", sistema.avenidas);
+    enviarLineaEscenario(linea);
+
+    for (int r = 0; r < sistema.numRestaurantes; r++) {
+        const Restaurante *rest = &sistema.listaRestaurantes[r];
+
+        n = snprintf(linea, sizeof(linea), "SCENARIO,R,%d,%d,%c,%d",
+                     rest->posxy.posx, rest->posxy.posy, rest->direccion, rest->cantidadDeCambio);
+        for (int p = 0; p < rest->numPlatillos && p < MAX_MENU; p++) {
+            n += snprintf(linea + n, sizeof(linea) - n, ",%d",
+                          (int)(rest->menu[p].tiempoPreparacion * 100.0f + 0.5f));
+        }
+        enviarLineaEscenario(linea);
+    }
+
+    for (int c = 0; c < sistema.numCasas; c++) {
+        const Casa *casa = &sistema.listaCasas[c];
+
+        snprintf(linea, sizeof(linea), "SCENARIO,H,%d,%d,%c",
+                 casa->posxy.posx, casa->posxy.posy, casa->direccion);
+        enviarLineaEscenario(linea);
+    }
+
+    for (int m = 0; m < sistema.numRepartidores; m++) {
+        const Repartidor *rep = &sistema.listaRepartidores[m];
+
+        snprintf(linea, sizeof(linea), "SCENARIO,D,%d,%d,%d",
+                 rep->posxy.posx, rep->posxy.posy, (int)(rep->velocidad * 100.0f + 0.5f));
+        enviarLineaEscenario(linea);
+    }
+
+    // La traza debe ser no decreciente; lo anterior al arranque va a 0
+    uint32_t previo = 0;
+    for (int p = 0; p < sistema.numPedidos; p++) {
+        const Pedido *pedido = &sistema.listaPedidos[p];
+        int32_t ms = (int32_t)(pedido->t_creado - inicioCorrida);
+        uint32_t instante = ms > 0 ? (uint32_t)ms : 0;
+
+        if (instante < previo) instante = previo;
+        previo = instante;
+
+        n = snprintf(linea, sizeof(linea), "SCENARIO,O,%lu,%d,%d", (unsigned long)instante,
+                     pedido->idRestaurante + 1, pedido->idCasa + 1);
+        for (int k = 0; k < pedido->platillosCount && k < MAX_PLATILLOS; k++) {
+            n += snprintf(linea + n, sizeof(linea) - n, ",%d", pedido->platillos[k]);
+        }
+        enviarLineaEscenario(linea);
+    }
+
+    enviarLineaEscenario("SCENARIO,END");
+}
+
+// Envía un mensaje locks por grupo de cerrojos:
+// [indice, tomas, contenciones, timeouts, espera p50, p99, max, tenencia prom, max] (us)
+void enviarCerrojos(void) {
+    static const char tipos[] = { 'M', 'S', 'Q' };
+    int total = cerrojosCantidad();
+    int i = 0;
+
+    while (i < total) {
+        ResumenCerrojo r;
+        JsonTx j;
+
+        cerrojoResumir(i, &r);
+        const char *grupo = r.grupo;
+
+        if (!jsonIniciar(&j, 768)) return;
+        jsonCadena(&j, "type", "locks");
+        jsonCadena(&j, "group", grupo);
+        jsonCaracter(&j, "kind", tipos[r.tipo]);
+        jsonAbrirArreglo(&j, "locks");
+        do {
+            jsonAbrirArreglo(&j, NULL);
+            jsonEntero(&j, NULL, r.indice);
+            jsonSinSigno(&j, NULL, r.tomas);
+            jsonSinSigno(&j, NULL, r.contenciones);
+            jsonSinSigno(&j, NULL, r.timeouts);
+            jsonSinSigno(&j, NULL, r.esperaP50);
+            jsonSinSigno(&j, NULL, r.esperaP99);
+            jsonSinSigno(&j, NULL, r.esperaMax);
+            jsonSinSigno(&j, NULL, r.tenenciaPromedio);
+            jsonSinSigno(&j, NULL, r.tenenciaMax);
+            jsonCerrarArreglo(&j);
+        } while (++i < total && cerrojoResumir(i, &r) && r.grupo == grupo);
+        jsonCerrarArreglo(&j);
+        jsonTerminar(&j);
+    }
+}
+
+// Envía las sondas de duración: [etiqueta, llamadas, min, prom, max, p99]
+void enviarSondas(void) {
+#if SONDAS_HABILITADAS
+    JsonTx j;
+    if (!jsonIniciar(&j, UART_TX_MAX_REGISTRO)) return;
+
+    jsonCadena(&j, "type", "probes");
+    jsonCadena(&j, "unit", sondaUnidad());
+    jsonAbrirArreglo(&j, "probes");
+    for (int i = 0; i < NUM_SONDAS; i++) {
+        ResumenSonda r;
+        if (!sondaResumir((IdSonda)i, &r)) continue;
+
+        jsonAbrirArreglo(&j, NULL);
+        jsonCadena(&j, NULL, sondaEtiqueta((IdSonda)i));
+        jsonSinSigno(&j, NULL, r.llamadas);
+        jsonSinSigno(&j, NULL, r.min);
+        jsonSinSigno(&j, NULL, (uint32_t)(r.suma / r.llamadas));
+        jsonSinSigno(&j, NULL, r.max);
+        jsonSinSigno(&j, NULL, r.p99);
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+    jsonTerminar(&j);
+#else
+    printf("{\"type\":\"info\",\"msg\":\"Sondas deshabilitadas en compilacion\"}\r\n");
+#endif
+}
+
+// Cancela pedido y actualiza estados
+void cancelarPedido(const char* numeroRecibo) {
+    LOG(CANC_INICIO, numeroRecibo);
+
+    Pedido* pedido = buscarPedido(numeroRecibo);
+    if (pedido == NULL) {
+        LOG(CANC_NO_ENCONTRADO, numeroRecibo);
+        enviarEventoPedido("CANCEL_FAILED", numeroRecibo, NULL, -1, 0, 0);
+        return;
+    }
+
+    int idRestaurante = pedido->idRestaurante;
+    int idRepartidor = pedido->repartidorId;
+
+    LOG(CANC_ESTADO, pedido->estado);
+    LOG(CANC_REPARTIDOR, idRepartidor);
+    LOG(CANC_BANDERAS, pedido->asignado, pedido->enPreparacion, pedido->listo, pedido->enReparto);
+
+    // Remover de cola si aún no se preparó
     if (pedido->estado == CREADO) {
-        if (xSemaphoreTake(mutexRestaurantes[idRestaurante], pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (cerrojoTomar(mutexRestaurantes[idRestaurante], pdMS_TO_TICKS(100)) == pdTRUE) {
             Restaurante *rest = &sistema.listaRestaurantes[idRestaurante];
 
             int encontrado = -1;
@@ -2122,29 +2931,29 @@ void cancelarPedido(const char* numeroRecibo) {
                 }
                 rest->colaPedidosCount--;
 
-                printf("[Cancelador] Pedido removido de cola del restaurante (posición %d)\r\n", encontrado);
-                printf("[Cancelador] Nueva cola: %d pedidos\r\n", rest->colaPedidosCount);
+                LOG(CANC_REMOVIDO_COLA, encontrado);
+                LOG(CANC_NUEVA_COLA, rest->colaPedidosCount);
 
-                xSemaphoreGive(semCapacidadCola);
+                cerrojoLiberar(semCapacidadCola);
             }
 
-            xSemaphoreGive(mutexRestaurantes[idRestaurante]);
+            cerrojoLiberar(mutexRestaurantes[idRestaurante]);
         }
     }
 
     // Remover del repartidor
     if (pedido->asignado && idRepartidor >= 0 && idRepartidor < sistema.numRepartidores) {
-        if (xSemaphoreTake(mutexRepartidores[idRepartidor], pdMS_TO_TICKS(100)) == pdTRUE) {
+        if (cerrojoTomar(mutexRepartidores[idRepartidor], pdMS_TO_TICKS(100)) == pdTRUE) {
             Repartidor* rep = &sistema.listaRepartidores[idRepartidor];
 
             // No cancelar si está entregando
             if (rep->estado == ENTREGANDO && rep->bloqueado) {
-                printf("[Cancelador] NO SE PUEDE CANCELAR - Repartidor está entregando en la casa\r\n");
-                printf("[Cancelador] El pedido será entregado en unos segundos\r\n");
+                LOG(CANC_ENTREGANDO);
+                LOG(CANC_SERA_ENTREGADO);
 
-                xSemaphoreGive(mutexRepartidores[idRepartidor]);
+                cerrojoLiberar(mutexRepartidores[idRepartidor]);
 
-                enviarEventoPedido("CANCEL_REJECTED", numeroRecibo, NULL, NULL, 0, 0);
+                enviarEventoPedido("CANCEL_REJECTED", numeroRecibo, NULL, -1, 0, 0);
                 printf("{\"type\":\"warning\",\"msg\":\"Cancelación rechazada: El pedido está siendo entregado\"}\r\n");
                 return;
             }
@@ -2158,17 +2967,15 @@ void cancelarPedido(const char* numeroRecibo) {
             }
 
             if (encontrado != -1) {
-                printf("[Cancelador] Pedido encontrado en repartidor (índice %d de %d)\r\n",
-                       encontrado, rep->numPedidosAceptados);
+                LOG(CANC_EN_REPARTIDOR, encontrado, rep->numPedidosAceptados);
 
                 // Pedido actual
                 if (encontrado == rep->indicePedidoActual) {
-                    printf("[Cancelador] Era el pedido ACTUAL del repartidor\r\n");
-                    printf("[Cancelador] Estado del repartidor: %d | Bloqueado: %d\r\n",
-                           rep->estado, rep->bloqueado);
+                    LOG(CANC_ERA_ACTUAL);
+                    LOG(CANC_ESTADO_REP, rep->estado, rep->bloqueado);
 
                     if (rep->bloqueado) {
-                        printf("[Cancelador] Desbloqueando repartidor (estaba esperando)\r\n");
+                        LOG(CANC_DESBLOQUEO);
                         rep->bloqueado = 0;
                         rep->tiempoEspera = 0;
                     }
@@ -2178,8 +2985,7 @@ void cancelarPedido(const char* numeroRecibo) {
                     }
                     rep->numPedidosAceptados--;
 
-                    printf("[Cancelador] Pedido removido. Repartidor ahora tiene %d pedidos\r\n",
-                           rep->numPedidosAceptados);
+                    LOG(CANC_REMOVIDO_REP, rep->numPedidosAceptados);
 
                     int av, ca;
                     convertirUnificadoAAvCa(rep->posxyUnificado, &av, &ca);
@@ -2194,7 +3000,7 @@ void cancelarPedido(const char* numeroRecibo) {
                         Pedido* siguienteP = buscarPedido(siguienteRecibo);
 
                         if (siguienteP != NULL) {
-                            printf("[Cancelador] Cambiando a siguiente pedido %s\r\n", siguienteRecibo);
+                            LOG(CANC_SIGUIENTE, siguienteRecibo);
 
                             if (siguienteP->estado == RECOGIDO) {
                                 rep->estado = EN_CAMINO_A_DESTINO;
@@ -2210,12 +3016,11 @@ void cancelarPedido(const char* numeroRecibo) {
 
                             rep->enRuta = 1;
 
-                            printf("{\"type\":\"mov\",\"rep\":%d,\"av\":%d,\"ca\":%d,\"estado\":\"EN_RUTA_SIGUIENTE\"}\r\n",
-                                   idRepartidor, av, ca);
+                            flotaActualizar(idRepartidor, av, ca, MOV_EN_RUTA_SIGUIENTE);
                         }
                     } else {
                         // Desocupado
-                        printf("[Cancelador] Repartidor ahora DESOCUPADO (sin más pedidos)\r\n");
+                        LOG(CANC_DESOCUPADO);
                         rep->estado = DESOCUPADO;
                         rep->enRuta = 0;
                         rep->destino.posx = -1;
@@ -2223,13 +3028,12 @@ void cancelarPedido(const char* numeroRecibo) {
                         strcpy(rep->tipoDestino, "");
                         rep->fase = 0;
 
-                        printf("{\"type\":\"mov\",\"rep\":%d,\"av\":%d,\"ca\":%d,\"estado\":\"DESOCUPADO\"}\r\n",
-                                idRepartidor, av, ca);
+                        flotaActualizar(idRepartidor, av, ca, DESOCUPADO);
                     }
                 }
                 // Pedido en cola
                 else {
-                    printf("[Cancelador] Era pedido en cola (no actual), removiendo\r\n");
+                    LOG(CANC_EN_COLA_REP);
 
                     for (int i = encontrado; i < rep->numPedidosAceptados - 1; i++) {
                         strcpy(rep->pedidosAceptados[i], rep->pedidosAceptados[i + 1]);
@@ -2240,19 +3044,21 @@ void cancelarPedido(const char* numeroRecibo) {
                         rep->indicePedidoActual--;
                     }
 
-                    printf("[Cancelador] Pedido removido. Repartidor ahora tiene %d pedidos\r\n",
-                           rep->numPedidosAceptados);
+                    LOG(CANC_REMOVIDO_REP, rep->numPedidosAceptados);
                 }
             } else {
-                printf("[Cancelador] Pedido NO encontrado en repartidor (pero estaba asignado)\r\n");
+                LOG(CANC_NO_EN_REP);
             }
 
-            xSemaphoreGive(mutexRepartidores[idRepartidor]);
+            cerrojoLiberar(mutexRepartidores[idRepartidor]);
+            // Pudo dejar la espera o quedar libre para pasear
+            despertarRepartidores(1u << idRepartidor);
         }
     }
 
     // Marcar como cancelado
     pedido->estado = CANCELADO;
+    trazarPedido(pedido);
     pedido->asignado = 0;
     pedido->enPreparacion = 0;
     pedido->listo = 0;
@@ -2260,11 +3066,11 @@ void cancelarPedido(const char* numeroRecibo) {
     pedido->entregado = 0;
     pedido->repartidorId = -1;
 
-    printf("[Cancelador] Pedido marcado como CANCELADO\r\n");
+    LOG(CANC_MARCADO);
 
-    enviarEventoPedido("CANCELLED", numeroRecibo, NULL, NULL, 0, 0);
+    enviarEventoPedido("CANCELLED", numeroRecibo, NULL, -1, 0, 0);
 
-    printf("[Cancelador] ===== Cancelación completada =====\n\r\n");
+    LOG(CANC_FIN);
 }
 
 // Procesa cancelación desde web
@@ -2276,362 +3082,772 @@ void procesarCancelacionWeb(const char* numeroRecibo) {
     printf("{\"type\":\"success\",\"msg\":\"Pedido %s cancelado exitosamente\"}\r\n", numeroRecibo);
 }
 
-// Tarea de recepción de comandos por UART
-void StartTaskRx(void *argument)
-{
-    char line[256];
-    int index = 0;
-    uint8_t ch;
+/* Comandos UART -------------------------------------------------------------*/
 
-    for(;;)
-    {
-        if (xQueueReceive(queueRx, &ch, pdMS_TO_TICKS(100)) == pdPASS)
-        {
-            if (ch == '\n' || ch == '\r')
-            {
-                line[index] = '\0';
-
-                if (strlen(line) > 0)
-                {
-                    // Comando START
-                    if (strstr(line, "START"))
-                    {
-                        sistema.sistemaCorriendo = 1;
-                        printf("{\"type\":\"info\",\"msg\":\"Sistema iniciado\"}\r\n");
-                        HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET);
-                    }
-                    // Comando STOP
-                    else if (strstr(line, "STOP"))
-                    {
-                        sistema.sistemaCorriendo = 0;
-                        printf("{\"type\":\"info\",\"msg\":\"Sistema detenido\"}\r\n");
-                        HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
-                    }
-                    // Comando MAP
-                    else if (strstr(line, "MAP"))
-                    {
-                        if (sistemaInicializado) {
-                            enviarMapaCompleto();
-                            enviarMapaCombinado();
-                        } else {
-                            printf("{\"type\":\"warning\",\"msg\":\"Sistema no inicializado. Presiona el boton primero\"}\r\n");
-                        }
-                    }
-                    // Comando REGEN
-                    else if (strstr(line, "REGEN"))
-                    {
-                        uint32_t msg = 1;
-                        xQueueSend(queueButton, &msg, 0);
-                    }
-                    // Comando STATS
-                    else if (strstr(line, "STATS"))
-                    {
-                        enviarEstadisticas();
-                    }
-                    // Comando METRICS
-                    else if (strstr(line, "METRICS"))
-                    {
-                        enviarMetricasGlobales();
-                    }
-                    // Comando CANCELAR_PEDIDO
-                    else if (strstr(line, "CANCELAR_PEDIDO"))
-                    {
-                        char numeroRecibo[20];
-                        char cleanLine[256];
-                        int cleanIdx = 0;
-
-                        // Limpiar espacios
-                        for(int i = 0; i < strlen(line); i++) {
-                            if(line[i] != ' ' && line[i] != '\r' && line[i] != '\n' && line[i] != '\t') {
-                                cleanLine[cleanIdx++] = line[i];
-                            }
-                        }
-                        cleanLine[cleanIdx] = '\0';
+// Error uniforme para argumentos inválidos
+static void errorArgumento(const char *comando, const char *argumento, const char *valor) {
+    printf("{\"type\":\"error\",\"msg\":\"%s: %s invalido (%s)\"}\r\n", comando, argumento, valor);
+}
 
-                        printf("{\"type\":\"debug\",\"msg\":\"Línea limpia: %s\"}\r\n", cleanLine);
+// Crea un pedido de la web (ids ya validados, base 0) y lo encola en su
+// restaurante; devuelve el número de recibo o 0 si el sistema está lleno
+int registrarPedidoWeb(int restId, int casaId, const int *platillos, int platillosCount) {
+    if (sistema.numPedidos >= MAX_PEDIDOS) {
+        return 0;
+    }
 
-                        // Parsear: CANCELAR_PEDIDO,numeroRecibo
-                        char *ptr = cleanLine;
-                        ptr = strchr(ptr, ',');
+    int numero = contadorPedidos++;
 
-                        if(ptr) {
-                            ptr++;
-                            int idx = 0;
-                            while(*ptr && *ptr != '\0' && idx < sizeof(numeroRecibo) - 1) {
-                                numeroRecibo[idx++] = *ptr++;
-                            }
-                            numeroRecibo[idx] = '\0';
+    // Crear pedido
+    Pedido nuevoPedido;
 
-                            printf("{\"type\":\"debug\",\"msg\":\"Recibo parseado: %s\"}\r\n", numeroRecibo);
+    memset(&nuevoPedido, 0, sizeof(Pedido));
 
-                            if(strlen(numeroRecibo) > 0) {
-                                procesarCancelacionWeb(numeroRecibo);
-                            } else {
-                                printf("{\"type\":\"error\",\"msg\":\"Numero de recibo vacio\"}\r\n");
-                            }
-                        } else {
-                            printf("{\"type\":\"error\",\"msg\":\"Formato invalido CANCELAR_PEDIDO (sin coma)\"}\r\n");
-                        }
-                    }
-                    // Comando PEDIDO_WEB
-                    else if (strstr(line, "PEDIDO_WEB"))
-                    {
-                        int restId = -1, casaId = -1;
-                        int platillos[MAX_PLATILLOS];
-                        int platillosCount = 0;
-
-                        char cleanLine[256];
-                        int cleanIdx = 0;
-                        for(int i = 0; i < strlen(line); i++) {
-                            if(line[i] != ' ' && line[i] != '\r' && line[i] != '\n' && line[i] != '\t') {
-                                cleanLine[cleanIdx++] = line[i];
-                            }
-                        }
-                        cleanLine[cleanIdx] = '\0';
-
-                        // Parsear: PEDIDO_WEB,restId,casaId,platillo1,platillo2,...
-                        char *ptr = cleanLine;
-                        ptr = strchr(ptr, ',');
-                        if(!ptr) {
-                            printf("{\"type\":\"error\",\"msg\":\"Formato invalido\"}\r\n");
-                            goto pedido_web_end;
-                        }
-                        ptr++;
+    nuevoPedido.id = sistema.numPedidos;
+    nuevoPedido.idRestaurante = restId;
+    nuevoPedido.idCasa = casaId;
+    nuevoPedido.posRestaurante = sistema.listaRestaurantes[restId].posxyUnificado;
+    nuevoPedido.posCasa = sistema.listaCasas[casaId].posxyUnificado;
 
-                        restId = atoi(ptr) - 1;
-                        ptr = strchr(ptr, ',');
-                        if(!ptr) {
-                            printf("{\"type\":\"error\",\"msg\":\"Falta casa\"}\r\n");
-                            goto pedido_web_end;
-                        }
-                        ptr++;
+    snprintf(nuevoPedido.numeroRecibo, 20, "PED-%d", numero);
 
-                        casaId = atoi(ptr) - 1;
-                        ptr = strchr(ptr, ',');
-                        if(!ptr) {
-                            printf("{\"type\":\"error\",\"msg\":\"Faltan platillos\"}\r\n");
-                            goto pedido_web_end;
-                        }
-                        ptr++;
+    nuevoPedido.t_creado = relojAhora();
+    ventanasRegistrarPedido(nuevoPedido.t_creado);
+    nuevoPedido.t_inicioPrep = 0;
+    nuevoPedido.t_finPrep = 0;
+    nuevoPedido.t_asignado = 0;
+    nuevoPedido.t_recogido = 0;
+    nuevoPedido.t_entregado = 0;
+    nuevoPedido.metricsSent = 0;
 
-                        while(*ptr && platillosCount < MAX_PLATILLOS) {
-                            platillos[platillosCount++] = atoi(ptr);
-                            ptr = strchr(ptr, ',');
-                            if(!ptr) break;
-                            ptr++;
-                        }
+    nuevoPedido.asignado = 0;
+    nuevoPedido.enPreparacion = 0;
+    nuevoPedido.listo = 0;
+    nuevoPedido.enReparto = 0;
+    nuevoPedido.entregado = 0;
+    nuevoPedido.repartidorId = -1;
+    nuevoPedido.estado = CREADO;
+    nuevoPedido.platillosCount = platillosCount;
 
-                        // Validar datos
-                        if (restId < 0 || restId >= sistema.numRestaurantes) {
-                            printf("{\"type\":\"error\",\"msg\":\"Restaurante invalido: %d\"}\r\n", restId + 1);
-                            goto pedido_web_end;
-                        }
+    float tiempoTotal = 0.0f;
+    for (int i = 0; i < platillosCount; i++) {
+        nuevoPedido.platillos[i] = platillos[i];
+        tiempoTotal += sistema.listaRestaurantes[restId].menu[platillos[i]].tiempoPreparacion;
+    }
+    nuevoPedido.tiempoPreparacion = tiempoTotal;
+    nuevoPedido.tiempoInicioPreparacion = 0;
+    nuevoPedido.reintentosAsignacion = 0;
 
-                        if (casaId < 0 || casaId >= sistema.numCasas) {
-                            printf("{\"type\":\"error\",\"msg\":\"Casa invalida: %d\"}\r\n", casaId + 1);
-                            goto pedido_web_end;
-                        }
+    sistema.listaPedidos[sistema.numPedidos] = nuevoPedido;
+    trazarPedido(&sistema.listaPedidos[sistema.numPedidos]);
 
-                        if (platillosCount == 0) {
-                            printf("{\"type\":\"error\",\"msg\":\"Sin platillos\"}\r\n");
-                            goto pedido_web_end;
-                        }
+    enviarEventoPedido("ORDER_CREATED", nuevoPedido.numeroRecibo, NULL, (int)(tiempoTotal * 100.0f), restId + 1, casaId + 1);
 
-                        if (sistema.numPedidos >= MAX_PEDIDOS) {
-                            printf("{\"type\":\"error\",\"msg\":\"Sistema lleno (%d/%d pedidos)\"}\r\n",
-                                   sistema.numPedidos, MAX_PEDIDOS);
-                            goto pedido_web_end;
-                        }
+    // Agregar a cola del restaurante
+    if (cerrojoTomar(mutexRestaurantes[restId], pdMS_TO_TICKS(100)) == pdTRUE) {
+        Restaurante *rest = &sistema.listaRestaurantes[restId];
 
-                        // Crear pedido
-                        Pedido nuevoPedido;
-
-                        memset(&nuevoPedido, 0, sizeof(Pedido));
-
-                        nuevoPedido.id = sistema.numPedidos;
-                        nuevoPedido.idRestaurante = restId;
-                        nuevoPedido.idCasa = casaId;
-                        nuevoPedido.posRestaurante = sistema.listaRestaurantes[restId].posxyUnificado;
-                        nuevoPedido.posCasa = sistema.listaCasas[casaId].posxyUnificado;
-
-                        snprintf(nuevoPedido.numeroRecibo, 20, "PED-%d", contadorPedidos++);
-
-                        nuevoPedido.t_creado = HAL_GetTick();
-                        nuevoPedido.t_inicioPrep = 0;
-                        nuevoPedido.t_finPrep = 0;
-                        nuevoPedido.t_asignado = 0;
-                        nuevoPedido.t_recogido = 0;
-                        nuevoPedido.t_entregado = 0;
-                        nuevoPedido.metricsSent = 0;
-
-                        nuevoPedido.asignado = 0;
-                        nuevoPedido.enPreparacion = 0;
-                        nuevoPedido.listo = 0;
-                        nuevoPedido.enReparto = 0;
-                        nuevoPedido.entregado = 0;
-                        nuevoPedido.repartidorId = -1;
-                        nuevoPedido.estado = CREADO;
-                        nuevoPedido.platillosCount = platillosCount;
-
-                        float tiempoTotal = 0.0f;
-                        for (int i = 0; i < platillosCount; i++) {
-                            nuevoPedido.platillos[i] = platillos[i];
-                            if (platillos[i] < sistema.listaRestaurantes[restId].numPlatillos) {
-                                tiempoTotal += sistema.listaRestaurantes[restId].menu[platillos[i]].tiempoPreparacion;
-                            }
-                        }
-                        nuevoPedido.tiempoPreparacion = tiempoTotal;
-                        nuevoPedido.tiempoInicioPreparacion = 0;
-                        nuevoPedido.reintentosAsignacion = 0;
+        if (rest->colaPedidosCount < MAX_PEDIDOS) {
+            rest->colaPedidos[rest->colaPedidosCount] = sistema.numPedidos;
+            rest->colaPedidosCount++;
+        }
 
-                        sistema.listaPedidos[sistema.numPedidos] = nuevoPedido;
+        cerrojoLiberar(mutexRestaurantes[restId]);
+    }
 
-                        char tiempoStr[16];
-                        floatToStr(tiempoTotal, tiempoStr, 16);
+    colaEnviar(queuePedidos, &sistema.numPedidos, 0);
+    sistema.numPedidos++;
 
-                        enviarEventoPedido("ORDER_CREATED", nuevoPedido.numeroRecibo, NULL, tiempoStr, restId + 1, casaId + 1);
+    return numero;
+}
 
-                        // Agregar a cola del restaurante
-                        if (xSemaphoreTake(mutexRestaurantes[restId], pdMS_TO_TICKS(100)) == pdTRUE) {
-                            Restaurante *rest = &sistema.listaRestaurantes[restId];
+// Valida los campos de un pedido web (restId, casaId, platillo...; ids de la
+// web en base 1); devuelve el nombre del campo inválido o NULL
+static const char *parsearPedidoWeb(char *const *campos, int n, int *campoMalo,
+                                    int *restId, int *casaId, int *platillos, int *platillosCount) {
+    int32_t valor;
 
-                            if (rest->colaPedidosCount < MAX_PEDIDOS) {
-                                rest->colaPedidos[rest->colaPedidosCount] = sistema.numPedidos;
-                                rest->colaPedidosCount++;
-                            }
+    *campoMalo = 0;
+    if (n < 3 || n > 2 + MAX_PLATILLOS) return "platillos";
 
-                            xSemaphoreGive(mutexRestaurantes[restId]);
-                        }
+    if (!cmdArgEntero(campos[0], 1, sistema.numRestaurantes, &valor)) return "restaurante";
+    *restId = valor - 1;
 
-                        xQueueSend(queuePedidos, &sistema.numPedidos, 0);
-                        sistema.numPedidos++;
+    *campoMalo = 1;
+    if (!cmdArgEntero(campos[1], 1, sistema.numCasas, &valor)) return "casa";
+    *casaId = valor - 1;
 
-                        printf("{\"type\":\"success\",\"msg\":\"Pedido %s creado (en cola del restaurante)\"}\r\n",
-                               nuevoPedido.numeroRecibo);
+    *platillosCount = 0;
+    for (int i = 2; i < n; i++) {
+        *campoMalo = i;
+        if (!cmdArgEntero(campos[i], 0, sistema.listaRestaurantes[*restId].numPlatillos - 1, &valor)) {
+            return "platillo";
+        }
+        platillos[(*platillosCount)++] = valor;
+    }
 
-                        pedido_web_end:
-                        ;
-                    }
-                    // Comando PEDIDO
-                    else if (strstr(line, "PEDIDO"))
-                    {
-                        crearPedidoAleatorio();
-                    }
-                    // Comando INFO
-                    else if (strstr(line, "INFO"))
-                    {
-                        printf("{\"type\":\"info\",\"msg\":\"Pedidos: %d, Rest: %d, Casas: %d, Reps: %d\"}\r\n",
-                               sistema.numPedidos, sistema.numRestaurantes,
-                               sistema.numCasas, sistema.numRepartidores);
-                    }
-                    // Comando HELP
-                    else if (strstr(line, "HELP"))
-                    {
-                        printf("{\"type\":\"info\",\"msg\":\"Comandos: START STOP MAP REGEN PEDIDO STATS METRICS INFO CANCELAR_PEDIDO HELP\"}\r\n");
-                    }
-                }
+    return NULL;
+}
 
-                index = 0;
-            }
-            else if (index < sizeof(line) - 1)
-            {
-                line[index++] = ch;
+static void cmdStart(const ArgsCmd *args) {
+    if (!sistema.sistemaCorriendo) reiniciarFlujosCorrida();
+    sistema.sistemaCorriendo = 1;
+    despertarRepartidores(TODOS_LOS_REPARTIDORES);
+    printf("{\"type\":\"info\",\"msg\":\"Sistema iniciado\"}\r\n");
+    HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_SET);
+}
+
+static void cmdStop(const ArgsCmd *args) {
+    sistema.sistemaCorriendo = 0;
+    printf("{\"type\":\"info\",\"msg\":\"Sistema detenido\"}\r\n");
+    HAL_GPIO_WritePin(GPIOA, GPIO_PIN_5, GPIO_PIN_RESET);
+}
+
+static void cmdMap(const ArgsCmd *args) {
+    if (sistemaInicializado) {
+        enviarMapaCompleto();
+        enviarMapaCombinado();
+    } else {
+        printf("{\"type\":\"warning\",\"msg\":\"Sistema no inicializado. Presiona el boton primero\"}\r\n");
+    }
+}
+
+static void cmdRegen(const ArgsCmd *args) {
+    uint32_t msg = 1;
+    colaEnviar(queueButton, &msg, 0);
+}
+
+static void cmdTxStats(const ArgsCmd *args) {
+    enviarEstadisticasTx();
+}
+
+static void cmdRxStats(const ArgsCmd *args) {
+    enviarEstadisticasRx();
+}
+
+// TXMODO[,BLOQUEAR|DESCARTAR]
+static void cmdTxModo(const ArgsCmd *args) {
+    static const char *const modos[] = { "DESCARTAR", "BLOQUEAR" };
+    int modo;
+
+    if (args->argc > 1) {
+        if (!cmdArgOpcion(args->argv[1], modos, 2, &modo)) {
+            errorArgumento("TXMODO", "modo", args->argv[1]);
+            return;
+        }
+        uartTxSetModo(modo == 0 ? UART_TX_DESCARTAR : UART_TX_BLOQUEAR);
+    }
+    enviarEstadisticasTx();
+}
+
+// FORMATO[,BIN|JSON]
+static void cmdFormato(const ArgsCmd *args) {
+    static const char *const formatos[] = { "JSON", "BIN" };
+    int formato;
+
+    if (args->argc > 1) {
+        if (!cmdArgOpcion(args->argv[1], formatos, 2, &formato)) {
+            errorArgumento("FORMATO", "formato", args->argv[1]);
+            return;
+        }
+        telemetriaSetFormato(formato == 1 ? TELEMETRIA_BINARIA : TELEMETRIA_JSON);
+    }
+    printf("{\"type\":\"info\",\"msg\":\"Formato telemetria: %s (v%d)\"}\r\n",
+           telemetriaBinaria() ? "BIN" : "JSON", TEL_VERSION);
+}
+
+static void cmdStats(const ArgsCmd *args) {
+    enviarEstadisticas();
+}
+
+static void cmdMetrics(const ArgsCmd *args) {
+    enviarMetricasGlobales();
+}
+
+// PROFILE[,segundos]: envía task_stats y opcionalmente cambia el periodo
+static void cmdProfile(const ArgsCmd *args) {
+    int32_t segundos;
+
+    if (args->argc == 2) {
+        if (!cmdArgEntero(args->argv[1], 0, 3600, &segundos)) {
+            errorArgumento("PROFILE", "segundos", args->argv[1]);
+            return;
+        }
+        periodoPerfil = (uint32_t)segundos * 1000u;
+    }
+    perfilEnviarEstadisticas();
+}
+
+// PROBES[,RESET]: envía las sondas; RESET las vacía después
+static void cmdProbes(const ArgsCmd *args) {
+    static const char *const opciones[] = { "RESET" };
+    int opcion;
+
+    if (args->argc == 2 && !cmdArgOpcion(args->argv[1], opciones, 1, &opcion)) {
+        errorArgumento("PROBES", "opcion", args->argv[1]);
+        return;
+    }
+    enviarSondas();
+#if SONDAS_HABILITADAS
+    if (args->argc == 2) sondasReiniciar();
+#endif
+}
+
+// LOCKS[,RESET]: envía los contadores de cerrojos; RESET los pone a cero después
+static void cmdLocks(const ArgsCmd *args) {
+    static const char *const opciones[] = { "RESET" };
+    int opcion;
+
+    if (args->argc == 2 && !cmdArgOpcion(args->argv[1], opciones, 1, &opcion)) {
+        errorArgumento("LOCKS", "opcion", args->argv[1]);
+        return;
+    }
+    enviarCerrojos();
+    if (args->argc == 2) cerrojosReiniciar();
+}
+
+// CLOCK[,REAL|VIRTUAL]: cambia el modo del reloj (virtual solo en host)
+static void cmdClock(const ArgsCmd *args) {
+    static const char *const modos[] = { "REAL", "VIRTUAL" };
+    int modo;
+
+    if (args->argc > 1) {
+        if (!cmdArgOpcion(args->argv[1], modos, 2, &modo)) {
+            errorArgumento("CLOCK", "modo", args->argv[1]);
+            return;
+        }
+        if (!relojFijarModo(modo == 1 ? RELOJ_VIRTUAL : RELOJ_REAL)) {
+            printf("{\"type\":\"error\",\"msg\":\"Reloj virtual solo en el simulador de host\"}\r\n");
+            return;
+        }
+        relojReiniciarEstadisticas();
+    }
+    enviarReloj();
+}
+
+// ROAM[,ON|OFF]: paseo al azar de los repartidores libres. Apagado, la
+// flota sin pedidos queda quieta y la tarea de movimiento puede dormir
+static void cmdRoam(const ArgsCmd *args) {
+    static const char *const opciones[] = { "OFF", "ON" };
+    int opcion;
+
+    if (args->argc > 1) {
+        if (!cmdArgOpcion(args->argv[1], opciones, 2, &opcion)) {
+            errorArgumento("ROAM", "modo", args->argv[1]);
+            return;
+        }
+        paseoLibre = opcion;
+        if (paseoLibre) despertarRepartidores(TODOS_LOS_REPARTIDORES);
+    }
+    printf("{\"type\":\"info\",\"msg\":\"Paseo de repartidores libres: %s\"}\r\n",
+           paseoLibre ? "ON" : "OFF");
+}
+
+// LOAD: sin argumentos informa; si no, cambia el generador de carga
+//   OFF | WEB | POISSON,porHora | RUSH,porHora[,periodoS]
+//   BURST,porHora,rafagasPorHora,tamRafaga | CURVE,p1,p2,... (%)
+//   SKEW,zipfRest[,zipfPlatillo] (x100) | MIX,w1[,w2...]
+//   SEED,n (semilla propia del flujo de carga; 0 = la de corrida)
+static void cmdLoad(const ArgsCmd *args) {
+    static const char *const opciones[] = {
+        "OFF", "WEB", "POISSON", "RUSH", "BURST", "CURVE", "SKEW", "MIX", "SEED"
+    };
+    // Argumentos numéricos mínimos y máximos de cada opción
+    static const uint8_t minArgs[] = { 0, 0, 1, 1, 3, 2, 1, 1, 1 };
+    static const uint8_t maxArgs[] = { 0, 0, 1, 2, 3, CARGA_TRAMOS, 2, CARGA_MAX_MEZCLA, 1 };
+    int32_t valores[CARGA_TRAMOS];
+    ConfigCarga c;
+    int opcion;
+
+    if (args->argc == 1) {
+        enviarCarga();
+        return;
+    }
+    if (!cmdArgOpcion(args->argv[1], opciones, 9, &opcion)) {
+        errorArgumento("LOAD", "opcion", args->argv[1]);
+        return;
+    }
+
+    int n = args->argc - 2;
+    if (n < minArgs[opcion] || n > maxArgs[opcion]) {
+        errorArgumento("LOAD", "argumentos", args->argv[1]);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        if (!cmdArgEntero(args->argv[2 + i], 0, 1000000, &valores[i])) {
+            errorArgumento("LOAD", "valor", args->argv[2 + i]);
+            return;
+        }
+    }
+
+    cargaObtenerConfig(&c);
+    switch (opcion) {
+        case 0: c.modo = CARGA_APAGADA; break;
+        case 1: c.modo = CARGA_WEB; break;
+        case 2:
+            c.modo = CARGA_POISSON;
+            c.porHora = valores[0];
+            break;
+        case 3:
+            c.modo = CARGA_HORA_PICO;
+            c.porHora = valores[0];
+            if (n > 1 && valores[1] > 0) c.periodoS = valores[1];
+            break;
+        case 4:
+            c.modo = CARGA_RAFAGAS;
+            c.porHora = valores[0];
+            c.rafagasPorHora = valores[1];
+            c.tamRafaga = valores[2];
+            break;
+        case 5:
+            c.tramos = n;
+            for (int i = 0; i < n; i++) c.curva[i] = valores[i] > 0xFFFF ? 0xFFFF : valores[i];
+            break;
+        case 6:
+            c.zipfRestaurante = valores[0] > 0xFFFF ? 0xFFFF : valores[0];
+            if (n > 1) c.zipfPlatillo = valores[1] > 0xFFFF ? 0xFFFF : valores[1];
+            break;
+        case 7:
+            c.mezclaCount = n;
+            for (int i = 0; i < n; i++) c.mezcla[i] = valores[i] > 0xFF ? 0xFF : valores[i];
+            break;
+        default:
+            c.semilla = valores[0];
+            break;
+    }
+
+    // StartTaskTx (más prioritaria) usa el generador: no debe verlo a medias
+    taskENTER_CRITICAL();
+    cargaConfigurar(&c, relojAhora());
+    taskEXIT_CRITICAL();
+
+    enviarCarga();
+}
+
+// SCENARIO: sin argumentos informa; EXPORT vuelca el mapa actual, CLEAR
+// vuelve al mapa aleatorio y el resto son registros (ver escenario.h). El
+// escenario se aplica con REGEN y su traza corre desde el arranque
+static void cmdScenario(const ArgsCmd *args) {
+    int campoMalo;
+
+    if (args->argc == 1) {
+        enviarEscenario();
+        return;
+    }
+    if (strcmp(args->argv[1], "EXPORT") == 0) {
+        exportarEscenario();
+        return;
+    }
+
+    // La traza en curso lee el escenario: no se reescribe con el sistema andando
+    if (sistema.sistemaCorriendo) {
+        printf("{\"type\":\"error\",\"msg\":\"SCENARIO: detener el sistema (STOP) antes de cargar\"}\r\n");
+        return;
+    }
+
+    if (strcmp(args->argv[1], "CLEAR") == 0) {
+        escenarioIniciar();
+        enviarEscenario();
+        return;
+    }
+
+    const char *motivo = escenarioProcesar(&args->argv[1], args->argc - 1, &campoMalo);
+    if (motivo != NULL) {
+        errorArgumento("SCENARIO", motivo, args->argv[1 + campoMalo]);
+        return;
+    }
+
+    // Un acuse por escenario, no por registro
+    if (escenarioEstado() == ESCENARIO_LISTO) {
+        enviarEscenario();
+    }
+}
+
+// SEED[,n]: sin argumentos informa; si no, fija la semilla de corrida y
+// reinicia todos los flujos. El próximo REGEN sale de esa semilla
+static void cmdSeed(const ArgsCmd *args) {
+    int32_t semilla;
+
+    if (args->argc == 1) {
+        enviarSemilla();
+        return;
+    }
+    if (!cmdArgEntero(args->argv[1], 0, 0x7FFFFFFF, &semilla)) {
+        errorArgumento("SEED", "semilla", args->argv[1]);
+        return;
+    }
+    // A mitad de corrida cortaría las secuencias de las otras tareas
+    if (sistema.sistemaCorriendo) {
+        printf("{\"type\":\"error\",\"msg\":\"SEED: detener el sistema (STOP) antes de cambiar la semilla\"}\r\n");
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    aleatorioSembrar((uint32_t)semilla);
+    taskEXIT_CRITICAL();
+
+    enviarSemilla();
+}
+
+// TRACE[,START|STOP|DUMP]: controla la traza del scheduler; sin argumento
+// informa el estado
+static void cmdTrace(const ArgsCmd *args) {
+#if TRAZA_HABILITADA
+    static const char *const opciones[] = { "START", "STOP", "DUMP" };
+    int opcion;
+
+    if (args->argc == 1) {
+        trazaEnviarEstado();
+        return;
+    }
+    if (!cmdArgOpcion(args->argv[1], opciones, 3, &opcion)) {
+        errorArgumento("TRACE", "opcion", args->argv[1]);
+        return;
+    }
+    if (opcion == 0) trazaArrancar();
+    else if (opcion == 1) trazaDetener();
+    else trazaVolcar();
+
+    if (opcion != 2) trazaEnviarEstado();
+#else
+    printf("{\"type\":\"info\",\"msg\":\"Traza deshabilitada en compilacion\"}\r\n");
+#endif
+}
+
+// ENTITY_METRICS[,REST|DRIVER]
+static void cmdEntityMetrics(const ArgsCmd *args) {
+    static const char *const opciones[] = { "REST", "DRIVER" };
+    int opcion;
+
+    if (args->argc == 1) {
+        enviarMetricasEntidades(ENTIDAD_RESTAURANTE | ENTIDAD_REPARTIDOR);
+        return;
+    }
+    if (!cmdArgOpcion(args->argv[1], opciones, 2, &opcion)) {
+        errorArgumento("ENTITY_METRICS", "tipo", args->argv[1]);
+        return;
+    }
+    enviarMetricasEntidades(opcion == 0 ? ENTIDAD_RESTAURANTE : ENTIDAD_REPARTIDOR);
+}
+
+// CANCELAR_PEDIDO,numeroRecibo
+static void cmdCancelarPedido(const ArgsCmd *args) {
+    const char *numeroRecibo;
+
+    if (!cmdArgTexto(args->argv[1], 19, &numeroRecibo)) {
+        errorArgumento("CANCELAR_PEDIDO", "recibo", args->argv[1]);
+        return;
+    }
+
+    procesarCancelacionWeb(numeroRecibo);
+}
+
+// PEDIDO_WEB,restId,casaId,platillo1,platillo2,...
+static void cmdPedidoWeb(const ArgsCmd *args) {
+    int restId, casaId, campoMalo;
+    int platillos[MAX_PLATILLOS];
+    int platillosCount;
+
+    const char *motivo = parsearPedidoWeb(&args->argv[1], args->argc - 1, &campoMalo,
+                                          &restId, &casaId, platillos, &platillosCount);
+    if (motivo != NULL) {
+        errorArgumento("PEDIDO_WEB", motivo, args->argv[1 + campoMalo]);
+        return;
+    }
+
+    int numero = registrarPedidoWeb(restId, casaId, platillos, platillosCount);
+
+    if (numero == 0) {
+        printf("{\"type\":\"error\",\"msg\":\"Sistema lleno (%d/%d pedidos)\"}\r\n",
+               sistema.numPedidos, MAX_PEDIDOS);
+        return;
+    }
+
+    printf("{\"type\":\"success\",\"msg\":\"Pedido PED-%d creado (en cola del restaurante)\"}\r\n", numero);
+}
+
+// PEDIDOS_WEB,lote,rest:casa:p1/p2/...,rest:casa:p1,...
+// Un solo acuse por lote: "r" trae el recibo de cada pedido en orden
+// (0 = rechazado) y "rej" el motivo de cada rechazo
+static void cmdPedidosWeb(const ArgsCmd *args) {
+    int32_t lote;
+    int recibos[CMD_MAX_TOKENS];
+    const char *motivos[CMD_MAX_TOKENS];
+    int n = args->argc - 2;
+    int aceptados = 0;
+
+    if (!cmdArgEntero(args->argv[1], 0, 0x7FFFFFFF, &lote)) {
+        errorArgumento("PEDIDOS_WEB", "lote", args->argv[1]);
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        char *partes[3];
+        char *campos[2 + MAX_PLATILLOS];
+        int restId, casaId, campoMalo;
+        int platillos[MAX_PLATILLOS];
+        int platillosCount;
+
+        recibos[i] = 0;
+        motivos[i] = NULL;
+
+        if (cmdPartir(args->argv[2 + i], ':', partes, 3) != 3) {
+            motivos[i] = "formato";
+            continue;
+        }
+
+        campos[0] = partes[0];
+        campos[1] = partes[1];
+        int numPlatillos = cmdPartir(partes[2], '/', &campos[2], MAX_PLATILLOS);
+        if (numPlatillos < 0) {
+            motivos[i] = "platillos";
+            continue;
+        }
+
+        motivos[i] = parsearPedidoWeb(campos, 2 + numPlatillos, &campoMalo,
+                                      &restId, &casaId, platillos, &platillosCount);
+        if (motivos[i] != NULL) continue;
+
+        recibos[i] = registrarPedidoWeb(restId, casaId, platillos, platillosCount);
+        if (recibos[i] == 0) {
+            motivos[i] = "lleno";
+        } else {
+            aceptados++;
+        }
+    }
+
+    JsonTx j;
+    jsonIniciar(&j, 96 + n * 24);
+    jsonCadena(&j, "type", "batch_ack");
+    jsonSinSigno(&j, "batch", (uint32_t)lote);
+    jsonEntero(&j, "accepted", aceptados);
+    jsonAbrirArreglo(&j, "r");
+    for (int i = 0; i < n; i++) {
+        jsonEntero(&j, NULL, recibos[i]);
+    }
+    jsonCerrarArreglo(&j);
+    jsonAbrirArreglo(&j, "rej");
+    for (int i = 0; i < n; i++) {
+        if (motivos[i] == NULL) continue;
+        jsonAbrirArreglo(&j, NULL);
+        jsonEntero(&j, NULL, i);
+        jsonCadena(&j, NULL, motivos[i]);
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+    jsonTerminar(&j);
+}
+
+static void cmdPedido(const ArgsCmd *args) {
+    crearPedidoAleatorio();
+}
+
+static void cmdInfo(const ArgsCmd *args) {
+    printf("{\"type\":\"info\",\"msg\":\"Pedidos: %d, Rest: %d, Casas: %d, Reps: %d\"}\r\n",
+           sistema.numPedidos, sistema.numRestaurantes,
+           sistema.numCasas, sistema.numRepartidores);
+}
+
+static void cmdHelp(const ArgsCmd *args) {
+    char lista[TAM_LISTA_HELP];
+    int completa = comandosListar(lista, sizeof(lista)) >= 0;
+
+    printf("{\"type\":\"info\",\"msg\":\"Comandos: %s%s\"}\r\n", lista, completa ? "" : " ...");
+    if (!completa) {
+        printf("{\"type\":\"warning\",\"msg\":\"HELP: la lista no entra en %d bytes\"}\r\n",
+               TAM_LISTA_HELP);
+    }
+}
+
+// Comandos aceptados por StartTaskRx (el orden solo afecta a HELP)
+static const Comando tablaComandosRx[] = {
+    { "START",           cmdStart,          0, 0,                 "" },
+    { "STOP",            cmdStop,           0, 0,                 "" },
+    { "MAP",             cmdMap,            0, 0,                 "" },
+    { "REGEN",           cmdRegen,          0, 0,                 "" },
+    { "PEDIDO",          cmdPedido,         0, 0,                 "" },
+    { "PEDIDO_WEB",      cmdPedidoWeb,      3, 2 + MAX_PLATILLOS, "restId,casaId,platillo..." },
+    { "PEDIDOS_WEB",     cmdPedidosWeb,     2, CMD_MAX_TOKENS - 1, "lote,rest:casa:p1/p2...,..." },
+    { "CANCELAR_PEDIDO", cmdCancelarPedido, 1, 1,                 "recibo" },
+    { "STATS",           cmdStats,          0, 0,                 "" },
+    { "METRICS",         cmdMetrics,        0, 0,                 "" },
+    { "ENTITY_METRICS",  cmdEntityMetrics,  0, 1,                 "[REST|DRIVER]" },
+    { "PROFILE",         cmdProfile,        0, 1,                 "[segundos]" },
+    { "PROBES",          cmdProbes,         0, 1,                 "[RESET]" },
+    { "LOCKS",           cmdLocks,          0, 1,                 "[RESET]" },
+    { "TRACE",           cmdTrace,          0, 1,                 "[START|STOP|DUMP]" },
+    { "CLOCK",           cmdClock,          0, 1,                 "[REAL|VIRTUAL]" },
+    { "ROAM",            cmdRoam,           0, 1,                 "[ON|OFF]" },
+    { "LOAD",            cmdLoad,           0, CMD_MAX_TOKENS - 1, "[OFF|WEB|POISSON|RUSH|BURST|CURVE|SKEW|MIX|SEED,...]" },
+    { "SCENARIO",        cmdScenario,       0, CMD_MAX_TOKENS - 1, "[EXPORT|CLEAR|BEGIN|R|H|D|O|END,...]" },
+    { "SEED",            cmdSeed,           0, 1,                 "[semilla]" },
+    { "INFO",            cmdInfo,           0, 0,                 "" },
+    { "TXSTATS",         cmdTxStats,        0, 0,                 "" },
+    { "RXSTATS",         cmdRxStats,        0, 0,                 "" },
+    { "TXMODO",          cmdTxModo,         0, 1,                 "[BLOQUEAR|DESCARTAR]" },
+    { "FORMATO",         cmdFormato,        0, 1,                 "[BIN|JSON]" },
+    { "HELP",            cmdHelp,           0, 0,                 "" },
+};
+
+void registrarComandosRx(void) {
+    comandosRegistrar(tablaComandosRx, sizeof(tablaComandosRx) / sizeof(tablaComandosRx[0]));
+}
+
+// Ejecuta un comando de texto y reporta los errores de sintaxis
+static void ejecutarComando(char *texto) {
+    ArgsCmd args;
+    const Comando *cmd;
+
+    switch (comandosDespachar(texto, &args, &cmd))
+    {
+        case CMD_DESCONOCIDO:
+            printf("{\"type\":\"error\",\"msg\":\"Comando desconocido: %s\"}\r\n", args.argv[0]);
+            break;
+        case CMD_FALTAN_ARGS:
+        case CMD_SOBRAN_ARGS:
+            printf("{\"type\":\"error\",\"msg\":\"Uso: %s,%s\"}\r\n", cmd->nombre, cmd->uso);
+            break;
+        default:
+            break;
+    }
+}
+
+// Tarea de recepción de comandos por UART
+void StartTaskRx(void *argument)
+{
+    LineaRx linea;
+
+    for(;;)
+    {
+        // Cada línea llega completa y terminada en '\0' dentro del anillo de DMA
+        if (uartRxSiguienteLinea(&linea, 100))
+        {
+            if (linea.binaria) {
+                // Canal confiable: NULL si la trama es inválida, repetida o
+                // llegó antes de su turno; detrás salen los retenidos
+                char *texto = canalCmdProcesarTrama((uint8_t *)linea.datos, linea.len);
+                while (texto != NULL) {
+                    ejecutarComando(texto);
+                    texto = canalCmdSiguiente();
+                }
+            } else {
+                ejecutarComando(linea.datos);
             }
         }
     }
 }
 
-// Tarea de movimiento de repartidores
+// Tarea de movimiento de repartidores. Solo recorre el conjunto activo:
+// los pasos van en una grilla fija de PERIODO_MOVIMIENTO_MS (vTaskDelayUntil,
+// sin deriva) y entre pasos se despierta justo al vencer el plazo de quien
+// recoge o entrega. Sin nadie que se mueva duerme hasta el próximo plazo o
+// hasta que otra tarea le avise con despertarRepartidores
 void StartTaskRepartidores(void *argument)
 {
-    uint32_t lastMove = 0;
+    const TickType_t periodo = (TickType_t)relojMsATicks(PERIODO_MOVIMIENTO_MS);
+    uint32_t activos = TODOS_LOS_REPARTIDORES;
+    uint32_t avisos;
+    TickType_t referencia = xTaskGetTickCount();
+    TickType_t proximoPaso = referencia + periodo;
+    int hayMovimiento = 0;
+
+    tareaRepartidores = xTaskGetCurrentTaskHandle();
 
     for(;;)
     {
-        if (sistema.sistemaCorriendo && sistemaInicializado) {
+        // Avisos que llegaron mientras dormía o durante el paso anterior
+        if (xTaskNotifyWait(0, UINT32_MAX, &avisos, 0) == pdTRUE) {
+            activos |= avisos;
+        }
 
-            if ((HAL_GetTick() - lastMove) > 500) {
-                lastMove = HAL_GetTick();
+        if (!sistema.sistemaCorriendo || !sistemaInicializado) {
+            // Detenido: nada se mueve hasta START o REGEN
+            xTaskNotifyWait(0, UINT32_MAX, &avisos, portMAX_DELAY);
+            activos |= avisos;
+            hayMovimiento = 0;
+            continue;
+        }
 
-                for (int i = 0; i < sistema.numRepartidores; i++) {
-                    if (xSemaphoreTake(mutexRepartidores[i], pdMS_TO_TICKS(10)) == pdTRUE) {
-                        Repartidor *rep = &sistema.listaRepartidores[i];
+        int numRep = sistema.numRepartidores;
+        activos &= (numRep >= 32) ? UINT32_MAX : ((1u << numRep) - 1u);
 
-                        if (rep->enRuta) {
-                            xSemaphoreGive(mutexRepartidores[i]);
-                            moverRepartidor(i);
-                        }
-                        else if (rep->numPedidosAceptados == 0 && rep->estado == DESOCUPADO) {
-                            // Movimiento aleatorio
-                            int x = rep->posxyUnificado.posx;
-                            int y = rep->posxyUnificado.posy;
-
-                            Posicion movimientos[4];
-                            int numMovimientos = 0;
-
-                            // Verificar 4 direcciones
-                            if (x - 1 >= 0 && sistema.mapaUnificado[x - 1][y] == 'o') {
-                                movimientos[numMovimientos].posx = x - 1;
-                                movimientos[numMovimientos].posy = y;
-                                numMovimientos++;
-                            }
-                            if (x + 1 < sistema.tamanioUnificado && sistema.mapaUnificado[x + 1][y] == 'o') {
-                                movimientos[numMovimientos].posx = x + 1;
-                                movimientos[numMovimientos].posy = y;
-                                numMovimientos++;
-                            }
-                            if (y - 1 >= 0 && sistema.mapaUnificado[x][y - 1] == 'o') {
-                                movimientos[numMovimientos].posx = x;
-                                movimientos[numMovimientos].posy = y - 1;
-                                numMovimientos++;
-                            }
-                            if (y + 1 < sistema.tamanioUnificado && sistema.mapaUnificado[x][y + 1] == 'o') {
-                                movimientos[numMovimientos].posx = x;
-                                movimientos[numMovimientos].posy = y + 1;
-                                numMovimientos++;
-                            }
+        TickType_t ahora = xTaskGetTickCount();
+        int tocaPaso = hayMovimiento && (TickType_t)(ahora - proximoPaso) < (portMAX_DELAY >> 1);
+        int atendidos = 0;
+        uint32_t plazo;
 
-                            if (numMovimientos > 0) {
-                                int indiceAleatorio = rand() % numMovimientos;
+        for (int i = 0; i < numRep; i++) {
+            if (!(activos & (1u << i))) continue;
 
-                                sistema.mapaUnificado[rep->posxyUnificado.posx][rep->posxyUnificado.posy] = 'o';
+            // Fuera de la grilla solo se atiende a los que esperan un plazo
+            if (tocaPaso || actividadRepartidor(i, &plazo) == ACTIVIDAD_PLAZO) {
+                avanzarRepartidor(i);
+                atendidos++;
+            }
+        }
 
-                                rep->posxyUnificado.posx = movimientos[indiceAleatorio].posx;
-                                rep->posxyUnificado.posy = movimientos[indiceAleatorio].posy;
+        if (tocaPaso) {
+            // Si la tarea se atrasó se saltan periodos enteros, sin correr la fase
+            do {
+                proximoPaso += periodo;
+            } while ((TickType_t)(ahora - proximoPaso) < (portMAX_DELAY >> 1));
+        }
 
-                                sistema.mapaUnificado[rep->posxyUnificado.posx][rep->posxyUnificado.posy] = 'p';
+        // Un solo frame con los cambios de todo el periodo
+        if (atendidos > 0) flotaEmitirFrame(numRep);
 
-                                int av, ca;
-                                convertirUnificadoAAvCa(rep->posxyUnificado, &av, &ca);
+        // Quien quedó quieto sale del conjunto; del resto, el plazo más cercano
+        int hayPlazo = 0;
+        int32_t faltaPlazo = 0;
+        int habiaMovimiento = hayMovimiento;
+        hayMovimiento = 0;
 
-                                printf("{\"type\":\"mov\",\"rep\":%d,\"av\":%d,\"ca\":%d,\"estado\":\"DESOCUPADO\"}\r\n",
-                                       i, av, ca);
-                            }
+        for (int i = 0; i < numRep; i++) {
+            if (!(activos & (1u << i))) continue;
 
-                            xSemaphoreGive(mutexRepartidores[i]);
-                        }
-                        else {
-                            xSemaphoreGive(mutexRepartidores[i]);
-                        }
-                    }
+            switch (actividadRepartidor(i, &plazo)) {
+                case ACTIVIDAD_MOVIMIENTO:
+                    hayMovimiento = 1;
+                    break;
+                case ACTIVIDAD_PLAZO: {
+                    int32_t falta = (int32_t)(plazo - relojAhora());
+                    if (falta < 0) falta = 0;
+                    if (!hayPlazo || falta < faltaPlazo) faltaPlazo = falta;
+                    hayPlazo = 1;
+                    break;
                 }
+                default:
+                    activos &= ~(1u << i);
+                    break;
             }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
-}
-
-// Callback de UART cuando se recibe un byte
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
-{
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        ahora = xTaskGetTickCount();
+        TickType_t hastaPlazo = (TickType_t)relojMsATicks((uint32_t)faltaPlazo);
+        // Un plazo vencido que no se pudo atender (cerrojo ocupado) se
+        // reintenta en el siguiente tick
+        if (hastaPlazo == 0) hastaPlazo = 1;
+
+        if (hayMovimiento) {
+            // Recién despierto: el primer paso va un periodo después
+            if (!habiaMovimiento) {
+                referencia = ahora;
+                proximoPaso = ahora + periodo;
+            }
 
-    if (huart->Instance == USART2)
-    {
-        xQueueSendFromISR(queueRx, &rxByte, &xHigherPriorityTaskWoken);
-        HAL_UART_Receive_IT(&huart2, &rxByte, 1);
-        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+            // Hasta el próximo paso, o antes si vence un plazo
+            TickType_t objetivo = proximoPaso;
+            if (hayPlazo && (TickType_t)(objetivo - ahora) > hastaPlazo) {
+                objetivo = ahora + hastaPlazo;
+            }
+            vTaskDelayUntil(&referencia, (TickType_t)(objetivo - referencia));
+        } else if (hayPlazo) {
+            xTaskNotifyWait(0, UINT32_MAX, &avisos, hastaPlazo);
+            activos |= avisos;
+        } else {
+            xTaskNotifyWait(0, UINT32_MAX, &avisos, portMAX_DELAY);
+            activos |= avisos;
+        }
     }
 }
 
@@ -2643,7 +3859,7 @@ void EXTI15_10_IRQHandler(void)
         __HAL_GPIO_EXTI_CLEAR_IT(GPIO_PIN_13);
 
         static uint32_t lastTime = 0;
-        uint32_t currentTime = HAL_GetTick();
+        uint32_t currentTime = relojAhora();
 
         // Anti-rebote 500ms
         if(currentTime - lastTime > 500)
@@ -2660,6 +3876,7 @@ void EXTI15_10_IRQHandler(void)
 // Hook de error malloc
 void vApplicationMallocFailedHook(void)
 {
+    uartTxModoPanico();
     printf("{\"type\":\"error\",\"msg\":\"Malloc Failed\"}\r\n");
     taskDISABLE_INTERRUPTS();
     for(;;);
@@ -2668,6 +3885,7 @@ void vApplicationMallocFailedHook(void)
 // Hook de error stack overflow
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
+    uartTxModoPanico();
     printf("{\"type\":\"error\",\"msg\":\"Stack Overflow: %s\"}\r\n", pcTaskName);
     taskDISABLE_INTERRUPTS();
     for(;;);
@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    histograma.c
+  * @brief   Histograma de latencias log-lineal (ver histograma.h).
+  *
+  *          Un solo escritor por histograma; un lector concurrente puede ver
+  *          una muestra a medio registrar, lo que solo corre un percentil
+  *          una cubeta.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "histograma.h"
+#include <string.h>
+
+/* Helper Functions ----------------------------------------------------------*/
+
+// Posición del bit más alto (v > 0)
+static inline uint32_t bitAlto(uint32_t v) {
+    return 31u - (uint32_t)__builtin_clz(v);
+}
+
+/* Cubetas -------------------------------------------------------------------*/
+
+// Cubeta de un valor con 2^bitsSub cubetas por potencia de 2: lineal por
+// debajo de 2^bitsSub y saturada en la última desde 2^bitsMax
+uint32_t histogramaIndice(uint32_t ms, uint32_t bitsSub, uint32_t bitsMax) {
+    uint32_t sub = 1u << bitsSub;
+
+    if (ms < sub) return ms;
+    if (ms >= (1u << bitsMax)) return sub * (bitsMax - bitsSub + 1) - 1;
+
+    uint32_t corrimiento = bitAlto(ms) - bitsSub;
+    return (corrimiento + 1) * sub + ((ms >> corrimiento) & (sub - 1));
+}
+
+// Valor representativo de una cubeta (su punto medio)
+uint32_t histogramaValorCubeta(uint32_t indice, uint32_t bitsSub) {
+    uint32_t sub = 1u << bitsSub;
+
+    if (indice < sub) return indice;
+
+    uint32_t corrimiento = indice / sub - 1;
+    uint32_t desde = (sub + indice % sub) << corrimiento;
+
+    return desde + ((1u << corrimiento) >> 1);
+}
+
+// Cubeta que contiene la muestra de rango ceil(total * milesimas / 1000);
+// -1 si está vacío o las cubetas suman menos que total
+int histogramaCubetaPercentil(const uint32_t *cubetas, uint32_t num, uint32_t total, uint32_t milesimas) {
+    if (total == 0) return -1;
+    if (milesimas > 1000) milesimas = 1000;
+
+    uint32_t rango = (uint32_t)(((uint64_t)total * milesimas + 999) / 1000);
+    if (rango == 0) rango = 1;
+
+    uint32_t acumulado = 0;
+    for (uint32_t i = 0; i < num; i++) {
+        acumulado += cubetas[i];
+        if (acumulado >= rango) return (int)i;
+    }
+    return -1;
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+void histogramaReiniciar(Histograma *h) {
+    memset(h, 0, sizeof(*h));
+    h->min = UINT32_MAX;
+}
+
+// Registra una muestra en O(1)
+void histogramaRegistrar(Histograma *h, uint32_t ms) {
+    h->cubetas[histogramaIndice(ms, HIST_BITS_SUB, HIST_BITS_MAX)]++;
+    h->suma += ms;
+    if (ms < h->min) h->min = ms;
+    if (ms > h->max) h->max = ms;
+    h->total++;
+}
+
+// Valor bajo el cual queda la fracción milesimas/1000 de las muestras
+// (500 = p50, 990 = p99); 0 si está vacío
+uint32_t histogramaPercentil(const Histograma *h, uint32_t milesimas) {
+    if (h->total == 0) return 0;
+
+    int i = histogramaCubetaPercentil(h->cubetas, HIST_NUM_CUBETAS, h->total, milesimas);
+    if (i < 0) return h->max;
+
+    uint32_t v = histogramaValorCubeta((uint32_t)i, HIST_BITS_SUB);
+    if (v < h->min) v = h->min;
+    if (v > h->max) v = h->max;
+    return v;
+}
+
+// Conteo, promedio, extremos y p50/p90/p95/p99 en milisegundos
+void histogramaResumir(const Histograma *h, ResumenHistograma *r) {
+    memset(r, 0, sizeof(*r));
+
+    r->pedidos = h->total;
+    if (r->pedidos == 0) return;
+
+    r->promedio = (uint32_t)(h->suma / r->pedidos);
+    r->min = h->min;
+    r->max = h->max;
+    r->p50 = histogramaPercentil(h, 500);
+    r->p90 = histogramaPercentil(h, 900);
+    r->p95 = histogramaPercentil(h, 950);
+    r->p99 = histogramaPercentil(h, 990);
+}
@@ -0,0 +1,218 @@
+/**
+  ******************************************************************************
+  * @file    json_tx.c
+  * @brief   Escritor JSON en flujo (ver json_tx.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "json_tx.h"
+#include <stddef.h>
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline void poner(JsonTx *j, char c) {
+    if (j->pos < j->cap) {
+        j->buf[j->pos++] = c;
+    } else {
+        j->desbordado = 1;
+    }
+}
+
+// Cadena entre comillas escapando lo mínimo para JSON válido
+static void ponerCadena(JsonTx *j, const char *s) {
+    poner(j, '"');
+    while (*s) {
+        char c = *s++;
+        if (c == '"' || c == '\\') {
+            poner(j, '\\');
+            poner(j, c);
+        } else if ((unsigned char)c < 0x20) {
+            poner(j, ' ');
+        } else {
+            poner(j, c);
+        }
+    }
+    poner(j, '"');
+}
+
+static void ponerSinSigno(JsonTx *j, uint32_t v) {
+    char tmp[10];
+    int n = 0;
+
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+
+    while (n > 0) {
+        poner(j, tmp[--n]);
+    }
+}
+
+static void ponerEntero(JsonTx *j, int32_t v) {
+    if (v < 0) {
+        poner(j, '-');
+        ponerSinSigno(j, (uint32_t)(-(int64_t)v));
+    } else {
+        ponerSinSigno(j, (uint32_t)v);
+    }
+}
+
+// Punto fijo: valor / 10^decimales con todos los decimales
+static void ponerFijo(JsonTx *j, int32_t valor, int decimales) {
+    uint32_t escala = 1;
+    for (int i = 0; i < decimales; i++) escala *= 10;
+
+    uint32_t absoluto;
+    if (valor < 0) {
+        poner(j, '-');
+        absoluto = (uint32_t)(-(int64_t)valor);
+    } else {
+        absoluto = (uint32_t)valor;
+    }
+
+    ponerSinSigno(j, absoluto / escala);
+
+    if (decimales > 0) {
+        uint32_t frac = absoluto % escala;
+        poner(j, '.');
+        for (uint32_t d = escala / 10; d > 0; d /= 10) {
+            poner(j, (char)('0' + (frac / d) % 10));
+        }
+    }
+}
+
+// Coma si hace falta y "clave": cuando se está dentro de un objeto
+static void ponerClave(JsonTx *j, const char *clave) {
+    uint8_t nivel = j->profundidad;
+
+    if (j->hayElemento[nivel]) {
+        poner(j, ',');
+    }
+    j->hayElemento[nivel] = 1;
+
+    if (clave != NULL) {
+        ponerCadena(j, clave);
+        poner(j, ':');
+    }
+}
+
+static void abrir(JsonTx *j, char c) {
+    poner(j, c);
+    if (j->profundidad + 1 < JSON_MAX_PROFUNDIDAD) {
+        j->profundidad++;
+        j->hayElemento[j->profundidad] = 0;
+    } else {
+        j->desbordado = 1;
+    }
+}
+
+static void cerrar(JsonTx *j, char c) {
+    if (j->profundidad > 0) j->profundidad--;
+    poner(j, c);
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+// Reserva "capacidad" bytes en el buffer de TX y abre el objeto raíz
+int jsonIniciar(JsonTx *j, int capacidad) {
+    uint8_t *destino = uartTxReservar(capacidad, &j->reserva);
+
+    jsonIniciarBuffer(j, (char *)destino, destino ? capacidad : 0);
+    j->enBufferTx = 1;
+
+    if (destino == NULL) {
+        j->desbordado = 1;
+        return 0;
+    }
+    return 1;
+}
+
+void jsonIniciarBuffer(JsonTx *j, char *buf, int cap) {
+    j->buf = buf;
+    j->cap = cap;
+    j->pos = 0;
+    j->desbordado = 0;
+    j->profundidad = 0;
+    j->enBufferTx = 0;
+    j->hayElemento[0] = 0;
+
+    abrir(j, '{');
+}
+
+// Cierra el objeto, agrega fin de línea y publica; devuelve la longitud o 0
+int jsonTerminar(JsonTx *j) {
+    while (j->profundidad > 1) {
+        cerrar(j, ']');
+    }
+    cerrar(j, '}');
+    poner(j, '\r');
+    poner(j, '\n');
+
+    int len = j->desbordado ? 0 : j->pos;
+
+    if (j->enBufferTx && j->buf != NULL) {
+        uartTxConfirmar(&j->reserva, len);
+    }
+
+    return len;
+}
+
+void jsonCadena(JsonTx *j, const char *clave, const char *valor) {
+    ponerClave(j, clave);
+    ponerCadena(j, valor ? valor : "");
+}
+
+void jsonCaracter(JsonTx *j, const char *clave, char valor) {
+    ponerClave(j, clave);
+    poner(j, '"');
+    poner(j, valor);
+    poner(j, '"');
+}
+
+void jsonEntero(JsonTx *j, const char *clave, int32_t valor) {
+    ponerClave(j, clave);
+    ponerEntero(j, valor);
+}
+
+void jsonSinSigno(JsonTx *j, const char *clave, uint32_t valor) {
+    ponerClave(j, clave);
+    ponerSinSigno(j, valor);
+}
+
+void jsonFijo(JsonTx *j, const char *clave, int32_t valor, int decimales) {
+    ponerClave(j, clave);
+    ponerFijo(j, valor, decimales);
+}
+
+// Igual que jsonFijo pero entre comillas (formato de los tiempos en el protocolo)
+void jsonFijoTexto(JsonTx *j, const char *clave, int32_t valor, int decimales) {
+    ponerClave(j, clave);
+    poner(j, '"');
+    ponerFijo(j, valor, decimales);
+    poner(j, '"');
+}
+
+// Bytes crudos como cadena hexadecimal (dos dígitos por byte, en orden)
+void jsonHex(JsonTx *j, const char *clave, const void *datos, int len) {
+    static const char digitos[] = "0123456789abcdef";
+    const uint8_t *b = (const uint8_t *)datos;
+
+    ponerClave(j, clave);
+    poner(j, '"');
+    for (int i = 0; i < len; i++) {
+        poner(j, digitos[b[i] >> 4]);
+        poner(j, digitos[b[i] & 0x0F]);
+    }
+    poner(j, '"');
+}
+
+void jsonAbrirArreglo(JsonTx *j, const char *clave) {
+    ponerClave(j, clave);
+    abrir(j, '[');
+}
+
+void jsonCerrarArreglo(JsonTx *j) {
+    cerrar(j, ']');
+}
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    log.c
+  * @brief   Codificación de mensajes de log diferidos (ver log.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "log.h"
+#include "telemetria.h"
+#include <stdarg.h>
+#include <string.h>
+
+/* Variables -----------------------------------------------------------------*/
+#define LOG_X_FIRMA(nombre, nivel, firma, formato)  firma,
+
+// Solo la firma de argumentos queda en flash, no el texto
+static const char *const firmas[LOG_NUM_MENSAJES] = {
+    LOG_TABLA(LOG_X_FIRMA)
+};
+
+/* Functions -----------------------------------------------------------------*/
+
+// Zigzag: enteros con signo pequeños en pocos bytes
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+void logEmitir(IdLog id, ...) {
+    if ((unsigned)id >= LOG_NUM_MENSAJES) return;
+
+    RegistroTel r;
+    telRegistroIniciar(&r, TEL_LOG);
+    telPonerVarint(&r, (uint32_t)id);
+
+    va_list args;
+    va_start(args, id);
+
+    for (const char *f = firmas[id]; *f; f++) {
+        switch (*f) {
+            case 'd':
+                telPonerVarint(&r, zigzag(va_arg(args, int)));
+                break;
+            case 'u':
+                telPonerVarint(&r, va_arg(args, unsigned int));
+                break;
+            case 'f': {
+                float v = (float)va_arg(args, double);
+                uint32_t bits;
+                memcpy(&bits, &v, sizeof(bits));
+                telPonerU8(&r, (uint8_t)(bits));
+                telPonerU8(&r, (uint8_t)(bits >> 8));
+                telPonerU8(&r, (uint8_t)(bits >> 16));
+                telPonerU8(&r, (uint8_t)(bits >> 24));
+                break;
+            }
+            case 's': {
+                const char *s = va_arg(args, const char *);
+                int len = s ? (int)strnlen(s, LOG_MAX_CADENA) : 0;
+                telPonerU8(&r, (uint8_t)len);
+                for (int i = 0; i < len; i++) {
+                    telPonerU8(&r, (uint8_t)s[i]);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    va_end(args);
+
+    telemetriaEnviarRegistro(&r);
+}
@@ -0,0 +1,197 @@
+/**
+  ******************************************************************************
+  * @file    perfil.c
+  * @brief   Perfil de tareas (ver perfil.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "perfil.h"
+#include "json_tx.h"
+#include "task.h"
+#include "semphr.h"
+#include <string.h>
+
+#ifdef HOST_SIM
+#include <time.h>
+#else
+#include "main.h"
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    const char *nombre;
+    QueueHandle_t cola;
+} ColaPerfil;
+
+/* Variables -----------------------------------------------------------------*/
+static uint64_t cuentaExtendida = 0;
+static uint32_t ultimaCuenta = 0;
+
+static ColaPerfil colas[PERFIL_MAX_COLAS];
+static int numColas = 0;
+
+// Contadores del reporte anterior, por número de tarea
+static UBaseType_t numeroAnterior[PERFIL_MAX_TAREAS];
+static uint32_t tiempoAnterior[PERFIL_MAX_TAREAS];
+static int numAnteriores = 0;
+static uint32_t totalAnterior = 0;
+
+static TaskStatus_t estados[PERFIL_MAX_TAREAS];
+static SemaphoreHandle_t mutexPerfil = NULL;
+
+/* Contador ------------------------------------------------------------------*/
+
+#ifdef HOST_SIM
+void perfilIniciarContador(void) {
+}
+
+static uint32_t leerCuenta(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+#else
+// Habilita el contador de ciclos del DWT (lo llama vTaskStartScheduler)
+void perfilIniciarContador(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    ultimaCuenta = 0;
+    cuentaExtendida = 0;
+}
+
+static inline uint32_t leerCuenta(void) {
+    return DWT->CYCCNT;
+}
+#endif
+
+// Lo llama el kernel en cada cambio de contexto (PendSV) y al tomar
+// estadísticas; el CYCCNT da la vuelta cada ~24 s pero los cambios de
+// contexto son mucho más frecuentes
+uint32_t perfilContador(void) {
+    UBaseType_t mascara = portSET_INTERRUPT_MASK_FROM_ISR();
+
+    uint32_t cuenta = leerCuenta();
+    cuentaExtendida += (uint32_t)(cuenta - ultimaCuenta);
+    ultimaCuenta = cuenta;
+
+#ifdef HOST_SIM
+    uint32_t valor = (uint32_t)cuentaExtendida;
+#else
+    uint32_t valor = (uint32_t)(cuentaExtendida >> PERFIL_CORRIMIENTO);
+#endif
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(mascara);
+    return valor;
+}
+
+/* Helper Functions ----------------------------------------------------------*/
+
+// Tiempo de la tarea en el reporte anterior (0 si es nueva) y lo actualiza
+static uint32_t tiempoPrevio(UBaseType_t numero, uint32_t actual, UBaseType_t *vistos, uint32_t *tiempos, int *nVistos) {
+    uint32_t previo = 0;
+
+    for (int i = 0; i < numAnteriores; i++) {
+        if (numeroAnterior[i] == numero) {
+            previo = tiempoAnterior[i];
+            break;
+        }
+    }
+
+    if (*nVistos < PERFIL_MAX_TAREAS) {
+        vistos[*nVistos] = numero;
+        tiempos[*nVistos] = actual;
+        (*nVistos)++;
+    }
+    return previo;
+}
+
+static char letraEstado(eTaskState estado) {
+    switch (estado) {
+        case eRunning:   return 'X';
+        case eReady:     return 'R';
+        case eBlocked:   return 'B';
+        case eSuspended: return 'S';
+        default:         return 'D';
+    }
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+void perfilIniciar(void) {
+    if (mutexPerfil == NULL) {
+        mutexPerfil = xSemaphoreCreateMutex();
+    }
+}
+
+// Agrega una cola (o semáforo) al reporte; 0 si no hay lugar
+int perfilRegistrarCola(const char *nombre, QueueHandle_t cola) {
+    if (numColas >= PERFIL_MAX_COLAS || cola == NULL) return 0;
+
+    colas[numColas].nombre = nombre;
+    colas[numColas].cola = cola;
+    numColas++;
+    return 1;
+}
+
+// Envía task_stats. CPU en % con dos decimales desde el reporte anterior;
+// pila libre mínima en bytes; estado X/R/B/S/D
+void perfilEnviarEstadisticas(void) {
+    if (mutexPerfil == NULL || xSemaphoreTake(mutexPerfil, pdMS_TO_TICKS(100)) != pdTRUE) return;
+
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(estados, PERFIL_MAX_TAREAS, &total);
+    uint32_t intervalo = total - totalAnterior;
+
+    UBaseType_t vistos[PERFIL_MAX_TAREAS];
+    uint32_t tiempos[PERFIL_MAX_TAREAS];
+    int nVistos = 0;
+
+    JsonTx j;
+    jsonIniciar(&j, 768);
+    jsonCadena(&j, "type", "task_stats");
+    jsonSinSigno(&j, "heap_free", (uint32_t)xPortGetFreeHeapSize());
+    jsonSinSigno(&j, "heap_min", (uint32_t)xPortGetMinimumEverFreeHeapSize());
+    jsonSinSigno(&j, "heap_size", (uint32_t)configTOTAL_HEAP_SIZE);
+
+    jsonAbrirArreglo(&j, "tasks");
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *t = &estados[i];
+        uint32_t previo = tiempoPrevio(t->xTaskNumber, t->ulRunTimeCounter, vistos, tiempos, &nVistos);
+        uint32_t usado = t->ulRunTimeCounter - previo;
+        uint32_t centesimas = intervalo ? (uint32_t)((uint64_t)usado * 10000u / intervalo) : 0;
+
+        // [nombre, cpu %, pila libre mínima (bytes), prioridad, estado]
+        jsonAbrirArreglo(&j, NULL);
+        jsonCadena(&j, NULL, t->pcTaskName);
+        jsonFijo(&j, NULL, (int32_t)centesimas, 2);
+        jsonSinSigno(&j, NULL, (uint32_t)t->usStackHighWaterMark * sizeof(StackType_t));
+        jsonSinSigno(&j, NULL, (uint32_t)t->uxCurrentPriority);
+        jsonCaracter(&j, NULL, letraEstado(t->eCurrentState));
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+
+    // [nombre, ocupados, capacidad]
+    jsonAbrirArreglo(&j, "queues");
+    for (int i = 0; i < numColas; i++) {
+        UBaseType_t ocupados = uxQueueMessagesWaiting(colas[i].cola);
+        UBaseType_t libres = uxQueueSpacesAvailable(colas[i].cola);
+
+        jsonAbrirArreglo(&j, NULL);
+        jsonCadena(&j, NULL, colas[i].nombre);
+        jsonSinSigno(&j, NULL, (uint32_t)ocupados);
+        jsonSinSigno(&j, NULL, (uint32_t)(ocupados + libres));
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+    jsonTerminar(&j);
+
+    memcpy(numeroAnterior, vistos, sizeof(vistos[0]) * nVistos);
+    memcpy(tiempoAnterior, tiempos, sizeof(tiempos[0]) * nVistos);
+    numAnteriores = nVistos;
+    totalAnterior = total;
+
+    xSemaphoreGive(mutexPerfil);
+}
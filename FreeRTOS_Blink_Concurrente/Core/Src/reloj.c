@@ -0,0 +1,128 @@
+/**
+  ******************************************************************************
+  * @file    reloj.c
+  * @brief   Modo del reloj de la simulación y salto del tick en host.
+  *
+  *          El FreeRTOSConfig.h del simulador activa configUSE_TICKLESS_IDLE
+  *          y define portSUPPRESS_TICKS_AND_SLEEP como relojSuprimirTicks.
+  *          El kernel la llama desde la tarea idle con el scheduler
+  *          suspendido y "esperados" = ticks hasta el próximo desbloqueo.
+  *          En modo virtual se avanza esperados - 1 con vTaskStepTick y el
+  *          último tick se cuenta como pendiente: xTaskResumeAll lo procesa
+  *          y desbloquea a la tarea en el tick exacto que pidió, igual que
+  *          en tiempo real. El kernel no suprime saltos de un solo tick;
+  *          esos los da el idle hook.
+  *
+  *          En modo virtual además se para el temporizador del port POSIX
+  *          (ITIMER_REAL): el tick solo avanza con los saltos, así el tiempo
+  *          de pared que tarda el cómputo no se cuela en la simulación y dos
+  *          corridas con la misma semilla y la misma entrada dan lo mismo.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "reloj.h"
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#ifdef HOST_SIM
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+/* Defines -------------------------------------------------------------------*/
+#define RELOJ_SALTO_MAX     1000u
+
+/* Variables -----------------------------------------------------------------*/
+static volatile ModoReloj modoActual = RELOJ_REAL;
+static volatile uint32_t saltos = 0;
+static volatile uint32_t ticksSaltados = 0;
+
+#ifdef HOST_SIM
+static int tickParado = 0;
+static struct itimerval tickPort;      // lo que armó el port al arrancar
+#endif
+
+/* Functions -----------------------------------------------------------------*/
+
+uint32_t relojAhora(void) {
+    return HAL_GetTick();
+}
+
+// pdMS_TO_TICKS multiplica en 32 bits y desborda pasados ~71 min
+uint32_t relojMsATicks(uint32_t ms) {
+    return (uint32_t)(((uint64_t)ms * configTICK_RATE_HZ) / 1000u);
+}
+
+void relojEsperar(uint32_t ms) {
+    vTaskDelay((TickType_t)relojMsATicks(ms));
+}
+
+ModoReloj relojModo(void) {
+    return modoActual;
+}
+
+int relojFijarModo(ModoReloj modo) {
+#ifndef HOST_SIM
+    // En la placa el tick lo da el hardware
+    if (modo != RELOJ_REAL) return 0;
+#endif
+    modoActual = modo;
+    return 1;
+}
+
+void relojObtenerEstadisticas(EstadisticasReloj *out) {
+    out->saltos = saltos;
+    out->ticksSaltados = ticksSaltados;
+}
+
+void relojReiniciarEstadisticas(void) {
+    saltos = 0;
+    ticksSaltados = 0;
+}
+
+#ifdef HOST_SIM
+// portSUPPRESS_TICKS_AND_SLEEP: en modo real no hace nada y la idle sigue
+void relojSuprimirTicks(uint32_t esperados) {
+    if (modoActual != RELOJ_VIRTUAL || esperados < 2) return;
+
+    // Con la lista de demoras vacía "esperados" llega hasta portMAX_DELAY
+    if (esperados > RELOJ_SALTO_MAX) esperados = RELOJ_SALTO_MAX;
+
+    taskENTER_CRITICAL();
+    vTaskStepTick(esperados - 1);
+    xTaskIncrementTick();
+    taskEXIT_CRITICAL();
+
+    saltos++;
+    ticksSaltados += esperados;
+}
+
+// Para o rearma el tick de tiempo de pared según el modo. Se hace desde la
+// idle porque el port arma el temporizador recién al arrancar el scheduler
+static void sincronizarTickPort(void) {
+    static const struct itimerval parado = { { 0, 0 }, { 0, 0 } };
+    int virtual = (modoActual == RELOJ_VIRTUAL);
+
+    if (virtual == tickParado) return;
+    if (virtual) {
+        setitimer(ITIMER_REAL, &parado, &tickPort);
+    } else {
+        tickPort.it_value = tickPort.it_interval;
+        setitimer(ITIMER_REAL, &tickPort, NULL);
+    }
+    tickParado = virtual;
+}
+
+// La idle solo corre si no hay nada listo: en modo virtual el tiempo avanza
+void vApplicationIdleHook(void) {
+    sincronizarTickPort();
+    if (modoActual == RELOJ_VIRTUAL) {
+        xTaskCatchUpTicks(1);
+        ticksSaltados++;
+    } else {
+        usleep(1000);
+    }
+}
+#endif
@@ -0,0 +1,131 @@
+/**
+  ******************************************************************************
+  * @file    sonda.c
+  * @brief   Sondas de duración (ver sonda.h).
+  *
+  *          Varias tareas pasan por las mismas sondas (los enviar*), así
+  *          que cada registro se aplica en una sección crítica corta.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sonda.h"
+
+#if SONDAS_HABILITADAS
+
+#include "histograma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#ifdef HOST_SIM
+#include <time.h>
+#else
+#include "main.h"
+#endif
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t llamadas;
+    uint32_t min;
+    uint32_t max;
+    uint64_t suma;
+    uint32_t cubetas[SONDA_CUBETAS];    // cubeta k: [2^k, 2^(k+1))
+} Sonda;
+
+/* Variables -----------------------------------------------------------------*/
+static Sonda sondas[NUM_SONDAS];
+
+static const char *const etiquetas[NUM_SONDAS] = {
+#define SONDA_ETIQUETA(nombre, etiqueta) etiqueta,
+    SONDAS_TABLA(SONDA_ETIQUETA)
+#undef SONDA_ETIQUETA
+};
+
+/* Reloj ---------------------------------------------------------------------*/
+
+#ifdef HOST_SIM
+void sondasIniciar(void) {
+    sondasReiniciar();
+}
+
+uint32_t sondaLeer(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+const char *sondaUnidad(void) {
+    return "ns";
+}
+#else
+// Habilita CYCCNT sin ponerlo a cero (lo comparte con perfil.c)
+void sondasIniciar(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    sondasReiniciar();
+}
+
+uint32_t sondaLeer(void) {
+    return DWT->CYCCNT;
+}
+
+const char *sondaUnidad(void) {
+    return "cycles";
+}
+#endif
+
+/* Functions -----------------------------------------------------------------*/
+
+void sondaRegistrar(IdSonda id, uint32_t duracion) {
+    if ((unsigned)id >= NUM_SONDAS) return;
+
+    uint32_t k = duracion ? 31u - (uint32_t)__builtin_clz(duracion) : 0;
+    Sonda *s = &sondas[id];
+
+    taskENTER_CRITICAL();
+    if (s->llamadas == 0 || duracion < s->min) s->min = duracion;
+    if (duracion > s->max) s->max = duracion;
+    s->suma += duracion;
+    s->cubetas[k]++;
+    s->llamadas++;
+    taskEXIT_CRITICAL();
+}
+
+void sondasReiniciar(void) {
+    taskENTER_CRITICAL();
+    memset(sondas, 0, sizeof(sondas));
+    taskEXIT_CRITICAL();
+}
+
+// Copia consistente de una sonda; 0 si todavía no se llamó
+int sondaResumir(IdSonda id, ResumenSonda *r) {
+    Sonda copia;
+
+    if ((unsigned)id >= NUM_SONDAS) return 0;
+
+    taskENTER_CRITICAL();
+    copia = sondas[id];
+    taskEXIT_CRITICAL();
+
+    memset(r, 0, sizeof(*r));
+    if (copia.llamadas == 0) return 0;
+
+    r->llamadas = copia.llamadas;
+    r->min = copia.min;
+    r->max = copia.max;
+    r->suma = copia.suma;
+
+    int k = histogramaCubetaPercentil(copia.cubetas, SONDA_CUBETAS, copia.llamadas, 990);
+    if (k >= 0) {
+        r->p99 = (k >= 31) ? UINT32_MAX : (2u << k) - 1;
+        if (r->p99 > r->max) r->p99 = r->max;
+    }
+    return 1;
+}
+
+const char *sondaEtiqueta(IdSonda id) {
+    return ((unsigned)id < NUM_SONDAS) ? etiquetas[id] : "?";
+}
+
+#endif /* SONDAS_HABILITADAS */
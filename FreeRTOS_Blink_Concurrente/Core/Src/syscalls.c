@@ -30,6 +30,7 @@
 #include <sys/time.h>
 #include <sys/times.h>
 #include "main.h"
+#include "uart_tx.h"
 
 /* Variables */
 extern int __io_putchar(int ch) __attribute__((weak));
@@ -79,7 +80,8 @@ __attribute__((weak)) int _read(int file, char *ptr, int len)
 
 __attribute__((weak)) int _write(int file, char *ptr, int len)
 {
-    HAL_UART_Transmit(&huart2, (uint8_t*)ptr, len, HAL_MAX_DELAY);
+    (void)file;
+    uartTxEnviar(ptr, len);
     return len;
 }
 
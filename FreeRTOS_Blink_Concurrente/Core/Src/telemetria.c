@@ -0,0 +1,280 @@
+/**
+  ******************************************************************************
+  * @file    telemetria.c
+  * @brief   Codificación de registros binarios de telemetría (ver telemetria.h)
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "telemetria.h"
+#include "uart_tx.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* Defines -------------------------------------------------------------------*/
+// version + tipo + payload + crc
+#define TEL_MAX_CRUDO   (2 + TEL_MAX_PAYLOAD + 2)
+// COBS agrega 1 byte cada 254 + delimitadores inicial y final
+#define TEL_MAX_TRAMA   (TEL_MAX_CRUDO + (TEL_MAX_CRUDO / 254) + 1 + 2)
+
+/* Variables -----------------------------------------------------------------*/
+static volatile FormatoTelemetria formatoActual = TELEMETRIA_JSON;
+
+static const char *nombresEvento[TEL_EV_DESCONOCIDO] = {
+    "ORDER_CREATED",
+    "ORDER_PREPARING",
+    "ORDER_READY",
+    "DRIVER_ASSIGNED",
+    "DRIVER_PICKED_UP",
+    "DELIVERED",
+    "CANCELLED",
+    "CANCEL_REJECTED",
+    "CANCEL_FAILED"
+};
+
+static const uint16_t tablaCrc[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/* Formato -------------------------------------------------------------------*/
+
+void telemetriaSetFormato(FormatoTelemetria formato) {
+    formatoActual = formato;
+}
+
+FormatoTelemetria telemetriaGetFormato(void) {
+    return formatoActual;
+}
+
+int telemetriaBinaria(void) {
+    return formatoActual == TELEMETRIA_BINARIA;
+}
+
+// Traduce el nombre de evento a su código binario
+CodigoEventoTel telemetriaCodigoEvento(const char *evento) {
+    for (int i = 0; i < TEL_EV_DESCONOCIDO; i++) {
+        if (strcmp(nombresEvento[i], evento) == 0) {
+            return (CodigoEventoTel)i;
+        }
+    }
+    return TEL_EV_DESCONOCIDO;
+}
+
+// Extrae el número de un recibo "PED-n"; -1 si no tiene ese formato
+int telemetriaNumeroRecibo(const char *numeroRecibo) {
+    if (numeroRecibo == NULL || strncmp(numeroRecibo, "PED-", 4) != 0) return -1;
+
+    const char *p = numeroRecibo + 4;
+    if (*p < '0' || *p > '9') return -1;
+
+    return atoi(p);
+}
+
+/* Registro ------------------------------------------------------------------*/
+
+void telRegistroIniciar(RegistroTel *r, uint8_t tipo) {
+    r->tipo = tipo;
+    r->len = 0;
+}
+
+void telPonerU8(RegistroTel *r, uint8_t v) {
+    if (r->len < TEL_MAX_PAYLOAD) {
+        r->datos[r->len++] = v;
+    }
+}
+
+// Varint LEB128: 7 bits por byte, bit alto = continúa
+void telPonerVarint(RegistroTel *r, uint32_t v) {
+    while (v >= 0x80) {
+        telPonerU8(r, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    telPonerU8(r, (uint8_t)v);
+}
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) con tabla de nibbles
+uint16_t telemetriaCrc16(const uint8_t *datos, int len) {
+    uint16_t crc = 0xFFFF;
+
+    for (int i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ tablaCrc[(crc >> 12) ^ (datos[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ tablaCrc[(crc >> 12) ^ (datos[i] & 0x0F)]);
+    }
+
+    return crc;
+}
+
+// Codifica COBS; devuelve la longitud escrita (sin delimitador)
+int telemetriaCobsCodificar(const uint8_t *entrada, int len, uint8_t *salida) {
+    int escribir = 1;
+    int idxCodigo = 0;
+    uint8_t codigo = 1;
+
+    for (int leer = 0; leer < len; leer++) {
+        if (entrada[leer] == 0) {
+            salida[idxCodigo] = codigo;
+            codigo = 1;
+            idxCodigo = escribir++;
+        } else {
+            salida[escribir++] = entrada[leer];
+            codigo++;
+
+            if (codigo == 0xFF) {
+                salida[idxCodigo] = codigo;
+                codigo = 1;
+                idxCodigo = escribir++;
+            }
+        }
+    }
+
+    salida[idxCodigo] = codigo;
+    return escribir;
+}
+
+// Decodifica COBS en el lugar (la salida nunca es más larga que la
+// entrada); devuelve la longitud decodificada o -1 si está mal formada
+int telemetriaCobsDecodificar(uint8_t *datos, int len) {
+    int leer = 0;
+    int escribir = 0;
+
+    while (leer < len) {
+        uint8_t codigo = datos[leer++];
+
+        if (codigo == 0 || leer + codigo - 1 > len) return -1;
+
+        for (int i = 1; i < codigo; i++) {
+            datos[escribir++] = datos[leer++];
+        }
+        if (codigo < 0xFF && leer < len) {
+            datos[escribir++] = 0;
+        }
+    }
+
+    return escribir;
+}
+
+// Arma la trama completa 0x00 + COBS(registro + crc) + 0x00
+int telemetriaEmpaquetar(const RegistroTel *r, uint8_t *salida, int maxLen) {
+    uint8_t crudo[TEL_MAX_CRUDO];
+    int n = 0;
+
+    crudo[n++] = TEL_VERSION;
+    crudo[n++] = r->tipo;
+    memcpy(&crudo[n], r->datos, r->len);
+    n += r->len;
+
+    uint16_t crc = telemetriaCrc16(crudo, n);
+    crudo[n++] = (uint8_t)(crc & 0xFF);
+    crudo[n++] = (uint8_t)(crc >> 8);
+
+    if (maxLen < n + (n / 254) + 1 + 2) return 0;
+
+    salida[0] = 0x00;
+    int len = telemetriaCobsCodificar(crudo, n, &salida[1]);
+    salida[1 + len] = 0x00;
+
+    return len + 2;
+}
+
+// Envía un registro como una sola unidad por el buffer de TX
+int telemetriaEnviarRegistro(const RegistroTel *r) {
+    uint8_t trama[TEL_MAX_TRAMA];
+    int len = telemetriaEmpaquetar(r, trama, sizeof(trama));
+
+    if (len <= 0) return 0;
+
+    return uartTxEnviar((const char *)trama, len);
+}
+
+/* Mensajes ------------------------------------------------------------------*/
+
+// entradas: n grupos de 4 bytes (rep, av, ca, estado)
+void telemetriaFlota(uint32_t seq, int keyframe, const uint8_t *entradas, int n) {
+    RegistroTel r;
+    telRegistroIniciar(&r, TEL_FLOTA);
+    telPonerVarint(&r, seq);
+    telPonerU8(&r, keyframe ? TEL_FLOTA_KEYFRAME : 0);
+    telPonerU8(&r, (uint8_t)n);
+
+    for (int i = 0; i < n * 4; i++) {
+        telPonerU8(&r, entradas[i]);
+    }
+
+    telemetriaEnviarRegistro(&r);
+}
+
+void telemetriaEvento(CodigoEventoTel ev, int pedido, int driver, uint32_t prepCentis, int restaurantId, int destinationId) {
+    RegistroTel r;
+    uint8_t banderas = 0;
+
+    if (driver >= 0) banderas |= TEL_EV_CON_DRIVER;
+    if (restaurantId > 0 && destinationId > 0) banderas |= TEL_EV_CON_PREP;
+
+    telRegistroIniciar(&r, TEL_EVENTO);
+    telPonerU8(&r, (uint8_t)ev);
+    telPonerU8(&r, banderas);
+    telPonerVarint(&r, (uint32_t)pedido);
+
+    if (banderas & TEL_EV_CON_DRIVER) {
+        telPonerU8(&r, (uint8_t)driver);
+    }
+    if (banderas & TEL_EV_CON_PREP) {
+        telPonerVarint(&r, prepCentis);
+        telPonerU8(&r, (uint8_t)restaurantId);
+        telPonerU8(&r, (uint8_t)destinationId);
+    }
+
+    telemetriaEnviarRegistro(&r);
+}
+
+void telemetriaMetricas(int pedido, uint32_t queueCs, uint32_t prepCs, uint32_t waitCs, uint32_t driveCs, uint32_t totalCs) {
+    RegistroTel r;
+    telRegistroIniciar(&r, TEL_METRICAS);
+    telPonerVarint(&r, (uint32_t)pedido);
+    telPonerVarint(&r, queueCs);
+    telPonerVarint(&r, prepCs);
+    telPonerVarint(&r, waitCs);
+    telPonerVarint(&r, driveCs);
+    telPonerVarint(&r, totalCs);
+    telemetriaEnviarRegistro(&r);
+}
+
+void telemetriaStats(int driver, int aceptados, int rechazados, int entregados, int tasa) {
+    RegistroTel r;
+    telRegistroIniciar(&r, TEL_STATS);
+    telPonerU8(&r, (uint8_t)driver);
+    telPonerVarint(&r, (uint32_t)aceptados);
+    telPonerVarint(&r, (uint32_t)rechazados);
+    telPonerVarint(&r, (uint32_t)entregados);
+    telPonerU8(&r, (uint8_t)tasa);
+    telemetriaEnviarRegistro(&r);
+}
+
+void telemetriaEstadoRestaurante(int id, int sjf, int cargado, int cola, int umbral) {
+    RegistroTel r;
+    uint8_t banderas = 0;
+
+    if (sjf) banderas |= TEL_REST_SJF;
+    if (cargado) banderas |= TEL_REST_CARGADO;
+
+    telRegistroIniciar(&r, TEL_ESTADO_REST);
+    telPonerU8(&r, (uint8_t)id);
+    telPonerU8(&r, banderas);
+    telPonerVarint(&r, (uint32_t)cola);
+    telPonerVarint(&r, (uint32_t)umbral);
+    telemetriaEnviarRegistro(&r);
+}
+
+// base: primer número de secuencia aún no recibido; bit i de la máscara:
+// recibido base + i (fuera de orden)
+void telemetriaAck(uint16_t base, uint32_t mascara) {
+    RegistroTel r;
+    telRegistroIniciar(&r, TEL_ACK);
+    telPonerU8(&r, (uint8_t)(base & 0xFF));
+    telPonerU8(&r, (uint8_t)(base >> 8));
+    for (int i = 0; i < 4; i++) {
+        telPonerU8(&r, (uint8_t)(mascara >> (8 * i)));
+    }
+    telemetriaEnviarRegistro(&r);
+}
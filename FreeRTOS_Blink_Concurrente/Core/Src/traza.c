@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file    traza.c
+  * @brief   Traza del scheduler en un anillo de RAM (ver traza.h).
+  *
+  *          trazaVolcar detiene la grabación y envía:
+  *            trace_info  frecuencia del reloj, eventos, perdidos, tareas
+  *                        [número, nombre] y objetos [número, grupo, índice]
+  *            trace       TRAZA_POR_MENSAJE eventos en hex, del más viejo
+  *                        al más nuevo (8 bytes little-endian cada uno)
+  *            trace_end   total enviado
+  *          traza.js (APLICACIÓN WEB) lo convierte a Chrome trace JSON.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "traza.h"
+
+#if TRAZA_HABILITADA
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cerrojo.h"
+#include "json_tx.h"
+#include "uart_tx.h"
+#include <stdio.h>
+
+#ifdef HOST_SIM
+#include <time.h>
+#endif
+
+/* Defines -------------------------------------------------------------------*/
+#define TRAZA_POR_MENSAJE   48
+#define TRAZA_MAX_TAREAS    12
+
+#ifdef HOST_SIM
+#define TRAZA_HZ            1000000u
+#else
+#define TRAZA_HZ            configCPU_CLOCK_HZ
+#endif
+
+/* Variables -----------------------------------------------------------------*/
+EventoTraza trazaEventos[TRAZA_EVENTOS];
+uint32_t trazaEscritos = 0;
+volatile uint8_t trazaActiva = 0;
+
+static TaskStatus_t estados[TRAZA_MAX_TAREAS];
+
+/* Reloj ---------------------------------------------------------------------*/
+
+#ifdef HOST_SIM
+uint32_t trazaReloj(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+#endif
+
+/* Helper Functions ----------------------------------------------------------*/
+
+// Tabla de tareas y objetos para poner nombres a los números
+static void enviarInfo(uint32_t eventos, uint32_t perdidos) {
+    JsonTx j;
+    UBaseType_t n = uxTaskGetSystemState(estados, TRAZA_MAX_TAREAS, NULL);
+
+    if (!jsonIniciar(&j, UART_TX_MAX_REGISTRO)) return;
+    jsonCadena(&j, "type", "trace_info");
+    jsonSinSigno(&j, "hz", TRAZA_HZ);
+    jsonSinSigno(&j, "events", eventos);
+    jsonSinSigno(&j, "lost", perdidos);
+
+    jsonAbrirArreglo(&j, "tasks");
+    for (UBaseType_t i = 0; i < n; i++) {
+        jsonAbrirArreglo(&j, NULL);
+        jsonSinSigno(&j, NULL, estados[i].xTaskNumber);
+        jsonCadena(&j, NULL, estados[i].pcTaskName);
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+
+    jsonAbrirArreglo(&j, "objs");
+    for (int i = 0; i < cerrojosCantidad(); i++) {
+        ResumenCerrojo r;
+        cerrojoResumir(i, &r);
+
+        jsonAbrirArreglo(&j, NULL);
+        jsonEntero(&j, NULL, i + 1);
+        jsonCadena(&j, NULL, r.grupo);
+        jsonEntero(&j, NULL, r.indice);
+        jsonCerrarArreglo(&j);
+    }
+    jsonCerrarArreglo(&j);
+    jsonTerminar(&j);
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+// Vacía el anillo y empieza a grabar
+void trazaArrancar(void) {
+    trazaActiva = 0;
+    __atomic_store_n(&trazaEscritos, 0u, __ATOMIC_RELAXED);
+    trazaActiva = 1;
+}
+
+void trazaDetener(void) {
+    trazaActiva = 0;
+}
+
+// Detiene la grabación y envía el anillo; TX pasa a bloquear mientras
+// tanto para no perder mensajes del volcado
+void trazaVolcar(void) {
+    trazaDetener();
+
+    uint32_t escritos = __atomic_load_n(&trazaEscritos, __ATOMIC_RELAXED);
+    uint32_t eventos = (escritos < TRAZA_EVENTOS) ? escritos : TRAZA_EVENTOS;
+    uint32_t primero = escritos - eventos;
+
+    ModoUartTx modoAnterior = uartTxGetModo();
+    uartTxSetModo(UART_TX_BLOQUEAR);
+
+    enviarInfo(eventos, escritos - eventos);
+
+    for (uint32_t enviados = 0; enviados < eventos; ) {
+        uint32_t inicio = (primero + enviados) & (TRAZA_EVENTOS - 1);
+        uint32_t n = eventos - enviados;
+
+        if (n > TRAZA_POR_MENSAJE) n = TRAZA_POR_MENSAJE;
+        // Un mensaje no da la vuelta al anillo
+        if (inicio + n > TRAZA_EVENTOS) n = TRAZA_EVENTOS - inicio;
+
+        JsonTx j;
+        if (jsonIniciar(&j, UART_TX_MAX_REGISTRO)) {
+            jsonCadena(&j, "type", "trace");
+            jsonSinSigno(&j, "i", enviados);
+            jsonHex(&j, "d", &trazaEventos[inicio], (int)(n * sizeof(EventoTraza)));
+            jsonTerminar(&j);
+        }
+        enviados += n;
+    }
+
+    JsonTx j;
+    if (jsonIniciar(&j, 64)) {
+        jsonCadena(&j, "type", "trace_end");
+        jsonSinSigno(&j, "events", eventos);
+        jsonTerminar(&j);
+    }
+
+    uartTxSetModo(modoAnterior);
+}
+
+// Estado de la grabación
+void trazaEnviarEstado(void) {
+    uint32_t escritos = __atomic_load_n(&trazaEscritos, __ATOMIC_RELAXED);
+
+    printf("{\"type\":\"info\",\"msg\":\"Traza %s: %lu eventos (%lu en el anillo de %d)\"}\r\n",
+           trazaActiva ? "grabando" : "detenida", (unsigned long)escritos,
+           (unsigned long)(escritos < TRAZA_EVENTOS ? escritos : TRAZA_EVENTOS), TRAZA_EVENTOS);
+}
+
+#endif /* TRAZA_HABILITADA */
@@ -0,0 +1,260 @@
+/**
+  ******************************************************************************
+  * @file    uart_rx.c
+  * @brief   Recepción UART por DMA circular (ver uart_rx.h).
+  *
+  *          La interrupción no toca los datos: convierte la posición del DMA
+  *          en un contador monótono de bytes recibidos y notifica a la tarea
+  *          lectora. Como el DMA avisa en la mitad y al final del anillo, el
+  *          avance entre dos avisos siempre es menor que el anillo.
+  *
+  *          Si la tarea se atrasa más de un anillo completo, el framer lo
+  *          detecta comparando posiciones y descarta la línea afectada en
+  *          lugar de entregar texto mezclado.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_rx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#ifndef HOST_SIM
+#include "main.h"
+#include "usart.h"
+#endif
+
+/* Variables -----------------------------------------------------------------*/
+static uint8_t bufferRx[UART_RX_BUFFER_SIZE];
+static FramerRx framer;
+
+// Bytes escritos por el DMA desde el arranque (monótono)
+static volatile uint32_t escritoTotal = 0;
+#ifndef HOST_SIM
+static uint32_t ultimaPosDma = 0;
+#endif
+
+// Tras un error el DMA reinicia en 0: la tarea salta a esta posición
+static volatile int saltoPendiente = 0;
+static volatile uint32_t posicionSalto = 0;
+
+static volatile uint32_t erroresUart = 0;
+static TaskHandle_t tareaLectora = NULL;
+
+/* Framer --------------------------------------------------------------------*/
+
+void framerRxIniciar(FramerRx *f, uint8_t *anillo, uint32_t tam) {
+    memset(f, 0, sizeof(*f));
+    f->anillo = anillo;
+    f->tam = tam;
+}
+
+// Abandona la línea en curso y continúa desde pos
+static void framerRxSaltar(FramerRx *f, uint32_t pos) {
+    f->leido = pos;
+    f->inicioLinea = pos;
+    f->descartando = 1;
+    f->enTrama = 0;
+}
+
+// Entrega la siguiente línea completa hasta la posición escrito; 0 si no hay.
+// El tramo apunta al anillo (o a f->partida si cruzó el final) y es válido
+// hasta la próxima llamada.
+int framerRxSiguiente(FramerRx *f, uint32_t escrito, LineaRx *linea) {
+    // El productor dio la vuelta sobre bytes sin leer
+    if (escrito - f->leido > f->tam) {
+        f->est.bytesPerdidos += escrito - f->leido - f->tam;
+        framerRxSaltar(f, escrito - f->tam);
+    }
+    // La línea en curso ya fue sobrescrita
+    if (escrito - f->inicioLinea > f->tam) {
+        f->descartando = 1;
+    }
+
+    while (f->leido != escrito) {
+        uint32_t pos = f->leido++;
+        uint8_t c = f->anillo[pos % f->tam];
+        int fin;
+
+        if (f->enTrama) {
+            fin = (c == 0x00);
+        } else if (c == 0x00) {
+            // Abre una trama; el texto a medias que hubiera se descarta
+            f->enTrama = 1;
+            f->inicioLinea = f->leido;
+            f->descartando = 0;
+            continue;
+        } else {
+            fin = (c == '\n' || c == '\r');
+        }
+
+        if (!fin) {
+            if (!f->descartando && pos - f->inicioLinea >= UART_RX_MAX_LINEA) {
+                f->descartando = 1;
+                f->est.lineasLargas++;
+            }
+            continue;
+        }
+
+        uint32_t inicio = f->inicioLinea;
+        uint32_t len = pos - inicio;
+        int descartar = f->descartando;
+        int binaria = f->enTrama;
+
+        // 0x00 repetido: la trama sigue abierta y empieza tras este cero
+        if (binaria && len == 0 && !descartar) {
+            f->inicioLinea = f->leido;
+            continue;
+        }
+
+        f->inicioLinea = f->leido;
+        f->descartando = 0;
+        f->enTrama = 0;
+
+        // "\r\n" deja una línea vacía que no se entrega
+        if (descartar || len == 0) continue;
+
+        uint32_t i = inicio % f->tam;
+
+        if (i + len < f->tam) {
+            // Contigua: el terminador se reemplaza en el lugar (en una
+            // trama ya vale 0x00)
+            f->anillo[i + len] = '\0';
+            linea->datos = (char *)&f->anillo[i];
+        } else {
+            uint32_t primera = f->tam - i;
+            memcpy(f->partida, &f->anillo[i], primera);
+            memcpy(&f->partida[primera], f->anillo, len - primera);
+            f->partida[len] = '\0';
+            linea->datos = f->partida;
+            f->est.lineasPartidas++;
+        }
+
+        linea->len = (uint16_t)len;
+        linea->binaria = (uint8_t)binaria;
+        if (binaria) f->est.tramas++;
+        else f->est.lineas++;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Recepción -----------------------------------------------------------------*/
+
+#ifndef HOST_SIM
+// Arranca el DMA circular con aviso de línea inactiva
+static void iniciarRecepcion(void) {
+    ultimaPosDma = 0;
+
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&huart2, bufferRx, UART_RX_BUFFER_SIZE) != HAL_OK) {
+        erroresUart++;
+    }
+}
+#endif
+
+void uartRxInit(void) {
+    framerRxIniciar(&framer, bufferRx, UART_RX_BUFFER_SIZE);
+    escritoTotal = 0;
+    saltoPendiente = 0;
+#ifndef HOST_SIM
+    iniciarRecepcion();
+#endif
+}
+
+// Despierta a la tarea lectora si ya se registró (contexto ISR)
+static void notificarDesdeISR(void) {
+#ifdef HOST_SIM
+    if (tareaLectora != NULL) {
+        xTaskNotifyGive(tareaLectora);
+    }
+#else
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if (tareaLectora != NULL) {
+        vTaskNotifyGiveFromISR(tareaLectora, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+#endif
+}
+
+// Espera la siguiente línea completa; 0 si vence la espera.
+// La primera llamada registra a la tarea que será notificada.
+int uartRxSiguienteLinea(LineaRx *linea, uint32_t esperaMs) {
+    if (tareaLectora == NULL) {
+        tareaLectora = xTaskGetCurrentTaskHandle();
+    }
+
+    for (;;) {
+        if (saltoPendiente) {
+            taskENTER_CRITICAL();
+            uint32_t pos = posicionSalto;
+            saltoPendiente = 0;
+            taskEXIT_CRITICAL();
+
+            framerRxSaltar(&framer, pos);
+        }
+
+        if (framerRxSiguiente(&framer, escritoTotal, linea)) {
+            return 1;
+        }
+
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(esperaMs)) == 0) {
+            return 0;
+        }
+    }
+}
+
+// Copia de los contadores de recepción
+void uartRxObtenerEstadisticas(EstadisticasUartRx *out) {
+    if (out == NULL) return;
+
+    taskENTER_CRITICAL();
+    *out = framer.est;
+    out->bytesRecibidos = escritoTotal;
+    out->erroresUart = erroresUart;
+    taskEXIT_CRITICAL();
+}
+
+#ifdef HOST_SIM
+// Simula al DMA: copia al anillo y avisa como lo haría la interrupción
+void uartRxAlimentar(const uint8_t *datos, int len) {
+    for (int k = 0; k < len; k++) {
+        bufferRx[(escritoTotal + k) % UART_RX_BUFFER_SIZE] = datos[k];
+    }
+    escritoTotal += len;
+    notificarDesdeISR();
+}
+#else
+// Error de UART: si la recepción quedó abortada (p. ej. overrun) se rearma
+void uartRxErrorUart(void) {
+    erroresUart++;
+
+    if (huart2.RxState != HAL_UART_STATE_READY) return;
+
+    // El DMA vuelve a escribir desde el índice 0 del anillo
+    uint32_t base = ((escritoTotal + UART_RX_BUFFER_SIZE - 1) / UART_RX_BUFFER_SIZE) * UART_RX_BUFFER_SIZE;
+    escritoTotal = base;
+    posicionSalto = base;
+    saltoPendiente = 1;
+
+    iniciarRecepcion();
+    notificarDesdeISR();
+}
+
+// Callback HAL de mitad, fin de anillo o línea inactiva (USART2 RX)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart->Instance != USART2) return;
+
+    uint32_t pos = Size % UART_RX_BUFFER_SIZE;
+    uint32_t nuevos = (pos + UART_RX_BUFFER_SIZE - ultimaPosDma) % UART_RX_BUFFER_SIZE;
+
+    ultimaPosDma = pos;
+    if (nuevos == 0) return;
+
+    escritoTotal += nuevos;
+    notificarDesdeISR();
+}
+#endif
@@ -0,0 +1,481 @@
+/**
+  ******************************************************************************
+  * @file    uart_tx.c
+  * @brief   Transmisión UART no bloqueante.
+  *
+  *          Las tareas (productores) reservan espacio en un buffer circular
+  *          con compare-and-swap, copian la línea y la publican marcando su
+  *          cabecera. Un único consumidor (quien gane la bandera "drenando")
+  *          envía los registros publicados en orden: por DMA en la placa,
+  *          encadenando el siguiente desde la interrupción de fin de envío,
+  *          o de forma síncrona con uartTxHostEscribir en host (HOST_SIM).
+  *
+  *          Formato en el buffer: cabecera de 4 bytes + datos, alineado a 4.
+  *          Un registro nunca cruza el final del buffer; si no cabe se
+  *          reserva un relleno hasta el final y el registro empieza en 0.
+  *          Todo byte libre del buffer vale 0, así una cabecera a medio
+  *          publicar nunca parece lista.
+  *
+  *          Si el DMA no acepta un registro (HAL_BUSY o HAL_ERROR) el
+  *          registro sigue en curso. Sin transferencia en vuelo no llega
+  *          ningún callback, así que se reintenta desde el próximo
+  *          productor o desde uartTxReintentar, que StartTaskTx llama en
+  *          cada vuelta aunque nadie imprima; tras UART_TX_MAX_REINTENTOS
+  *          se descarta y cuenta como tal.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#ifdef HOST_SIM
+#include <stdio.h>
+#else
+#include "main.h"
+#include "usart.h"
+#endif
+
+/* Defines -------------------------------------------------------------------*/
+#define MASCARA_TX     (UART_TX_BUFFER_SIZE - 1)
+#define CAB_LISTO      (1u << 31)
+#define CAB_RELLENO    (1u << 30)
+#define CAB_LONGITUD   0xFFFFu
+#define TAM_CABECERA   4u
+
+#if (UART_TX_BUFFER_SIZE & MASCARA_TX) != 0
+#error "UART_TX_BUFFER_SIZE debe ser potencia de 2"
+#endif
+
+/* Variables -----------------------------------------------------------------*/
+static uint8_t bufferTx[UART_TX_BUFFER_SIZE] __attribute__((aligned(4)));
+
+// Índices monótonos (se enmascaran al acceder al buffer)
+static uint32_t idxReservado;
+static uint32_t idxLeido;
+
+// Propiedad del consumidor y registro en vuelo
+static uint32_t drenando;
+static uint32_t tamEnCurso;
+static uint32_t lenEnCurso;
+static const uint8_t *datosEnCurso;
+// Intentos fallidos del registro en curso (0 = en vuelo por DMA)
+static volatile uint32_t reintentosEnCurso;
+
+static volatile int modoPanico = 0;
+static volatile ModoUartTx modoTx = UART_TX_BLOQUEAR;
+
+static EstadisticasUartTx estadisticasTx;
+
+/* Helper Functions ----------------------------------------------------------*/
+
+#ifdef HOST_SIM
+// Transporte por defecto en host; el simulador (Host/sim) lo reemplaza por
+// su enlace serie
+__attribute__((weak)) void uartTxHostEscribir(const uint8_t *datos, int len) {
+    fwrite(datos, 1, len, stdout);
+    fflush(stdout);
+}
+#endif
+
+static inline uint32_t alinear4(uint32_t n) {
+    return (n + 3u) & ~3u;
+}
+
+static inline uint32_t *cabeceraEn(uint32_t idx) {
+    return (uint32_t *)&bufferTx[idx & MASCARA_TX];
+}
+
+static inline void contar(uint32_t *contador, uint32_t n) {
+    __atomic_fetch_add(contador, n, __ATOMIC_RELAXED);
+}
+
+// Máximo atómico: varios productores pueden reservar a la vez
+static void actualizarMaximo(uint32_t *maximo, uint32_t valor) {
+    uint32_t actual = __atomic_load_n(maximo, __ATOMIC_RELAXED);
+
+    while (valor > actual &&
+           !__atomic_compare_exchange_n(maximo, &actual, valor, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Indica si se ejecuta dentro de una interrupción
+static int enContextoISR(void) {
+#ifdef HOST_SIM
+    return 0;
+#else
+    return __get_IPSR() != 0;
+#endif
+}
+
+// Solo se puede esperar desde una tarea con el scheduler corriendo
+static int puedeBloquear(void) {
+    return !enContextoISR() && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+// Reserva "total" bytes contiguos; devuelve 0 si no hay espacio
+static int reservarRegistro(uint32_t total, uint32_t *inicio) {
+    uint32_t r = __atomic_load_n(&idxReservado, __ATOMIC_RELAXED);
+
+    for (;;) {
+        uint32_t l = __atomic_load_n(&idxLeido, __ATOMIC_ACQUIRE);
+        uint32_t off = r & MASCARA_TX;
+        uint32_t relleno = (UART_TX_BUFFER_SIZE - off < total) ? (UART_TX_BUFFER_SIZE - off) : 0;
+        uint32_t ocupado = r - l;
+
+        if (ocupado + relleno + total > UART_TX_BUFFER_SIZE) {
+            return 0;
+        }
+
+        if (__atomic_compare_exchange_n(&idxReservado, &r, r + relleno + total,
+                                        1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            if (relleno > 0) {
+                __atomic_store_n(cabeceraEn(r), CAB_LISTO | CAB_RELLENO | (relleno - TAM_CABECERA),
+                                 __ATOMIC_RELEASE);
+            }
+
+            actualizarMaximo(&estadisticasTx.ocupacionMaxima, ocupado + relleno + total);
+
+            *inicio = r + relleno;
+            return 1;
+        }
+    }
+}
+
+// Hay un registro publicado esperando al consumidor
+static int hayRegistroListo(void) {
+    uint32_t l = __atomic_load_n(&idxLeido, __ATOMIC_RELAXED);
+
+    if (l == __atomic_load_n(&idxReservado, __ATOMIC_ACQUIRE)) return 0;
+
+    return (__atomic_load_n(cabeceraEn(l), __ATOMIC_ACQUIRE) & CAB_LISTO) != 0;
+}
+
+// Avanza hasta el siguiente registro de datos publicado (solo consumidor)
+static int prepararSiguiente(const uint8_t **datos, uint16_t *len) {
+    for (;;) {
+        uint32_t l = __atomic_load_n(&idxLeido, __ATOMIC_RELAXED);
+
+        if (l == __atomic_load_n(&idxReservado, __ATOMIC_ACQUIRE)) return 0;
+
+        uint32_t cab = __atomic_load_n(cabeceraEn(l), __ATOMIC_ACQUIRE);
+        if (!(cab & CAB_LISTO)) return 0;
+
+        uint32_t n = cab & CAB_LONGITUD;
+
+        if (cab & CAB_RELLENO) {
+            *cabeceraEn(l) = 0;
+            __atomic_store_n(&idxLeido, l + TAM_CABECERA + n, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        *datos = &bufferTx[(l & MASCARA_TX) + TAM_CABECERA];
+        *len = (uint16_t)n;
+        datosEnCurso = *datos;
+        tamEnCurso = alinear4(TAM_CABECERA + n);
+        lenEnCurso = n;
+        return 1;
+    }
+}
+
+// Libera el registro en vuelo dejando sus bytes a 0 (solo consumidor)
+static void liberarEnCurso(int enviado) {
+    uint32_t l = __atomic_load_n(&idxLeido, __ATOMIC_RELAXED);
+
+    memset(&bufferTx[l & MASCARA_TX], 0, tamEnCurso);
+
+    if (enviado) {
+        contar(&estadisticasTx.bytesEnviados, lenEnCurso);
+        contar(&estadisticasTx.registrosEnviados, 1);
+    } else {
+        contar(&estadisticasTx.bytesDescartados, lenEnCurso);
+        contar(&estadisticasTx.registrosDescartados, 1);
+    }
+
+    __atomic_store_n(&idxLeido, l + tamEnCurso, __ATOMIC_RELEASE);
+    tamEnCurso = 0;
+    lenEnCurso = 0;
+    datosEnCurso = NULL;
+    reintentosEnCurso = 0;
+}
+
+// Inicia el envío del siguiente registro; 1 si queda una transferencia en curso
+static int drenarSiguiente(void) {
+    const uint8_t *datos;
+    uint16_t len;
+
+    while (prepararSiguiente(&datos, &len)) {
+#ifdef HOST_SIM
+        uartTxHostEscribir(datos, len);
+        liberarEnCurso(1);
+#else
+        if (HAL_UART_Transmit_DMA(&huart2, datos, len) != HAL_OK) {
+            // Periférico ocupado o en error: el registro queda en curso
+            contar(&estadisticasTx.fallosDma, 1);
+            reintentosEnCurso = 1;
+        }
+        return 1;
+#endif
+    }
+
+    return 0;
+}
+
+static void finalizarTransferencia(int enviado);
+
+#ifndef HOST_SIM
+// Vuelve a pasar al DMA el registro que rechazó; lo descarta al agotar los
+// intentos. Se llama con las interrupciones enmascaradas o desde la ISR
+static void reintentarEnCurso(void) {
+    if (reintentosEnCurso == 0 || tamEnCurso == 0) return;
+
+    if (HAL_UART_Transmit_DMA(&huart2, datosEnCurso, (uint16_t)lenEnCurso) == HAL_OK) {
+        reintentosEnCurso = 0;
+        return;
+    }
+
+    contar(&estadisticasTx.fallosDma, 1);
+    if (++reintentosEnCurso > UART_TX_MAX_REINTENTOS) {
+        finalizarTransferencia(0);
+    }
+}
+#endif
+
+// Toma el rol de consumidor si está libre y arranca el drenado
+static void intentarDrenar(void) {
+    uint32_t libre = 0;
+
+#ifndef HOST_SIM
+    // El consumidor actual tiene un registro que el DMA rechazó
+    if (reintentosEnCurso != 0) {
+        UBaseType_t estado = taskENTER_CRITICAL_FROM_ISR();
+        reintentarEnCurso();
+        taskEXIT_CRITICAL_FROM_ISR(estado);
+    }
+#endif
+
+    while (__atomic_compare_exchange_n(&drenando, &libre, 1, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if (drenarSiguiente()) return;
+
+        __atomic_store_n(&drenando, 0, __ATOMIC_RELEASE);
+
+        // Un productor pudo publicar mientras teníamos la bandera
+        if (!hayRegistroListo()) return;
+        libre = 0;
+    }
+}
+
+// Reserva con la política del modo actual; cuenta el descarte si falla
+static int reservarConEspera(uint32_t total, uint32_t len, uint32_t *inicio) {
+    if (!reservarRegistro(total, inicio)) {
+        contar(&estadisticasTx.desbordes, 1);
+
+        int reservado = 0;
+        if (modoTx == UART_TX_BLOQUEAR && puedeBloquear()) {
+            TickType_t limite = pdMS_TO_TICKS(UART_TX_TIMEOUT_BLOQUEO_MS);
+            TickType_t esperado = 0;
+
+            do {
+                vTaskDelay(1);
+                esperado++;
+                reservado = reservarRegistro(total, inicio);
+            } while (!reservado && esperado < limite);
+        }
+
+        if (!reservado) {
+            contar(&estadisticasTx.bytesDescartados, len);
+            contar(&estadisticasTx.registrosDescartados, 1);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+// Copia y publica un registro de hasta UART_TX_MAX_REGISTRO bytes
+static int encolarRegistro(const char *datos, uint32_t len) {
+    uint32_t total = alinear4(TAM_CABECERA + len);
+    uint32_t inicio;
+
+    if (!reservarConEspera(total, len, &inicio)) return 0;
+
+    memcpy(&bufferTx[(inicio & MASCARA_TX) + TAM_CABECERA], datos, len);
+    __atomic_store_n(cabeceraEn(inicio), CAB_LISTO | len, __ATOMIC_RELEASE);
+
+    intentarDrenar();
+    return 1;
+}
+
+/* Public Functions ----------------------------------------------------------*/
+
+// Reinicia el buffer y los contadores
+void uartTxInit(void) {
+    memset(bufferTx, 0, sizeof(bufferTx));
+    memset(&estadisticasTx, 0, sizeof(estadisticasTx));
+    idxReservado = 0;
+    idxLeido = 0;
+    drenando = 0;
+    tamEnCurso = 0;
+    lenEnCurso = 0;
+    datosEnCurso = NULL;
+    reintentosEnCurso = 0;
+    modoPanico = 0;
+}
+
+// Encola datos para transmitir; devuelve los bytes aceptados
+int uartTxEnviar(const char *datos, int len) {
+    if (datos == NULL || len <= 0) return 0;
+
+    if (modoPanico) {
+#ifdef HOST_SIM
+        uartTxHostEscribir((const uint8_t *)datos, len);
+#else
+        HAL_UART_Transmit(&huart2, (const uint8_t *)datos, (uint16_t)len, HAL_MAX_DELAY);
+#endif
+        return len;
+    }
+
+    // Partido en trozos podría intercalarse con otro productor: se descarta
+    if (len > UART_TX_MAX_REGISTRO) {
+        contar(&estadisticasTx.bytesDescartados, (uint32_t)len);
+        contar(&estadisticasTx.registrosDescartados, 1);
+        contar(&estadisticasTx.registrosLargos, 1);
+        return 0;
+    }
+
+    return encolarRegistro(datos, (uint32_t)len) ? len : 0;
+}
+
+// Reserva hasta "capacidad" bytes para escribir en el lugar; NULL si no hay espacio
+uint8_t *uartTxReservar(int capacidad, ReservaUartTx *reserva) {
+    if (reserva == NULL || capacidad <= 0 || capacidad > UART_TX_MAX_REGISTRO || modoPanico) {
+        return NULL;
+    }
+
+    uint32_t total = alinear4(TAM_CABECERA + (uint32_t)capacidad);
+    uint32_t inicio;
+
+    if (!reservarConEspera(total, (uint32_t)capacidad, &inicio)) return NULL;
+
+    reserva->inicio = inicio;
+    reserva->total = total;
+    return &bufferTx[(inicio & MASCARA_TX) + TAM_CABECERA];
+}
+
+// Publica los primeros "len" bytes de la reserva; el resto queda como relleno
+void uartTxConfirmar(ReservaUartTx *reserva, int len) {
+    uint32_t usado = (len > 0) ? alinear4(TAM_CABECERA + (uint32_t)len) : 0;
+    uint32_t sobrante = reserva->total - usado;
+    uint8_t *base = &bufferTx[reserva->inicio & MASCARA_TX];
+
+    if (sobrante > 0) {
+        // El escritor pudo tocar bytes que ya no se envían: vuelven a 0
+        memset(base + usado + TAM_CABECERA, 0, sobrante - TAM_CABECERA);
+        __atomic_store_n(cabeceraEn(reserva->inicio + usado),
+                         CAB_LISTO | CAB_RELLENO | (sobrante - TAM_CABECERA), __ATOMIC_RELEASE);
+    }
+
+    if (usado > 0) {
+        __atomic_store_n(cabeceraEn(reserva->inicio), CAB_LISTO | (uint32_t)len, __ATOMIC_RELEASE);
+    } else {
+        contar(&estadisticasTx.registrosDescartados, 1);
+    }
+
+    intentarDrenar();
+}
+
+void uartTxSetModo(ModoUartTx modo) {
+    modoTx = modo;
+}
+
+ModoUartTx uartTxGetModo(void) {
+    return modoTx;
+}
+
+// Copia de los contadores de transmisión
+void uartTxObtenerEstadisticas(EstadisticasUartTx *out) {
+    if (out == NULL) return;
+
+    out->bytesEnviados = __atomic_load_n(&estadisticasTx.bytesEnviados, __ATOMIC_RELAXED);
+    out->registrosEnviados = __atomic_load_n(&estadisticasTx.registrosEnviados, __ATOMIC_RELAXED);
+    out->registrosDescartados = __atomic_load_n(&estadisticasTx.registrosDescartados, __ATOMIC_RELAXED);
+    out->bytesDescartados = __atomic_load_n(&estadisticasTx.bytesDescartados, __ATOMIC_RELAXED);
+    out->desbordes = __atomic_load_n(&estadisticasTx.desbordes, __ATOMIC_RELAXED);
+    out->ocupacionMaxima = __atomic_load_n(&estadisticasTx.ocupacionMaxima, __ATOMIC_RELAXED);
+    out->fallosDma = __atomic_load_n(&estadisticasTx.fallosDma, __ATOMIC_RELAXED);
+    out->registrosLargos = __atomic_load_n(&estadisticasTx.registrosLargos, __ATOMIC_RELAXED);
+}
+
+// Pasa a transmisión bloqueante directa (hooks de error con IRQs deshabilitadas)
+void uartTxModoPanico(void) {
+    modoPanico = 1;
+#ifndef HOST_SIM
+    HAL_UART_AbortTransmit(&huart2);
+#endif
+}
+
+// Cierra la transferencia en vuelo y encadena la siguiente (contexto ISR)
+static void finalizarTransferencia(int enviado) {
+    if (tamEnCurso == 0) return;
+
+#ifndef HOST_SIM
+    // El registro en curso no llegó a salir: este aviso es la ocasión de
+    // reintentarlo, no su fin
+    if (reintentosEnCurso != 0 && enviado) {
+        reintentarEnCurso();
+        return;
+    }
+#endif
+
+    liberarEnCurso(enviado);
+
+    if (!drenarSiguiente()) {
+        __atomic_store_n(&drenando, 0, __ATOMIC_RELEASE);
+
+        if (hayRegistroListo()) {
+            intentarDrenar();
+        }
+    }
+}
+
+// Reintenta el registro que el DMA rechazó, o drena lo publicado si nadie
+// lo hizo; llamarla periódicamente desde una tarea
+void uartTxReintentar(void) {
+    if (modoPanico) return;
+    intentarDrenar();
+}
+
+// Fin de una transferencia: libera el registro y encadena el siguiente
+void uartTxTransmisionCompleta(void) {
+    finalizarTransferencia(1);
+}
+
+#ifndef HOST_SIM
+// Callback HAL de fin de transmisión (USART2 TX por DMA)
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART2)
+    {
+        uartTxTransmisionCompleta();
+    }
+}
+
+// Callback HAL de error: si la transmisión quedó abortada se descarta el
+// registro; la recepción se rearma en uart_rx.c
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if (huart->Instance != USART2) return;
+
+    if (huart->gState == HAL_UART_STATE_READY)
+    {
+        finalizarTransferencia(0);
+    }
+
+    uartRxErrorUart();
+}
+#endif
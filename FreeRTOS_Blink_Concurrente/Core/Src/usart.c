@@ -25,6 +25,8 @@
 /* USER CODE END 0 */
 
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart2_tx;
+DMA_HandleTypeDef hdma_usart2_rx;
 
 /* USART2 init function */
 
@@ -82,6 +84,50 @@ HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
 /* USER CODE BEGIN USART2_MspInit 1 */
 
+/* ===== CONFIGURACIÓN DMA USART2 TX (DMA1 Stream6 Channel4) ===== */
+__HAL_RCC_DMA1_CLK_ENABLE();
+
+hdma_usart2_tx.Instance = DMA1_Stream6;
+hdma_usart2_tx.Init.Channel = DMA_CHANNEL_4;
+hdma_usart2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+hdma_usart2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+hdma_usart2_tx.Init.MemInc = DMA_MINC_ENABLE;
+hdma_usart2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+hdma_usart2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+hdma_usart2_tx.Init.Mode = DMA_NORMAL;
+hdma_usart2_tx.Init.Priority = DMA_PRIORITY_LOW;
+hdma_usart2_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+if (HAL_DMA_Init(&hdma_usart2_tx) != HAL_OK)
+{
+Error_Handler();
+}
+
+__HAL_LINKDMA(uartHandle, hdmatx, hdma_usart2_tx);
+
+HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 5, 0);
+HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+
+/* ===== CONFIGURACIÓN DMA USART2 RX (DMA1 Stream5 Channel4, circular) ===== */
+hdma_usart2_rx.Instance = DMA1_Stream5;
+hdma_usart2_rx.Init.Channel = DMA_CHANNEL_4;
+hdma_usart2_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+hdma_usart2_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+hdma_usart2_rx.Init.MemInc = DMA_MINC_ENABLE;
+hdma_usart2_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+hdma_usart2_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+hdma_usart2_rx.Init.Mode = DMA_CIRCULAR;
+hdma_usart2_rx.Init.Priority = DMA_PRIORITY_HIGH;
+hdma_usart2_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+if (HAL_DMA_Init(&hdma_usart2_rx) != HAL_OK)
+{
+Error_Handler();
+}
+
+__HAL_LINKDMA(uartHandle, hdmarx, hdma_usart2_rx);
+
+HAL_NVIC_SetPriority(DMA1_Stream5_IRQn, 5, 0);
+HAL_NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+
 /* ===== CONFIGURACIÓN DE INTERRUPCIONES USART2 ===== */
 HAL_NVIC_SetPriority(USART2_IRQn, 5, 0);
 HAL_NVIC_EnableIRQ(USART2_IRQn);
@@ -112,6 +158,14 @@ HAL_GPIO_DeInit(GPIOA, USART_TX_Pin|USART_RX_Pin);
 /* ===== DESHABILITAR INTERRUPCIONES USART2 ===== */
 HAL_NVIC_DisableIRQ(USART2_IRQn);
 
+/* ===== LIBERAR DMA USART2 TX ===== */
+HAL_DMA_DeInit(uartHandle->hdmatx);
+HAL_NVIC_DisableIRQ(DMA1_Stream6_IRQn);
+
+/* ===== LIBERAR DMA USART2 RX ===== */
+HAL_DMA_DeInit(uartHandle->hdmarx);
+HAL_NVIC_DisableIRQ(DMA1_Stream5_IRQn);
+
 /* USER CODE END USART2_MspDeInit 1 */
 }
 }
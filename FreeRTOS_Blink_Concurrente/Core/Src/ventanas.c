@@ -0,0 +1,127 @@
+/**
+  ******************************************************************************
+  * @file    ventanas.c
+  * @brief   Métricas en ventanas móviles (ver ventanas.h).
+  *
+  *          Registran varias tareas (creación de pedidos y entregas), así
+  *          que cada evento se aplica en una sección crítica corta. El
+  *          resumen lee sin bloquear: como mucho ve a medias el evento que
+  *          se está registrando.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "ventanas.h"
+#include "histograma.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t numero;            // tiempo / VENTANA_SEG_CUBETA que representa
+    uint16_t pedidos;
+    uint16_t entregas;
+    uint8_t latencia[VENTANA_HIST_CUBETAS];
+} CubetaVentana;
+
+/* Variables -----------------------------------------------------------------*/
+static CubetaVentana anillo[VENTANA_NUM_CUBETAS];
+static uint32_t inicio = 0;
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static inline uint32_t numeroCubeta(uint32_t ahora) {
+    return ahora / (VENTANA_SEG_CUBETA * 1000u);
+}
+
+// Cubeta del instante dado; si tenía datos de una vuelta anterior se vacía
+static CubetaVentana *cubetaActual(uint32_t ahora) {
+    uint32_t numero = numeroCubeta(ahora);
+    CubetaVentana *c = &anillo[numero % VENTANA_NUM_CUBETAS];
+
+    if (c->numero != numero) {
+        memset(c, 0, sizeof(*c));
+        c->numero = numero;
+    }
+    return c;
+}
+
+static inline void sumarSaturado16(uint16_t *v) {
+    if (*v != UINT16_MAX) (*v)++;
+}
+
+/* Functions -----------------------------------------------------------------*/
+
+void ventanasReiniciar(uint32_t ahora) {
+    taskENTER_CRITICAL();
+    memset(anillo, 0, sizeof(anillo));
+    for (int i = 0; i < VENTANA_NUM_CUBETAS; i++) {
+        anillo[i].numero = UINT32_MAX;
+    }
+    inicio = ahora;
+    taskEXIT_CRITICAL();
+}
+
+void ventanasRegistrarPedido(uint32_t ahora) {
+    taskENTER_CRITICAL();
+    sumarSaturado16(&cubetaActual(ahora)->pedidos);
+    taskEXIT_CRITICAL();
+}
+
+void ventanasRegistrarEntrega(uint32_t ahora, uint32_t totalMs) {
+    uint32_t i = histogramaIndice(totalMs, VENTANA_HIST_BITS_SUB, VENTANA_HIST_BITS_MAX);
+
+    taskENTER_CRITICAL();
+    CubetaVentana *c = cubetaActual(ahora);
+    sumarSaturado16(&c->entregas);
+    if (c->latencia[i] != UINT8_MAX) c->latencia[i]++;
+    taskEXIT_CRITICAL();
+}
+
+// Tasas y percentiles de los últimos minutos (1..VENTANA_MAX_MIN)
+void ventanasResumir(uint32_t ahora, uint32_t minutos, ResumenVentana *r) {
+    uint32_t latencia[VENTANA_HIST_CUBETAS];
+    uint32_t muestras = 0;
+
+    memset(r, 0, sizeof(*r));
+    memset(latencia, 0, sizeof(latencia));
+
+    if (minutos < 1) minutos = 1;
+    if (minutos > VENTANA_MAX_MIN) minutos = VENTANA_MAX_MIN;
+    r->minutos = minutos;
+
+    uint32_t actual = numeroCubeta(ahora);
+    uint32_t cubetas = minutos * 60 / VENTANA_SEG_CUBETA + 1;
+
+    for (uint32_t k = 0; k < cubetas && k <= actual; k++) {
+        const CubetaVentana *c = &anillo[(actual - k) % VENTANA_NUM_CUBETAS];
+        if (c->numero != actual - k) continue;
+
+        r->pedidos += c->pedidos;
+        r->entregas += c->entregas;
+        for (uint32_t i = 0; i < VENTANA_HIST_CUBETAS; i++) {
+            latencia[i] += c->latencia[i];
+            muestras += c->latencia[i];
+        }
+    }
+
+    // Minutos completos más lo que va de la cubeta actual, sin pasar del
+    // tiempo transcurrido desde el reinicio
+    uint32_t cubiertoMs = minutos * 60000u + ahora % (VENTANA_SEG_CUBETA * 1000u);
+    if (ahora - inicio < cubiertoMs) cubiertoMs = ahora - inicio;
+    r->segundosCubiertos = cubiertoMs / 1000;
+
+    if (cubiertoMs > 0) {
+        r->pedidosPorMin = (uint32_t)((uint64_t)r->pedidos * 6000000u / cubiertoMs);
+        r->entregasPorMin = (uint32_t)((uint64_t)r->entregas * 6000000u / cubiertoMs);
+    }
+
+    const uint32_t milesimas[3] = { 500, 950, 990 };
+    uint32_t *destino[3] = { &r->p50, &r->p95, &r->p99 };
+
+    for (int k = 0; k < 3; k++) {
+        int i = histogramaCubetaPercentil(latencia, VENTANA_HIST_CUBETAS, muestras, milesimas[k]);
+        if (i >= 0) *destino[k] = histogramaValorCubeta((uint32_t)i, VENTANA_HIST_BITS_SUB);
+    }
+}
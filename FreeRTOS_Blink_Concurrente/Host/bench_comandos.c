@@ -0,0 +1,256 @@
+/**
+  ******************************************************************************
+  * @file    bench_comandos.c
+  * @brief   Benchmark en host: despacho de comandos por tabla (comandos.c)
+  *          contra la cadena anterior de strstr + cleanLine + atoi.
+  *
+  *          Compilar desde FreeRTOS_Blink_Concurrente:
+  *            gcc -O2 -ICore/Inc Host/bench_comandos.c Core/Src/comandos.c -o bench_comandos
+  *          Ejecutar: ./bench_comandos [iteraciones]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "comandos.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define MAX_PLATILLOS   10
+#define NUM_LINEAS      8
+// Comandos extra para comprobar que el costo no crece con la tabla
+#define NUM_EXTRA       40
+
+/* Types ---------------------------------------------------------------------*/
+// Lo que cada camino extrae de la línea; se compara entre ambos
+typedef struct {
+    int comando;
+    int restId;
+    int casaId;
+    int platillos[MAX_PLATILLOS];
+    int platillosCount;
+    char recibo[20];
+} Resultado;
+
+/* Variables -----------------------------------------------------------------*/
+static const char *lineas[NUM_LINEAS] = {
+    "PEDIDO_WEB,3,7,0,2,4",
+    "PEDIDO_WEB,1,12,5",
+    "PEDIDO_WEB, 2, 4, 1, 1, 3, 0",
+    "CANCELAR_PEDIDO,PED-1234",
+    "STATS",
+    "PEDIDO",
+    "TXSTATS",
+    "INFO"
+};
+
+static Resultado resultado;
+static volatile int sumidero;
+
+enum { C_START = 1, C_STOP, C_MAP, C_REGEN, C_TXSTATS, C_RXSTATS, C_TXMODO, C_FORMATO,
+       C_STATS, C_METRICS, C_CANCELAR, C_PEDIDO_WEB, C_PEDIDO, C_INFO, C_HELP, C_EXTRA };
+
+/* Camino anterior -----------------------------------------------------------*/
+
+static void limpiar(const char *line, char *cleanLine) {
+    int cleanIdx = 0;
+    for (int i = 0; i < (int)strlen(line); i++) {
+        if (line[i] != ' ' && line[i] != '\r' && line[i] != '\n' && line[i] != '\t') {
+            cleanLine[cleanIdx++] = line[i];
+        }
+    }
+    cleanLine[cleanIdx] = '\0';
+}
+
+// Misma cadena y el mismo parseo que tenía StartTaskRx
+static void despacharAnterior(const char *line) {
+    char cleanLine[256];
+    memset(&resultado, 0, sizeof(resultado));
+
+    if (strstr(line, "START")) resultado.comando = C_START;
+    else if (strstr(line, "STOP")) resultado.comando = C_STOP;
+    else if (strstr(line, "MAP")) resultado.comando = C_MAP;
+    else if (strstr(line, "REGEN")) resultado.comando = C_REGEN;
+    else if (strstr(line, "TXSTATS")) resultado.comando = C_TXSTATS;
+    else if (strstr(line, "RXSTATS")) resultado.comando = C_RXSTATS;
+    else if (strstr(line, "TXMODO")) resultado.comando = C_TXMODO;
+    else if (strstr(line, "FORMATO")) resultado.comando = C_FORMATO;
+    else if (strstr(line, "STATS")) resultado.comando = C_STATS;
+    else if (strstr(line, "METRICS")) resultado.comando = C_METRICS;
+    else if (strstr(line, "CANCELAR_PEDIDO")) {
+        resultado.comando = C_CANCELAR;
+        limpiar(line, cleanLine);
+        char *ptr = strchr(cleanLine, ',');
+        if (ptr) {
+            ptr++;
+            int idx = 0;
+            while (*ptr && idx < (int)sizeof(resultado.recibo) - 1) {
+                resultado.recibo[idx++] = *ptr++;
+            }
+            resultado.recibo[idx] = '\0';
+        }
+    }
+    else if (strstr(line, "PEDIDO_WEB")) {
+        resultado.comando = C_PEDIDO_WEB;
+        limpiar(line, cleanLine);
+        char *ptr = strchr(cleanLine, ',');
+        if (!ptr) return;
+        ptr++;
+        resultado.restId = atoi(ptr) - 1;
+        ptr = strchr(ptr, ',');
+        if (!ptr) return;
+        ptr++;
+        resultado.casaId = atoi(ptr) - 1;
+        ptr = strchr(ptr, ',');
+        if (!ptr) return;
+        ptr++;
+        while (*ptr && resultado.platillosCount < MAX_PLATILLOS) {
+            resultado.platillos[resultado.platillosCount++] = atoi(ptr);
+            ptr = strchr(ptr, ',');
+            if (!ptr) break;
+            ptr++;
+        }
+    }
+    else if (strstr(line, "PEDIDO")) resultado.comando = C_PEDIDO;
+    else if (strstr(line, "INFO")) resultado.comando = C_INFO;
+    else if (strstr(line, "HELP")) resultado.comando = C_HELP;
+}
+
+/* Camino nuevo --------------------------------------------------------------*/
+
+#define MANEJADOR_SIMPLE(nombre, codigo) \
+    static void nombre(const ArgsCmd *args) { (void)args; resultado.comando = codigo; }
+
+MANEJADOR_SIMPLE(cmdStart, C_START)
+MANEJADOR_SIMPLE(cmdStop, C_STOP)
+MANEJADOR_SIMPLE(cmdMap, C_MAP)
+MANEJADOR_SIMPLE(cmdRegen, C_REGEN)
+MANEJADOR_SIMPLE(cmdTxStats, C_TXSTATS)
+MANEJADOR_SIMPLE(cmdRxStats, C_RXSTATS)
+MANEJADOR_SIMPLE(cmdTxModo, C_TXMODO)
+MANEJADOR_SIMPLE(cmdFormato, C_FORMATO)
+MANEJADOR_SIMPLE(cmdStats, C_STATS)
+MANEJADOR_SIMPLE(cmdMetrics, C_METRICS)
+MANEJADOR_SIMPLE(cmdPedido, C_PEDIDO)
+MANEJADOR_SIMPLE(cmdInfo, C_INFO)
+MANEJADOR_SIMPLE(cmdHelp, C_HELP)
+MANEJADOR_SIMPLE(cmdExtra, C_EXTRA)
+
+static void cmdCancelarPedido(const ArgsCmd *args) {
+    const char *recibo;
+    resultado.comando = C_CANCELAR;
+    if (cmdArgTexto(args->argv[1], 19, &recibo)) {
+        strcpy(resultado.recibo, recibo);
+    }
+}
+
+static void cmdPedidoWeb(const ArgsCmd *args) {
+    int32_t v;
+    resultado.comando = C_PEDIDO_WEB;
+    if (!cmdArgEntero(args->argv[1], 1, 50, &v)) return;
+    resultado.restId = v - 1;
+    if (!cmdArgEntero(args->argv[2], 1, 50, &v)) return;
+    resultado.casaId = v - 1;
+    for (int i = 3; i < args->argc; i++) {
+        if (!cmdArgEntero(args->argv[i], 0, 15, &v)) return;
+        resultado.platillos[resultado.platillosCount++] = v;
+    }
+}
+
+static const Comando tablaBase[] = {
+    { "START",           cmdStart,          0, 0, "" },
+    { "STOP",            cmdStop,           0, 0, "" },
+    { "MAP",             cmdMap,            0, 0, "" },
+    { "REGEN",           cmdRegen,          0, 0, "" },
+    { "PEDIDO",          cmdPedido,         0, 0, "" },
+    { "PEDIDO_WEB",      cmdPedidoWeb,      3, 2 + MAX_PLATILLOS, "" },
+    { "CANCELAR_PEDIDO", cmdCancelarPedido, 1, 1, "" },
+    { "STATS",           cmdStats,          0, 0, "" },
+    { "METRICS",         cmdMetrics,        0, 0, "" },
+    { "INFO",            cmdInfo,           0, 0, "" },
+    { "TXSTATS",         cmdTxStats,        0, 0, "" },
+    { "RXSTATS",         cmdRxStats,        0, 0, "" },
+    { "TXMODO",          cmdTxModo,         0, 1, "" },
+    { "FORMATO",         cmdFormato,        0, 1, "" },
+    { "HELP",            cmdHelp,           0, 0, "" },
+};
+
+#define NUM_BASE ((int)(sizeof(tablaBase) / sizeof(tablaBase[0])))
+
+static Comando tablaGrande[NUM_BASE + NUM_EXTRA];
+static char nombresExtra[NUM_EXTRA][16];
+
+static void despacharNuevo(const char *line) {
+    char copia[256];
+    ArgsCmd args;
+    const Comando *cmd;
+
+    // La tarea recibe la línea ya en el anillo; aquí se copia para no
+    // destruir la entrada del benchmark
+    strcpy(copia, line);
+    memset(&resultado, 0, sizeof(resultado));
+    sumidero += comandosDespachar(copia, &args, &cmd);
+}
+
+/* Medición ------------------------------------------------------------------*/
+
+static double ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Tiempo por comando (ns) de un camino sobre la mezcla de líneas
+static double medir(void (*despachar)(const char *), long iteraciones) {
+    double t0 = ahoraNs();
+    for (long i = 0; i < iteraciones; i++) {
+        despachar(lineas[i % NUM_LINEAS]);
+        sumidero += resultado.comando;
+    }
+    return (ahoraNs() - t0) / iteraciones;
+}
+
+int main(int argc, char **argv) {
+    long iteraciones = (argc > 1) ? atol(argv[1]) : 2000000;
+    long diferencias = 0;
+
+    if (!comandosRegistrar(tablaBase, NUM_BASE)) {
+        fprintf(stderr, "tabla invalida\n");
+        return 1;
+    }
+
+    // Ambos caminos deben extraer lo mismo de cada línea
+    for (int i = 0; i < NUM_LINEAS; i++) {
+        Resultado a;
+        despacharAnterior(lineas[i]);
+        a = resultado;
+        despacharNuevo(lineas[i]);
+        if (memcmp(&a, &resultado, sizeof(Resultado)) != 0) {
+            fprintf(stderr, "diferencia en \"%s\"\n", lineas[i]);
+            diferencias++;
+        }
+    }
+
+    double nsAnterior = medir(despacharAnterior, iteraciones);
+    double nsNuevo = medir(despacharNuevo, iteraciones);
+
+    // Misma mezcla con NUM_EXTRA comandos más registrados
+    memcpy(tablaGrande, tablaBase, sizeof(tablaBase));
+    for (int i = 0; i < NUM_EXTRA; i++) {
+        snprintf(nombresExtra[i], sizeof(nombresExtra[i]), "EXTRA_%02d", i);
+        tablaGrande[NUM_BASE + i] = (Comando){ nombresExtra[i], cmdExtra, 0, 0, "" };
+    }
+    comandosRegistrar(tablaGrande, NUM_BASE + NUM_EXTRA);
+    double nsNuevoGrande = medir(despacharNuevo, iteraciones);
+
+    printf("{\"bench\":\"comandos\",\"iterations\":%ld,\"mismatches\":%ld,"
+           "\"strstr_ns\":%.1f,\"tabla_ns\":%.1f,\"tabla_%d_cmds_ns\":%.1f,"
+           "\"strstr_cmds_per_sec\":%.0f,\"tabla_cmds_per_sec\":%.0f}\n",
+           iteraciones, diferencias,
+           nsAnterior, nsNuevo, NUM_BASE + NUM_EXTRA, nsNuevoGrande,
+           1e9 / nsAnterior, 1e9 / nsNuevo);
+
+    return diferencias != 0;
+}
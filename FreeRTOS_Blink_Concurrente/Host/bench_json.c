@@ -0,0 +1,159 @@
+/**
+  ******************************************************************************
+  * @file    bench_json.c
+  * @brief   Benchmark en host: escritor JSON (json_tx) contra los caminos
+  *          anteriores con snprintf + floatToStr.
+  *
+  *          Compilar desde FreeRTOS_Blink_Concurrente:
+  *            gcc -O2 -ICore/Inc Host/bench_json.c Core/Src/json_tx.c -o bench_json
+  *          Ejecutar: ./bench_json [iteraciones]
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "json_tx.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Stubs ---------------------------------------------------------------------*/
+// El benchmark escribe en un buffer propio, nunca en el buffer de TX
+uint8_t *uartTxReservar(int capacidad, ReservaUartTx *reserva) {
+    (void)capacidad; (void)reserva;
+    return NULL;
+}
+
+void uartTxConfirmar(ReservaUartTx *reserva, int len) {
+    (void)reserva; (void)len;
+}
+
+/* Caminos anteriores ----------------------------------------------------------*/
+
+// Peor caso de "%d.%02d" con dos int de 32 bits, más el terminador
+#define TAM_FLOAT_STR 24
+
+static void floatToStr(float val, char *str, int maxLen) {
+    int intPart = (int)val;
+    int fracPart = (int)((val - intPart) * 100);
+    if (fracPart < 0) fracPart = -fracPart;
+    snprintf(str, maxLen, "%d.%02d", intPart, fracPart);
+}
+
+static int metricasSnprintf(char *buffer, int cap, const char *recibo, const uint32_t ms[5]) {
+    char qStr[TAM_FLOAT_STR], pStr[TAM_FLOAT_STR], wStr[TAM_FLOAT_STR], dStr[TAM_FLOAT_STR], totStr[TAM_FLOAT_STR];
+    floatToStr((float)ms[0] / 1000.0f, qStr, sizeof(qStr));
+    floatToStr((float)ms[1] / 1000.0f, pStr, sizeof(pStr));
+    floatToStr((float)ms[2] / 1000.0f, wStr, sizeof(wStr));
+    floatToStr((float)ms[3] / 1000.0f, dStr, sizeof(dStr));
+    floatToStr((float)ms[4] / 1000.0f, totStr, sizeof(totStr));
+
+    return snprintf(buffer, cap,
+        "{\"type\":\"metrics\",\"order\":\"%s\","
+        "\"t_queue_kitchen\":\"%s\","
+        "\"t_prep\":\"%s\","
+        "\"t_wait_driver\":\"%s\","
+        "\"t_drive\":\"%s\","
+        "\"t_total\":\"%s\"}\r\n",
+        recibo, qStr, pStr, wStr, dStr, totStr);
+}
+
+static int eventoSnprintf(char *buffer, int cap, const char *recibo, int prepCentis) {
+    char prepStr[TAM_FLOAT_STR];
+    floatToStr((float)prepCentis / 100.0f, prepStr, sizeof(prepStr));
+
+    return snprintf(buffer, cap,
+        "{\"type\":\"event\",\"ev\":\"%s\",\"order\":\"%s\",\"prepTime\":\"%s\",\"restaurantId\":%d,\"destinationId\":%d}\r\n",
+        "ORDER_CREATED", recibo, prepStr, 3, 12);
+}
+
+/* Caminos nuevos ------------------------------------------------------------*/
+
+static int metricasJson(char *buffer, int cap, const char *recibo, const uint32_t ms[5]) {
+    JsonTx j;
+    jsonIniciarBuffer(&j, buffer, cap);
+    jsonCadena(&j, "type", "metrics");
+    jsonCadena(&j, "order", recibo);
+    jsonFijoTexto(&j, "t_queue_kitchen", (int32_t)(ms[0] / 10), 2);
+    jsonFijoTexto(&j, "t_prep", (int32_t)(ms[1] / 10), 2);
+    jsonFijoTexto(&j, "t_wait_driver", (int32_t)(ms[2] / 10), 2);
+    jsonFijoTexto(&j, "t_drive", (int32_t)(ms[3] / 10), 2);
+    jsonFijoTexto(&j, "t_total", (int32_t)(ms[4] / 10), 2);
+    return jsonTerminar(&j);
+}
+
+static int eventoJson(char *buffer, int cap, const char *recibo, int prepCentis) {
+    JsonTx j;
+    jsonIniciarBuffer(&j, buffer, cap);
+    jsonCadena(&j, "type", "event");
+    jsonCadena(&j, "ev", "ORDER_CREATED");
+    jsonCadena(&j, "order", recibo);
+    jsonFijoTexto(&j, "prepTime", prepCentis, 2);
+    jsonEntero(&j, "restaurantId", 3);
+    jsonEntero(&j, "destinationId", 12);
+    return jsonTerminar(&j);
+}
+
+/* Medición ------------------------------------------------------------------*/
+
+static double ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static volatile int sumidero;
+
+int main(int argc, char **argv) {
+    long iteraciones = (argc > 1) ? atol(argv[1]) : 1000000;
+    char a[256], b[256];
+    char recibo[20];
+    uint32_t ms[5] = { 1530, 12500, 4210, 33070, 51310 };
+    long diferencias = 0;
+    long redondeos = 0;
+
+    // Misma estructura; los decimales pueden diferir en la última cifra
+    // porque floatToStr trunca un float y json_tx usa el entero exacto
+    for (int i = 0; i < 1000; i++) {
+        snprintf(recibo, sizeof(recibo), "PED-%d", i);
+        ms[1] = 10000 + (uint32_t)i * 37;
+        int la = metricasSnprintf(a, sizeof(a), recibo, ms);
+        int lb = metricasJson(b, sizeof(b), recibo, ms);
+        if (la != lb) diferencias++;
+        else if (memcmp(a, b, la) != 0) redondeos++;
+
+        la = eventoSnprintf(a, sizeof(a), recibo, 1250 + i);
+        lb = eventoJson(b, sizeof(b), recibo, 1250 + i);
+        if (la != lb) diferencias++;
+        else if (memcmp(a, b, la) != 0) redondeos++;
+    }
+
+    double t0 = ahoraNs();
+    for (long i = 0; i < iteraciones; i++) {
+        ms[4] = 51310 + (uint32_t)(i & 1023);
+        sumidero += metricasSnprintf(a, sizeof(a), "PED-1234", ms);
+    }
+    double t1 = ahoraNs();
+    for (long i = 0; i < iteraciones; i++) {
+        ms[4] = 51310 + (uint32_t)(i & 1023);
+        sumidero += metricasJson(b, sizeof(b), "PED-1234", ms);
+    }
+    double t2 = ahoraNs();
+    for (long i = 0; i < iteraciones; i++) {
+        sumidero += eventoSnprintf(a, sizeof(a), "PED-1234", 1250 + (int)(i & 1023));
+    }
+    double t3 = ahoraNs();
+    for (long i = 0; i < iteraciones; i++) {
+        sumidero += eventoJson(b, sizeof(b), "PED-1234", 1250 + (int)(i & 1023));
+    }
+    double t4 = ahoraNs();
+
+    printf("{\"bench\":\"json_tx\",\"iterations\":%ld,\"mismatches\":%ld,\"rounding_diffs\":%ld,"
+           "\"metrics_snprintf_ns\":%.1f,\"metrics_json_tx_ns\":%.1f,"
+           "\"event_snprintf_ns\":%.1f,\"event_json_tx_ns\":%.1f}\n",
+           iteraciones, diferencias, redondeos,
+           (t1 - t0) / iteraciones, (t2 - t1) / iteraciones,
+           (t3 - t2) / iteraciones, (t4 - t3) / iteraciones);
+
+    return diferencias != 0;
+}
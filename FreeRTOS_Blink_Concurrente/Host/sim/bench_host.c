@@ -0,0 +1,480 @@
+/**
+  ******************************************************************************
+  * @file    bench_host.c
+  * @brief   Benchmarks del núcleo de despacho en host, en dos niveles.
+  *
+  *          Micro: funciones sueltas de freertos.c sobre un mundo fijo (mapa
+  *          de 8x8, tabla de pedidos llena, repartidores ocupados). Cada
+  *          muestra mide "lote" llamadas seguidas; se informan media, p50,
+  *          p95 y mínimo en ns por llamada, y los bytes que emite cada una.
+  *
+  *          Macro: la aplicación completa (las cinco tareas) con el reloj
+  *          virtual y el generador de carga. Cada perfil genera hasta
+  *          llenar la tabla (MAX_PEDIDOS, sin reciclar huecos), así todos
+  *          miden la misma cantidad de pedidos; luego la carga se apaga y se
+  *          espera a que se entreguen. Se informan pedidos entregados por
+  *          segundo real, p95 de t_total (histograma de la aplicación) y CPU
+  *          del proceso por pedido.
+  *
+  *          freertos.c se compila dentro de este archivo para llegar a sus
+  *          tipos y estáticos; la salida de la aplicación solo se cuenta.
+  *          El resultado es un objeto JSON con el commit del build:
+  *            make bench FREERTOS_KERNEL=...
+  *            ./despacho_bench --salida bench-$(git rev-parse --short HEAD).json
+  *          --micro / --macro corren un solo nivel; --muestras n por micro.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "freertos.c"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Defines -------------------------------------------------------------------*/
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "desconocido"
+#endif
+
+#define SEMILLA_BENCH       2024u
+#define MUESTRAS_DEFECTO    2000
+#define MUESTRAS_MAX        20000
+#define MAX_PARES_ASTAR     (MAX_RESTAURANTES * MAX_CASAS)
+#define SALIDA_MAX          16384
+
+// Sondeo de la tabla durante las llegadas (tiempo simulado)
+#define LLEGADAS_PASO_MS    200u
+
+// Drenaje tras la ventana de llegadas: sondeo y tope (tiempo simulado)
+#define DRENAJE_PASO_MS     10000u
+#define DRENAJE_MAX_MS      (30u * 60000u)
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    const char *nombre;
+    void (*preparar)(void);     // antes de cada muestra, fuera de la medición
+    void (*medir)(uint32_t i);
+    uint32_t lote;              // llamadas por muestra
+} Micro;
+
+typedef struct {
+    const char *nombre;
+    ModoCarga modo;
+    uint32_t porHora;
+    uint32_t periodoS;          // periodo de la curva de hora pico (comprimida)
+    uint32_t rafagasPorHora;
+    uint32_t tamRafaga;
+    uint32_t minutosMax;        // tope de la ventana si la tabla no se llena
+} Macro;
+
+/* Variables -----------------------------------------------------------------*/
+static volatile int sumidero;
+static uint64_t bytesSalida;
+
+static int muestras = MUESTRAS_DEFECTO;
+static int correrMicros = 1;
+static int correrMacros = 1;
+static int fdResultado = STDOUT_FILENO;
+
+static double tiempos[MUESTRAS_MAX];
+
+static Posicion paresAStar[MAX_PARES_ASTAR][2];
+static int numPares;
+
+static char recibos[MAX_PEDIDOS + 1][20];
+static Restaurante restauranteOriginal;
+static Pedido pedidoMetricas;
+
+static char salida[SALIDA_MAX];
+static int largoSalida;
+
+/* Salida --------------------------------------------------------------------*/
+
+// Transporte de uart_tx.c: la salida de la aplicación solo se cuenta
+void uartTxHostEscribir(const uint8_t *datos, int len) {
+    (void)datos;
+    bytesSalida += (uint64_t)len;
+}
+
+static void agregar(const char *formato, ...) __attribute__((format(__printf__, 1, 2)));
+
+static void agregar(const char *formato, ...) {
+    va_list args;
+
+    if (largoSalida >= SALIDA_MAX) return;
+
+    va_start(args, formato);
+    int n = vsnprintf(salida + largoSalida, SALIDA_MAX - largoSalida, formato, args);
+    va_end(args);
+
+    if (n > 0) largoSalida += n;
+    if (largoSalida > SALIDA_MAX - 1) largoSalida = SALIDA_MAX - 1;
+}
+
+static void escribirResultado(void) {
+    const char *p = salida;
+    int len = largoSalida;
+
+    while (len > 0) {
+        ssize_t n = write(fdResultado, p, (size_t)len);
+        if (n > 0) {
+            p += n;
+            len -= (int)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return;
+        }
+    }
+}
+
+/* Medición ------------------------------------------------------------------*/
+
+static double ahoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double cpuNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compararDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Mundo de los micro ----------------------------------------------------------*/
+
+// Mapa fijo, MAX_PEDIDOS pedidos y cada repartidor con dos pedidos en curso
+static void prepararMundo(void) {
+    aleatorioSembrar(SEMILLA_BENCH);
+    inicializarSistema(8, 8, 6, 15, 5);
+
+    for (int n = 0; n < MAX_PEDIDOS; n++) {
+        int platillos[2] = { n % 3, (n + 1) % 3 };
+        registrarPedidoWeb(n % sistema.numRestaurantes, n % sistema.numCasas, platillos, 2);
+    }
+    xQueueReset(queuePedidos);
+
+    // Los pedidos en curso están al final de la tabla: buscarPedido recorre
+    for (int r = 0; r < sistema.numRepartidores; r++) {
+        Repartidor *rep = &sistema.listaRepartidores[r];
+        for (int k = 0; k < 2; k++) {
+            strcpy(rep->pedidosAceptados[k], sistema.listaPedidos[MAX_PEDIDOS - 1 - 2 * r - k].numeroRecibo);
+        }
+        rep->numPedidosAceptados = 2;
+        rep->indicePedidoActual = 0;
+        rep->estado = (r % 2) ? EN_CAMINO_A_DESTINO : EN_CAMINO_A_RESTAURANTE;
+    }
+
+    numPares = 0;
+    for (int r = 0; r < sistema.numRestaurantes; r++) {
+        for (int c = 0; c < sistema.numCasas && numPares < MAX_PARES_ASTAR; c++) {
+            paresAStar[numPares][0] = getPuntoAccesoRestaurante(r);
+            paresAStar[numPares][1] = getPuntoAccesoCasa(c);
+            numPares++;
+        }
+    }
+
+    for (int n = 0; n < sistema.numPedidos; n++) {
+        strcpy(recibos[n], sistema.listaPedidos[n].numeroRecibo);
+    }
+    strcpy(recibos[sistema.numPedidos], "PED-999");
+
+    restauranteOriginal = sistema.listaRestaurantes[0];
+
+    // Cinco etapas con tiempos plausibles para enviarMetricasPedido
+    strcpy(pedidoMetricas.numeroRecibo, "PED-1234");
+    pedidoMetricas.idRestaurante = 0;
+    pedidoMetricas.repartidorId = 0;
+    pedidoMetricas.t_creado = 1000;
+    pedidoMetricas.t_inicioPrep = 2530;
+    pedidoMetricas.t_finPrep = 15030;
+    pedidoMetricas.t_recogido = 19240;
+    pedidoMetricas.t_entregado = 52310;
+
+    // Historia para los percentiles: 1000 entregas sintéticas
+    for (int n = 0; n < 1000; n++) {
+        for (int e = 0; e < NUM_ETAPAS; e++) {
+            histogramaRegistrar(&histogramasEtapa[e], 500u + (uint32_t)(rand() % 60000));
+        }
+    }
+}
+
+/* Micro-benchmarks ----------------------------------------------------------*/
+
+static void medirAStar(uint32_t i) {
+    Posicion paso = calcularSiguientePasoAStar(paresAStar[i % numPares][0], paresAStar[i % numPares][1]);
+    sumidero += paso.posx;
+}
+
+// Lo que hace asignarPedidoARepartidor con cada candidato, sin la
+// confirmación aleatoria ni las esperas
+static void medirScore(uint32_t i) {
+    Pedido *p = &sistema.listaPedidos[i % sistema.numPedidos];
+
+    for (int r = 0; r < sistema.numRepartidores; r++) {
+        int desvio = calcularDesvioRuta(r, p);
+        sumidero += (int)calcularScoreCompleto(r, p, desvio);
+    }
+}
+
+static void medirMetricasGlobales(uint32_t i) {
+    (void)i;
+    calcularMetricasGlobales();
+    sumidero += (int)metricas.etapas[ETAPA_TOTAL].p95;
+}
+
+static void medirPercentil(uint32_t i) {
+    sumidero += (int)histogramaPercentil(&histogramasEtapa[ETAPA_TOTAL], 500u + (i & 7u) * 60u);
+}
+
+// Tres en cola con umbral 5: FCFS
+static void prepararFcfs(void) {
+    sistema.listaRestaurantes[0] = restauranteOriginal;
+    sistema.listaRestaurantes[0].cantidadDeCambio = 5;
+    sistema.listaRestaurantes[0].colaPedidosCount = 3;
+}
+
+// Cola completa (MAX_COLA_RESTAURANTE) con umbral 5: SJF
+static void prepararSjf(void) {
+    Restaurante *rest = &sistema.listaRestaurantes[0];
+
+    *rest = restauranteOriginal;
+    rest->cantidadDeCambio = 5;
+    rest->colaPedidosCount = MAX_COLA_RESTAURANTE;
+    for (int k = 0; k < MAX_COLA_RESTAURANTE; k++) {
+        rest->colaPedidos[k] = k;
+    }
+}
+
+static void medirProcesar(uint32_t i) {
+    (void)i;
+    procesarPedidosRestaurante(0);
+}
+
+static void medirBuscar(uint32_t i) {
+    sumidero += buscarPedido(recibos[i % (uint32_t)(sistema.numPedidos + 1)]) != NULL;
+}
+
+static void medirEvento(uint32_t i) {
+    enviarEventoPedido("ORDER_CREATED", "PED-1234", NULL, 1250 + (int)(i & 1023), 3, 12);
+}
+
+static void medirMetricasPedido(uint32_t i) {
+    pedidoMetricas.metricsSent = 0;
+    pedidoMetricas.t_entregado = 52310 + (i & 1023);
+    enviarMetricasPedido(&pedidoMetricas);
+}
+
+static void medirEstadisticas(uint32_t i) {
+    (void)i;
+    enviarEstadisticas();
+}
+
+static void medirEnvioGlobal(uint32_t i) {
+    (void)i;
+    enviarMetricasGlobales();
+}
+
+static const Micro micros[] = {
+    { "astar_step",           NULL,         medirAStar,            1 },
+    { "assign_scoring",       NULL,         medirScore,            1 },
+    { "global_metrics",       NULL,         medirMetricasGlobales, 1 },
+    { "histogram_percentile", NULL,         medirPercentil,        16 },
+    { "restaurant_fcfs",      prepararFcfs, medirProcesar,         1 },
+    { "restaurant_sjf",       prepararSjf,  medirProcesar,         1 },
+    { "find_order",           NULL,         medirBuscar,           16 },
+    { "emit_event",           NULL,         medirEvento,           4 },
+    { "emit_order_metrics",   NULL,         medirMetricasPedido,   4 },
+    { "emit_driver_stats",    NULL,         medirEstadisticas,     1 },
+    { "emit_global_metrics",  NULL,         medirEnvioGlobal,      1 },
+};
+
+#define NUM_MICROS ((int)(sizeof(micros) / sizeof(micros[0])))
+
+static void correrMicro(const Micro *m, int primero) {
+    uint32_t llamada = 0;
+
+    // Calentamiento: caches, predictor y la primera reserva de TX
+    for (int s = 0; s < muestras / 10 + 1; s++) {
+        if (m->preparar) m->preparar();
+        for (uint32_t k = 0; k < m->lote; k++) m->medir(llamada++);
+    }
+
+    uint64_t bytesAntes = bytesSalida;
+    double suma = 0.0;
+
+    for (int s = 0; s < muestras; s++) {
+        if (m->preparar) m->preparar();
+
+        double t0 = ahoraNs();
+        for (uint32_t k = 0; k < m->lote; k++) m->medir(llamada++);
+        tiempos[s] = (ahoraNs() - t0) / m->lote;
+        suma += tiempos[s];
+    }
+
+    qsort(tiempos, (size_t)muestras, sizeof(tiempos[0]), compararDouble);
+
+    uint64_t llamadas = (uint64_t)muestras * m->lote;
+    agregar("%s\n  {\"name\":\"%s\",\"calls\":%llu,\"mean_ns\":%.1f,\"p50_ns\":%.1f,"
+            "\"p95_ns\":%.1f,\"min_ns\":%.1f,\"bytes_per_call\":%.1f}",
+            primero ? "" : ",", m->nombre, (unsigned long long)llamadas, suma / muestras,
+            tiempos[muestras / 2], tiempos[(muestras * 95) / 100], tiempos[0],
+            (double)(bytesSalida - bytesAntes) / (double)llamadas);
+}
+
+/* Macro-benchmarks ----------------------------------------------------------*/
+
+static const Macro macros[] = {
+    { "poisson_30h", CARGA_POISSON,   30, 0,        0, 0, 8 * 60 },
+    { "rush_15h",    CARGA_HORA_PICO, 15, 2 * 3600, 0, 0, 8 * 60 },
+    { "burst_10h",   CARGA_RAFAGAS,   10, 0,        2, 8, 8 * 60 },
+};
+
+#define NUM_MACROS ((int)(sizeof(macros) / sizeof(macros[0])))
+
+static void aplicarCarga(const ConfigCarga *c) {
+    taskENTER_CRITICAL();
+    cargaConfigurar(c, relojAhora());
+    taskEXIT_CRITICAL();
+}
+
+static int contarEntregados(void) {
+    int n = 0;
+    for (int p = 0; p < sistema.numPedidos; p++) {
+        if (sistema.listaPedidos[p].entregado) n++;
+    }
+    return n;
+}
+
+static int hayPendientes(void) {
+    for (int p = 0; p < sistema.numPedidos; p++) {
+        const Pedido *pedido = &sistema.listaPedidos[p];
+        if (!pedido->entregado && pedido->estado != CANCELADO) return 1;
+    }
+    return 0;
+}
+
+static void correrMacro(const Macro *m, int primero) {
+    ConfigCarga c;
+
+    // La carga se configura antes de arrancar: TaskTx la reinicia desde la
+    // semilla al ver el sistema corriendo
+    cargaObtenerConfig(&c);
+    c.modo = m->modo;
+    c.porHora = m->porHora;
+    if (m->periodoS) c.periodoS = m->periodoS;
+    c.rafagasPorHora = m->rafagasPorHora;
+    c.tamRafaga = m->tamRafaga;
+    c.semilla = SEMILLA_BENCH;
+    aplicarCarga(&c);
+
+    aleatorioSembrar(SEMILLA_BENCH);
+    regenerarMapa();
+
+    uint64_t bytesAntes = bytesSalida;
+    uint32_t simInicio = relojAhora();
+    double t0 = ahoraNs();
+    double c0 = cpuNs();
+
+    // La ventana termina al llenarse la tabla; lo que llegue en el último
+    // sondeo sale como "capped"
+    for (uint32_t ms = 0; ms < m->minutosMax * 60000u && sistema.numPedidos < MAX_PEDIDOS;
+         ms += LLEGADAS_PASO_MS) {
+        relojEsperar(LLEGADAS_PASO_MS);
+    }
+
+    c.modo = CARGA_APAGADA;
+    aplicarCarga(&c);
+    for (uint32_t ms = 0; ms < DRENAJE_MAX_MS && hayPendientes(); ms += DRENAJE_PASO_MS) {
+        relojEsperar(DRENAJE_PASO_MS);
+    }
+
+    double muroNs = ahoraNs() - t0;
+    double cpu = cpuNs() - c0;
+    uint32_t simMs = relojAhora() - simInicio;
+    sistema.sistemaCorriendo = 0;
+
+    ContadoresCarga contadores;
+    cargaObtenerContadores(&contadores);
+    int entregados = contarEntregados();
+
+    agregar("%s\n  {\"name\":\"%s\",\"seed\":%u,\"sim_s\":%.1f,\"wall_ms\":%.2f,"
+            "\"created\":%d,\"delivered\":%d,\"capped\":%lu,\"orders_per_s\":%.1f,"
+            "\"p50_total_ms\":%lu,\"p95_total_ms\":%lu,\"cpu_us_per_order\":%.1f,\"bytes_out\":%llu}",
+            primero ? "" : ",", m->nombre, SEMILLA_BENCH, simMs / 1000.0, muroNs / 1e6,
+            sistema.numPedidos, entregados, (unsigned long)contadores.alTope,
+            muroNs > 0 ? entregados / (muroNs / 1e9) : 0.0,
+            (unsigned long)histogramaPercentil(&histogramasEtapa[ETAPA_TOTAL], 500),
+            (unsigned long)histogramaPercentil(&histogramasEtapa[ETAPA_TOTAL], 950),
+            entregados > 0 ? cpu / 1e3 / entregados : 0.0,
+            (unsigned long long)(bytesSalida - bytesAntes));
+}
+
+/* Tasks ---------------------------------------------------------------------*/
+
+// Prioridad máxima: durante los micro ninguna otra tarea corre
+static void tareaBench(void *argumento) {
+    (void)argumento;
+
+    agregar("{\"bench\":\"dispatch\",\"commit\":\"%s\",\"samples\":%d,\"micro\":[",
+            BENCH_COMMIT, muestras);
+    if (correrMicros) {
+        prepararMundo();
+        for (int i = 0; i < NUM_MICROS; i++) {
+            correrMicro(&micros[i], i == 0);
+        }
+    }
+    agregar("],\n\"macro\":[");
+
+    if (correrMacros) {
+        relojFijarModo(RELOJ_VIRTUAL);
+        for (int i = 0; i < NUM_MACROS; i++) {
+            correrMacro(&macros[i], i == 0);
+        }
+    }
+    agregar("]}\n");
+
+    escribirResultado();
+    _exit(0);
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--salida") == 0 && i + 1 < argc) {
+            fdResultado = open(argv[++i], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fdResultado < 0) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--micro") == 0) {
+            correrMacros = 0;
+        } else if (strcmp(argv[i], "--macro") == 0) {
+            correrMicros = 0;
+        } else if (strcmp(argv[i], "--muestras") == 0 && i + 1 < argc) {
+            muestras = atoi(argv[++i]);
+            if (muestras < 1) muestras = 1;
+            if (muestras > MUESTRAS_MAX) muestras = MUESTRAS_MAX;
+        } else {
+            fprintf(stderr, "Uso: %s [--salida archivo] [--micro|--macro] [--muestras n]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    osKernelInitialize();
+    MX_FREERTOS_Init();
+    xTaskCreate(tareaBench, "Bench", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL);
+    osKernelStart();
+
+    return 1;
+}
@@ -0,0 +1,531 @@
+/**
+  ******************************************************************************
+  * @file    canal_host.c
+  * @brief   Prueba del canal confiable de comandos sobre un enlace con
+  *          pérdidas.
+  *
+  *          Del lado del STM32 corren el framer de uart_rx.c, canal_cmd.c y
+  *          los acuses de telemetria.c, que salen por uart_tx.c. Del otro
+  *          lado, un emisor con la misma lógica que canal.js: ventana
+  *          deslizante desde el seq más antiguo sin confirmar, retransmisión
+  *          por timeout de lo que el acuse selectivo no cubre.
+  *
+  *          Entre ambos, un enlace simulado en cada sentido que descarta,
+  *          duplica, corrompe y reordena tramas (retardo al azar) y a veces
+  *          repite el 0x00 de apertura, como al resincronizar tras perder
+  *          un delimitador. El tiempo es simulado, en ms, y todo sale de una
+  *          semilla: una falla se repite igual.
+  *
+  *          Comprueba que cada comando se ejecuta exactamente una vez y en
+  *          orden, y que el emisor no abandona ninguno. Recorre varios
+  *          niveles de pérdida; sale con 0 si todos pasan y 1 si no.
+  *            ./despacho_canal [--comandos n] [--semilla n] [--ventana n]
+  *          --ventana (hasta 32) por encima de CANAL_CMD_RETENIDOS ejercita
+  *          las tramas que el STM32 no puede retener.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "uart_rx.h"
+#include "uart_tx.h"
+#include "canal_cmd.h"
+#include "telemetria.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define COMANDOS_DEFECTO    3000
+#define SEMILLA_DEFECTO     2024u
+
+// Emisor, como en canal.js (windowSize, rtoMs, maxRetries); la ventana
+// por defecto es la que usa serial.js
+#define VENTANA_DEFECTO     8
+#define VENTANA_EMISOR      32
+#define RTO_MS              300u
+#define MAX_REINTENTOS      60
+#define REVISION_MS         (RTO_MS / 4)
+
+#define MAX_TRAMA           160
+#define MAX_EN_ENLACE       512
+#define LIMITE_MS           (60u * 60u * 1000u)
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t llega;
+    uint32_t orden;             // desempate estable entre iguales
+    int len;
+    uint8_t datos[MAX_TRAMA];
+} TramaEnVuelo;
+
+typedef struct {
+    const char *nombre;
+    float perdida;
+    float corrupcion;
+    float duplicado;
+    uint32_t retardoMaxMs;      // retardo al azar: reordena
+    float ceroRepetido;         // 0x00 extra delante de la trama
+} PerfilEnlace;
+
+typedef struct {
+    const PerfilEnlace *perfil;
+    TramaEnVuelo cola[MAX_EN_ENLACE];
+    int n;
+    uint32_t orden;
+    uint32_t enviadas;
+    uint32_t perdidas;
+    uint32_t corruptas;
+    uint32_t duplicadas;
+    uint32_t cerosRepetidos;
+} Enlace;
+
+typedef struct {
+    int usado;
+    uint16_t seq;
+    int comando;
+    uint32_t enviado;
+    int intentos;
+} EnVuelo;
+
+typedef struct {
+    EnVuelo vuelo[VENTANA_EMISOR];
+    int siguienteComando;
+    uint16_t siguienteSeq;
+    uint8_t sesion;
+    uint32_t confirmados;
+    uint32_t retransmisiones;
+    uint32_t abandonados;
+    uint32_t acuses;
+} Emisor;
+
+/* Variables -----------------------------------------------------------------*/
+static uint32_t estadoAzar;
+static uint32_t ahoraMs;
+static int numComandos = COMANDOS_DEFECTO;
+static int ventanaEmisor = VENTANA_DEFECTO;
+
+static Enlace haciaPlaca;
+static Enlace haciaHost;
+static Emisor emisor;
+
+// Lado del STM32: anillo de recepción y framer reales
+static uint8_t anilloRx[UART_RX_BUFFER_SIZE];
+static FramerRx framer;
+static uint32_t escritoRx;
+
+// Resultado: veces que corrió cada comando y orden de llegada
+static uint8_t *ejecuciones;
+static int esperado;
+static uint32_t fueraDeOrden;
+static uint32_t repetidos;
+static uint32_t lineasBasura;
+
+static const PerfilEnlace perfiles[] = {
+    { "limpio",       0.00f, 0.00f, 0.00f,   5, 0.00f },
+    { "ceros_dobles", 0.00f, 0.00f, 0.00f,   5, 0.50f },
+    { "perdida_10",   0.10f, 0.03f, 0.03f,  40, 0.03f },
+    { "perdida_20",   0.20f, 0.05f, 0.05f,  80, 0.05f },
+    { "perdida_40",   0.40f, 0.10f, 0.10f, 150, 0.10f },
+};
+
+/* Stubs ---------------------------------------------------------------------*/
+// uart_rx.c y uart_tx.c se enlazan sin el kernel: en esta prueba no hay
+// scheduler, el TX nunca se llena y la recepción va por framerRxSiguiente
+
+BaseType_t xTaskGetSchedulerState(void) {
+    return taskSCHEDULER_NOT_STARTED;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay) {
+    (void)xTicksToDelay;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return NULL;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+    (void)xClearCountOnExit; (void)xTicksToWait;
+    return 0;
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction,
+                              uint32_t *pulPreviousNotificationValue) {
+    (void)xTaskToNotify; (void)ulValue; (void)eAction; (void)pulPreviousNotificationValue;
+    return pdPASS;
+}
+
+void vPortEnterCritical(void) {
+}
+
+void vPortExitCritical(void) {
+}
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static uint32_t azar(void) {
+    // xorshift32: alcanza para decidir pérdidas y retardos
+    estadoAzar ^= estadoAzar << 13;
+    estadoAzar ^= estadoAzar >> 17;
+    estadoAzar ^= estadoAzar << 5;
+    return estadoAzar;
+}
+
+static float azarUniforme(void) {
+    return (float)(azar() >> 8) * (1.0f / 16777216.0f);
+}
+
+static int16_t seqDiff(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b);
+}
+
+/* Enlace --------------------------------------------------------------------*/
+
+static void enlaceIniciar(Enlace *e, const PerfilEnlace *perfil) {
+    memset(e, 0, sizeof(*e));
+    e->perfil = perfil;
+}
+
+// Pone una trama en el enlace: puede perderse, duplicarse, corromperse o
+// llevar un 0x00 repetido delante
+static void enlaceEnviar(Enlace *e, const uint8_t *datos, int len) {
+    const PerfilEnlace *p = e->perfil;
+    int extra = 0;
+
+    e->enviadas++;
+    if (azarUniforme() < p->ceroRepetido) {
+        extra = 1;
+        e->cerosRepetidos++;
+    }
+    if (len + extra > MAX_TRAMA) len = MAX_TRAMA - extra;
+
+    if (azarUniforme() < p->perdida) {
+        e->perdidas++;
+        return;
+    }
+
+    int copias = 1;
+    if (azarUniforme() < p->duplicado) {
+        copias = 2;
+        e->duplicadas++;
+    }
+
+    for (int c = 0; c < copias && e->n < MAX_EN_ENLACE; c++) {
+        TramaEnVuelo *t = &e->cola[e->n++];
+
+        t->datos[0] = 0x00;
+        memcpy(&t->datos[extra], datos, len);
+        t->len = len + extra;
+        t->llega = ahoraMs + 1 + (p->retardoMaxMs ? azar() % p->retardoMaxMs : 0);
+        t->orden = e->orden++;
+
+        if (azarUniforme() < p->corrupcion) {
+            t->datos[extra + azar() % len] ^= (uint8_t)(1u << (azar() % 8));
+            e->corruptas++;
+        }
+    }
+}
+
+// Saca la próxima trama que ya llegó (la de menor instante); 0 si no hay
+static int enlaceRecibir(Enlace *e, TramaEnVuelo *out) {
+    int mejor = -1;
+
+    for (int i = 0; i < e->n; i++) {
+        TramaEnVuelo *t = &e->cola[i];
+        if (t->llega > ahoraMs) continue;
+        if (mejor < 0 || t->llega < e->cola[mejor].llega ||
+            (t->llega == e->cola[mejor].llega && t->orden < e->cola[mejor].orden)) {
+            mejor = i;
+        }
+    }
+    if (mejor < 0) return 0;
+
+    *out = e->cola[mejor];
+    e->cola[mejor] = e->cola[--e->n];
+    return 1;
+}
+
+/* Lado del STM32 ------------------------------------------------------------*/
+
+// Transporte de uart_tx.c: los acuses vuelven por el enlace con pérdidas
+void uartTxHostEscribir(const uint8_t *datos, int len) {
+    enlaceEnviar(&haciaHost, datos, len);
+}
+
+// "Ejecuta" un comando CMD,n: lo anota y revisa el orden
+static void ejecutarComandoPrueba(const char *texto) {
+    int n;
+
+    if (sscanf(texto, "CMD,%d", &n) != 1 || n < 0 || n >= numComandos) {
+        lineasBasura++;
+        return;
+    }
+
+    if (ejecuciones[n]++ > 0) repetidos++;
+    if (n != esperado) fueraDeOrden++;
+    esperado = n + 1;
+}
+
+// Como StartTaskRx: los bytes entran al anillo y el framer los separa
+static void placaRecibir(const uint8_t *datos, int len) {
+    LineaRx linea;
+
+    for (int k = 0; k < len; k++) {
+        anilloRx[(escritoRx + k) % UART_RX_BUFFER_SIZE] = datos[k];
+    }
+    escritoRx += len;
+
+    while (framerRxSiguiente(&framer, escritoRx, &linea)) {
+        if (!linea.binaria) {
+            // Restos de una trama cortada por un 0x00 corrupto
+            lineasBasura++;
+            continue;
+        }
+
+        char *texto = canalCmdProcesarTrama((uint8_t *)linea.datos, linea.len);
+        while (texto != NULL) {
+            ejecutarComandoPrueba(texto);
+            texto = canalCmdSiguiente();
+        }
+    }
+}
+
+/* Emisor (canal.js) ---------------------------------------------------------*/
+
+// seq más antiguo sin confirmar, o el próximo si no hay ninguno
+static uint16_t emisorVentana(void) {
+    int hay = 0;
+    uint16_t min = emisor.siguienteSeq;
+
+    for (int i = 0; i < VENTANA_EMISOR; i++) {
+        EnVuelo *v = &emisor.vuelo[i];
+        if (v->usado && (!hay || seqDiff(v->seq, min) < 0)) {
+            min = v->seq;
+            hay = 1;
+        }
+    }
+    return min;
+}
+
+static void emisorTransmitir(EnVuelo *v) {
+    uint8_t crudo[MAX_TRAMA];
+    uint8_t trama[MAX_TRAMA + 8];
+    uint16_t ventana = emisorVentana();
+    int n = 0;
+
+    crudo[n++] = TEL_VERSION;
+    crudo[n++] = TEL_CMD;
+    crudo[n++] = (uint8_t)(v->seq & 0xFF);
+    crudo[n++] = (uint8_t)(v->seq >> 8);
+    crudo[n++] = (uint8_t)(ventana & 0xFF);
+    crudo[n++] = (uint8_t)(ventana >> 8);
+    crudo[n++] = emisor.sesion;
+    n += snprintf((char *)&crudo[n], MAX_TRAMA - n - 2, "CMD,%d", v->comando);
+
+    uint16_t crc = telemetriaCrc16(crudo, n);
+    crudo[n++] = (uint8_t)(crc & 0xFF);
+    crudo[n++] = (uint8_t)(crc >> 8);
+
+    trama[0] = 0x00;
+    int len = telemetriaCobsCodificar(crudo, n, &trama[1]);
+    trama[1 + len] = 0x00;
+
+    v->enviado = ahoraMs;
+    enlaceEnviar(&haciaPlaca, trama, len + 2);
+}
+
+// La ventana limita la distancia al más antiguo sin confirmar
+static void emisorLlenarVentana(void) {
+    while (emisor.siguienteComando < numComandos &&
+           seqDiff(emisor.siguienteSeq, emisorVentana()) < ventanaEmisor) {
+        EnVuelo *v = NULL;
+        for (int i = 0; i < VENTANA_EMISOR && v == NULL; i++) {
+            if (!emisor.vuelo[i].usado) v = &emisor.vuelo[i];
+        }
+        if (v == NULL) return;
+
+        v->usado = 1;
+        v->seq = emisor.siguienteSeq++;
+        v->comando = emisor.siguienteComando++;
+        v->intentos = 0;
+        emisorTransmitir(v);
+    }
+}
+
+// Retransmite lo vencido; se rinde tras MAX_REINTENTOS
+static void emisorRevisar(void) {
+    for (int i = 0; i < VENTANA_EMISOR; i++) {
+        EnVuelo *v = &emisor.vuelo[i];
+        if (!v->usado || ahoraMs - v->enviado < RTO_MS) continue;
+
+        if (v->intentos >= MAX_REINTENTOS) {
+            v->usado = 0;
+            emisor.abandonados++;
+            continue;
+        }
+        v->intentos++;
+        emisor.retransmisiones++;
+        emisorTransmitir(v);
+    }
+    emisorLlenarVentana();
+}
+
+// Acuse del STM32: base = primer seq sin recibir, bit i = base + i recibido
+static void emisorAcuse(uint16_t base, uint32_t mascara) {
+    emisor.acuses++;
+
+    for (int i = 0; i < VENTANA_EMISOR; i++) {
+        EnVuelo *v = &emisor.vuelo[i];
+        if (!v->usado) continue;
+
+        int16_t d = seqDiff(v->seq, base);
+        if (d < 0 || (d < 32 && ((mascara >> d) & 1u))) {
+            v->usado = 0;
+            emisor.confirmados++;
+        }
+    }
+    emisorLlenarVentana();
+}
+
+// Trama del STM32 (con delimitadores): solo interesan los TEL_ACK válidos.
+// Un 0x00 de apertura repetido se salta, como en telemetria.js
+static void emisorRecibir(uint8_t *trama, int len) {
+    while (len > 1 && trama[0] == 0x00 && trama[1] == 0x00) {
+        trama++;
+        len--;
+    }
+    if (len < 3 || trama[0] != 0x00 || trama[len - 1] != 0x00) return;
+
+    int n = telemetriaCobsDecodificar(&trama[1], len - 2);
+    uint8_t *r = &trama[1];
+
+    if (n != 2 + 6 + 2) return;
+    if (telemetriaCrc16(r, n - 2) != (uint16_t)(r[n - 2] | (r[n - 1] << 8))) return;
+    if (r[0] != TEL_VERSION || r[1] != TEL_ACK) return;
+
+    uint16_t base = (uint16_t)(r[2] | (r[3] << 8));
+    uint32_t mascara = (uint32_t)r[4] | ((uint32_t)r[5] << 8) |
+                       ((uint32_t)r[6] << 16) | ((uint32_t)r[7] << 24);
+    emisorAcuse(base, mascara);
+}
+
+static int emisorPendientes(void) {
+    if (emisor.siguienteComando < numComandos) return 1;
+    for (int i = 0; i < VENTANA_EMISOR; i++) {
+        if (emisor.vuelo[i].usado) return 1;
+    }
+    return 0;
+}
+
+/* Corrida -------------------------------------------------------------------*/
+
+// Una corrida completa con un perfil; devuelve 1 si pasó
+static int correrPerfil(const PerfilEnlace *perfil, uint32_t semilla) {
+    TramaEnVuelo t;
+
+    estadoAzar = semilla ? semilla : 1u;
+    ahoraMs = 0;
+    enlaceIniciar(&haciaPlaca, perfil);
+    enlaceIniciar(&haciaHost, perfil);
+
+    // Sesión distinta de la anterior, como un puente recién arrancado
+    uint8_t sesionPrevia = emisor.sesion;
+    memset(&emisor, 0, sizeof(emisor));
+    do {
+        emisor.sesion = (uint8_t)azar();
+    } while (emisor.sesion == sesionPrevia);
+    emisor.siguienteSeq = (uint16_t)azar();
+
+    framerRxIniciar(&framer, anilloRx, UART_RX_BUFFER_SIZE);
+    escritoRx = 0;
+    memset(ejecuciones, 0, (size_t)numComandos);
+    esperado = 0;
+    fueraDeOrden = 0;
+    repetidos = 0;
+    lineasBasura = 0;
+
+    EstadisticasCanalCmd antes;
+    canalCmdObtenerEstadisticas(&antes);
+
+    emisorLlenarVentana();
+
+    while ((emisorPendientes() || haciaPlaca.n > 0 || haciaHost.n > 0) && ahoraMs < LIMITE_MS) {
+        ahoraMs++;
+
+        while (enlaceRecibir(&haciaPlaca, &t)) placaRecibir(t.datos, t.len);
+        while (enlaceRecibir(&haciaHost, &t)) emisorRecibir(t.datos, t.len);
+
+        if (ahoraMs % REVISION_MS == 0) emisorRevisar();
+    }
+
+    int faltantes = 0;
+    for (int i = 0; i < numComandos; i++) {
+        if (ejecuciones[i] == 0) faltantes++;
+    }
+
+    EstadisticasCanalCmd canal;
+    canalCmdObtenerEstadisticas(&canal);
+
+    // Sin pérdida ni corrupción no debe hacer falta retransmitir: un 0x00
+    // repetido no puede costar la trama que lo sigue
+    int sinDanio = perfil->perdida == 0.0f && perfil->corrupcion == 0.0f;
+
+    int ok = faltantes == 0 && repetidos == 0 && fueraDeOrden == 0 &&
+             emisor.abandonados == 0 && ahoraMs < LIMITE_MS &&
+             (!sinDanio || emisor.retransmisiones == 0);
+
+    printf("{\"profile\":\"%s\",\"ok\":%s,\"commands\":%d,\"missing\":%d,\"repeated\":%lu,"
+           "\"out_of_order\":%lu,\"abandoned\":%lu,\"sim_ms\":%lu,\"retransmits\":%lu,"
+           "\"lost\":%lu,\"corrupted\":%lu,\"duplicated\":%lu,\"double_zero\":%lu,\"held\":%lu,\"no_room\":%lu,"
+           "\"crc_errors\":%lu,\"garbage\":%lu}\n",
+           perfil->nombre, ok ? "true" : "false", numComandos, faltantes,
+           (unsigned long)repetidos, (unsigned long)fueraDeOrden,
+           (unsigned long)emisor.abandonados, (unsigned long)ahoraMs,
+           (unsigned long)emisor.retransmisiones,
+           (unsigned long)(haciaPlaca.perdidas + haciaHost.perdidas),
+           (unsigned long)(haciaPlaca.corruptas + haciaHost.corruptas),
+           (unsigned long)(haciaPlaca.duplicadas + haciaHost.duplicadas),
+           (unsigned long)(haciaPlaca.cerosRepetidos + haciaHost.cerosRepetidos),
+           (unsigned long)(canal.retenidas - antes.retenidas),
+           (unsigned long)(canal.sinLugar - antes.sinLugar),
+           (unsigned long)(canal.erroresCrc - antes.erroresCrc),
+           (unsigned long)lineasBasura);
+
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    uint32_t semilla = SEMILLA_DEFECTO;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--comandos") == 0 && i + 1 < argc) {
+            numComandos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            semilla = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--ventana") == 0 && i + 1 < argc) {
+            ventanaEmisor = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "uso: %s [--comandos n] [--semilla n] [--ventana n]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (numComandos <= 0) numComandos = COMANDOS_DEFECTO;
+    if (ventanaEmisor < 1 || ventanaEmisor > VENTANA_EMISOR) ventanaEmisor = VENTANA_DEFECTO;
+
+    ejecuciones = calloc((size_t)numComandos, 1);
+    if (ejecuciones == NULL) return 2;
+
+    uartTxInit();
+    uartTxSetModo(UART_TX_DESCARTAR);
+
+    int fallas = 0;
+    for (size_t p = 0; p < sizeof(perfiles) / sizeof(perfiles[0]); p++) {
+        // Cada perfil es un puente nuevo: otra sesión, el STM32 se resincroniza
+        if (!correrPerfil(&perfiles[p], semilla + (uint32_t)p)) fallas++;
+    }
+
+    free(ejecuciones);
+    return fallas ? 1 : 0;
+}
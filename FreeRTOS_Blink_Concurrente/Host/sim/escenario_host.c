@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file    escenario_host.c
+  * @brief   Archivo de escenario -> registros SCENARIO, para main_host.c y
+  *          regresion_host.c. Las líneas vacías y las que empiezan con '#'
+  *          se ignoran.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "escenario_host.h"
+#include "escenario.h"
+#include "comandos.h"
+#include "uart_rx.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Functions -----------------------------------------------------------------*/
+
+// Carga un escenario con los mismos registros que el comando SCENARIO
+int escenarioCargarArchivo(const char *ruta) {
+    char linea[UART_RX_MAX_LINEA + 2];
+    int numLinea = 0;
+    FILE *f = fopen(ruta, "r");
+
+    if (f == NULL) {
+        perror(ruta);
+        return 0;
+    }
+
+    while (fgets(linea, sizeof(linea), f) != NULL) {
+        ArgsCmd args;
+        int campoMalo;
+
+        numLinea++;
+        int n = comandosTokenizar(linea, &args);
+        if (n == 0 || args.argv[0][0] == '#') continue;
+
+        if (n < 2 || strcmp(args.argv[0], "SCENARIO") != 0) {
+            fprintf(stderr, "%s:%d: se esperaba un registro SCENARIO\n", ruta, numLinea);
+            fclose(f);
+            return 0;
+        }
+
+        const char *motivo = escenarioProcesar(&args.argv[1], n - 1, &campoMalo);
+        if (motivo != NULL) {
+            fprintf(stderr, "%s:%d: %s invalido (%s)\n", ruta, numLinea, motivo, args.argv[1 + campoMalo]);
+            fclose(f);
+            return 0;
+        }
+    }
+    fclose(f);
+
+    if (escenarioEstado() != ESCENARIO_LISTO) {
+        fprintf(stderr, "%s: falta SCENARIO,END\n", ruta);
+        return 0;
+    }
+    return 1;
+}
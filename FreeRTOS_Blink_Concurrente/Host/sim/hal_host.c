@@ -0,0 +1,142 @@
+/**
+  ******************************************************************************
+  * @file    hal_host.c
+  * @brief   Stubs del HAL y de CMSIS-RTOS v2 para el simulador de host.
+  *
+  *          HAL_GetTick es el contador de ticks de FreeRTOS (1 ms), así el
+  *          tiempo de la aplicación es el del scheduler simulado. El LED
+  *          solo guarda su estado y la UART escribe en el enlace serie de
+  *          main_host.c.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "usart.h"
+#include "gpio.h"
+#include "cmsis_os.h"
+#include "uart_tx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Variables -----------------------------------------------------------------*/
+uint32_t SystemCoreClock = 180000000u;
+
+GPIO_TypeDef hostGpioA;
+USART_TypeDef hostUsart2;
+
+UART_HandleTypeDef huart2 = {
+    .Instance = USART2,
+    .gState = HAL_UART_STATE_READY,
+    .RxState = HAL_UART_STATE_READY
+};
+
+/* HAL -----------------------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void) {
+    return (uint32_t)xTaskGetTickCount();
+}
+
+// Con el scheduler corriendo cede la CPU en lugar de esperar activamente
+void HAL_Delay(uint32_t ms) {
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+    } else {
+        usleep(ms * 1000u);
+    }
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *puerto, uint16_t pin, GPIO_PinState estado) {
+    if (estado == GPIO_PIN_SET) {
+        puerto->odr |= pin;
+    } else {
+        puerto->odr &= ~(uint32_t)pin;
+    }
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *puerto, uint16_t pin) {
+    return (puerto->odr & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *puerto, uint16_t pin) {
+    puerto->odr ^= pin;
+}
+
+// Transmisión bloqueante directa (la usa el modo pánico de uart_tx.c)
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *datos, uint16_t len, uint32_t espera) {
+    (void)huart;
+    (void)espera;
+    uartTxHostEscribir(datos, len);
+    return HAL_OK;
+}
+
+void SystemClock_Config(void) {
+}
+
+void MX_GPIO_Init(void) {
+}
+
+void MX_USART2_UART_Init(void) {
+}
+
+void Error_Handler(void) {
+    fprintf(stderr, "Error_Handler\n");
+    abort();
+}
+
+void vAssertCalled(const char *archivo, unsigned long linea) {
+    fprintf(stderr, "configASSERT en %s:%lu\n", archivo, linea);
+    abort();
+}
+
+/* printf --------------------------------------------------------------------*/
+
+// Mismo camino que _write en la placa: el texto entra al buffer de TX
+int hostPrintf(const char *formato, ...) {
+    char buffer[UART_TX_MAX_REGISTRO];
+    va_list args;
+
+    va_start(args, formato);
+    int len = vsnprintf(buffer, sizeof(buffer), formato, args);
+    va_end(args);
+
+    if (len < 0) return len;
+    if (len >= (int)sizeof(buffer)) len = sizeof(buffer) - 1;
+
+    return uartTxEnviar(buffer, len);
+}
+
+/* CMSIS-RTOS v2 -------------------------------------------------------------*/
+
+osStatus_t osKernelInitialize(void) {
+    return osOK;
+}
+
+osStatus_t osKernelStart(void) {
+    vTaskStartScheduler();
+    return osError;
+}
+
+// La pila pedida (bytes) se agranda al mínimo que necesita un pthread
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr) {
+    const char *nombre = (attr && attr->name) ? attr->name : "";
+    UBaseType_t prioridad = (attr && attr->priority) ? (UBaseType_t)attr->priority : osPriorityNormal;
+    uint32_t palabras = (attr && attr->stack_size) ? attr->stack_size / sizeof(StackType_t) : 0;
+    TaskHandle_t tarea = NULL;
+
+    if (palabras < configMINIMAL_STACK_SIZE) palabras = configMINIMAL_STACK_SIZE;
+
+    if (xTaskCreate(func, nombre, (uint16_t)palabras, argument, prioridad, &tarea) != pdPASS) {
+        return NULL;
+    }
+    return (osThreadId_t)tarea;
+}
+
+osStatus_t osDelay(uint32_t ticks) {
+    vTaskDelay(ticks);
+    return osOK;
+}
@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file    FreeRTOSConfig.h (host)
+  * @brief   Configuración de FreeRTOS para el port POSIX del simulador.
+  *
+  *          Mantiene lo que la aplicación ve en la placa (tick de 1 ms,
+  *          prioridades CMSIS, mutex, semáforos, estadísticas de ejecución,
+  *          traza) y cambia solo lo que el port necesita: cada tarea es un
+  *          pthread, así que las pilas y el heap son mucho más grandes.
+  ******************************************************************************
+  */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <stdint.h>
+extern uint32_t SystemCoreClock;
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          0
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      1
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       ( SystemCoreClock )
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 56 )
+// Palabras de pila; cada tarea necesita al menos PTHREAD_STACK_MIN
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)8192)
+#define configTOTAL_HEAP_SIZE                    ((size_t)(4 * 1024 * 1024))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_TRACE_FACILITY                 1
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configUSE_MALLOC_FAILED_HOOK             1
+
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+#define configUSE_TIMERS                         1
+#define configTIMER_TASK_PRIORITY                ( 2 )
+#define configTIMER_QUEUE_LENGTH                 10
+#define configTIMER_TASK_STACK_DEPTH             configMINIMAL_STACK_SIZE
+
+#define INCLUDE_vTaskPrioritySet                 1
+#define INCLUDE_uxTaskPriorityGet                1
+#define INCLUDE_vTaskDelete                      1
+#define INCLUDE_vTaskCleanUpResources            0
+#define INCLUDE_vTaskSuspend                     1
+#define INCLUDE_vTaskDelayUntil                  1
+#define INCLUDE_vTaskDelay                       1
+#define INCLUDE_xTaskGetSchedulerState           1
+#define INCLUDE_xTimerPendFunctionCall           1
+#define INCLUDE_xQueueGetMutexHolder             1
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#define INCLUDE_xTaskGetCurrentTaskHandle        1
+#define INCLUDE_xTaskGetIdleTaskHandle           1
+#define INCLUDE_eTaskGetState                    1
+
+#define configASSERT( x ) if ((x) == 0) { vAssertCalled(__FILE__, __LINE__); }
+void vAssertCalled(const char *archivo, unsigned long linea);
+
+/* Igual que en la placa: tiempo de CPU por tarea (perfil.c cuenta
+   microsegundos del reloj monótono en host) */
+#define configGENERATE_RUN_TIME_STATS            1
+void perfilIniciarContador(void);
+uint32_t perfilContador(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() perfilIniciarContador()
+#define portGET_RUN_TIME_COUNTER_VALUE()         perfilContador()
+
+/* Reloj virtual (reloj.c): con todas las tareas bloqueadas la idle salta el
+   tick al próximo desbloqueo; en modo real relojSuprimirTicks no hace nada
+   y el idle hook duerme para no ocupar un núcleo */
+#define configUSE_TICKLESS_IDLE                  1
+void relojSuprimirTicks(uint32_t esperados);
+#define portSUPPRESS_TICKS_AND_SLEEP(x)          relojSuprimirTicks(x)
+
+/* Traza del scheduler (traza.c), con los mismos macros que la placa */
+#include "traza.h"
+#if TRAZA_HABILITADA
+#define traceTASK_SWITCHED_IN()                  trazaRegistrar(TRAZA_TAREA_ENTRA, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SWITCHED_OUT()                 trazaRegistrar(TRAZA_TAREA_SALE, (uint8_t)pxCurrentTCB->uxTCBNumber, 0)
+#define traceQUEUE_SEND(q)                       trazaCola(TRAZA_COLA_ENVIO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_SEND_FROM_ISR(q)              trazaCola(TRAZA_COLA_ENVIO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_SEND_FAILED(q)                trazaCola(TRAZA_COLA_ENVIO_FALLO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_RECEIVE(q)                    trazaCola(TRAZA_COLA_RECEPCION, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceQUEUE_RECEIVE_FROM_ISR(q)           trazaCola(TRAZA_COLA_RECEPCION, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceBLOCKING_ON_QUEUE_SEND(q)           trazaCola(TRAZA_COLA_BLOQUEO_ENVIO, (q)->uxQueueNumber, (q)->ucQueueType)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(q)        trazaCola(TRAZA_COLA_BLOQUEO_RECEPCION, (q)->uxQueueNumber, (q)->ucQueueType)
+#endif
+
+#endif /* FREERTOS_CONFIG_H */
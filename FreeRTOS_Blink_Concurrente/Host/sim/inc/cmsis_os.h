@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file    cmsis_os.h (host)
+  * @brief   Subconjunto de CMSIS-RTOS v2 que usa la aplicación, sobre la API
+  *          nativa de FreeRTOS.
+  *
+  *          El cmsis_os2.c de Middlewares depende del núcleo Cortex-M
+  *          (IPSR, PRIMASK, SysTick), así que en host se reemplaza por
+  *          estas pocas funciones (hal_host.c).
+  ******************************************************************************
+  */
+#ifndef CMSIS_OS_H_
+#define CMSIS_OS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    osOK = 0,
+    osError = -1
+} osStatus_t;
+
+// Mismos valores que CMSIS-RTOS v2 (configMAX_PRIORITIES = 56)
+typedef enum {
+    osPriorityIdle          = 1,
+    osPriorityLow           = 8,
+    osPriorityBelowNormal   = 16,
+    osPriorityNormal        = 24,
+    osPriorityAboveNormal   = 32,
+    osPriorityHigh          = 40,
+    osPriorityRealtime      = 48
+} osPriority_t;
+
+typedef void *osThreadId_t;
+typedef void (*osThreadFunc_t)(void *argument);
+
+typedef struct {
+    const char *name;
+    uint32_t attr_bits;
+    void *cb_mem;
+    uint32_t cb_size;
+    void *stack_mem;
+    uint32_t stack_size;
+    osPriority_t priority;
+    uint32_t tz_module;
+    uint32_t reserved;
+} osThreadAttr_t;
+
+/* Function prototypes -------------------------------------------------------*/
+osStatus_t osKernelInitialize(void);
+osStatus_t osKernelStart(void);
+osThreadId_t osThreadNew(osThreadFunc_t func, void *argument, const osThreadAttr_t *attr);
+osStatus_t osDelay(uint32_t ticks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CMSIS_OS_H_ */
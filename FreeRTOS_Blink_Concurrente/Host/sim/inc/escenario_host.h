@@ -0,0 +1,14 @@
+/**
+  ******************************************************************************
+  * @file    escenario_host.h
+  * @brief   Carga de un archivo de escenario en las herramientas del host.
+  ******************************************************************************
+  */
+#ifndef __ESCENARIO_HOST_H__
+#define __ESCENARIO_HOST_H__
+
+// Procesa los registros SCENARIO del archivo (ver escenario.h); 0 si falla,
+// con el error en stderr
+int escenarioCargarArchivo(const char *ruta);
+
+#endif /* __ESCENARIO_HOST_H__ */
@@ -0,0 +1,24 @@
+/**
+  ******************************************************************************
+  * @file    gpio.h (host)
+  * @brief   GPIO simulado: solo guarda el estado de los pines.
+  ******************************************************************************
+  */
+#ifndef __GPIO_H__
+#define __GPIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Function prototypes -------------------------------------------------------*/
+void MX_GPIO_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GPIO_H__ */
@@ -0,0 +1,92 @@
+/**
+  ******************************************************************************
+  * @file    main.h (host)
+  * @brief   Superficie del HAL que usa la aplicación, para el simulador de
+  *          host. Reemplaza a Core/Inc/main.h: va antes en la ruta de
+  *          includes (ver Host/sim/Makefile).
+  *
+  *          Las funciones están en hal_host.c: HAL_GetTick es el tick de
+  *          FreeRTOS, HAL_Delay cede la CPU y el GPIO solo guarda el estado.
+  ******************************************************************************
+  */
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Types ---------------------------------------------------------------------*/
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef enum {
+    RESET = 0,
+    SET = !RESET
+} FlagStatus, ITStatus;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef enum {
+    HAL_UART_STATE_RESET = 0,
+    HAL_UART_STATE_READY = 0x20
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+    uint32_t odr;
+} GPIO_TypeDef;
+
+typedef struct {
+    uint32_t id;
+} USART_TypeDef;
+
+typedef struct {
+    USART_TypeDef *Instance;
+    HAL_UART_StateTypeDef gState;
+    HAL_UART_StateTypeDef RxState;
+} UART_HandleTypeDef;
+
+/* Defines -------------------------------------------------------------------*/
+extern GPIO_TypeDef hostGpioA;
+extern USART_TypeDef hostUsart2;
+
+#define GPIOA               (&hostGpioA)
+#define USART2              (&hostUsart2)
+
+#define GPIO_PIN_5          ((uint16_t)0x0020)
+#define GPIO_PIN_13         ((uint16_t)0x2000)
+
+#define HAL_MAX_DELAY       0xFFFFFFFFU
+
+// No hay líneas EXTI en host: el botón se simula con el comando REGEN
+#define __HAL_GPIO_EXTI_GET_IT(pin)     (RESET)
+#define __HAL_GPIO_EXTI_CLEAR_IT(pin)   ((void)(pin))
+
+extern uint32_t SystemCoreClock;
+
+/* Function prototypes -------------------------------------------------------*/
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t ms);
+void HAL_GPIO_WritePin(GPIO_TypeDef *puerto, uint16_t pin, GPIO_PinState estado);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *puerto, uint16_t pin);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *puerto, uint16_t pin);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *datos, uint16_t len, uint32_t espera);
+void SystemClock_Config(void);
+void Error_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
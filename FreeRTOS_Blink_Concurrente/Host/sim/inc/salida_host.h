@@ -0,0 +1,21 @@
+/**
+  ******************************************************************************
+  * @file    salida_host.h
+  * @brief   printf de la aplicación hacia el buffer de TX, como en la placa
+  *          (syscalls.c: _write -> uartTxEnviar).
+  *
+  *          El Makefile lo fuerza con -include en las fuentes de Core/Src.
+  *          Así ninguna tarea entra a la stdio de la libc, que toma locks
+  *          por hilo y no es segura con las tareas-pthread del port POSIX.
+  ******************************************************************************
+  */
+#ifndef __SALIDA_HOST_H__
+#define __SALIDA_HOST_H__
+
+#include <stdio.h>
+
+int hostPrintf(const char *formato, ...) __attribute__((format(printf, 1, 2)));
+
+#define printf hostPrintf
+
+#endif /* __SALIDA_HOST_H__ */
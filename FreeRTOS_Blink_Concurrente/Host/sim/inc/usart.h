@@ -0,0 +1,28 @@
+/**
+  ******************************************************************************
+  * @file    usart.h (host)
+  * @brief   USART2 simulado: el enlace serie es stdin/stdout o una
+  *          pseudo-terminal (ver main_host.c).
+  ******************************************************************************
+  */
+#ifndef __USART_H__
+#define __USART_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Variables -----------------------------------------------------------------*/
+extern UART_HandleTypeDef huart2;
+
+/* Function prototypes -------------------------------------------------------*/
+void MX_USART2_UART_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __USART_H__ */
@@ -0,0 +1,208 @@
+/**
+  ******************************************************************************
+  * @file    main_host.c
+  * @brief   Punto de entrada del simulador de host: la misma aplicación de
+  *          Core/Src sobre el port POSIX de FreeRTOS.
+  *
+  *          El enlace serie es stdin/stdout o un pseudo-terminal:
+  *            ./despacho_host                    (stdin/stdout)
+  *            ./despacho_host --pty /tmp/ttyDespacho
+  *            SERIAL_PORT=/tmp/ttyDespacho node serial.js
+  *          --duracion <ms> termina el proceso tras esos ms de tick.
+  *          --virtual arranca con el reloj virtual (ver reloj.h); también
+  *          se cambia en marcha con el comando CLOCK,VIRTUAL.
+  *          --escenario <archivo> carga registros SCENARIO (ver escenario.h)
+  *          antes de arrancar; el mapa sale de ahí en el próximo REGEN.
+  *          --semilla <n> fija la semilla de corrida, como SEED,n.
+  *
+  *          La tarea "SerieHost" hace de DMA de recepción: pasa lo leído a
+  *          uartRxAlimentar. La salida la escribe uart_tx.c con
+  *          uartTxHostEscribir.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "main.h"
+#include "cmsis_os.h"
+#include "uart_rx.h"
+#include "uart_tx.h"
+#include "reloj.h"
+#include "aleatorio.h"
+#include "escenario_host.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Defines -------------------------------------------------------------------*/
+#define LECTURA_MAX        256
+#define PERIODO_SONDEO_MS  2
+
+/* Variables -----------------------------------------------------------------*/
+static int fdEntrada = STDIN_FILENO;
+static int fdSalida = STDOUT_FILENO;
+// Extremo esclavo del pty; se mantiene abierto para que el maestro no vea
+// EIO cuando el puente se desconecta
+static int fdEsclavo = -1;
+static int entradaCerrada = 0;
+static uint32_t duracionMs = 0;
+
+void MX_FREERTOS_Init(void);
+
+/* Helper Functions ----------------------------------------------------------*/
+
+static void usoYSalir(const char *programa) {
+    fprintf(stderr, "Uso: %s [--pty [enlace]] [--duracion ms] [--virtual] [--escenario archivo] [--semilla n]\n", programa);
+    exit(2);
+}
+
+static void ponerNoBloqueante(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+// Crea el pty en modo crudo; "enlace" (opcional) apunta al esclavo
+static int abrirPty(const char *enlace) {
+    int maestro = posix_openpt(O_RDWR | O_NOCTTY);
+    if (maestro < 0 || grantpt(maestro) != 0 || unlockpt(maestro) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+
+    const char *nombre = ptsname(maestro);
+    if (nombre == NULL) {
+        perror("ptsname");
+        return -1;
+    }
+
+    fdEsclavo = open(nombre, O_RDWR | O_NOCTTY);
+    if (fdEsclavo >= 0) {
+        struct termios t;
+        if (tcgetattr(fdEsclavo, &t) == 0) {
+            cfmakeraw(&t);
+            cfsetispeed(&t, B115200);
+            cfsetospeed(&t, B115200);
+            tcsetattr(fdEsclavo, TCSANOW, &t);
+        }
+    }
+
+    if (enlace != NULL) {
+        unlink(enlace);
+        if (symlink(nombre, enlace) != 0) {
+            perror("symlink");
+            return -1;
+        }
+        fprintf(stderr, "Enlace serie: %s -> %s\n", enlace, nombre);
+    } else {
+        fprintf(stderr, "Enlace serie: %s\n", nombre);
+    }
+
+    return maestro;
+}
+
+// Transporte de uart_tx.c: escritura completa, reintentando si el fd está lleno
+void uartTxHostEscribir(const uint8_t *datos, int len) {
+    while (len > 0) {
+        ssize_t n = write(fdSalida, datos, (size_t)len);
+        if (n > 0) {
+            datos += n;
+            len -= (int)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            usleep(1000);
+        } else {
+            return;
+        }
+    }
+}
+
+/* Tasks ---------------------------------------------------------------------*/
+
+// Hace de DMA de recepción: sondea el enlace y alimenta el framer
+static void tareaSerieHost(void *argumento) {
+    uint8_t buffer[LECTURA_MAX];
+    (void)argumento;
+
+    for (;;) {
+        if (duracionMs != 0 && HAL_GetTick() >= duracionMs) {
+            _exit(0);
+        }
+
+        if (!entradaCerrada) {
+            ssize_t n = read(fdEntrada, buffer, sizeof(buffer));
+            if (n > 0) {
+                uartRxAlimentar(buffer, (int)n);
+                // Deja que la tarea RX consuma antes de la siguiente lectura
+                vTaskDelay(1);
+                continue;
+            }
+            // Fin de stdin: la simulación sigue sin entrada
+            if (n == 0 && fdEsclavo < 0) {
+                entradaCerrada = 1;
+            }
+        }
+
+        // Sin entrada no hace falta sondear: en reloj virtual cada sondeo
+        // sería un evento más que simular
+        if (entradaCerrada) {
+            if (duracionMs == 0) vTaskSuspend(NULL);
+            vTaskDelay(duracionMs - HAL_GetTick());
+            continue;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(PERIODO_SONDEO_MS));
+    }
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+int main(int argc, char *argv[]) {
+    int usarPty = 0;
+    const char *enlace = NULL;
+    uint32_t semilla = ALEATORIO_SEMILLA_DEFECTO;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pty") == 0) {
+            usarPty = 1;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                enlace = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--duracion") == 0 && i + 1 < argc) {
+            duracionMs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--virtual") == 0) {
+            relojFijarModo(RELOJ_VIRTUAL);
+        } else if (strcmp(argv[i], "--escenario") == 0 && i + 1 < argc) {
+            if (!escenarioCargarArchivo(argv[++i])) return 2;
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            semilla = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            usoYSalir(argv[0]);
+        }
+    }
+
+    if (usarPty) {
+        int maestro = abrirPty(enlace);
+        if (maestro < 0) return 1;
+        fdEntrada = maestro;
+        fdSalida = maestro;
+    }
+    ponerNoBloqueante(fdEntrada);
+
+    osKernelInitialize();
+    MX_FREERTOS_Init();
+    aleatorioSembrar(semilla);
+    xTaskCreate(tareaSerieHost, "SerieHost", configMINIMAL_STACK_SIZE, NULL, osPriorityHigh, NULL);
+    osKernelStart();
+
+    // vTaskStartScheduler solo vuelve si no pudo crear la tarea idle
+    return 1;
+}
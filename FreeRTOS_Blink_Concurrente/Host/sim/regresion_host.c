@@ -0,0 +1,592 @@
+/**
+  ******************************************************************************
+  * @file    regresion_host.c
+  * @brief   Regresión de comportamiento y rendimiento sobre un escenario.
+  *
+  *          Graba: corre el escenario con el reloj virtual hasta entregar
+  *          toda la traza y guarda, en orden, los eventos de pedido
+  *          (ORDER_CREATED ... DELIVERED) con su instante en ms desde el
+  *          arranque, más las celdas recorridas por la flota:
+  *            ./despacho_regresion --escenario escenarios/ciudad_base.scn \
+  *                                 --grabar actual.ev
+  *          --semilla n fija la semilla de corrida y --comando "X,..."
+  *          (repetible) ejecuta comandos antes del arranque; con ellos se
+  *          elige la política a probar.
+  *
+  *          Compara: --golden archivo compara la corrida con una grabación
+  *          guardada; --comparar a.ev b.ev compara dos grabaciones, p. ej.
+  *          de dos políticas o de dos commits. El informe lista los pedidos
+  *          que divergen (otro repartidor, otra secuencia de eventos, otros
+  *          instantes o presentes en un solo lado) y las diferencias de
+  *          pedidos por hora, p50/p95 del tiempo total y celdas recorridas.
+  *          Sale con 0 si no hay divergencias, 1 si las hay y 2 ante error.
+  *
+  *          Un cambio de comportamiento buscado se acepta regrabando el
+  *          golden (escenarios/<nombre>.ev) en el mismo commit.
+  *
+  *          Formato de una grabación, un registro por línea:
+  *            RUN,semilla
+  *            EV,ms,evento,recibo,repartidor   (repartidor en base 1, 0 = no)
+  *            CELLS,n
+  *            END,ms                           (última marca de la corrida)
+  *          Las líneas que empiezan con '#' son comentarios. El commit va en
+  *          "# commit x": solo se muestra en el informe, así el golden no
+  *          cambia con cada commit. Se acepta aún el viejo RUN,commit,semilla.
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "freertos.c"
+#include "escenario_host.h"
+#include <stdarg.h>
+#include <unistd.h>
+
+/* Defines -------------------------------------------------------------------*/
+#ifndef REGRESION_COMMIT
+#define REGRESION_COMMIT "desconocido"
+#endif
+
+#define MAX_EVENTOS         1024
+#define MAX_COMANDOS        16
+#define MAX_DETALLES        20          // pedidos listados en el informe
+#define PASO_MS             1000u
+#define LIMITE_DEFECTO_MIN  240u
+#define ERROR_JSON          "\"type\":\"error\""
+#define COMENTARIO_COMMIT   "# commit "
+
+/* Types ---------------------------------------------------------------------*/
+typedef struct {
+    uint32_t ms;
+    char evento[20];
+    char recibo[20];
+    uint8_t repartidor;                 // base 1, 0 = sin repartidor
+} EventoGrabado;
+
+typedef struct {
+    char commit[24];
+    uint32_t semilla;
+    EventoGrabado eventos[MAX_EVENTOS];
+    int numEventos;
+    int desbordado;
+    uint32_t celdas;
+    uint32_t finMs;
+} Grabacion;
+
+typedef struct {
+    int creados;
+    int entregados;
+    float porHora;
+    uint32_t p50TotalMs;
+    uint32_t p95TotalMs;
+} Resumen;
+
+typedef struct {
+    int repartidor;
+    int secuencia;
+    int tiempos;
+    int soloA;
+    int soloB;
+} Divergencias;
+
+/* Variables -----------------------------------------------------------------*/
+static Grabacion corrida;
+static Grabacion referencia;
+
+static const char *rutaGrabar = NULL;
+static const char *rutaGolden = NULL;
+static const char *comandos[MAX_COMANDOS];
+static int numComandos = 0;
+static uint32_t semillaCorrida = ALEATORIO_SEMILLA_DEFECTO;
+static uint32_t limiteMs = LIMITE_DEFECTO_MIN * 60000u;
+
+// Mientras se aplican los comandos sus errores van a stderr
+static volatile int mostrarErrores = 0;
+static int erroresComando = 0;
+
+/* Salida --------------------------------------------------------------------*/
+
+static int contiene(const uint8_t *datos, int len, const char *patron) {
+    int n = (int)strlen(patron);
+    for (int i = 0; i + n <= len; i++) {
+        if (memcmp(&datos[i], patron, (size_t)n) == 0) return 1;
+    }
+    return 0;
+}
+
+// Transporte de uart_tx.c: la salida de la aplicación se descarta salvo los
+// errores de los comandos de --comando
+void uartTxHostEscribir(const uint8_t *datos, int len) {
+    if (!mostrarErrores) return;
+    if (!contiene(datos, len, ERROR_JSON)) return;
+
+    fwrite(datos, 1, (size_t)len, stderr);
+    erroresComando++;
+}
+
+/* Grabación -----------------------------------------------------------------*/
+
+// observadorEventoPedido: el instante queda absoluto hasta el final
+static void registrarEvento(const char *evento, const char *numeroRecibo, const char *driver) {
+    if (corrida.numEventos >= MAX_EVENTOS) {
+        corrida.desbordado = 1;
+        return;
+    }
+
+    EventoGrabado *e = &corrida.eventos[corrida.numEventos++];
+    e->ms = relojAhora();
+    snprintf(e->evento, sizeof(e->evento), "%s", evento);
+    snprintf(e->recibo, sizeof(e->recibo), "%s", numeroRecibo);
+    e->repartidor = (uint8_t)(indiceRepartidorPorNombre(driver) + 1);
+}
+
+static int escribirGrabacion(const Grabacion *g, const char *ruta) {
+    FILE *f = fopen(ruta, "w");
+    if (f == NULL) {
+        perror(ruta);
+        return 0;
+    }
+
+    fprintf(f, "# despacho_regresion: %d eventos\n", g->numEventos);
+    for (int i = 0; i < numComandos; i++) {
+        fprintf(f, "# comando %s\n", comandos[i]);
+    }
+    fprintf(f, COMENTARIO_COMMIT "%s\n", g->commit);
+    fprintf(f, "RUN,%lu\n", (unsigned long)g->semilla);
+    for (int i = 0; i < g->numEventos; i++) {
+        const EventoGrabado *e = &g->eventos[i];
+        fprintf(f, "EV,%lu,%s,%s,%u\n", (unsigned long)e->ms, e->evento, e->recibo, e->repartidor);
+    }
+    fprintf(f, "CELLS,%lu\n", (unsigned long)g->celdas);
+    fprintf(f, "END,%lu\n", (unsigned long)g->finMs);
+
+    return fclose(f) == 0;
+}
+
+static int leerEntero(const char *tok, uint32_t *out) {
+    char *fin;
+    unsigned long v = strtoul(tok, &fin, 10);
+
+    if (*tok == '\0' || *fin != '\0') return 0;
+    *out = (uint32_t)v;
+    return 1;
+}
+
+static int leerGrabacion(Grabacion *g, const char *ruta) {
+    char linea[128];
+    int numLinea = 0;
+    FILE *f = fopen(ruta, "r");
+
+    if (f == NULL) {
+        perror(ruta);
+        return 0;
+    }
+
+    memset(g, 0, sizeof(*g));
+    snprintf(g->commit, sizeof(g->commit), "?");
+
+    while (fgets(linea, sizeof(linea), f) != NULL) {
+        ArgsCmd args;
+        uint32_t v;
+        int ok = 1;
+
+        numLinea++;
+        if (strncmp(linea, COMENTARIO_COMMIT, strlen(COMENTARIO_COMMIT)) == 0) {
+            const char *commit = linea + strlen(COMENTARIO_COMMIT);
+            snprintf(g->commit, sizeof(g->commit), "%.*s", (int)strcspn(commit, "\r\n"), commit);
+            continue;
+        }
+
+        int n = comandosTokenizar(linea, &args);
+        if (n == 0 || args.argv[0][0] == '#') continue;
+
+        if (strcmp(args.argv[0], "EV") == 0 && n == 5 && g->numEventos < MAX_EVENTOS) {
+            EventoGrabado *e = &g->eventos[g->numEventos++];
+            ok = leerEntero(args.argv[1], &e->ms) && leerEntero(args.argv[4], &v);
+            snprintf(e->evento, sizeof(e->evento), "%s", args.argv[2]);
+            snprintf(e->recibo, sizeof(e->recibo), "%s", args.argv[3]);
+            e->repartidor = (uint8_t)v;
+        } else if (strcmp(args.argv[0], "RUN") == 0 && n == 2) {
+            ok = leerEntero(args.argv[1], &g->semilla);
+        } else if (strcmp(args.argv[0], "RUN") == 0 && n == 3) {
+            snprintf(g->commit, sizeof(g->commit), "%s", args.argv[1]);
+            ok = leerEntero(args.argv[2], &g->semilla);
+        } else if (strcmp(args.argv[0], "CELLS") == 0 && n == 2) {
+            ok = leerEntero(args.argv[1], &g->celdas);
+        } else if (strcmp(args.argv[0], "END") == 0 && n == 2) {
+            ok = leerEntero(args.argv[1], &g->finMs);
+        } else {
+            ok = 0;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "%s:%d: registro invalido\n", ruta, numLinea);
+            fclose(f);
+            return 0;
+        }
+    }
+    fclose(f);
+    return 1;
+}
+
+/* Resumen -------------------------------------------------------------------*/
+
+static int compararU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Primer evento "nombre" del pedido, o NULL
+static const EventoGrabado *buscarEvento(const Grabacion *g, const char *recibo, const char *nombre) {
+    for (int i = 0; i < g->numEventos; i++) {
+        if (strcmp(g->eventos[i].recibo, recibo) == 0 && strcmp(g->eventos[i].evento, nombre) == 0) {
+            return &g->eventos[i];
+        }
+    }
+    return NULL;
+}
+
+// Percentil por rango más cercano sobre "n" valores ordenados
+static uint32_t percentil(const uint32_t *v, int n, int permil) {
+    if (n == 0) return 0;
+    int k = (n * permil + 999) / 1000;
+    if (k < 1) k = 1;
+    return v[k - 1];
+}
+
+static void resumir(const Grabacion *g, Resumen *r) {
+    static uint32_t totales[MAX_EVENTOS];
+    int numTotales = 0;
+    uint32_t ultimaEntrega = 0;
+
+    memset(r, 0, sizeof(*r));
+    for (int i = 0; i < g->numEventos; i++) {
+        const EventoGrabado *e = &g->eventos[i];
+
+        if (strcmp(e->evento, "ORDER_CREATED") == 0) {
+            r->creados++;
+        } else if (strcmp(e->evento, "DELIVERED") == 0) {
+            const EventoGrabado *creado = buscarEvento(g, e->recibo, "ORDER_CREATED");
+            if (creado != NULL && e->ms >= creado->ms) {
+                totales[numTotales++] = e->ms - creado->ms;
+            }
+            r->entregados++;
+            if (e->ms > ultimaEntrega) ultimaEntrega = e->ms;
+        }
+    }
+
+    qsort(totales, (size_t)numTotales, sizeof(totales[0]), compararU32);
+    r->p50TotalMs = percentil(totales, numTotales, 500);
+    r->p95TotalMs = percentil(totales, numTotales, 950);
+    r->porHora = ultimaEntrega > 0 ? r->entregados * 3600000.0f / ultimaEntrega : 0.0f;
+}
+
+/* Comparación ---------------------------------------------------------------*/
+
+// Repartidor del último DRIVER_ASSIGNED del pedido (0 = ninguno)
+static int repartidorAsignado(const Grabacion *g, const char *recibo) {
+    int rep = 0;
+    for (int i = 0; i < g->numEventos; i++) {
+        if (strcmp(g->eventos[i].recibo, recibo) == 0 &&
+            strcmp(g->eventos[i].evento, "DRIVER_ASSIGNED") == 0) {
+            rep = g->eventos[i].repartidor;
+        }
+    }
+    return rep;
+}
+
+// Eventos del pedido en orden; devuelve cuántos hay
+static int eventosDe(const Grabacion *g, const char *recibo, const EventoGrabado **out, int max) {
+    int n = 0;
+    for (int i = 0; i < g->numEventos && n < max; i++) {
+        if (strcmp(g->eventos[i].recibo, recibo) == 0) out[n++] = &g->eventos[i];
+    }
+    return n;
+}
+
+// 1 si el pedido ya se listó antes en la grabación
+static int yaVisto(const Grabacion *g, int hasta, const char *recibo) {
+    for (int i = 0; i < hasta; i++) {
+        if (strcmp(g->eventos[i].recibo, recibo) == 0) return 1;
+    }
+    return 0;
+}
+
+static void detalle(int *listados, const char *formato, ...) __attribute__((format(__printf__, 2, 3)));
+
+static void detalle(int *listados, const char *formato, ...) {
+    va_list args;
+
+    if ((*listados)++ >= MAX_DETALLES) return;
+    va_start(args, formato);
+    vfprintf(stdout, formato, args);
+    va_end(args);
+}
+
+// Compara pedido a pedido; "a" es la referencia
+static void compararPedidos(const Grabacion *a, const Grabacion *b, Divergencias *d) {
+    const EventoGrabado *ea[16];
+    const EventoGrabado *eb[16];
+    int listados = 0;
+
+    memset(d, 0, sizeof(*d));
+
+    for (int i = 0; i < a->numEventos; i++) {
+        const char *recibo = a->eventos[i].recibo;
+        if (yaVisto(a, i, recibo)) continue;
+
+        int na = eventosDe(a, recibo, ea, 16);
+        int nb = eventosDe(b, recibo, eb, 16);
+
+        if (nb == 0) {
+            d->soloA++;
+            detalle(&listados, "  %-8s solo en a\n", recibo);
+            continue;
+        }
+
+        int repA = repartidorAsignado(a, recibo);
+        int repB = repartidorAsignado(b, recibo);
+        if (repA != repB) {
+            d->repartidor++;
+            detalle(&listados, "  %-8s repartidor %d -> %d\n", recibo, repA, repB);
+            continue;
+        }
+
+        int igualSecuencia = (na == nb);
+        for (int k = 0; igualSecuencia && k < na; k++) {
+            igualSecuencia = strcmp(ea[k]->evento, eb[k]->evento) == 0;
+        }
+        if (!igualSecuencia) {
+            d->secuencia++;
+            detalle(&listados, "  %-8s secuencia: %d eventos -> %d, ultimo %s -> %s\n", recibo,
+                    na, nb, ea[na - 1]->evento, eb[nb - 1]->evento);
+            continue;
+        }
+
+        int32_t maxDelta = 0;
+        for (int k = 0; k < na; k++) {
+            int32_t delta = (int32_t)(eb[k]->ms - ea[k]->ms);
+            if (abs(delta) > abs(maxDelta)) maxDelta = delta;
+        }
+        if (maxDelta != 0) {
+            d->tiempos++;
+            detalle(&listados, "  %-8s tiempos: hasta %+ld ms\n", recibo, (long)maxDelta);
+        }
+    }
+
+    for (int i = 0; i < b->numEventos; i++) {
+        const char *recibo = b->eventos[i].recibo;
+        if (yaVisto(b, i, recibo)) continue;
+        if (eventosDe(a, recibo, ea, 1) == 0) {
+            d->soloB++;
+            detalle(&listados, "  %-8s solo en b\n", recibo);
+        }
+    }
+
+    if (listados > MAX_DETALLES) {
+        fprintf(stdout, "  ... y %d pedidos mas\n", listados - MAX_DETALLES);
+    }
+}
+
+static int mismoEvento(const EventoGrabado *x, const EventoGrabado *y) {
+    return x->ms == y->ms && x->repartidor == y->repartidor &&
+           strcmp(x->evento, y->evento) == 0 && strcmp(x->recibo, y->recibo) == 0;
+}
+
+static void imprimirEvento(const char *lado, const Grabacion *g, int i) {
+    if (i >= g->numEventos) {
+        fprintf(stdout, "    %s: (fin)\n", lado);
+        return;
+    }
+    const EventoGrabado *e = &g->eventos[i];
+    fprintf(stdout, "    %s: %lu %s %s %u\n", lado, (unsigned long)e->ms, e->evento, e->recibo, e->repartidor);
+}
+
+static void filaMetrica(const char *nombre, double a, double b, const char *formato) {
+    char va[24], vb[24];
+
+    snprintf(va, sizeof(va), formato, a);
+    snprintf(vb, sizeof(vb), formato, b);
+    if (a != 0.0) {
+        fprintf(stdout, "  %-14s %12s %12s %+9.1f%%\n", nombre, va, vb, (b - a) * 100.0 / a);
+    } else {
+        fprintf(stdout, "  %-14s %12s %12s %10s\n", nombre, va, vb, "-");
+    }
+}
+
+// Informe completo; devuelve 1 si hay divergencias de comportamiento
+static int comparar(const Grabacion *a, const char *nombreA, const Grabacion *b, const char *nombreB) {
+    Divergencias d;
+    Resumen ra, rb;
+
+    fprintf(stdout, "a: %s (commit %s, semilla %lu, %d eventos)\n",
+            nombreA, a->commit, (unsigned long)a->semilla, a->numEventos);
+    fprintf(stdout, "b: %s (commit %s, semilla %lu, %d eventos)\n",
+            nombreB, b->commit, (unsigned long)b->semilla, b->numEventos);
+
+    int primera = -1;
+    int n = a->numEventos > b->numEventos ? a->numEventos : b->numEventos;
+    for (int i = 0; i < n && primera < 0; i++) {
+        if (i >= a->numEventos || i >= b->numEventos || !mismoEvento(&a->eventos[i], &b->eventos[i])) {
+            primera = i;
+        }
+    }
+
+    if (primera < 0) {
+        fprintf(stdout, "\nflujo de eventos identico\n");
+    } else {
+        fprintf(stdout, "\nprimera divergencia en el evento %d:\n", primera + 1);
+        imprimirEvento("a", a, primera);
+        imprimirEvento("b", b, primera);
+        fprintf(stdout, "\npedidos:\n");
+    }
+
+    compararPedidos(a, b, &d);
+    if (primera >= 0) {
+        fprintf(stdout, "divergencias: %d repartidor, %d secuencia, %d tiempos, %d solo en a, %d solo en b\n",
+                d.repartidor, d.secuencia, d.tiempos, d.soloA, d.soloB);
+    }
+
+    resumir(a, &ra);
+    resumir(b, &rb);
+    fprintf(stdout, "\n  %-14s %12s %12s %10s\n", "metrica", "a", "b", "delta");
+    filaMetrica("creados", ra.creados, rb.creados, "%.0f");
+    filaMetrica("entregados", ra.entregados, rb.entregados, "%.0f");
+    filaMetrica("pedidos_h", ra.porHora, rb.porHora, "%.2f");
+    filaMetrica("p50_total_ms", ra.p50TotalMs, rb.p50TotalMs, "%.0f");
+    filaMetrica("p95_total_ms", ra.p95TotalMs, rb.p95TotalMs, "%.0f");
+    filaMetrica("celdas", a->celdas, b->celdas, "%.0f");
+    filaMetrica("fin_ms", a->finMs, b->finMs, "%.0f");
+
+    return primera >= 0;
+}
+
+/* Corrida -------------------------------------------------------------------*/
+
+static int hayPendientes(void) {
+    for (int p = 0; p < sistema.numPedidos; p++) {
+        const Pedido *pedido = &sistema.listaPedidos[p];
+        if (!pedido->entregado && pedido->estado != CANCELADO) return 1;
+    }
+    return 0;
+}
+
+static int trazaTerminada(void) {
+    return escenarioPedidosReproducidos() >= escenarioObtener()->numPedidos;
+}
+
+static void aplicarComandos(void) {
+    char linea[UART_RX_MAX_LINEA + 1];
+
+    mostrarErrores = 1;
+    for (int i = 0; i < numComandos; i++) {
+        snprintf(linea, sizeof(linea), "%s", comandos[i]);
+        ejecutarComando(linea);
+    }
+    mostrarErrores = 0;
+}
+
+static void correr(void) {
+    memset(&corrida, 0, sizeof(corrida));
+    snprintf(corrida.commit, sizeof(corrida.commit), "%s", REGRESION_COMMIT);
+    corrida.semilla = semillaCorrida;
+
+    relojFijarModo(RELOJ_VIRTUAL);
+    aleatorioSembrar(semillaCorrida);
+    aplicarComandos();
+    // SEED en --comando manda sobre --semilla
+    corrida.semilla = aleatorioSemilla();
+
+    observadorEventoPedido = registrarEvento;
+    regenerarMapa();
+
+    // inicioCorrida lo fija TaskTx al ver el sistema corriendo
+    uint32_t inicio = relojAhora();
+    while (relojAhora() - inicio < limiteMs) {
+        relojEsperar(PASO_MS);
+        if (inicioCorrida != 0 && trazaTerminada() && !hayPendientes()) break;
+    }
+
+    sistema.sistemaCorriendo = 0;
+    observadorEventoPedido = NULL;
+
+    for (int i = 0; i < corrida.numEventos; i++) {
+        corrida.eventos[i].ms -= inicioCorrida;
+    }
+    for (int r = 0; r < sistema.numRepartidores; r++) {
+        corrida.celdas += sistema.listaRepartidores[r].celdasRecorridas;
+    }
+    corrida.finMs = relojAhora() - inicioCorrida;
+}
+
+/* Tasks ---------------------------------------------------------------------*/
+
+static void tareaRegresion(void *argumento) {
+    int codigo = 0;
+    (void)argumento;
+
+    correr();
+
+    if (!trazaTerminada() || hayPendientes()) {
+        fprintf(stderr, "aviso: limite alcanzado con pedidos pendientes\n");
+    }
+    if (corrida.desbordado) {
+        fprintf(stderr, "aviso: mas de %d eventos, se grabaron los primeros\n", MAX_EVENTOS);
+    }
+    if (erroresComando > 0) codigo = 2;
+
+    if (codigo == 0 && rutaGrabar != NULL && !escribirGrabacion(&corrida, rutaGrabar)) codigo = 2;
+    if (codigo == 0 && rutaGolden != NULL) {
+        codigo = comparar(&referencia, rutaGolden, &corrida, "corrida") ? 1 : 0;
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+    _exit(codigo);
+}
+
+/* Main ----------------------------------------------------------------------*/
+
+static void usoYSalir(const char *programa) {
+    fprintf(stderr,
+            "Uso: %s --escenario archivo [--semilla n] [--comando X,...]... [--limite min]\n"
+            "          [--grabar archivo] [--golden archivo]\n"
+            "     %s --comparar a.ev b.ev\n", programa, programa);
+    exit(2);
+}
+
+int main(int argc, char *argv[]) {
+    const char *escenario = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--comparar") == 0 && i + 2 < argc) {
+            if (!leerGrabacion(&referencia, argv[i + 1]) || !leerGrabacion(&corrida, argv[i + 2])) return 2;
+            return comparar(&referencia, argv[i + 1], &corrida, argv[i + 2]);
+        } else if (strcmp(argv[i], "--escenario") == 0 && i + 1 < argc) {
+            escenario = argv[++i];
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            semillaCorrida = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--comando") == 0 && i + 1 < argc && numComandos < MAX_COMANDOS) {
+            comandos[numComandos++] = argv[++i];
+        } else if (strcmp(argv[i], "--limite") == 0 && i + 1 < argc) {
+            limiteMs = (uint32_t)strtoul(argv[++i], NULL, 10) * 60000u;
+        } else if (strcmp(argv[i], "--grabar") == 0 && i + 1 < argc) {
+            rutaGrabar = argv[++i];
+        } else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            rutaGolden = argv[++i];
+        } else {
+            usoYSalir(argv[0]);
+        }
+    }
+
+    if (escenario == NULL || (rutaGrabar == NULL && rutaGolden == NULL)) usoYSalir(argv[0]);
+    if (!escenarioCargarArchivo(escenario)) return 2;
+    if (rutaGolden != NULL && !leerGrabacion(&referencia, rutaGolden)) return 2;
+
+    osKernelInitialize();
+    MX_FREERTOS_Init();
+    xTaskCreate(tareaRegresion, "Regresion", configMINIMAL_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, NULL);
+    osKernelStart();
+
+    return 2;
+}